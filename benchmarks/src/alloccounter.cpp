@@ -0,0 +1,79 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "microbench.hpp"
+
+/* Replacements of the global allocation functions, counting the allocations made by the whole process
+ * (including the ones made by bit7z, since it is statically linked). */
+
+namespace {
+std::atomic< uint64_t > allocations_count{ 0 };
+std::atomic< uint64_t > allocations_bytes{ 0 };
+
+void* countedAlloc( std::size_t size ) {
+    allocations_count.fetch_add( 1, std::memory_order_relaxed );
+    allocations_bytes.fetch_add( size, std::memory_order_relaxed );
+    void* result = std::malloc( size == 0 ? 1 : size ); // NOLINT(*-no-malloc, *-owning-memory)
+    if ( result == nullptr ) {
+        throw std::bad_alloc{};
+    }
+    return result;
+}
+} // namespace
+
+bit7z::bench::AllocationStats bit7z::bench::allocationStats() noexcept {
+    return { allocations_count.load( std::memory_order_relaxed ), allocations_bytes.load( std::memory_order_relaxed ) };
+}
+
+void* operator new( std::size_t size ) {
+    return countedAlloc( size );
+}
+
+void* operator new[]( std::size_t size ) {
+    return countedAlloc( size );
+}
+
+void* operator new( std::size_t size, const std::nothrow_t& /*tag*/ ) noexcept {
+    try {
+        return countedAlloc( size );
+    } catch ( ... ) {
+        return nullptr;
+    }
+}
+
+void* operator new[]( std::size_t size, const std::nothrow_t& /*tag*/ ) noexcept {
+    try {
+        return countedAlloc( size );
+    } catch ( ... ) {
+        return nullptr;
+    }
+}
+
+void operator delete( void* pointer ) noexcept {
+    std::free( pointer ); // NOLINT(*-no-malloc, *-owning-memory)
+}
+
+void operator delete[]( void* pointer ) noexcept {
+    std::free( pointer ); // NOLINT(*-no-malloc, *-owning-memory)
+}
+
+void operator delete( void* pointer, std::size_t /*size*/ ) noexcept {
+    std::free( pointer ); // NOLINT(*-no-malloc, *-owning-memory)
+}
+
+void operator delete[]( void* pointer, std::size_t /*size*/ ) noexcept {
+    std::free( pointer ); // NOLINT(*-no-malloc, *-owning-memory)
+}
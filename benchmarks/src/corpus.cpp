@@ -0,0 +1,136 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "corpus.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace bit7z;
+using namespace bit7z::bench;
+
+namespace {
+// Words used for generating the compressible parts of the files.
+constexpr const char* kWords[] = { // NOLINT(*-avoid-c-arrays)
+    "archive ", "stream ", "buffer ", "compress ", "extract ", "item ", "property ", "callback ",
+    "format ", "method ", "level ", "dictionary ", "volume ", "solid ", "header ", "update ",
+    "0123456789", "\n", "\t", "{ ", "} ", "; ", "= ", "return "
+};
+constexpr size_t kWordsCount = sizeof( kWords ) / sizeof( kWords[ 0 ] );
+
+constexpr size_t kChunkSize = 64;
+
+constexpr const char* kExtensions[] = { ".txt", ".log", ".cpp", ".json", ".bin", ".dat" }; // NOLINT(*-avoid-c-arrays)
+constexpr size_t kExtensionsCount = sizeof( kExtensions ) / sizeof( kExtensions[ 0 ] );
+
+uint64_t logUniformSize( SplitMix64& rng, uint64_t min_size, uint64_t max_size ) {
+    if ( max_size <= min_size ) {
+        return min_size;
+    }
+    // File sizes in real data sets are roughly log-uniformly distributed.
+    const double log_min = std::log( static_cast< double >( std::max< uint64_t >( min_size, 1 ) ) );
+    const double log_max = std::log( static_cast< double >( max_size ) );
+    const double value = std::exp( log_min + rng.nextDouble() * ( log_max - log_min ) );
+    return std::min( max_size, std::max( min_size, static_cast< uint64_t >( value ) ) );
+}
+} // namespace
+
+Corpus::Corpus( const CorpusOptions& options ) : mOptions{ options }, mTotalSize{ 0 } {
+    if ( options.compressibility < 0.0 || options.compressibility > 1.0 ) {
+        throw std::invalid_argument( "Compressibility must be a value between 0.0 and 1.0" );
+    }
+    if ( options.min_file_size > options.max_file_size ) {
+        throw std::invalid_argument( "Minimum file size must not be greater than the maximum file size" );
+    }
+
+    SplitMix64 rng{ options.seed };
+    mFiles.reserve( options.files_count );
+    for ( uint32_t index = 0; index < options.files_count; ++index ) {
+        std::string path;
+        const auto depth = static_cast< uint32_t >( rng.nextInRange( 0, options.max_depth ) );
+        for ( uint32_t level = 0; level < depth; ++level ) {
+            path += "dir" + std::to_string( rng.nextInRange( 0, 3 ) ) + "/";
+        }
+        path += "file" + std::to_string( index ) + kExtensions[ rng.next() % kExtensionsCount ];
+
+        const uint64_t size = logUniformSize( rng, options.min_file_size, options.max_file_size );
+        mFiles.push_back( { std::move( path ), size, rng.next() } );
+        mTotalSize += size;
+    }
+}
+
+const CorpusOptions& Corpus::options() const noexcept {
+    return mOptions;
+}
+
+const std::vector< CorpusFile >& Corpus::files() const noexcept {
+    return mFiles;
+}
+
+uint64_t Corpus::totalSize() const noexcept {
+    return mTotalSize;
+}
+
+std::vector< byte_t > Corpus::content( const CorpusFile& file ) const {
+    std::vector< byte_t > result;
+    result.reserve( file.size );
+
+    SplitMix64 rng{ file.seed };
+    while ( result.size() < file.size ) {
+        const size_t chunk_size = std::min< size_t >( kChunkSize, file.size - result.size() );
+        if ( rng.nextDouble() < mOptions.compressibility ) {
+            // Compressible chunk: a sequence of words taken from a small vocabulary.
+            size_t written = 0;
+            while ( written < chunk_size ) {
+                const char* word = kWords[ rng.next() % kWordsCount ];
+                for ( ; *word != '\0' && written < chunk_size; ++word, ++written ) {
+                    result.push_back( static_cast< byte_t >( *word ) );
+                }
+            }
+        } else {
+            // Incompressible chunk: pseudo-random bytes.
+            for ( size_t written = 0; written < chunk_size; written += sizeof( uint64_t ) ) {
+                uint64_t value = rng.next();
+                for ( size_t i = 0; i < sizeof( uint64_t ) && written + i < chunk_size; ++i, value >>= 8u ) {
+                    result.push_back( static_cast< byte_t >( value & 0xFFu ) );
+                }
+            }
+        }
+    }
+    return result;
+}
+
+std::vector< byte_t > Corpus::blob() const {
+    std::vector< byte_t > result;
+    result.reserve( mTotalSize );
+    for ( const auto& file : mFiles ) {
+        const auto file_content = content( file );
+        result.insert( result.end(), file_content.begin(), file_content.end() );
+    }
+    return result;
+}
+
+void Corpus::materialize( const fs::path& out_dir ) const {
+    for ( const auto& file : mFiles ) {
+        const fs::path file_path = out_dir / fs::path{ file.path };
+        fs::create_directories( file_path.parent_path() );
+
+        fs::ofstream out_file{ file_path, std::ios::binary | std::ios::trunc };
+        if ( !out_file ) {
+            throw std::runtime_error( "Could not create corpus file " + file_path.string() );
+        }
+        const auto file_content = content( file );
+        out_file.write( reinterpret_cast< const char* >( file_content.data() ), // NOLINT(*-reinterpret-cast)
+                        static_cast< std::streamsize >( file_content.size() ) );
+    }
+}
@@ -0,0 +1,102 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CORPUS_HPP
+#define CORPUS_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <bittypes.hpp>
+#include <internal/fs.hpp>
+
+namespace bit7z { // NOLINT(modernize-concat-nested-namespaces)
+namespace bench {
+
+/**
+ * @brief Parameters of a synthetic corpus: the same parameters always generate the same corpus.
+ */
+struct CorpusOptions {
+    uint32_t files_count = 200;
+    uint64_t min_file_size = 1024;
+    uint64_t max_file_size = 256 * 1024;
+    double compressibility = 0.5; // 0.0: random bytes, 1.0: highly repetitive text.
+    uint32_t max_depth = 3;
+    uint64_t seed = 42;
+};
+
+struct CorpusFile {
+    std::string path; // relative, '/' separated.
+    uint64_t size;
+    uint64_t seed;
+};
+
+/**
+ * @brief A deterministic set of synthetic files, whose content is generated on demand.
+ */
+class Corpus final {
+    public:
+        explicit Corpus( const CorpusOptions& options );
+
+        BIT7Z_NODISCARD const CorpusOptions& options() const noexcept;
+
+        BIT7Z_NODISCARD const std::vector< CorpusFile >& files() const noexcept;
+
+        BIT7Z_NODISCARD uint64_t totalSize() const noexcept;
+
+        BIT7Z_NODISCARD std::vector< byte_t > content( const CorpusFile& file ) const;
+
+        /**
+         * @return the content of all the files, concatenated (used by single-file formats like GZip and Xz).
+         */
+        BIT7Z_NODISCARD std::vector< byte_t > blob() const;
+
+        /**
+         * @brief Writes the corpus files inside the given directory (which is created if needed).
+         */
+        void materialize( const fs::path& out_dir ) const;
+
+    private:
+        CorpusOptions mOptions;
+        std::vector< CorpusFile > mFiles;
+        uint64_t mTotalSize;
+};
+
+/**
+ * @brief A small and fast PRNG (SplitMix64), used instead of <random> engines
+ *        since their output is not guaranteed to be the same across standard library implementations.
+ */
+class SplitMix64 final {
+    public:
+        explicit SplitMix64( uint64_t seed ) noexcept: mState{ seed } {}
+
+        inline uint64_t next() noexcept {
+            uint64_t result = ( mState += 0x9E3779B97F4A7C15ull );
+            result = ( result ^ ( result >> 30u ) ) * 0xBF58476D1CE4E5B9ull;
+            result = ( result ^ ( result >> 27u ) ) * 0x94D049BB133111EBull;
+            return result ^ ( result >> 31u );
+        }
+
+        inline uint64_t nextInRange( uint64_t min, uint64_t max ) noexcept {
+            return max <= min ? min : min + ( next() % ( max - min + 1 ) );
+        }
+
+        inline double nextDouble() noexcept {
+            return static_cast< double >( next() >> 11u ) * ( 1.0 / 9007199254740992.0 );
+        }
+
+    private:
+        uint64_t mState;
+};
+
+} // namespace bench
+} // namespace bit7z
+
+#endif //CORPUS_HPP
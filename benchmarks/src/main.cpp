@@ -0,0 +1,270 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+#include <bit7zlibrary.hpp>
+#include <bitexception.hpp>
+#include <bitnullcodec.hpp>
+#include <internal/fs.hpp>
+
+#include "corpus.hpp"
+#include "report.hpp"
+#include "scenarios.hpp"
+
+using namespace bit7z;
+using namespace bit7z::bench;
+
+namespace {
+constexpr auto kUsage =
+    "Usage: bit7z-bench [options]\n"
+    "\n"
+    "Options:\n"
+    "  --lib <path>              path of the 7-zip shared library, or \"null\" for the in-process null codec\n"
+    "                            (available only if built with BIT7Z_NULL_CODEC)\n"
+    "  --formats <list>          comma-separated formats (default: 7z,zip,tar,gz,xz; null with the null codec)\n"
+    "  --io <list>               comma-separated I/O kinds (default: file,buffer,stream)\n"
+    "  --ops <list>              comma-separated operations (default: compress,list,test,extract,update)\n"
+    "  --filter <text>           run only the benchmarks whose name contains the text\n"
+    "  --files <count>           number of files in the corpus (default: 200)\n"
+    "  --min-size <bytes>        minimum size of a corpus file (default: 1024)\n"
+    "  --max-size <bytes>        maximum size of a corpus file (default: 262144)\n"
+    "  --compressibility <0..1>  fraction of compressible data in the corpus (default: 0.5)\n"
+    "  --seed <number>           seed of the corpus generator (default: 42)\n"
+    "  --iterations <count>      measured iterations per benchmark (default: 5)\n"
+    "  --warmup <count>          warm-up iterations per benchmark (default: 1)\n"
+    "  --work-dir <path>         directory for temporary files (default: system temp directory)\n"
+    "  --output <path>           write the JSON results to the file instead of the standard output\n"
+    "  --baseline <path>         compare the results with a JSON baseline previously written by bit7z-bench\n"
+    "  --tolerance <ratio>       slowdown allowed before reporting a regression (default: 0.05)\n";
+
+inline tstring defaultLibraryPath() {
+#ifdef BIT7Z_BENCH_USE_SYSTEM_7ZIP
+#ifdef _WIN32
+    return BIT7Z_STRING( "C:\\Program Files\\7-Zip\\7z.dll" );
+#elif defined( __linux__ )
+    return "/usr/lib/p7zip/7z.so"; //default installation path of p7zip shared library
+#else
+    return "./7z.so";
+#endif
+#elif defined( _WIN32 )
+    return BIT7Z_STRING( "7z.dll" );
+#else
+    return "./7z.so";
+#endif
+}
+
+// Value of the --lib option selecting the in-process null codec instead of a 7-zip shared library.
+constexpr auto kNullCodecLibrary = BIT7Z_STRING( "null" );
+
+std::unique_ptr< Bit7zLibrary > makeLibrary( const tstring& lib_path ) {
+    if ( lib_path == kNullCodecLibrary ) {
+#ifdef BIT7Z_NULL_CODEC
+        return std::make_unique< Bit7zLibrary >( &nullCodecCreateObject );
+#else
+        throw std::invalid_argument( "The null codec is not available (bit7z was built without BIT7Z_NULL_CODEC)" );
+#endif
+    }
+    return std::make_unique< Bit7zLibrary >( lib_path );
+}
+
+std::vector< std::string > splitList( const std::string& list ) {
+    std::vector< std::string > result;
+    std::istringstream stream{ list };
+    std::string token;
+    while ( std::getline( stream, token, ',' ) ) {
+        if ( !token.empty() ) {
+            result.push_back( token );
+        }
+    }
+    return result;
+}
+
+const BitInOutFormat& parseFormat( const std::string& name ) {
+    if ( name == "7z" ) {
+        return BitFormat::SevenZip;
+    }
+    if ( name == "zip" ) {
+        return BitFormat::Zip;
+    }
+    if ( name == "tar" ) {
+        return BitFormat::Tar;
+    }
+    if ( name == "gz" ) {
+        return BitFormat::GZip;
+    }
+    if ( name == "xz" ) {
+        return BitFormat::Xz;
+    }
+    if ( name == "bz2" ) {
+        return BitFormat::BZip2;
+    }
+#ifdef BIT7Z_NULL_CODEC
+    if ( name == "null" ) {
+        return BitNullFormat;
+    }
+#endif
+    throw std::invalid_argument( "Unknown format: " + name );
+}
+
+IoKind parseIoKind( const std::string& name ) {
+    for ( const auto io_kind : { IoKind::File, IoKind::Buffer, IoKind::Stream } ) {
+        if ( name == ioKindName( io_kind ) ) {
+            return io_kind;
+        }
+    }
+    throw std::invalid_argument( "Unknown I/O kind: " + name );
+}
+
+Operation parseOperation( const std::string& name ) {
+    for ( const auto operation : { Operation::Compress, Operation::List, Operation::Test,
+                                   Operation::Extract, Operation::Update } ) {
+        if ( name == operationName( operation ) ) {
+            return operation;
+        }
+    }
+    throw std::invalid_argument( "Unknown operation: " + name );
+}
+} // namespace
+
+int main( int argc, char* argv[] ) {
+    tstring lib_path = defaultLibraryPath();
+    CorpusOptions corpus_options{};
+    SuiteOptions suite_options{};
+    std::string output_path;
+    std::string baseline_path;
+    double tolerance = 0.05;
+    std::string formats;
+    std::string io_kinds = "file,buffer,stream";
+    std::string operations = "compress,list,test,extract,update";
+    suite_options.work_dir = fs::temp_directory_path() / "bit7z-bench";
+
+    try {
+        for ( int i = 1; i < argc; ++i ) {
+            const std::string arg = argv[ i ]; // NOLINT(*-pointer-arithmetic)
+            if ( arg == "--help" || arg == "-h" ) {
+                std::cout << kUsage;
+                return EXIT_SUCCESS;
+            }
+            if ( i + 1 >= argc ) {
+                throw std::invalid_argument( "Missing value for option " + arg );
+            }
+            const std::string value = argv[ ++i ]; // NOLINT(*-pointer-arithmetic)
+            if ( arg == "--lib" ) {
+                lib_path = fs::path{ value }.string< tchar >();
+            } else if ( arg == "--formats" ) {
+                formats = value;
+            } else if ( arg == "--io" ) {
+                io_kinds = value;
+            } else if ( arg == "--ops" ) {
+                operations = value;
+            } else if ( arg == "--filter" ) {
+                suite_options.filter = value;
+            } else if ( arg == "--files" ) {
+                corpus_options.files_count = static_cast< uint32_t >( std::stoul( value ) );
+            } else if ( arg == "--min-size" ) {
+                corpus_options.min_file_size = std::stoull( value );
+            } else if ( arg == "--max-size" ) {
+                corpus_options.max_file_size = std::stoull( value );
+            } else if ( arg == "--compressibility" ) {
+                corpus_options.compressibility = std::stod( value );
+            } else if ( arg == "--seed" ) {
+                corpus_options.seed = std::stoull( value );
+            } else if ( arg == "--iterations" ) {
+                suite_options.iterations = static_cast< uint32_t >( std::stoul( value ) );
+            } else if ( arg == "--warmup" ) {
+                suite_options.warmup_iterations = static_cast< uint32_t >( std::stoul( value ) );
+            } else if ( arg == "--work-dir" ) {
+                suite_options.work_dir = value;
+            } else if ( arg == "--output" ) {
+                output_path = value;
+            } else if ( arg == "--baseline" ) {
+                baseline_path = value;
+            } else if ( arg == "--tolerance" ) {
+                tolerance = std::stod( value );
+            } else {
+                throw std::invalid_argument( "Unknown option " + arg );
+            }
+        }
+
+        if ( formats.empty() ) {
+            formats = lib_path == kNullCodecLibrary ? "null" : "7z,zip,tar,gz,xz";
+        }
+        for ( const auto& format : splitList( formats ) ) {
+            suite_options.formats.push_back( &parseFormat( format ) );
+        }
+        for ( const auto& io_kind : splitList( io_kinds ) ) {
+            suite_options.io_kinds.push_back( parseIoKind( io_kind ) );
+        }
+        for ( const auto& operation : splitList( operations ) ) {
+            suite_options.operations.push_back( parseOperation( operation ) );
+        }
+    } catch ( const std::exception& ex ) {
+        std::cerr << "Error: " << ex.what() << "\n\n" << kUsage;
+        return EXIT_FAILURE;
+    }
+
+    // When the results are written to the standard output, the human-readable log goes to the standard error.
+    std::ostream& log = output_path.empty() ? std::cerr : std::cout;
+    try {
+        const auto lib = makeLibrary( lib_path );
+        const Corpus corpus{ corpus_options };
+
+        fs::create_directories( suite_options.work_dir );
+        const fs::path work_dir = suite_options.work_dir;
+        BenchmarkSuite suite{ *lib, corpus, std::move( suite_options ) };
+        const auto results = suite.run( log );
+        fs::remove_all( work_dir );
+
+        log << '\n';
+        printTable( log, results );
+
+        const std::map< std::string, std::string > metadata = {
+            { "files", std::to_string( corpus_options.files_count ) },
+            { "min_size", std::to_string( corpus_options.min_file_size ) },
+            { "max_size", std::to_string( corpus_options.max_file_size ) },
+            { "compressibility", std::to_string( corpus_options.compressibility ) },
+            { "seed", std::to_string( corpus_options.seed ) },
+            { "corpus_bytes", std::to_string( corpus.totalSize() ) }
+        };
+        if ( output_path.empty() ) {
+            writeJson( std::cout, metadata, results );
+        } else {
+            std::ofstream out_file{ output_path };
+            writeJson( out_file, metadata, results );
+        }
+
+        if ( !baseline_path.empty() ) {
+            std::ifstream baseline_file{ baseline_path };
+            if ( !baseline_file ) {
+                throw std::runtime_error( "Could not open baseline file " + baseline_path );
+            }
+            const auto baseline = readJson( baseline_file );
+            log << '\n';
+            const auto regressions = printComparisons( log, compare( baseline, results ), tolerance );
+            if ( regressions > 0 ) {
+                log << '\n' << regressions << " benchmark(s) regressed more than "
+                    << tolerance * 100 << "% with respect to the baseline" << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+    } catch ( const std::exception& ex ) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
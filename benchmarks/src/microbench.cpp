@@ -0,0 +1,436 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+#include <bit7zlibrary.hpp>
+#include <bitarchivereader.hpp>
+#include <bitarchivewriter.hpp>
+#include <bitexception.hpp>
+#include <bitnullcodec.hpp>
+#include <bitpropvariant.hpp>
+
+#include <internal/cbufferinstream.hpp>
+#include <internal/cbufferoutstream.hpp>
+#include <internal/cstdinstream.hpp>
+#include <internal/cstdoutstream.hpp>
+#include <internal/formatdetect.hpp>
+#include <internal/fs.hpp>
+#include <internal/fsindexer.hpp>
+#include <internal/fsutil.hpp>
+#include <internal/updatecallback.hpp>
+#include <internal/util.hpp>
+
+#include "corpus.hpp"
+#include "microbench.hpp"
+#include "report.hpp"
+
+using namespace bit7z;
+using namespace bit7z::bench;
+using bit7z::filesystem::FSIndexer;
+using bit7z::filesystem::FSItem;
+using bit7z::filesystem::FSItemTable;
+
+namespace {
+constexpr auto kUsage =
+    "Usage: bit7z-microbench [options]\n"
+    "\n"
+    "Options:\n"
+    "  --lib <path>          path of the 7-zip shared library (needed only by the UpdateCallback benchmarks,\n"
+    "                        which use the in-process null codec by default, if built with BIT7Z_NULL_CODEC)\n"
+    "  --filter <text>       run only the benchmarks whose name contains the text\n"
+    "  --min-time <ms>       minimum duration of a measured batch of calls (default: 20)\n"
+    "  --repetitions <count> measured batches per benchmark (default: 5)\n"
+    "  --work-dir <path>     directory for temporary files (default: system temp directory)\n"
+    "  --output <path>       write the JSON results to the file instead of the standard output\n"
+    "  --baseline <path>     compare the results with a JSON baseline previously written by bit7z-microbench\n"
+    "  --tolerance <ratio>   slowdown allowed before reporting a regression (default: 0.05)\n";
+
+constexpr size_t kStreamSize = 1024 * 1024;
+
+class MicroSuite final {
+    public:
+        MicroSuite( MicroOptions options, fs::path work_dir )
+            : mOptions{ std::move( options ) }, mWorkDir{ std::move( work_dir ) } {}
+
+        std::vector< Measurement > run( const Bit7zLibrary* lib, const BitInOutFormat& format ) {
+            streams();
+            propVariant();
+            wildcardMatch();
+#ifdef BIT7Z_AUTO_FORMAT
+            formatDetection();
+#endif
+            indexing();
+#ifdef BIT7Z_NULL_CODEC
+            nullCodec();
+#endif
+            if ( lib != nullptr ) {
+                updateCallback( *lib, format );
+            } else {
+                std::cerr << "Skipping UpdateCallback benchmarks (7-zip library not available)" << std::endl;
+            }
+            return std::move( mResults );
+        }
+
+    private:
+        MicroOptions mOptions;
+        fs::path mWorkDir;
+        std::vector< Measurement > mResults;
+
+        template< typename Operation >
+        void add( const std::string& name, uint64_t bytes_per_op, Operation&& operation ) {
+            if ( !mOptions.filter.empty() && name.find( mOptions.filter ) == std::string::npos ) {
+                return;
+            }
+            mResults.push_back( measureMicro( name, bytes_per_op, std::forward< Operation >( operation ), mOptions ) );
+            std::cerr << "  " << name << ": " << mResults.back().median_ns << " ns/op" << std::endl;
+        }
+
+        void streams() {
+            const buffer_t input( kStreamSize, static_cast< byte_t >( 'x' ) );
+
+            for ( const UInt32 chunk_size : { 64u, 4096u, 65536u } ) {
+                const std::string suffix = "/" + std::to_string( chunk_size ) + "B";
+                std::vector< char > chunk( chunk_size );
+
+                // Each operation reads (or writes) the whole 1 MiB stream, chunk by chunk.
+                CBufferInStream buffer_in{ input };
+                add( "CBufferInStream::Read" + suffix, kStreamSize, [ & ]() {
+                    buffer_in.Seek( 0, STREAM_SEEK_SET, nullptr );
+                    UInt32 processed = 0;
+                    do {
+                        buffer_in.Read( chunk.data(), chunk_size, &processed );
+                    } while ( processed > 0 );
+                    doNotOptimize( chunk );
+                } );
+
+                buffer_t output;
+                CBufferOutStream buffer_out{ output };
+                add( "CBufferOutStream::Write" + suffix, kStreamSize, [ & ]() {
+                    buffer_out.Seek( 0, STREAM_SEEK_SET, nullptr );
+                    for ( size_t written = 0; written < kStreamSize; written += chunk_size ) {
+                        UInt32 processed = 0;
+                        buffer_out.Write( chunk.data(), chunk_size, &processed );
+                    }
+                    doNotOptimize( output );
+                } );
+
+                std::istringstream std_input{ std::string( kStreamSize, 'x' ) };
+                CStdInStream std_in{ std_input };
+                add( "CStdInStream::Read" + suffix, kStreamSize, [ & ]() {
+                    std_in.Seek( 0, STREAM_SEEK_SET, nullptr );
+                    UInt32 processed = 0;
+                    do {
+                        std_in.Read( chunk.data(), chunk_size, &processed );
+                    } while ( processed > 0 );
+                    doNotOptimize( chunk );
+                } );
+
+                std::ostringstream std_output;
+                CStdOutStream std_out{ std_output };
+                add( "CStdOutStream::Write" + suffix, kStreamSize, [ & ]() {
+                    std_out.Seek( 0, STREAM_SEEK_SET, nullptr );
+                    for ( size_t written = 0; written < kStreamSize; written += chunk_size ) {
+                        UInt32 processed = 0;
+                        std_out.Write( chunk.data(), chunk_size, &processed );
+                    }
+                    doNotOptimize( std_output );
+                } );
+            }
+
+            CBufferInStream buffer_in{ input };
+            add( "CBufferInStream::Seek", 0, [ & ]() {
+                UInt64 position = 0;
+                buffer_in.Seek( 1024, STREAM_SEEK_CUR, &position );
+                buffer_in.Seek( -512, STREAM_SEEK_END, &position );
+                doNotOptimize( position );
+            } );
+
+            std::istringstream std_input{ std::string( kStreamSize, 'x' ) };
+            CStdInStream std_in{ std_input };
+            add( "CStdInStream::Seek", 0, [ & ]() {
+                UInt64 position = 0;
+                std_in.Seek( 1024, STREAM_SEEK_CUR, &position );
+                std_in.Seek( -512, STREAM_SEEK_END, &position );
+                doNotOptimize( position );
+            } );
+        }
+
+        void propVariant() {
+            const std::wstring path = L"some/directory/inside/the/archive/file.txt";
+            add( "BitPropVariant(wstring)", 0, [ & ]() {
+                const BitPropVariant variant{ path };
+                doNotOptimize( variant );
+            } );
+            add( "BitPropVariant(uint64_t)", 0, [ & ]() {
+                const BitPropVariant variant{ static_cast< uint64_t >( 42 ) };
+                doNotOptimize( variant );
+            } );
+
+            const BitPropVariant string_variant{ path };
+            add( "BitPropVariant::BitPropVariant(const&)", 0, [ & ]() {
+                const BitPropVariant variant{ string_variant }; // NOLINT(performance-unnecessary-copy-initialization)
+                doNotOptimize( variant );
+            } );
+            add( "BitPropVariant::getString", 0, [ & ]() {
+                const tstring result = string_variant.getString();
+                doNotOptimize( result );
+            } );
+        }
+
+        void wildcardMatch() {
+            const tstring path = BIT7Z_STRING( "some/directory/inside/the/archive/file.txt" );
+            add( "fsutil::wildcardMatch/*.txt", 0, [ & ]() {
+                const bool result = bit7z::filesystem::fsutil::wildcardMatch( BIT7Z_STRING( "*.txt" ), path );
+                doNotOptimize( result );
+            } );
+            add( "fsutil::wildcardMatch/some*/*?ile*.t*t", 0, [ & ]() {
+                const bool result = bit7z::filesystem::fsutil::wildcardMatch( BIT7Z_STRING( "some*/*?ile*.t*t" ),
+                                                                              path );
+                doNotOptimize( result );
+            } );
+        }
+
+#ifdef BIT7Z_AUTO_FORMAT
+        void formatDetection() {
+            // A buffer starting with the 7z signature, followed by some arbitrary data.
+            buffer_t signature{ 0x37, 0x7A, 0xBC, 0xAF, 0x27, 0x1C, 0x00, 0x04 };
+            signature.resize( 4096, static_cast< byte_t >( 0 ) );
+            add( "detectFormatFromSig/7z", 0, [ & ]() {
+                CBufferInStream stream{ signature };
+                const BitInFormat& format = detectFormatFromSig( &stream );
+                doNotOptimize( format );
+            } );
+        }
+#endif
+
+        void indexing() {
+            CorpusOptions corpus_options{};
+            corpus_options.files_count = 1000;
+            corpus_options.min_file_size = 0;
+            corpus_options.max_file_size = 0;
+            const Corpus corpus{ corpus_options };
+            const fs::path corpus_dir = mWorkDir / "indexing";
+            fs::remove_all( corpus_dir );
+            corpus.materialize( corpus_dir );
+
+            add( "FSIndexer::listDirectoryItems/1000", 0, [ & ]() {
+                FSItemTable items;
+                FSIndexer indexer{ FSItem{ corpus_dir } };
+                indexer.listDirectoryItems( items, true );
+                doNotOptimize( items );
+            } );
+            fs::remove_all( corpus_dir );
+        }
+
+#ifdef BIT7Z_NULL_CODEC
+        // End-to-end operations on the null codec, i.e., the whole wrapper overhead without any real codec.
+        void nullCodec() {
+            const Bit7zLibrary lib{ &nullCodecCreateObject };
+
+            for ( const uint32_t items_count : { 1u, 1000u } ) {
+                const uint64_t item_size = items_count == 1 ? 16 * kStreamSize : 16;
+                const uint64_t total_size = items_count * item_size;
+                const std::string suffix = "/" + std::to_string( items_count ) + "x" + std::to_string( item_size ) + "B";
+                const buffer_t archive = makeNullArchive( items_count, item_size );
+
+                add( "NullCodec::open" + suffix, 0, [ & ]() {
+                    const BitArchiveReader reader{ lib, archive, BitNullFormat };
+                    doNotOptimize( reader );
+                } );
+
+                const BitArchiveReader reader{ lib, archive, BitNullFormat };
+                add( "NullCodec::items" + suffix, 0, [ & ]() {
+                    auto items = reader.items();
+                    doNotOptimize( items );
+                } );
+
+                add( "NullCodec::visitItems" + suffix, 0, [ & ]() {
+                    uint64_t visited_size = 0;
+                    const auto fields = BitItemField::Path | BitItemField::Size;
+                    reader.visitItems( fields, [ &visited_size ]( const BitItemView& item ) {
+                        visited_size += item.size + item.path_size;
+                    } );
+                    doNotOptimize( visited_size );
+                } );
+
+                add( "NullCodec::test" + suffix, total_size, [ & ]() {
+                    reader.test();
+                } );
+
+                add( "NullCodec::extract/map" + suffix, total_size, [ & ]() {
+                    std::map< tstring, buffer_t > out_map;
+                    reader.extract( out_map );
+                    doNotOptimize( out_map );
+                } );
+
+                std::vector< std::pair< tstring, buffer_t > > buffers;
+                for ( uint32_t index = 0; index < items_count; ++index ) {
+                    buffers.emplace_back( BIT7Z_STRING( "dir/file" ) + to_tstring( index ) + BIT7Z_STRING( ".bin" ),
+                                          buffer_t( static_cast< size_t >( item_size ) ) );
+                }
+                add( "NullCodec::compress/buffer" + suffix, total_size, [ & ]() {
+                    BitArchiveWriter writer{ lib, BitNullFormat };
+                    for ( const auto& entry : buffers ) {
+                        writer.addFile( entry.second, entry.first );
+                    }
+                    buffer_t out_buffer;
+                    writer.compressTo( out_buffer );
+                    doNotOptimize( out_buffer );
+                } );
+            }
+        }
+#endif
+
+        void updateCallback( const Bit7zLibrary& lib, const BitInOutFormat& format ) {
+            std::vector< std::pair< tstring, buffer_t > > buffers;
+            for ( int index = 0; index < 1000; ++index ) {
+                buffers.emplace_back( BIT7Z_STRING( "dir/file" ) + to_tstring( index ) + BIT7Z_STRING( ".txt" ),
+                                      buffer_t( 16 ) );
+            }
+            BitArchiveWriter writer{ lib, format };
+            for ( const auto& entry : buffers ) {
+                writer.addFile( entry.second, entry.first );
+            }
+
+            auto callback = bit7z::make_com< UpdateCallback, IArchiveUpdateCallback2 >( writer );
+            for ( const PROPID property : { kpidPath, kpidSize, kpidMTime } ) {
+                const std::string name = property == kpidPath ? "kpidPath" : property == kpidSize ? "kpidSize" : "kpidMTime";
+                UInt32 index = 0;
+                add( "UpdateCallback::GetProperty/" + name, 0, [ & ]() {
+                    PROPVARIANT value{};
+                    callback->GetProperty( index, property, &value );
+                    if ( value.vt == VT_BSTR ) {
+                        SysFreeString( value.bstrVal );
+                    }
+                    index = ( index + 1 ) % buffers.size();
+                } );
+            }
+
+            // Progress notifications, as received from fast codecs working on small chunks.
+            writer.setTotalCallback( []( uint64_t ) {} );
+            writer.setProgressCallback( []( uint64_t ) { return true; } );
+            for ( const int interval : { 0, 100 } ) {
+                writer.setProgressInterval( std::chrono::milliseconds{ interval } );
+                auto progress_callback = bit7z::make_com< UpdateCallback, IArchiveUpdateCallback2 >( writer );
+                progress_callback->SetTotal( std::numeric_limits< UInt64 >::max() );
+                UInt64 completed = 0;
+                add( "UpdateCallback::SetCompleted/" + std::to_string( interval ) + "ms", 0, [ & ]() {
+                    ++completed;
+                    progress_callback->SetCompleted( &completed );
+                } );
+            }
+        }
+};
+} // namespace
+
+int main( int argc, char* argv[] ) {
+    MicroOptions options{};
+    tstring lib_path;
+    std::string output_path;
+    std::string baseline_path;
+    double tolerance = 0.05;
+    fs::path work_dir = fs::temp_directory_path() / "bit7z-microbench";
+
+    try {
+        for ( int i = 1; i < argc; ++i ) {
+            const std::string arg = argv[ i ]; // NOLINT(*-pointer-arithmetic)
+            if ( arg == "--help" || arg == "-h" ) {
+                std::cout << kUsage;
+                return EXIT_SUCCESS;
+            }
+            if ( i + 1 >= argc ) {
+                throw std::invalid_argument( "Missing value for option " + arg );
+            }
+            const std::string value = argv[ ++i ]; // NOLINT(*-pointer-arithmetic)
+            if ( arg == "--lib" ) {
+                lib_path = fs::path{ value }.string< tchar >();
+            } else if ( arg == "--filter" ) {
+                options.filter = value;
+            } else if ( arg == "--min-time" ) {
+                options.min_batch_time = std::chrono::milliseconds( std::stoul( value ) );
+            } else if ( arg == "--repetitions" ) {
+                options.repetitions = std::max( 1u, static_cast< uint32_t >( std::stoul( value ) ) );
+            } else if ( arg == "--work-dir" ) {
+                work_dir = value;
+            } else if ( arg == "--output" ) {
+                output_path = value;
+            } else if ( arg == "--baseline" ) {
+                baseline_path = value;
+            } else if ( arg == "--tolerance" ) {
+                tolerance = std::stod( value );
+            } else {
+                throw std::invalid_argument( "Unknown option " + arg );
+            }
+        }
+    } catch ( const std::exception& ex ) {
+        std::cerr << "Error: " << ex.what() << "\n\n" << kUsage;
+        return EXIT_FAILURE;
+    }
+
+    try {
+        std::unique_ptr< Bit7zLibrary > lib;
+        const BitInOutFormat* format = &BitFormat::SevenZip;
+        if ( !lib_path.empty() ) {
+            lib = std::make_unique< Bit7zLibrary >( lib_path );
+        }
+#ifdef BIT7Z_NULL_CODEC
+        else {
+            lib = std::make_unique< Bit7zLibrary >( &nullCodecCreateObject );
+            format = &BitNullFormat;
+        }
+#endif
+
+        fs::create_directories( work_dir );
+        MicroSuite suite{ options, work_dir };
+        const auto results = suite.run( lib.get(), *format );
+        fs::remove_all( work_dir );
+
+        std::cerr << '\n';
+        printMicroTable( std::cerr, results );
+
+        const std::map< std::string, std::string > metadata = {
+            { "repetitions", std::to_string( options.repetitions ) }
+        };
+        if ( output_path.empty() ) {
+            writeJson( std::cout, metadata, results );
+        } else {
+            std::ofstream out_file{ output_path };
+            writeJson( out_file, metadata, results );
+        }
+
+        if ( !baseline_path.empty() ) {
+            std::ifstream baseline_file{ baseline_path };
+            if ( !baseline_file ) {
+                throw std::runtime_error( "Could not open baseline file " + baseline_path );
+            }
+            std::cerr << '\n';
+            const auto regressions = printComparisons( std::cerr, compare( readJson( baseline_file ), results ),
+                                                       tolerance );
+            if ( regressions > 0 ) {
+                return EXIT_FAILURE;
+            }
+        }
+    } catch ( const std::exception& ex ) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
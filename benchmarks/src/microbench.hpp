@@ -0,0 +1,120 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef MICROBENCH_HPP
+#define MICROBENCH_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "report.hpp"
+
+namespace bit7z { // NOLINT(modernize-concat-nested-namespaces)
+namespace bench {
+
+/**
+ * @brief Counters of the heap allocations made by the benchmark process
+ *        (updated by the replaced global operator new, see alloccounter.cpp).
+ *
+ * @note Allocations not made through operator new (e.g., BSTR strings allocated by SysAllocString) are not counted.
+ */
+struct AllocationStats {
+    uint64_t count;
+    uint64_t bytes;
+};
+
+AllocationStats allocationStats() noexcept;
+
+/**
+ * @brief Prevents the compiler from optimizing away the computation of the given value.
+ */
+template< typename T >
+inline void doNotOptimize( const T& value ) {
+#if defined( __GNUC__ ) || defined( __clang__ )
+    asm volatile( "" : : "r,m"( value ) : "memory" ); // NOLINT(hicpp-no-assembler)
+#else
+    static volatile const T* sink;
+    sink = &value;
+#endif
+}
+
+struct MicroOptions {
+    std::chrono::nanoseconds min_batch_time = std::chrono::milliseconds( 20 );
+    uint32_t repetitions = 5;
+    std::string filter; // If not empty, only the benchmarks whose name contains this string are run.
+};
+
+/**
+ * @brief Measures the time per call of the given operation, and the heap allocations it makes.
+ *
+ * The number of calls per batch is doubled until a batch lasts at least MicroOptions::min_batch_time;
+ * then, MicroOptions::repetitions batches are measured.
+ *
+ * @param name          the name of the benchmark.
+ * @param bytes_per_op  the bytes processed by each call (used for computing the throughput).
+ * @param operation     the operation to be measured.
+ * @param options       the measurement options.
+ */
+template< typename Operation >
+Measurement measureMicro( const std::string& name,
+                          uint64_t bytes_per_op,
+                          Operation&& operation,
+                          const MicroOptions& options ) {
+    using clock = std::chrono::steady_clock;
+
+    uint64_t batch_size = 1;
+    for ( ;; ) {
+        const auto start = clock::now();
+        for ( uint64_t i = 0; i < batch_size; ++i ) {
+            operation();
+        }
+        if ( clock::now() - start >= options.min_batch_time || batch_size >= ( uint64_t{ 1 } << 40u ) ) {
+            break;
+        }
+        batch_size *= 2;
+    }
+
+    std::vector< double > samples;
+    samples.reserve( options.repetitions );
+    const AllocationStats allocations_before = allocationStats();
+    for ( uint32_t repetition = 0; repetition < options.repetitions; ++repetition ) {
+        const auto start = clock::now();
+        for ( uint64_t i = 0; i < batch_size; ++i ) {
+            operation();
+        }
+        const auto end = clock::now();
+        samples.push_back( std::chrono::duration< double, std::nano >( end - start ).count() /
+                           static_cast< double >( batch_size ) );
+    }
+    const AllocationStats allocations_after = allocationStats();
+    const auto total_ops = static_cast< double >( batch_size * options.repetitions );
+
+    Measurement result;
+    result.name = name;
+    result.bytes = bytes_per_op;
+    result.iterations = static_cast< uint32_t >( std::min< uint64_t >( batch_size * options.repetitions,
+                                                                      UINT32_MAX ) );
+    std::sort( samples.begin(), samples.end() );
+    const std::size_t middle = samples.size() / 2;
+    result.min_ns = samples.front();
+    result.median_ns = samples.size() % 2 == 0 ? ( samples[ middle - 1 ] + samples[ middle ] ) / 2 : samples[ middle ];
+    result.mean_ns = std::accumulate( samples.begin(), samples.end(), 0.0 ) / static_cast< double >( samples.size() );
+    result.allocations = static_cast< double >( allocations_after.count - allocations_before.count ) / total_ops;
+    result.allocated_bytes = static_cast< double >( allocations_after.bytes - allocations_before.bytes ) / total_ops;
+    return result;
+}
+
+} // namespace bench
+} // namespace bit7z
+
+#endif //MICROBENCH_HPP
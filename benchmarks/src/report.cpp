@@ -0,0 +1,347 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "report.hpp"
+
+#include <cctype>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+
+using namespace bit7z::bench;
+
+namespace {
+constexpr double kNanosecondsPerSecond = 1e9;
+constexpr double kBytesPerMebibyte = 1024.0 * 1024.0;
+
+std::string escapeJson( const std::string& str ) {
+    std::string result;
+    result.reserve( str.size() );
+    for ( const char character : str ) {
+        switch ( character ) {
+            case '"':
+                result += "\\\"";
+                break;
+            case '\\':
+                result += "\\\\";
+                break;
+            case '\n':
+                result += "\\n";
+                break;
+            case '\t':
+                result += "\\t";
+                break;
+            default:
+                if ( static_cast< unsigned char >( character ) < 0x20 ) {
+                    char escaped[ 7 ]; // NOLINT(*-avoid-c-arrays)
+                    std::snprintf( escaped, sizeof( escaped ), "\\u%04x", static_cast< unsigned >( character ) );
+                    result += escaped;
+                } else {
+                    result += character;
+                }
+        }
+    }
+    return result;
+}
+
+/* Minimal JSON reader, supporting only the subset of JSON produced by writeJson
+ * (objects, arrays, strings with simple escapes, numbers, booleans and null). */
+class JsonReader final {
+    public:
+        explicit JsonReader( std::string text ) : mText{ std::move( text ) }, mPos{ 0 } {}
+
+        std::vector< Measurement > readResults() {
+            std::vector< Measurement > results;
+            expect( '{' );
+            if ( consume( '}' ) ) {
+                return results;
+            }
+            do {
+                const std::string key = readString();
+                expect( ':' );
+                if ( key == "results" ) {
+                    results = readMeasurements();
+                } else {
+                    skipValue();
+                }
+            } while ( consume( ',' ) );
+            expect( '}' );
+            return results;
+        }
+
+    private:
+        std::string mText;
+        std::size_t mPos;
+
+        std::vector< Measurement > readMeasurements() {
+            std::vector< Measurement > results;
+            expect( '[' );
+            if ( consume( ']' ) ) {
+                return results;
+            }
+            do {
+                results.push_back( readMeasurement() );
+            } while ( consume( ',' ) );
+            expect( ']' );
+            return results;
+        }
+
+        Measurement readMeasurement() {
+            Measurement measurement;
+            expect( '{' );
+            if ( consume( '}' ) ) {
+                return measurement;
+            }
+            do {
+                const std::string key = readString();
+                expect( ':' );
+                if ( key == "name" ) {
+                    measurement.name = readString();
+                } else if ( key == "iterations" ) {
+                    measurement.iterations = static_cast< uint32_t >( readNumber() );
+                } else if ( key == "min_ns" ) {
+                    measurement.min_ns = readNumber();
+                } else if ( key == "median_ns" ) {
+                    measurement.median_ns = readNumber();
+                } else if ( key == "mean_ns" ) {
+                    measurement.mean_ns = readNumber();
+                } else if ( key == "bytes" ) {
+                    measurement.bytes = static_cast< uint64_t >( readNumber() );
+                } else if ( key == "allocations" ) {
+                    measurement.allocations = readNumber();
+                } else if ( key == "allocated_bytes" ) {
+                    measurement.allocated_bytes = readNumber();
+                } else {
+                    skipValue();
+                }
+            } while ( consume( ',' ) );
+            expect( '}' );
+            return measurement;
+        }
+
+        void skipWhitespace() {
+            while ( mPos < mText.size() && std::isspace( static_cast< unsigned char >( mText[ mPos ] ) ) != 0 ) {
+                ++mPos;
+            }
+        }
+
+        bool consume( char expected ) {
+            skipWhitespace();
+            if ( mPos < mText.size() && mText[ mPos ] == expected ) {
+                ++mPos;
+                return true;
+            }
+            return false;
+        }
+
+        void expect( char expected ) {
+            if ( !consume( expected ) ) {
+                throw std::runtime_error( std::string{ "Invalid JSON: expected '" } + expected + "' at offset " +
+                                          std::to_string( mPos ) );
+            }
+        }
+
+        std::string readString() {
+            expect( '"' );
+            std::string result;
+            while ( mPos < mText.size() && mText[ mPos ] != '"' ) {
+                char character = mText[ mPos++ ];
+                if ( character == '\\' && mPos < mText.size() ) {
+                    character = mText[ mPos++ ];
+                    switch ( character ) {
+                        case 'n':
+                            character = '\n';
+                            break;
+                        case 't':
+                            character = '\t';
+                            break;
+                        case 'u':
+                            character = static_cast< char >( std::stoi( mText.substr( mPos, 4 ), nullptr, 16 ) );
+                            mPos += 4;
+                            break;
+                        default: // e.g., '"', '\\', and '/'
+                            break;
+                    }
+                }
+                result += character;
+            }
+            expect( '"' );
+            return result;
+        }
+
+        double readNumber() {
+            skipWhitespace();
+            std::size_t parsed = 0;
+            const double result = std::stod( mText.substr( mPos, 32 ), &parsed );
+            mPos += parsed;
+            return result;
+        }
+
+        void skipValue() {
+            skipWhitespace();
+            if ( mPos >= mText.size() ) {
+                throw std::runtime_error( "Invalid JSON: unexpected end of document" );
+            }
+            const char character = mText[ mPos ];
+            if ( character == '"' ) {
+                readString();
+            } else if ( character == '{' || character == '[' ) {
+                const char closing = character == '{' ? '}' : ']';
+                ++mPos;
+                if ( consume( closing ) ) {
+                    return;
+                }
+                do {
+                    if ( closing == '}' ) {
+                        readString();
+                        expect( ':' );
+                    }
+                    skipValue();
+                } while ( consume( ',' ) );
+                expect( closing );
+            } else if ( std::isalpha( static_cast< unsigned char >( character ) ) != 0 ) { // true, false, null
+                while ( mPos < mText.size() && std::isalpha( static_cast< unsigned char >( mText[ mPos ] ) ) != 0 ) {
+                    ++mPos;
+                }
+            } else {
+                readNumber();
+            }
+        }
+};
+} // namespace
+
+namespace bit7z { // NOLINT(modernize-concat-nested-namespaces)
+namespace bench {
+
+double Measurement::throughput() const noexcept {
+    if ( median_ns <= 0 ) {
+        return 0;
+    }
+    return ( static_cast< double >( bytes ) / kBytesPerMebibyte ) / ( median_ns / kNanosecondsPerSecond );
+}
+
+double Comparison::change() const noexcept {
+    return baseline_ns > 0 ? ( current_ns - baseline_ns ) / baseline_ns : 0;
+}
+
+void writeJson( std::ostream& out,
+                const std::map< std::string, std::string >& metadata,
+                const std::vector< Measurement >& results ) {
+    out << "{\n  \"metadata\": {";
+    bool first = true;
+    for ( const auto& entry : metadata ) {
+        out << ( first ? "\n" : ",\n" ) << "    \"" << escapeJson( entry.first ) << "\": \""
+            << escapeJson( entry.second ) << "\"";
+        first = false;
+    }
+    out << "\n  },\n  \"results\": [";
+    first = true;
+    out << std::fixed << std::setprecision( 1 );
+    for ( const auto& result : results ) {
+        out << ( first ? "\n" : ",\n" )
+            << "    { \"name\": \"" << escapeJson( result.name ) << "\""
+            << ", \"iterations\": " << result.iterations
+            << ", \"min_ns\": " << result.min_ns
+            << ", \"median_ns\": " << result.median_ns
+            << ", \"mean_ns\": " << result.mean_ns
+            << ", \"bytes\": " << result.bytes
+            << ", \"allocations\": " << std::setprecision( 3 ) << result.allocations
+            << ", \"allocated_bytes\": " << result.allocated_bytes
+            << ", \"mib_per_s\": " << std::setprecision( 3 ) << result.throughput() << std::setprecision( 1 )
+            << " }";
+        first = false;
+    }
+    out << "\n  ]\n}\n";
+}
+
+std::vector< Measurement > readJson( std::istream& in ) {
+    std::string text{ std::istreambuf_iterator< char >( in ), std::istreambuf_iterator< char >() };
+    return JsonReader{ std::move( text ) }.readResults();
+}
+
+std::vector< Comparison > compare( const std::vector< Measurement >& baseline,
+                                   const std::vector< Measurement >& current ) {
+    std::map< std::string, const Measurement* > baseline_map;
+    for ( const auto& measurement : baseline ) {
+        baseline_map.emplace( measurement.name, &measurement );
+    }
+
+    std::vector< Comparison > result;
+    for ( const auto& measurement : current ) {
+        const auto it = baseline_map.find( measurement.name );
+        if ( it != baseline_map.end() ) {
+            result.push_back( { measurement.name, it->second->median_ns, measurement.median_ns } );
+        }
+    }
+    return result;
+}
+
+void printTable( std::ostream& out, const std::vector< Measurement >& results ) {
+    out << std::left << std::setw( 36 ) << "benchmark"
+        << std::right << std::setw( 8 ) << "iters"
+        << std::setw( 14 ) << "median (ms)"
+        << std::setw( 14 ) << "min (ms)"
+        << std::setw( 12 ) << "MiB/s" << '\n';
+    out << std::fixed;
+    for ( const auto& result : results ) {
+        out << std::left << std::setw( 36 ) << result.name
+            << std::right << std::setw( 8 ) << result.iterations
+            << std::setw( 14 ) << std::setprecision( 3 ) << result.median_ns / 1e6
+            << std::setw( 14 ) << result.min_ns / 1e6
+            << std::setw( 12 ) << std::setprecision( 2 ) << result.throughput() << '\n';
+    }
+}
+
+void printMicroTable( std::ostream& out, const std::vector< Measurement >& results ) {
+    out << std::left << std::setw( 44 ) << "benchmark"
+        << std::right << std::setw( 14 ) << "ops"
+        << std::setw( 12 ) << "ns/op"
+        << std::setw( 12 ) << "allocs/op"
+        << std::setw( 14 ) << "bytes/op"
+        << std::setw( 12 ) << "MiB/s" << '\n';
+    out << std::fixed;
+    for ( const auto& result : results ) {
+        out << std::left << std::setw( 44 ) << result.name
+            << std::right << std::setw( 14 ) << result.iterations
+            << std::setw( 12 ) << std::setprecision( 1 ) << result.median_ns
+            << std::setw( 12 ) << std::setprecision( 2 ) << result.allocations
+            << std::setw( 14 ) << std::setprecision( 1 ) << result.allocated_bytes
+            << std::setw( 12 ) << std::setprecision( 2 ) << result.throughput() << '\n';
+    }
+}
+
+std::size_t printComparisons( std::ostream& out, const std::vector< Comparison >& comparisons, double tolerance ) {
+    std::size_t regressions = 0;
+    out << std::left << std::setw( 36 ) << "benchmark"
+        << std::right << std::setw( 16 ) << "baseline (ms)"
+        << std::setw( 16 ) << "current (ms)"
+        << std::setw( 10 ) << "change" << '\n';
+    out << std::fixed;
+    for ( const auto& comparison : comparisons ) {
+        const double change = comparison.change();
+        const bool is_regression = change > tolerance;
+        if ( is_regression ) {
+            ++regressions;
+        }
+        out << std::left << std::setw( 36 ) << comparison.name
+            << std::right << std::setw( 16 ) << std::setprecision( 3 ) << comparison.baseline_ns / 1e6
+            << std::setw( 16 ) << comparison.current_ns / 1e6
+            << std::setw( 9 ) << std::showpos << std::setprecision( 1 ) << change * 100 << '%' << std::noshowpos
+            << ( is_regression ? "  REGRESSION" : ( change < -tolerance ? "  improvement" : "" ) ) << '\n';
+    }
+    return regressions;
+}
+
+} // namespace bench
+} // namespace bit7z
@@ -0,0 +1,84 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef REPORT_HPP
+#define REPORT_HPP
+
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace bit7z { // NOLINT(modernize-concat-nested-namespaces)
+namespace bench {
+
+struct Measurement {
+    std::string name;
+    uint32_t iterations = 0;
+    double min_ns = 0;
+    double median_ns = 0;
+    double mean_ns = 0;
+    uint64_t bytes = 0; // Uncompressed bytes processed by a single iteration.
+    double allocations = 0; // Heap allocations per iteration (measured only by the micro-benchmarks).
+    double allocated_bytes = 0; // Heap-allocated bytes per iteration (measured only by the micro-benchmarks).
+
+    /**
+     * @return the throughput in MiB/s computed on the median time of the iterations.
+     */
+    double throughput() const noexcept;
+};
+
+struct Comparison {
+    std::string name;
+    double baseline_ns;
+    double current_ns;
+
+    /**
+     * @return the relative change of the median time with respect to the baseline (e.g., 0.1 means 10% slower).
+     */
+    double change() const noexcept;
+};
+
+/**
+ * @brief Writes the measurements as a JSON document, together with the given run metadata (e.g., corpus options).
+ */
+void writeJson( std::ostream& out,
+                const std::map< std::string, std::string >& metadata,
+                const std::vector< Measurement >& results );
+
+/**
+ * @brief Reads the measurements from a JSON document previously written by writeJson.
+ */
+std::vector< Measurement > readJson( std::istream& in );
+
+/**
+ * @brief Compares the current measurements with the baseline ones having the same name.
+ */
+std::vector< Comparison > compare( const std::vector< Measurement >& baseline,
+                                   const std::vector< Measurement >& current );
+
+void printTable( std::ostream& out, const std::vector< Measurement >& results );
+
+/**
+ * @brief Prints the measurements of micro-benchmarks, i.e., using ns/op and allocations/op as units.
+ */
+void printMicroTable( std::ostream& out, const std::vector< Measurement >& results );
+
+/**
+ * @brief Prints the comparisons, marking as regressions the ones slower than the given tolerance.
+ *
+ * @return the number of regressions.
+ */
+std::size_t printComparisons( std::ostream& out, const std::vector< Comparison >& comparisons, double tolerance );
+
+} // namespace bench
+} // namespace bit7z
+
+#endif //REPORT_HPP
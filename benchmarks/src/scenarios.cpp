@@ -0,0 +1,395 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "scenarios.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <sstream>
+
+#include <bitarchivereader.hpp>
+#include <bitarchivewriter.hpp>
+#include <bitexception.hpp>
+#include <bitfilecompressor.hpp>
+#include <bitmemcompressor.hpp>
+#include <bitnullcodec.hpp>
+#include <bitstreamcompressor.hpp>
+
+using namespace bit7z;
+using namespace bit7z::bench;
+
+namespace {
+constexpr auto kBlobName = BIT7Z_STRING( "corpus.bin" );
+constexpr auto kUpdateItemName = BIT7Z_STRING( "update/extra.bin" );
+constexpr uint64_t kUpdateItemSize = 64 * 1024;
+
+/* A read-only std::streambuf over an existing buffer, so that stream benchmarks
+ * do not include the cost of copying the input data into a std::stringstream. */
+class MemoryStreamBuf final : public std::streambuf {
+    public:
+        explicit MemoryStreamBuf( const std::vector< byte_t >& buffer ) {
+            // NOLINTNEXTLINE(*-reinterpret-cast, *-const-cast)
+            auto* begin = const_cast< char* >( reinterpret_cast< const char* >( buffer.data() ) );
+            setg( begin, begin, begin + buffer.size() );
+        }
+
+    protected:
+        pos_type seekoff( off_type offset, std::ios_base::seekdir way, std::ios_base::openmode /*which*/ ) override {
+            char* base = ( way == std::ios_base::beg ) ? eback() : ( way == std::ios_base::cur ) ? gptr() : egptr();
+            char* position = base + offset;
+            if ( position < eback() || position > egptr() ) {
+                return pos_type( off_type( -1 ) );
+            }
+            setg( eback(), position, egptr() );
+            return pos_type( position - eback() );
+        }
+
+        pos_type seekpos( pos_type position, std::ios_base::openmode which ) override {
+            return seekoff( off_type( position ), std::ios_base::beg, which );
+        }
+};
+
+class MemoryIStream final : public std::istream {
+    public:
+        explicit MemoryIStream( const std::vector< byte_t >& buffer ) : std::istream( nullptr ), mBuffer( buffer ) {
+            rdbuf( &mBuffer );
+        }
+
+    private:
+        MemoryStreamBuf mBuffer;
+};
+
+std::vector< byte_t > readFile( const fs::path& path ) {
+    fs::ifstream in_file{ path, std::ios::binary };
+    return { std::istreambuf_iterator< char >( in_file ), std::istreambuf_iterator< char >() };
+}
+
+bool isMultiFile( const BitInOutFormat& format ) {
+    return format.hasFeature( FormatFeatures::MultipleFiles );
+}
+} // namespace
+
+namespace bit7z { // NOLINT(modernize-concat-nested-namespaces)
+namespace bench {
+
+const char* operationName( Operation operation ) noexcept {
+    switch ( operation ) {
+        case Operation::Compress:
+            return "compress";
+        case Operation::List:
+            return "list";
+        case Operation::Test:
+            return "test";
+        case Operation::Extract:
+            return "extract";
+        case Operation::Update:
+        default:
+            return "update";
+    }
+}
+
+const char* ioKindName( IoKind io_kind ) noexcept {
+    switch ( io_kind ) {
+        case IoKind::File:
+            return "file";
+        case IoKind::Buffer:
+            return "buffer";
+        case IoKind::Stream:
+        default:
+            return "stream";
+    }
+}
+
+const char* formatName( const BitInOutFormat& format ) noexcept {
+    if ( format == BitFormat::SevenZip ) {
+        return "7z";
+    }
+    if ( format == BitFormat::Zip ) {
+        return "zip";
+    }
+    if ( format == BitFormat::Tar ) {
+        return "tar";
+    }
+    if ( format == BitFormat::GZip ) {
+        return "gz";
+    }
+    if ( format == BitFormat::Xz ) {
+        return "xz";
+    }
+    if ( format == BitFormat::BZip2 ) {
+        return "bz2";
+    }
+#ifdef BIT7Z_NULL_CODEC
+    if ( format == BitNullFormat ) {
+        return "null";
+    }
+#endif
+    return "wim";
+}
+
+BenchmarkSuite::BenchmarkSuite( const Bit7zLibrary& lib, const Corpus& corpus, SuiteOptions options )
+    : mLibrary{ lib }, mCorpus{ corpus }, mOptions{ std::move( options ) } {}
+
+std::vector< Measurement > BenchmarkSuite::run( std::ostream& log ) {
+    prepareCorpus( log );
+
+    std::vector< Measurement > results;
+    for ( const auto* format : mOptions.formats ) {
+        runFormat( *format, results, log );
+    }
+    return results;
+}
+
+void BenchmarkSuite::prepareCorpus( std::ostream& log ) {
+    log << "Generating corpus: " << mCorpus.files().size() << " files, "
+        << mCorpus.totalSize() << " bytes (seed " << mCorpus.options().seed << ")" << std::endl;
+
+    mCorpusDir = mOptions.work_dir / "corpus";
+    fs::remove_all( mCorpusDir );
+    mCorpus.materialize( mCorpusDir );
+
+    mCorpusBuffers.clear();
+    mCorpusBuffers.reserve( mCorpus.files().size() );
+    for ( const auto& file : mCorpus.files() ) {
+        mCorpusBuffers.emplace_back( fs::path{ file.path }.string< tchar >(), mCorpus.content( file ) );
+    }
+
+    mBlob = mCorpus.blob();
+    mBlobFile = mOptions.work_dir / kBlobName;
+    fs::ofstream blob_file{ mBlobFile, std::ios::binary | std::ios::trunc };
+    blob_file.write( reinterpret_cast< const char* >( mBlob.data() ), // NOLINT(*-reinterpret-cast)
+                     static_cast< std::streamsize >( mBlob.size() ) );
+
+    SplitMix64 rng{ mCorpus.options().seed ^ 0x5555555555555555ull };
+    mUpdateBuffer.resize( kUpdateItemSize );
+    std::generate( mUpdateBuffer.begin(), mUpdateBuffer.end(), [ &rng ]() {
+        return static_cast< byte_t >( rng.next() & 0xFFu );
+    } );
+}
+
+void BenchmarkSuite::runFormat( const BitInOutFormat& format,
+                                std::vector< Measurement >& results,
+                                std::ostream& log ) {
+    const std::string format_name = formatName( format );
+    const bool multi_file = isMultiFile( format );
+    const uint64_t corpus_size = multi_file ? mCorpus.totalSize() : mBlob.size();
+
+    const fs::path format_dir = mOptions.work_dir / format_name;
+    fs::remove_all( format_dir );
+    fs::create_directories( format_dir );
+
+    const tstring out_file = ( format_dir / ( "output" + std::string{ "." } + format_name ) ).string< tchar >();
+    const tstring out_dir = ( format_dir / "extracted" ).string< tchar >();
+
+    // The reference archive used by all the reading operations.
+    const tstring reference_file = ( format_dir / ( "reference." + format_name ) ).string< tchar >();
+    BitFileCompressor reference_compressor{ mLibrary, format };
+    if ( multi_file ) {
+        reference_compressor.compressDirectory( mCorpusDir.string< tchar >(), reference_file );
+    } else {
+        reference_compressor.compressFile( mBlobFile.string< tchar >(), reference_file );
+    }
+    const std::vector< byte_t > reference_buffer = readFile( reference_file );
+    log << "Reference " << format_name << " archive: " << reference_buffer.size() << " bytes" << std::endl;
+
+    for ( const auto io_kind : mOptions.io_kinds ) {
+        for ( const auto operation : mOptions.operations ) {
+            const std::string name = format_name + "/" + operationName( operation ) + "/" + ioKindName( io_kind );
+            if ( !isSelected( name ) ) {
+                continue;
+            }
+            if ( operation == Operation::Update && !multi_file ) {
+                continue; // Single-file formats cannot be updated.
+            }
+
+            std::function< void() > action;
+            uint64_t bytes = corpus_size;
+
+            std::vector< byte_t > out_buffer;
+            std::ostringstream out_stream;
+            std::map< tstring, std::vector< byte_t > > out_map;
+            uint32_t largest_item = 0;
+            const auto reset_outputs = [ & ]() {
+                out_buffer.clear();
+                out_stream.str( {} );
+                out_stream.clear();
+                out_map.clear();
+                std::error_code error;
+                fs::remove( out_file, error );
+                fs::remove_all( out_dir, error );
+            };
+            const std::function< void() > setup = reset_outputs;
+
+            switch ( operation ) {
+                case Operation::Compress: {
+                    action = [ & ]() {
+                        if ( io_kind == IoKind::File ) {
+                            BitFileCompressor compressor{ mLibrary, format };
+                            if ( multi_file ) {
+                                compressor.compressDirectory( mCorpusDir.string< tchar >(), out_file );
+                            } else {
+                                compressor.compressFile( mBlobFile.string< tchar >(), out_file );
+                            }
+                        } else if ( io_kind == IoKind::Buffer ) {
+                            if ( multi_file ) {
+                                BitArchiveWriter writer{ mLibrary, format };
+                                for ( const auto& entry : mCorpusBuffers ) {
+                                    writer.addFile( entry.second, entry.first );
+                                }
+                                writer.compressTo( out_buffer );
+                            } else {
+                                BitMemCompressor compressor{ mLibrary, format };
+                                compressor.compressFile( mBlob, out_buffer, kBlobName );
+                            }
+                        } else {
+                            if ( multi_file ) {
+                                std::vector< std::unique_ptr< MemoryIStream > > in_streams;
+                                in_streams.reserve( mCorpusBuffers.size() );
+                                BitArchiveWriter writer{ mLibrary, format };
+                                for ( const auto& entry : mCorpusBuffers ) {
+                                    in_streams.push_back( std::make_unique< MemoryIStream >( entry.second ) );
+                                    writer.addFile( *in_streams.back(), entry.first );
+                                }
+                                writer.compressTo( out_stream );
+                            } else {
+                                MemoryIStream in_stream{ mBlob };
+                                BitStreamCompressor compressor{ mLibrary, format };
+                                compressor.compressFile( in_stream, out_stream, kBlobName );
+                            }
+                        }
+                    };
+                    break;
+                }
+                case Operation::List:
+                case Operation::Test:
+                case Operation::Extract: {
+                    if ( operation == Operation::List ) {
+                        bytes = 0; // Listing doesn't decode any item data.
+                    }
+                    if ( operation == Operation::Extract && io_kind == IoKind::Stream ) {
+                        // Extracting to a stream is done one item at a time: we extract the largest one.
+                        BitArchiveReader reader{ mLibrary, reference_buffer, format };
+                        uint64_t largest_size = 0;
+                        for ( const auto& item : reader.items() ) {
+                            if ( !item.isDir() && item.size() >= largest_size ) {
+                                largest_size = item.size();
+                                largest_item = item.index();
+                            }
+                        }
+                        bytes = largest_size;
+                    }
+                    action = [ & ]() {
+                        MemoryIStream in_stream{ reference_buffer };
+                        std::unique_ptr< BitArchiveReader > reader;
+                        if ( io_kind == IoKind::File ) {
+                            reader = std::make_unique< BitArchiveReader >( mLibrary, reference_file, format );
+                        } else if ( io_kind == IoKind::Buffer ) {
+                            reader = std::make_unique< BitArchiveReader >( mLibrary, reference_buffer, format );
+                        } else {
+                            reader = std::make_unique< BitArchiveReader >( mLibrary, in_stream, format );
+                        }
+
+                        if ( operation == Operation::List ) {
+                            const auto items = reader->items();
+                            if ( items.empty() ) {
+                                throw std::runtime_error( "The reference archive has no items" );
+                            }
+                        } else if ( operation == Operation::Test ) {
+                            reader->test();
+                        } else if ( io_kind == IoKind::File ) {
+                            reader->extract( out_dir );
+                        } else if ( io_kind == IoKind::Buffer ) {
+                            reader->extract( out_map );
+                        } else {
+                            reader->extract( out_stream, largest_item );
+                        }
+                    };
+                    break;
+                }
+                case Operation::Update: {
+                    action = [ & ]() {
+                        if ( io_kind == IoKind::File ) {
+                            BitArchiveWriter writer{ mLibrary, reference_file, format };
+                            writer.addFile( mUpdateBuffer, kUpdateItemName );
+                            writer.compressTo( out_file );
+                        } else if ( io_kind == IoKind::Buffer ) {
+                            BitArchiveWriter writer{ mLibrary, reference_buffer, format };
+                            writer.addFile( mUpdateBuffer, kUpdateItemName );
+                            writer.compressTo( out_buffer );
+                        } else {
+                            MemoryIStream in_stream{ reference_buffer };
+                            MemoryIStream update_stream{ mUpdateBuffer };
+                            BitArchiveWriter writer{ mLibrary, in_stream, format };
+                            writer.addFile( update_stream, kUpdateItemName );
+                            writer.compressTo( out_stream );
+                        }
+                    };
+                    break;
+                }
+            }
+
+            try {
+                results.push_back( measure( name, bytes, setup, action ) );
+                log << "  " << name << ": " << results.back().median_ns / 1e6 << " ms" << std::endl;
+            } catch ( const BitException& ex ) {
+                log << "  " << name << ": failed (" << ex.what() << ")" << std::endl;
+            }
+        }
+    }
+    fs::remove_all( format_dir );
+}
+
+Measurement BenchmarkSuite::measure( const std::string& name,
+                                     uint64_t bytes,
+                                     const std::function< void() >& setup,
+                                     const std::function< void() >& operation ) const {
+    using clock = std::chrono::steady_clock;
+
+    for ( uint32_t i = 0; i < mOptions.warmup_iterations; ++i ) {
+        setup();
+        operation();
+    }
+
+    std::vector< double > samples;
+    samples.reserve( mOptions.iterations );
+    for ( uint32_t i = 0; i < mOptions.iterations; ++i ) {
+        setup();
+        const auto start = clock::now();
+        operation();
+        const auto end = clock::now();
+        samples.push_back( std::chrono::duration< double, std::nano >( end - start ).count() );
+    }
+
+    Measurement result;
+    result.name = name;
+    result.bytes = bytes;
+    result.iterations = static_cast< uint32_t >( samples.size() );
+    if ( !samples.empty() ) {
+        std::sort( samples.begin(), samples.end() );
+        const std::size_t middle = samples.size() / 2;
+        result.min_ns = samples.front();
+        result.median_ns = samples.size() % 2 == 0 ? ( samples[ middle - 1 ] + samples[ middle ] ) / 2 : samples[ middle ];
+        result.mean_ns = std::accumulate( samples.begin(), samples.end(), 0.0 ) / static_cast< double >( samples.size() );
+    }
+    return result;
+}
+
+bool BenchmarkSuite::isSelected( const std::string& name ) const {
+    return mOptions.filter.empty() || name.find( mOptions.filter ) != std::string::npos;
+}
+
+} // namespace bench
+} // namespace bit7z
@@ -0,0 +1,95 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef SCENARIOS_HPP
+#define SCENARIOS_HPP
+
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <bit7zlibrary.hpp>
+#include <bitformat.hpp>
+#include <internal/fs.hpp>
+
+#include "corpus.hpp"
+#include "report.hpp"
+
+namespace bit7z { // NOLINT(modernize-concat-nested-namespaces)
+namespace bench {
+
+enum struct Operation {
+    Compress,
+    List,
+    Test,
+    Extract,
+    Update
+};
+
+enum struct IoKind {
+    File,
+    Buffer,
+    Stream
+};
+
+const char* operationName( Operation operation ) noexcept;
+
+const char* ioKindName( IoKind io_kind ) noexcept;
+
+const char* formatName( const BitInOutFormat& format ) noexcept;
+
+struct SuiteOptions {
+    std::vector< const BitInOutFormat* > formats;
+    std::vector< IoKind > io_kinds;
+    std::vector< Operation > operations;
+    uint32_t iterations = 5;
+    uint32_t warmup_iterations = 1;
+    fs::path work_dir;
+    std::string filter; // If not empty, only the benchmarks whose name contains this string are run.
+};
+
+/**
+ * @brief Runs the end-to-end benchmarks (i.e., including the codecs' costs) over a synthetic corpus.
+ *
+ * Each benchmark is named "<format>/<operation>/<io kind>" (e.g., "7z/extract/buffer").
+ */
+class BenchmarkSuite final {
+    public:
+        BenchmarkSuite( const Bit7zLibrary& lib, const Corpus& corpus, SuiteOptions options );
+
+        std::vector< Measurement > run( std::ostream& log );
+
+    private:
+        const Bit7zLibrary& mLibrary;
+        const Corpus& mCorpus;
+        SuiteOptions mOptions;
+
+        fs::path mCorpusDir;
+        fs::path mBlobFile;
+        std::vector< std::pair< tstring, std::vector< byte_t > > > mCorpusBuffers;
+        std::vector< byte_t > mBlob;
+        std::vector< byte_t > mUpdateBuffer;
+
+        void prepareCorpus( std::ostream& log );
+
+        void runFormat( const BitInOutFormat& format, std::vector< Measurement >& results, std::ostream& log );
+
+        Measurement measure( const std::string& name,
+                             uint64_t bytes,
+                             const std::function< void() >& setup,
+                             const std::function< void() >& operation ) const;
+
+        BIT7Z_NODISCARD bool isSelected( const std::string& name ) const;
+};
+
+} // namespace bench
+} // namespace bit7z
+
+#endif //SCENARIOS_HPP
@@ -35,9 +35,24 @@ if( BIT7Z_USE_NATIVE_STRING )
     set_property( TARGET ${TARGET_NAME} PROPERTY POSITION_INDEPENDENT_CODE ON )
 endif()
 
+option( BIT7Z_NULL_CODEC "Enable or disable the in-process null codec (an uncompressed format for tests and benchmarks)" )
+message( STATUS "Null codec: ${BIT7Z_NULL_CODEC}" )
+if( BIT7Z_NULL_CODEC )
+    target_compile_definitions( ${LIB_TARGET} PUBLIC BIT7Z_NULL_CODEC )
+endif()
+
+option( BIT7Z_TRACING "Enable or disable the USDT probes and the in-memory trace recorder" )
+message( STATUS "Tracing: ${BIT7Z_TRACING}" )
+if( BIT7Z_TRACING )
+    target_compile_definitions( ${LIB_TARGET} PUBLIC BIT7Z_TRACING )
+endif()
+
 option( BIT7Z_BUILD_TESTS "Enable or disable building the testing executable" )
 message( STATUS "Build tests: ${BIT7Z_BUILD_TESTS}" )
 
+option( BIT7Z_BUILD_BENCHMARKS "Enable or disable building the benchmarking executable" )
+message( STATUS "Build benchmarks: ${BIT7Z_BUILD_BENCHMARKS}" )
+
 if( CMAKE_CXX_COMPILER_ID MATCHES "Clang" )
     option( BIT7Z_LINK_LIBCPP "Enable or disable linking to libc++" )
     message( STATUS "Link to libc++: ${BIT7Z_LINK_LIBCPP}" )
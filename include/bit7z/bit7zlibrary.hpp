@@ -58,6 +58,11 @@ constexpr auto default_library = "./7z.so";
  */
 class Bit7zLibrary final {
     public:
+        /**
+         * @brief The signature of the CreateObject function exported by the 7-zip shared libraries.
+         */
+        using CreateObjectFunc = HRESULT ( WINAPI* )( const GUID* clsID, const GUID* interfaceID, void** out );
+
         Bit7zLibrary( const Bit7zLibrary& ) = delete;
 
         Bit7zLibrary( Bit7zLibrary&& ) = delete;
@@ -75,6 +80,14 @@ class Bit7zLibrary final {
          */
         explicit Bit7zLibrary( const tstring& library_path = default_library );
 
+        /**
+         * @brief Constructs a Bit7zLibrary object using the given function for creating the archive handlers,
+         * without loading any shared library (e.g., for using the in-process null codec).
+         *
+         * @param create_object_func  the function to be used in place of the CreateObject of the 7-zip libraries.
+         */
+        explicit Bit7zLibrary( CreateObjectFunc create_object_func );
+
         /**
          * @brief Destructs the Bit7zLibrary object, freeing the loaded shared library.
          */
@@ -94,12 +107,12 @@ class Bit7zLibrary final {
 
         /**
          * @brief Set the 7-zip shared library to use large memory pages.
+         *
+         * @note It does nothing if no shared library was loaded.
          */
         void setLargePageMode();
 
     private:
-        using CreateObjectFunc = HRESULT ( WINAPI* )( const GUID* clsID, const GUID* interfaceID, void** out );
-
         HMODULE mLibrary;
         CreateObjectFunc mCreateObjectFunc;
 };
@@ -18,6 +18,7 @@
 #include "bitcompressionmethod.hpp"
 #include "bitformat.hpp"
 #include "bitinputarchive.hpp"
+#include "bitmemoryestimate.hpp"
 
 struct IOutStream;
 struct ISequentialOutStream;
@@ -28,6 +29,16 @@ using std::ostream;
 
 class ArchiveProperties;
 
+/**
+ * @brief The default memory budget (in bytes) for the input files read ahead of the compressor.
+ */
+constexpr uint64_t kDefaultInputPrefetchBudget = 64 * 1024 * 1024;
+
+/**
+ * @brief The default entropy (in bits per byte) from which an input file is considered incompressible.
+ */
+constexpr double kDefaultIncompressibleEntropy = 7.5;
+
 /**
  * @brief Enumeration representing how an archive creator should deal when the output archive already exists.
  */
@@ -35,9 +46,22 @@ enum struct UpdateMode {
     None, ///< The creator will throw an exception (unless the OverwriteMode is not None).
     Append, ///< The creator will append the new items to the existing archive.
     Update, ///< New items whose path already exists in the archive will overwrite the old ones, other will be appended.
+    Sync, ///< Like Update, but unchanged items are kept as they are, and the ones missing in the new items are deleted.
     BIT7Z_DEPRECATED_ENUMERATOR( Overwrite, Update, "Since v4.0; please use the UpdateMode::Update enumerator." ) ///< @deprecated since v4.0; please use the UpdateMode::Update enumerator.
 };
 
+/**
+ * @brief Enumeration representing the order in which the new items are passed to the compressor.
+ *
+ * In solid archives, the order determines which files end up next to each other in the compressed stream,
+ * hence how many matches the compressor can find between them.
+ */
+enum struct SolidOrder {
+    None, ///< The items are compressed in the order they were added (e.g., the order they were indexed).
+    ByType, ///< The files are grouped by extension, and sorted by size within each group.
+    BySimilarity ///< Like ByType, but the files with a similar content are placed next to each other.
+};
+
 /**
  * @brief Abstract class representing a generic archive creator.
  */
@@ -93,6 +117,21 @@ class BitAbstractArchiveCreator : public BitAbstractArchiveHandler {
          */
         BIT7Z_NODISCARD bool solidMode() const noexcept;
 
+        /**
+         * @return the order in which the new items are passed to the compressor.
+         */
+        BIT7Z_NODISCARD SolidOrder solidOrder() const noexcept;
+
+        /**
+         * @return the maximum size (in bytes) of the solid blocks (a 0 value means no limit).
+         */
+        BIT7Z_NODISCARD uint64_t solidBlockSize() const noexcept;
+
+        /**
+         * @return the maximum number of files in each solid block (a 0 value means no limit).
+         */
+        BIT7Z_NODISCARD uint32_t solidBlockFilesCount() const noexcept;
+
         /**
          * @return the update mode used when updating existing archives.
          */
@@ -110,6 +149,44 @@ class BitAbstractArchiveCreator : public BitAbstractArchiveHandler {
          */
         BIT7Z_NODISCARD uint32_t threadsCount() const noexcept;
 
+        /**
+         * @return the maximum number of input files read ahead of the compressor
+         *         (a 0 value means that the input files are read only when requested by the compressor).
+         */
+        BIT7Z_NODISCARD uint32_t inputPrefetchCount() const noexcept;
+
+        /**
+         * @return the maximum memory (in bytes) used for keeping the input files read ahead of the compressor.
+         */
+        BIT7Z_NODISCARD uint64_t inputPrefetchBudget() const noexcept;
+
+        /**
+         * @return whether UpdateMode::Sync compares the content of the items, rather than their modification time.
+         */
+        BIT7Z_NODISCARD bool syncContentCheck() const noexcept;
+
+        /**
+         * @return whether the input files estimated to be incompressible are stored without compression.
+         */
+        BIT7Z_NODISCARD bool storeIncompressible() const noexcept;
+
+        /**
+         * @return the entropy (in bits per byte) from which an input file is considered incompressible.
+         */
+        BIT7Z_NODISCARD double incompressibleEntropy() const noexcept;
+
+        /**
+         * @return the maximum memory (in bytes) that the compression of an archive can use
+         *         (a 0 value means that there is no per-job limit).
+         */
+        BIT7Z_NODISCARD uint64_t memoryBudget() const noexcept;
+
+        /**
+         * @return the maximum memory (in bytes) that the compression of any archive can use
+         *         (a 0 value means that there is no global limit).
+         */
+        BIT7Z_NODISCARD static uint64_t globalMemoryBudget() noexcept;
+
         /**
          * @brief Sets up a password for the output archives.
          *
@@ -192,6 +269,34 @@ class BitAbstractArchiveCreator : public BitAbstractArchiveHandler {
          */
         void setSolidMode( bool solid_mode ) noexcept;
 
+        /**
+         * @brief Sets the order in which the new items are passed to the compressor.
+         *
+         * With SolidOrder::BySimilarity, the first bytes of each file on the filesystem are read for computing
+         * a sketch of its content (a MinHash over content-defined chunks), and the files of each type are chained
+         * so that every file is followed by the most similar among the next ones with a similar size.
+         *
+         * @note The 7z format sorts the files by itself: when this option is set, the files are sorted by type
+         *       (i.e., the "qs" property is set), but the order of the files having the same type is by name.
+         *       Formats that store the files in the given order (e.g., tar and wim) keep the order set by bit7z.
+         *
+         * @param order the desired order of the items.
+         */
+        void setSolidOrder( SolidOrder order ) noexcept;
+
+        /**
+         * @brief Sets the limits of the solid blocks, i.e., after how many bytes or files a new block is started.
+         *
+         * Smaller blocks allow extracting single files faster, at the cost of a worse compression ratio.
+         *
+         * @note The limits have effect only when the solid compression mode is enabled, and the output format
+         *       supports solid archives (i.e., 7z).
+         *
+         * @param max_block_size    the maximum size (in bytes) of each solid block (0 means no limit).
+         * @param max_block_files   the maximum number of files in each solid block (0 means no limit).
+         */
+        void setSolidBlockLimits( uint64_t max_block_size, uint32_t max_block_files = 0 ) noexcept;
+
         /**
          * @brief Sets whether and how the creator can update existing archives or not.
          *
@@ -231,6 +336,81 @@ class BitAbstractArchiveCreator : public BitAbstractArchiveHandler {
          */
         void setThreadsCount( uint32_t threads_count ) noexcept;
 
+        /**
+         * @brief Sets how many input files must be read ahead of the compressor, on background threads.
+         *
+         * When compressing many small files, or files on slow storage (e.g., network mounts), reading the next
+         * files in advance avoids the compressor waiting for each file to be opened and read.
+         *
+         * @note Only files on the filesystem are read in advance; files larger than the given memory budget
+         *       are always read directly by the compressor.
+         *
+         * @param items_count  the maximum number of files to be read in advance (0 disables the prefetch).
+         * @param max_bytes    the maximum memory (in bytes) used for the files read in advance.
+         */
+        void setInputPrefetch( uint32_t items_count, uint64_t max_bytes = kDefaultInputPrefetchBudget ) noexcept;
+
+        /**
+         * @brief Sets how UpdateMode::Sync detects whether a new item changed with respect to the archived one.
+         *
+         * By default, an item is considered unchanged if it has the same size and modification time of the archived
+         * one (the latter compared at the precision of the archive format, i.e., seconds, or two seconds for Zip).
+         * If the content check is enabled, the modification time is ignored, and the CRC of the new item is compared
+         * with the one stored in the archive (if the format stores it; otherwise, the modification time is used).
+         *
+         * @note The content check reads every new item having the same size of the archived one.
+         *
+         * @param content_check whether to compare the content of the items rather than their modification time.
+         */
+        void setSyncContentCheck( bool content_check ) noexcept;
+
+        /**
+         * @brief Sets whether the input files that are already compressed (e.g., media files and packages)
+         *        must be stored without compression, rather than wasting CPU time trying to compress them.
+         *
+         * A file is considered incompressible if the entropy of its first bytes (up to 8 KiB) is at least the given
+         * minimum entropy: already compressed data has an entropy close to 8 bits per byte, text usually below 5.
+         *
+         * When compressing to shards, the incompressible files are stored into shards of their own, using the
+         * Copy method, while the other files are compressed as usual. When compressing to a single archive,
+         * the archive is created using the Copy method only if all its new files are incompressible.
+         * In both cases, the metrics report the bytes stored without compression (BitOperationMetrics::stored_bytes).
+         *
+         * @note Only files on the filesystem at least 1 KiB large are checked; the other items are compressed.
+         *       The store has effect only with formats supporting multiple compression methods (i.e., 7z and zip).
+         *
+         * @param store         whether to store the incompressible files without compression.
+         * @param min_entropy   the entropy (in bits per byte) from which a file is considered incompressible.
+         */
+        void setStoreIncompressible( bool store, double min_entropy = kDefaultIncompressibleEntropy ) noexcept;
+
+        /**
+         * @brief Sets the maximum memory that the compression of an archive can use.
+         *
+         * Before compressing, the memory used by the encoder is estimated from the compression method,
+         * dictionary size, number of threads, and the size of the input (of the solid blocks, in solid archives).
+         * If the estimate exceeds the budget, the number of threads is reduced first, and then the dictionary size
+         * (down to 64 KiB); if the estimate still exceeds the budget, the compression fails with a BitException
+         * (std::errc::not_enough_memory), before creating the output archive.
+         * When compressing to shards, the budget is shared by the shards compressed at the same time.
+         *
+         * @note The creator's settings are left untouched: the reduced values are used only for the compression.
+         *       The estimate, together with the planned values, is returned by BitOutputArchive::memoryEstimate.
+         *
+         * @param max_memory the maximum memory (in bytes) of the compression (0 means no per-job limit).
+         */
+        void setMemoryBudget( uint64_t max_memory ) noexcept;
+
+        /**
+         * @brief Sets the maximum memory that the compression of any archive can use.
+         *
+         * The global budget applies to all the archive creators; when a creator has a memory budget too,
+         * the smaller of the two is used.
+         *
+         * @param max_memory the maximum memory (in bytes) of each compression (0 means no global limit).
+         */
+        static void setGlobalMemoryBudget( uint64_t max_memory ) noexcept;
+
         /**
          * @brief Sets a property for the output archive format as described by the 7-zip documentation
          * (e.g. https://sevenzip.osdn.jp/chm/cmdline/switches/method.htm).
@@ -268,7 +448,13 @@ class BitAbstractArchiveCreator : public BitAbstractArchiveHandler {
                                    tstring password = {},
                                    UpdateMode update_mode = UpdateMode::None );
 
-        BIT7Z_NODISCARD ArchiveProperties archiveProperties() const;
+        // The threads_limit (if not 0) caps the "mt" property, e.g., to the threads granted by a thread governor.
+        BIT7Z_NODISCARD ArchiveProperties archiveProperties( bool store_only = false,
+                                                             const BitMemoryEstimate* memory_plan = nullptr,
+                                                             uint32_t threads_limit = 0 ) const;
+
+        // The smaller between the memory budget of this creator and the global one (0 if neither is set).
+        BIT7Z_NODISCARD uint64_t effectiveMemoryBudget() const noexcept;
 
         friend class BitOutputArchive;
 
@@ -282,8 +468,17 @@ class BitAbstractArchiveCreator : public BitAbstractArchiveHandler {
         uint32_t mWordSize;
         bool mCryptHeaders;
         bool mSolidMode;
+        SolidOrder mSolidOrder;
+        uint64_t mSolidBlockSize;
+        uint32_t mSolidBlockFilesCount;
         uint64_t mVolumeSize;
         uint32_t mThreadsCount;
+        uint32_t mInputPrefetchCount;
+        uint64_t mInputPrefetchBudget;
+        bool mSyncContentCheck;
+        bool mStoreIncompressible;
+        double mIncompressibleEntropy;
+        uint64_t mMemoryBudget;
         std::map< std::wstring, BitPropVariant > mExtraProperties;
 };
 
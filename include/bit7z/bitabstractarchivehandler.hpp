@@ -10,11 +10,20 @@
 #ifndef BITABSTRACTARCHIVEHANDLER_HPP
 #define BITABSTRACTARCHIVEHANDLER_HPP
 
+#include <chrono>
 #include <cstdint>
 #include <functional>
 
 #include "bit7zlibrary.hpp"
+#include "bitadmissioncontroller.hpp"
+#include "bitcancellationtoken.hpp"
 #include "bitdefines.hpp"
+#include "bitextractioncache.hpp"
+#include "bithashmanifest.hpp"
+#include "bitmetrics.hpp"
+#include "bitprogress.hpp"
+#include "bitthreadgovernor.hpp"
+#include "bittracerecorder.hpp"
 
 namespace bit7z {
 
@@ -50,6 +59,11 @@ using FileCallback = function< void( tstring ) >;
  */
 using PasswordCallback = function< tstring() >;
 
+/**
+ * @brief A std::function whose argument contains the metrics collected during the operation just completed.
+ */
+using MetricsCallback = function< void( const BitOperationMetrics& ) >;
+
 /**
  * @brief Enumeration representing how a handler should deal when an output file already exists.
  */
@@ -127,6 +141,61 @@ class BitAbstractArchiveHandler {
          */
         BIT7Z_NODISCARD PasswordCallback passwordCallback() const;
 
+        /**
+         * @return the current metrics callback.
+         */
+        BIT7Z_NODISCARD MetricsCallback metricsCallback() const;
+
+        /**
+         * @return the minimum interval between two consecutive calls of the progress and ratio callbacks.
+         */
+        BIT7Z_NODISCARD std::chrono::milliseconds progressInterval() const noexcept;
+
+        /**
+         * @return the progress tracker updated by the handler, or nullptr if no tracker was set.
+         */
+        BIT7Z_NODISCARD BitProgress* progressTracker() const noexcept;
+
+        /**
+         * @return the admission controller of the handler's extractions, or nullptr if no controller was set.
+         */
+        BIT7Z_NODISCARD BitAdmissionController* admissionController() const noexcept;
+
+        /**
+         * @return the thread governor of the handler's operations (the global one if the handler has none),
+         *         or nullptr if no governor was set.
+         */
+        BIT7Z_NODISCARD BitThreadGovernor* threadGovernor() const noexcept;
+
+        /**
+         * @return the cancellation token of the handler's operations, or nullptr if no token was set.
+         */
+        BIT7Z_NODISCARD BitCancellationToken* cancellationToken() const noexcept;
+
+        /**
+         * @return the extraction cache of the handler's extractions to the filesystem,
+         *         or nullptr if no cache was set.
+         */
+        BIT7Z_NODISCARD BitExtractionCache* extractionCache() const noexcept;
+
+        /**
+         * @return the hash manifest of the archive's items used for keying them in the extraction cache,
+         *         or nullptr if no manifest was set.
+         */
+        BIT7Z_NODISCARD const BitHashManifest* hashManifest() const noexcept;
+
+        /**
+         * @return the maximum duration of each operation of the handler (0 means no limit).
+         */
+        BIT7Z_NODISCARD std::chrono::milliseconds timeout() const noexcept;
+
+#ifdef BIT7Z_TRACING
+        /**
+         * @return the trace recorder used by the handler, or nullptr if no recorder was set.
+         */
+        BIT7Z_NODISCARD BitTraceRecorder* traceRecorder() const noexcept;
+#endif
+
         /**
          * @return the current OverwriteMode.
          */
@@ -211,6 +280,134 @@ class BitAbstractArchiveHandler {
          */
         void setPasswordCallback( const PasswordCallback& callback );
 
+        /**
+         * @brief Sets the function to be called with the metrics of each operation, once it is completed.
+         *
+         * @note When no metrics callback is set, no metrics are collected.
+         *
+         * @param callback  the metrics callback to be used.
+         */
+        void setMetricsCallback( const MetricsCallback& callback );
+
+        /**
+         * @brief Sets the minimum interval between two consecutive calls of the progress and ratio callbacks.
+         *
+         * The notifications received in the meantime are coalesced, i.e., the callbacks are called only with
+         * the latest values. The last progress and ratio values of an operation are always notified when it
+         * finishes (even if it fails or it is stopped).
+         *
+         * @note By default, the interval is zero, and the callbacks are called at every notification of 7-zip.
+         *
+         * @param interval  the minimum interval between the calls of the callbacks.
+         */
+        void setProgressInterval( std::chrono::milliseconds interval ) noexcept;
+
+        /**
+         * @brief Sets the progress tracker to be updated during the operations of the handler.
+         *
+         * The tracker is updated at every notification, regardless of the progress interval, and it can be polled
+         * by other threads while an operation is running.
+         *
+         * @note The tracker is not owned by the handler, and it must outlive the operations using it.
+         *
+         * @param tracker  the progress tracker to be used (nullptr disables the tracking).
+         */
+        void setProgressTracker( BitProgress* tracker ) noexcept;
+
+        /**
+         * @brief Sets the admission controller that must admit the handler's extractions (and tests) before they run.
+         *
+         * Each extraction is admitted with the memory estimated for decoding the archive
+         * (see BitInputArchive::memoryEstimate), and it releases it once completed; sharing the same controller
+         * among the handlers used by different threads keeps their concurrent extractions within its budget.
+         *
+         * @note The controller is not owned by the handler, and it must outlive the operations using it.
+         *
+         * @param controller  the admission controller to be used (nullptr disables the admission control).
+         */
+        void setAdmissionController( BitAdmissionController* controller ) noexcept;
+
+        /**
+         * @brief Sets the thread governor granting the threads used by the handler's operations.
+         *
+         * Each compression, extraction, and test sets the number of 7-zip worker threads (i.e., the "mt" property)
+         * to the threads granted by the governor, which never exceed the ones set by
+         * BitAbstractArchiveCreator::setThreadsCount (if any); the threads are given back when the operation ends.
+         *
+         * @note The governor is not owned by the handler, and it must outlive the operations using it.
+         *
+         * @param governor  the thread governor to be used (nullptr means the global one, if any).
+         */
+        void setThreadGovernor( BitThreadGovernor* governor ) noexcept;
+
+        /**
+         * @brief Sets the thread governor of all the handlers that have no governor of their own.
+         *
+         * @note The governor is not owned by the handlers, and it must outlive the operations using it.
+         *
+         * @param governor  the thread governor to be used (nullptr disables the global governor).
+         */
+        static void setGlobalThreadGovernor( BitThreadGovernor* governor ) noexcept;
+
+        /**
+         * @brief Sets the token that cancels the handler's operations.
+         *
+         * Cancelled operations fail with std::errc::operation_canceled, discarding their partial output:
+         * the output archive of a compression to a file (or a buffer), or the item being extracted to the disk.
+         * The files that were overwritten (see OverwriteMode::Overwrite) are not restored, while
+         * the archives updated in place are left unchanged.
+         * Operations aborted by the progress callback (see setProgressCallback) are not cancelled by the token,
+         * so they keep their partial output.
+         *
+         * @note The token is not owned by the handler, and it must outlive the operations using it.
+         *
+         * @param token  the cancellation token to be used (nullptr disables it).
+         */
+        void setCancellationToken( BitCancellationToken* token ) noexcept;
+
+        /**
+         * @brief Sets the maximum duration of each operation of the handler, after which the operation is cancelled
+         *        (as if by the cancellation token).
+         *
+         * @param timeout  the maximum duration of each operation (0 means no limit).
+         */
+        void setTimeout( std::chrono::milliseconds timeout ) noexcept;
+
+        /**
+         * @brief Sets the content-addressed cache used by the handler's extractions to the filesystem.
+         *
+         * The files already in the cache (by CRC, size, and SHA-256) are restored from it, without being decoded;
+         * the others are extracted as usual, and then inserted into the cache. The SHA-256 of the items is the one
+         * in the hash manifest (see setHashManifest); the items without it are cached only if the cache accepts
+         * the CRC-only keys (see BitExtractionCache::setCrcOnlyKeys).
+         *
+         * @note The cache is not owned by the handler, and it must outlive the operations using it.
+         *
+         * @param cache  the extraction cache to be used (nullptr disables the cache).
+         */
+        void setExtractionCache( BitExtractionCache* cache ) noexcept;
+
+        /**
+         * @brief Sets the manifest with the SHA-256 of the archive's items, used for keying them in the extraction
+         *        cache (e.g., the manifest recorded when creating the archive).
+         *
+         * @note The manifest is not owned by the handler, and it must outlive the operations using it.
+         *
+         * @param manifest  the hash manifest to be used (nullptr means that the SHA-256 of the items is unknown).
+         */
+        void setHashManifest( const BitHashManifest* manifest ) noexcept;
+
+#ifdef BIT7Z_TRACING
+        /**
+         * @brief Sets the recorder of the trace events of the handler's operations.
+         *
+         * @note The recorder is not owned by the handler, and it must outlive the operations using it.
+         *
+         * @param recorder  the trace recorder to be used (nullptr disables the recording).
+         */
+        void setTraceRecorder( BitTraceRecorder* recorder ) noexcept;
+#endif
+
         /**
          * @brief Sets how the handler should behave when it tries to output to an existing file or buffer.
          *
@@ -235,6 +432,18 @@ class BitAbstractArchiveHandler {
         RatioCallback mRatioCallback;
         FileCallback mFileCallback;
         PasswordCallback mPasswordCallback;
+        MetricsCallback mMetricsCallback;
+        std::chrono::milliseconds mProgressInterval;
+        BitProgress* mProgressTracker;
+        BitAdmissionController* mAdmissionController;
+        BitThreadGovernor* mThreadGovernor;
+        BitCancellationToken* mCancellationToken;
+        std::chrono::milliseconds mTimeout;
+        BitExtractionCache* mExtractionCache;
+        const BitHashManifest* mHashManifest;
+#ifdef BIT7Z_TRACING
+        BitTraceRecorder* mTraceRecorder = nullptr;
+#endif
 };
 
 }  // namespace bit7z
@@ -0,0 +1,116 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef BITADMISSIONCONTROLLER_HPP
+#define BITADMISSIONCONTROLLER_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+#include "bitdefines.hpp"
+
+namespace bit7z {
+
+/**
+ * @brief Enumeration representing what an admission controller does with a job that does not fit
+ *        into the memory left by the running jobs.
+ */
+enum struct AdmissionPolicy {
+    Queue, ///< The job waits until the running jobs release enough memory (jobs are admitted in arrival order).
+    Reject ///< The job fails with a BitException.
+};
+
+/**
+ * @brief The BitAdmissionController class keeps the memory used by concurrent jobs (e.g., extractions
+ *        of different archives by different threads) within a memory budget.
+ *
+ * Each job is admitted with its estimated memory usage, and it releases it once completed.
+ * Jobs that need more memory than the whole budget are always rejected (with std::errc::not_enough_memory).
+ *
+ * @note The controller can be shared by any number of handlers and threads (see
+ *       BitAbstractArchiveHandler::setAdmissionController).
+ */
+class BitAdmissionController final {
+    public:
+        /**
+         * @brief Constructs an admission controller with the given memory budget.
+         *
+         * @param memory_budget the maximum memory (in bytes) of the jobs running at the same time.
+         * @param policy        what to do with the jobs that do not fit into the memory left by the running ones.
+         */
+        explicit BitAdmissionController( uint64_t memory_budget, AdmissionPolicy policy = AdmissionPolicy::Queue );
+
+        BitAdmissionController( const BitAdmissionController& ) = delete;
+
+        BitAdmissionController( BitAdmissionController&& ) = delete;
+
+        BitAdmissionController& operator=( const BitAdmissionController& ) = delete;
+
+        BitAdmissionController& operator=( BitAdmissionController&& ) = delete;
+
+        ~BitAdmissionController() = default;
+
+        /**
+         * @return the maximum memory (in bytes) of the jobs running at the same time.
+         */
+        BIT7Z_NODISCARD uint64_t memoryBudget() const noexcept;
+
+        /**
+         * @return what the controller does with the jobs that do not fit into the memory left by the running ones.
+         */
+        BIT7Z_NODISCARD AdmissionPolicy policy() const noexcept;
+
+        /**
+         * @return the memory (in bytes) currently used by the admitted jobs.
+         */
+        BIT7Z_NODISCARD uint64_t memoryInUse() const;
+
+        /**
+         * @return the number of jobs currently admitted.
+         */
+        BIT7Z_NODISCARD uint32_t runningJobs() const;
+
+        /**
+         * @return the number of jobs currently waiting to be admitted.
+         */
+        BIT7Z_NODISCARD uint32_t queuedJobs() const;
+
+        /**
+         * @brief Admits a job using the given memory, waiting for the running jobs to release enough memory
+         *        if the policy is AdmissionPolicy::Queue.
+         *
+         * @note Every admitted job must be released with the same memory usage.
+         *
+         * @param memory_usage the estimated memory usage (in bytes) of the job.
+         */
+        void acquire( uint64_t memory_usage );
+
+        /**
+         * @brief Releases the memory of an admitted job, admitting the queued jobs that now fit.
+         *
+         * @param memory_usage the memory usage (in bytes) with which the job was admitted.
+         */
+        void release( uint64_t memory_usage ) noexcept;
+
+    private:
+        const uint64_t mMemoryBudget;
+        const AdmissionPolicy mPolicy;
+
+        mutable std::mutex mMutex;
+        std::condition_variable mReleased;
+        uint64_t mMemoryInUse;
+        uint32_t mRunningJobs;
+        uint64_t mNextTicket; // The queued jobs are admitted in the order of their tickets.
+        uint64_t mServedTicket;
+};
+
+}  // namespace bit7z
+
+#endif // BITADMISSIONCONTROLLER_HPP
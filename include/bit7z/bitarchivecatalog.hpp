@@ -0,0 +1,105 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef BITARCHIVECATALOG_HPP
+#define BITARCHIVECATALOG_HPP
+
+#include <cstdint>
+#include <unordered_map>
+
+#include "bitdefines.hpp"
+#include "bitpropvariant.hpp"
+#include "bittypes.hpp"
+
+namespace bit7z {
+
+class BitInputArchive;
+
+/**
+ * @brief The BitCatalogItem struct contains the metadata of an archived item needed for detecting
+ *        whether the corresponding file changed since it was archived.
+ */
+struct BitCatalogItem {
+    bool is_dir = false; ///< Whether the item is a folder.
+    uint64_t size = 0; ///< The size of the item (0 if unknown).
+    time_type last_write_time{}; ///< The last write time of the item (the epoch if unknown).
+    bool has_crc = false; ///< Whether the CRC-32 of the item is known.
+    uint32_t crc = 0; ///< The CRC-32 of the item (if known).
+};
+
+/**
+ * @brief The BitArchiveCatalog class is a hash index of the items of an archive by their paths, e.g., the baseline
+ *        of differential archives (see BitOutputArchive::setBaseline).
+ *
+ * A catalog can be saved to a file, so that the next differential archives do not need the baseline archive.
+ */
+class BitArchiveCatalog final {
+    public:
+        /**
+         * @brief Constructs an empty catalog.
+         */
+        BitArchiveCatalog() = default;
+
+        /**
+         * @brief Constructs the catalog of the items of the given archive.
+         *
+         * @param archive the archive whose items must be indexed (anti-items excluded).
+         */
+        explicit BitArchiveCatalog( const BitInputArchive& archive );
+
+        /**
+         * @brief Adds an item to the catalog, replacing any item with the same path.
+         *
+         * @param path the path of the item within the archive.
+         * @param item the metadata of the item.
+         */
+        void addItem( const tstring& path, const BitCatalogItem& item );
+
+        /**
+         * @brief Searches the item with the given path.
+         *
+         * @param path the path of the item within the archive.
+         *
+         * @return a pointer to the metadata of the item, or nullptr if the catalog has no item with the path.
+         */
+        BIT7Z_NODISCARD const BitCatalogItem* find( const tstring& path ) const;
+
+        /**
+         * @return the number of items in the catalog.
+         */
+        BIT7Z_NODISCARD std::size_t size() const noexcept;
+
+        /**
+         * @return the items of the catalog, indexed by their paths.
+         */
+        BIT7Z_NODISCARD const std::unordered_map< tstring, BitCatalogItem >& items() const noexcept;
+
+        /**
+         * @brief Writes the catalog to the given file (UTF-8 text, one line per item).
+         *
+         * @param catalog_file the path of the catalog file to be written.
+         */
+        void save( const tstring& catalog_file ) const;
+
+        /**
+         * @brief Reads a catalog previously written using the save method.
+         *
+         * @param catalog_file the path of the catalog file to be read.
+         *
+         * @return the catalog read from the file.
+         */
+        BIT7Z_NODISCARD static BitArchiveCatalog load( const tstring& catalog_file );
+
+    private:
+        std::unordered_map< tstring, BitCatalogItem > mItems;
+};
+
+}  // namespace bit7z
+
+#endif // BITARCHIVECATALOG_HPP
@@ -0,0 +1,110 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef BITARCHIVEDIFF_HPP
+#define BITARCHIVEDIFF_HPP
+
+#include <utility>
+#include <vector>
+
+#include "bitarchivecatalog.hpp"
+#include "bitdefines.hpp"
+#include "bitformat.hpp"
+#include "bittypes.hpp"
+
+namespace bit7z {
+
+class Bit7zLibrary;
+class BitInputArchive;
+
+/**
+ * @brief The BitArchiveDiff class compares two archives (e.g., two releases of the same software) using only
+ *        the metadata stored in them, i.e., without extracting their content.
+ *
+ * Two items with the same path are unchanged if they are both folders, or if they are both files having the same
+ * size and CRC-32. If the CRC of an item is not known (e.g., in Tar archives), the items are compared by content
+ * (when comparing two archives, see the content_check parameter) or by their last write time (otherwise).
+ */
+class BitArchiveDiff final {
+    public:
+        /**
+         * @brief Compares the items of the given catalogs.
+         *
+         * @param old_catalog the catalog of the old archive.
+         * @param new_catalog the catalog of the new archive.
+         */
+        BitArchiveDiff( const BitArchiveCatalog& old_catalog, const BitArchiveCatalog& new_catalog );
+
+        /**
+         * @brief Compares the items of the given archives.
+         *
+         * @param old_archive   the old archive.
+         * @param new_archive   the new archive.
+         * @param content_check (optional) whether to compare the content of the files of the same size
+         *                      whose CRC is not known (only these files are extracted).
+         */
+        BitArchiveDiff( const BitInputArchive& old_archive,
+                        const BitInputArchive& new_archive,
+                        bool content_check = true );
+
+        /**
+         * @return the paths of the items that are only in the new archive (sorted).
+         */
+        BIT7Z_NODISCARD const std::vector< tstring >& added() const noexcept;
+
+        /**
+         * @return the paths of the items that are only in the old archive (sorted).
+         */
+        BIT7Z_NODISCARD const std::vector< tstring >& removed() const noexcept;
+
+        /**
+         * @return the paths of the items that are in both archives, but changed (sorted).
+         */
+        BIT7Z_NODISCARD const std::vector< tstring >& changed() const noexcept;
+
+        /**
+         * @return the paths of the items that are in both archives, and unchanged (sorted).
+         */
+        BIT7Z_NODISCARD const std::vector< tstring >& unchanged() const noexcept;
+
+        /**
+         * @return true if and only if the two archives have the same items, all unchanged.
+         */
+        BIT7Z_NODISCARD bool identical() const noexcept;
+
+        /**
+         * @brief Compares the given pairs of archive files concurrently (one pair per thread).
+         *
+         * @param lib           the 7z library used.
+         * @param pairs         the paths of the pairs of archives (old and new) to be compared.
+         * @param format        the format of the archives.
+         *
+         * @return the differences between the archives of each pair, in the same order of the pairs.
+         */
+        BIT7Z_NODISCARD
+        static std::vector< BitArchiveDiff > compare( const Bit7zLibrary& lib,
+                                                      const std::vector< std::pair< tstring, tstring > >& pairs,
+                                                      const BitInFormat& format BIT7Z_DEFAULT_FORMAT );
+
+    private:
+        std::vector< tstring > mAdded;
+        std::vector< tstring > mRemoved;
+        std::vector< tstring > mChanged;
+        std::vector< tstring > mUnchanged;
+
+        // Compares the catalogs, returning the paths of the files whose change cannot be detected by their CRC.
+        std::vector< tstring > compareCatalogs( const BitArchiveCatalog& old_catalog,
+                                                const BitArchiveCatalog& new_catalog );
+
+        void sortPaths();
+};
+
+}  // namespace bit7z
+
+#endif // BITARCHIVEDIFF_HPP
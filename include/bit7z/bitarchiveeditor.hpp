@@ -57,7 +57,7 @@ class BIT7Z_MAYBE_UNUSED BitArchiveEditor final : public BitArchiveWriter {
          *
          * @note BitArchiveEditor doesn't support UpdateMode::None.
          *
-         * @param mode the desired update mode (either UpdateMode::Append or UpdateMode::Overwrite).
+         * @param mode the desired update mode (i.e., UpdateMode::Append, UpdateMode::Update, or UpdateMode::Sync).
          */
         void setUpdateMode( UpdateMode mode ) override;
 
@@ -164,6 +164,8 @@ class BIT7Z_MAYBE_UNUSED BitArchiveEditor final : public BitArchiveWriter {
         bool hasNewData( uint32_t index ) const noexcept override;
 
         bool hasNewProperties( uint32_t index ) const noexcept override;
+
+        bool isEditedIndex( uint32_t index ) const noexcept override;
 };
 
 }  // namespace bit7z
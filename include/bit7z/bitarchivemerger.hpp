@@ -0,0 +1,104 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef BITARCHIVEMERGER_HPP
+#define BITARCHIVEMERGER_HPP
+
+#include <vector>
+
+#include "bitabstractarchivehandler.hpp"
+#include "bitdefines.hpp"
+#include "bitformat.hpp"
+#include "bittypes.hpp"
+
+namespace bit7z {
+
+/**
+ * @brief Enumeration representing how an archive merger handles the items having the same path
+ *        in the merged archives.
+ *
+ * @note Folders with the same path are always merged into a single folder item (the first one).
+ */
+enum struct DuplicatePolicy {
+    Fail, ///< The merger throws an exception (std::errc::file_exists), and it does not create the output archive.
+    KeepFirst, ///< The merger keeps only the first item with the path (in the order of the merged archives).
+    KeepLast, ///< The merger keeps only the last item with the path (in the order of the merged archives).
+    KeepAll ///< The merger keeps all the items with the path.
+};
+
+/**
+ * @brief The BitArchiveMerger class merges Zip or Tar archives into a single archive of the same format,
+ *        copying the (compressed) data of the items as it is, without decompressing and compressing it again.
+ *
+ * The merger reads and writes the archive formats natively, so it does not need the 7-zip shared library,
+ * and it is bound only by the speed of the disk.
+ * For Zip archives, the local headers and the central directory are rewritten with the new offsets of the items
+ * (switching to Zip64 structures when needed); Tar archives are concatenated item by item, with their header blocks
+ * (including the pax and GNU extended headers) copied as they are.
+ *
+ * @note Multi-volume Zip archives are not supported.
+ */
+class BitArchiveMerger final {
+    public:
+        /**
+         * @brief Constructs a merger for the given archive format.
+         *
+         * @param format the format of the merged archives (either BitFormat::Zip or BitFormat::Tar).
+         */
+        explicit BitArchiveMerger( const BitInOutFormat& format );
+
+        /**
+         * @return the format of the merged archives.
+         */
+        BIT7Z_NODISCARD const BitInOutFormat& format() const noexcept;
+
+        /**
+         * @return how the merger handles the items having the same path in the merged archives.
+         */
+        BIT7Z_NODISCARD DuplicatePolicy duplicatePolicy() const noexcept;
+
+        /**
+         * @return what the merger does when the output archive already exists.
+         */
+        BIT7Z_NODISCARD OverwriteMode overwriteMode() const noexcept;
+
+        /**
+         * @brief Sets how the merger handles the items having the same path in the merged archives.
+         *
+         * @param policy the policy for the items with duplicate paths (DuplicatePolicy::Fail by default).
+         */
+        void setDuplicatePolicy( DuplicatePolicy policy ) noexcept;
+
+        /**
+         * @brief Sets what the merger does when the output archive already exists.
+         *
+         * @param mode the overwrite mode (OverwriteMode::None by default).
+         */
+        void setOverwriteMode( OverwriteMode mode ) noexcept;
+
+        /**
+         * @brief Merges the given archives into the output archive.
+         *
+         * The items are written in the order of the input archives, and, within each archive, in their original
+         * order. If the merge fails, the partially written output archive is removed.
+         *
+         * @param in_archives the paths of the archives to be merged.
+         * @param out_archive the path of the output archive (it must not be one of the input archives).
+         */
+        void merge( const std::vector< tstring >& in_archives, const tstring& out_archive ) const;
+
+    private:
+        const BitInOutFormat& mFormat;
+        DuplicatePolicy mDuplicatePolicy;
+        OverwriteMode mOverwriteMode;
+};
+
+}  // namespace bit7z
+
+#endif // BITARCHIVEMERGER_HPP
@@ -14,6 +14,9 @@
 #include "bitarchiveiteminfo.hpp"
 #include "bitinputarchive.hpp"
 
+#include <memory>
+#include <system_error>
+
 struct IInArchive;
 struct IOutArchive;
 struct IArchiveExtractCallback;
@@ -79,6 +82,43 @@ class BitArchiveReader final : public BitAbstractArchiveOpener, public BitInputA
                           const BitInFormat& format BIT7Z_DEFAULT_FORMAT,
                           const tstring& password = {} );
 
+        /**
+         * @brief Opens the input file archive without throwing exceptions (e.g., when many files might not be
+         *        valid archives).
+         *
+         * @param lib           the 7z library used.
+         * @param in_archive    the path to the archive to be read.
+         * @param error         the error code set if the archive could not be opened.
+         * @param format        the format of the input archive.
+         * @param password      the password needed for opening the input archive.
+         *
+         * @return the BitArchiveReader of the opened archive, or nullptr if it could not be opened.
+         */
+        BIT7Z_NODISCARD
+        static std::unique_ptr< BitArchiveReader > tryOpen( const Bit7zLibrary& lib,
+                                                            const tstring& in_archive,
+                                                            std::error_code& error,
+                                                            const BitInFormat& format BIT7Z_DEFAULT_FORMAT,
+                                                            const tstring& password = {} ) noexcept;
+
+        /**
+         * @brief Opens the archive in the input buffer without throwing exceptions.
+         *
+         * @param lib           the 7z library used.
+         * @param in_archive    the input buffer containing the archive to be read.
+         * @param error         the error code set if the archive could not be opened.
+         * @param format        the format of the input archive.
+         * @param password      the password needed for opening the input archive.
+         *
+         * @return the BitArchiveReader of the opened archive, or nullptr if it could not be opened.
+         */
+        BIT7Z_NODISCARD
+        static std::unique_ptr< BitArchiveReader > tryOpen( const Bit7zLibrary& lib,
+                                                            const std::vector< byte_t >& in_archive,
+                                                            std::error_code& error,
+                                                            const BitInFormat& format BIT7Z_DEFAULT_FORMAT,
+                                                            const tstring& password = {} ) noexcept;
+
         BitArchiveReader( const BitArchiveReader& ) = delete;
 
         BitArchiveReader( BitArchiveReader&& ) = delete;
@@ -143,6 +183,19 @@ class BitArchiveReader final : public BitAbstractArchiveOpener, public BitInputA
          * @return true if and only if the archive was created using solid compression.
          */
         BIT7Z_NODISCARD bool isSolid() const;
+
+    private:
+        BitArchiveReader( const Bit7zLibrary& lib,
+                          const tstring& in_archive,
+                          const BitInFormat& format,
+                          const tstring& password,
+                          std::error_code& error );
+
+        BitArchiveReader( const Bit7zLibrary& lib,
+                          const std::vector< byte_t >& in_archive,
+                          const BitInFormat& format,
+                          const tstring& password,
+                          std::error_code& error );
 };
 
 using BitArchiveInfo BIT7Z_MAYBE_UNUSED BIT7Z_DEPRECATED_MSG("Since v4.0; please use BitArchiveReader.") = BitArchiveReader;
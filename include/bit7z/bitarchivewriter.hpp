@@ -10,6 +10,7 @@
 #ifndef BITARCHIVEWRITER_HPP
 #define BITARCHIVEWRITER_HPP
 
+#include "bitcalibration.hpp"
 #include "bitoutputarchive.hpp"
 
 namespace bit7z {
@@ -65,6 +66,22 @@ class BitArchiveWriter : public BitAbstractArchiveCreator, public BitOutputArchi
                           std::istream& in_archive,
                           const BitInOutFormat& format,
                           const tstring& password = {} );
+
+        /**
+         * @brief Chooses the compression parameters of the items added so far, and applies them to this writer.
+         *
+         * A sample of the input files is compressed in memory with each candidate parameter set;
+         * the candidate with the best compression ratio among the ones meeting the throughput target
+         * (or deadline) is then applied via setCompressionLevel, setDictionarySize, setWordSize,
+         * and setThreadsCount.
+         *
+         * @note Only the items read from the filesystem are sampled.
+         *
+         * @param options the calibration settings.
+         *
+         * @return the chosen parameters, together with their measured ratio and throughput on the sample.
+         */
+        BitCalibrationResult calibrate( const BitCalibrationOptions& options = {} );
 };
 
 }  // namespace bit7z
@@ -0,0 +1,87 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef BITCALIBRATION_HPP
+#define BITCALIBRATION_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "bitcompressionlevel.hpp"
+#include "bitdefines.hpp"
+#include "bittypes.hpp"
+
+namespace bit7z {
+
+/**
+ * @brief The default maximum size (in bytes) of the sample of the input files used for a calibration.
+ */
+constexpr uint64_t kDefaultCalibrationSampleSize = 16 * 1024 * 1024;
+
+/**
+ * @brief The BitCompressionParameters struct contains a set of compression parameters evaluated by a calibration.
+ */
+struct BitCompressionParameters {
+    BitCompressionLevel level = BitCompressionLevel::Normal; ///< The compression level.
+    uint32_t dictionary_size = 0; ///< The dictionary size (0 means the default one for the level).
+    uint32_t word_size = 0; ///< The word size (0 means the default one for the level).
+    uint32_t threads_count = 0; ///< The number of threads (0 means the 7-zip default).
+};
+
+/**
+ * @brief The BitCalibrationOptions struct contains the settings of a calibration of the compression parameters.
+ */
+struct BitCalibrationOptions {
+    /**
+     * @brief The minimum throughput (in input bytes per second) that the chosen parameters must reach
+     *        (0 means no minimum).
+     */
+    double min_throughput = 0;
+
+    /**
+     * @brief The maximum time for compressing all the input files, which is converted into a minimum throughput
+     *        (0 means no deadline).
+     */
+    std::chrono::milliseconds deadline{ 0 };
+
+    /**
+     * @brief The maximum size (in bytes) of the sample of the input files that is compressed with each candidate.
+     */
+    uint64_t sample_size = kDefaultCalibrationSampleSize;
+
+    /**
+     * @brief The candidate parameters to be evaluated; if empty, the compression levels from Fastest to Ultra
+     *        are evaluated, with their default dictionary and word sizes.
+     */
+    std::vector< BitCompressionParameters > candidates;
+
+    /**
+     * @brief The path of the file caching the calibrations per data profile (if empty, no cache is used).
+     *
+     * The profile of the input files is made of their main extensions, the entropy of the sample,
+     * the output format and method, the target throughput, the candidates, and the number of CPU cores.
+     */
+    tstring cache_file;
+};
+
+/**
+ * @brief The BitCalibrationResult struct contains the outcome of a calibration of the compression parameters.
+ */
+struct BitCalibrationResult {
+    BitCompressionParameters parameters; ///< The chosen compression parameters.
+    double ratio = 0; ///< The compressed size of the sample divided by its uncompressed size.
+    double throughput = 0; ///< The throughput on the sample (in input bytes per second).
+    bool meets_target = false; ///< Whether the throughput target is met (if not, the fastest candidate is chosen).
+    bool cached = false; ///< Whether the result was read from the cache, without compressing the sample.
+};
+
+}  // namespace bit7z
+
+#endif // BITCALIBRATION_HPP
@@ -0,0 +1,84 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef BITCANCELLATIONTOKEN_HPP
+#define BITCANCELLATIONTOKEN_HPP
+
+#include <atomic>
+#include <chrono>
+
+#include "bitdefines.hpp"
+
+namespace bit7z {
+
+/**
+ * @brief The BitCancellationToken class allows cancelling the operations of the handlers using it
+ *        (see BitAbstractArchiveHandler::setCancellationToken), either explicitly or once a deadline has passed.
+ *
+ * The token is checked at every read and write of the archive and item streams, and at every progress
+ * notification, so a cancelled operation stops within one I/O chunk, failing with std::errc::operation_canceled.
+ *
+ * @note The token can be cancelled from any thread (e.g., while another thread is running the operation).
+ */
+class BitCancellationToken final {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        /**
+         * @brief Constructs a token without a deadline.
+         */
+        BitCancellationToken() noexcept;
+
+        /**
+         * @brief Constructs a token that is cancelled once the given deadline has passed.
+         *
+         * @param deadline the time point after which the token is cancelled.
+         */
+        explicit BitCancellationToken( clock::time_point deadline ) noexcept;
+
+        BitCancellationToken( const BitCancellationToken& ) = delete;
+
+        BitCancellationToken( BitCancellationToken&& ) = delete;
+
+        BitCancellationToken& operator=( const BitCancellationToken& ) = delete;
+
+        BitCancellationToken& operator=( BitCancellationToken&& ) = delete;
+
+        ~BitCancellationToken() = default;
+
+        /**
+         * @brief Cancels the operations using the token.
+         */
+        void cancel() noexcept;
+
+        /**
+         * @brief Sets the time point after which the token is cancelled.
+         *
+         * @param deadline the deadline of the operations using the token.
+         */
+        void setDeadline( clock::time_point deadline ) noexcept;
+
+        /**
+         * @return the deadline of the token (clock::time_point::max() if it has no deadline).
+         */
+        BIT7Z_NODISCARD clock::time_point deadline() const noexcept;
+
+        /**
+         * @return true if the token was cancelled, or its deadline has passed.
+         */
+        BIT7Z_NODISCARD bool isCancelled() const noexcept;
+
+    private:
+        std::atomic< bool > mCancelled;
+        std::atomic< clock::rep > mDeadline; // The ticks of the deadline since the clock's epoch.
+};
+
+}  // namespace bit7z
+
+#endif // BITCANCELLATIONTOKEN_HPP
@@ -10,6 +10,7 @@
 #ifndef BITEXCEPTION_HPP
 #define BITEXCEPTION_HPP
 
+#include <cstdint>
 #include <vector>
 #include <system_error>
 
@@ -21,6 +22,7 @@ namespace bit7z {
 
 using std::system_error;
 using FailedFiles = std::vector< std::pair< tstring, std::error_code > >;
+using FailedItems = std::vector< std::pair< uint32_t, std::error_code > >; // The indices of the items in the archive.
 
 std::error_code make_hresult_code( HRESULT res ) noexcept;
 
@@ -0,0 +1,207 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef BITEXTRACTIONCACHE_HPP
+#define BITEXTRACTIONCACHE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "bitdefines.hpp"
+#include "bittypes.hpp"
+
+namespace bit7z {
+
+/**
+ * @brief The BitExtractionCache class is a local content-addressed store of extracted files, keyed by their CRC-32,
+ *        size, and SHA-256, which lets repeated extractions of the same files (e.g., of the same archive into many
+ *        directories) restore them without decoding them again (see BitAbstractArchiveHandler::setExtractionCache).
+ *
+ * The cached files are restored as reflinks (copy-on-write clones) where the filesystem supports them (e.g., Btrfs
+ * or XFS on Linux), as hard links if enabled, or else as copies. The files are inserted atomically, so the same store
+ * can be shared by concurrent extractions, even of different processes.
+ *
+ * The archives do not store any hash stronger than the CRC of the items, so the SHA-256 of the items is supplied
+ * by the caller, e.g., through the hash manifest of the archive (see BitAbstractArchiveHandler::setHashManifest);
+ * a file is inserted only if it matches the SHA-256 of its key. The SHA-256 of each cached file is also recorded
+ * when inserting it, so that the cached files can be verified before being restored (see setHashVerification).
+ *
+ * Two different files with the same CRC and size would share the same entry of the cache if keyed only by them
+ * (detecting it would require decoding the items), so such keys are refused unless enabled (see setCrcOnlyKeys).
+ *
+ * @note Only the items whose CRC is stored in the archive (e.g., in 7z and Zip archives) can be cached.
+ */
+class BitExtractionCache final {
+    public:
+        /**
+         * @brief Constructs a cache backed by the given directory, creating it if it does not exist.
+         *
+         * @param store_dir the directory where the cached files are stored.
+         */
+        explicit BitExtractionCache( const tstring& store_dir );
+
+        BitExtractionCache( const BitExtractionCache& ) = delete;
+
+        BitExtractionCache( BitExtractionCache&& ) = delete;
+
+        BitExtractionCache& operator=( const BitExtractionCache& ) = delete;
+
+        BitExtractionCache& operator=( BitExtractionCache&& ) = delete;
+
+        ~BitExtractionCache() = default;
+
+        /**
+         * @return the directory where the cached files are stored.
+         */
+        BIT7Z_NODISCARD const tstring& storeDirectory() const noexcept;
+
+        /**
+         * @return whether the cached files can be restored as hard links.
+         */
+        BIT7Z_NODISCARD bool hardLinks() const noexcept;
+
+        /**
+         * @brief Sets whether the cached files can be restored as hard links, when reflinks are not supported.
+         *
+         * @note Hard links share the same file with the cache, so the restored files must not be modified.
+         *       For the same reason, the files restored as hard links keep the last write time and the attributes
+         *       of the cached files, rather than the ones of the extracted items.
+         *
+         * @param enabled whether hard links are enabled (false by default).
+         */
+        void setHardLinks( bool enabled ) noexcept;
+
+        /**
+         * @return whether the cached files are verified before being restored.
+         */
+        BIT7Z_NODISCARD bool hashVerification() const noexcept;
+
+        /**
+         * @brief Sets whether the cached files are verified against the SHA-256 recorded when inserting them,
+         *        before being restored.
+         *
+         * The cached files failing the verification (e.g., modified through a hard link) are removed from the cache,
+         * and they count as misses, so the items are decoded and inserted again.
+         *
+         * @note The verification reads the whole cached file for each restore.
+         *
+         * @param enabled whether the verification is enabled (false by default).
+         */
+        void setHashVerification( bool enabled ) noexcept;
+
+        /**
+         * @return whether the files can be keyed only by their CRC and size, i.e., without their SHA-256.
+         */
+        BIT7Z_NODISCARD bool crcOnlyKeys() const noexcept;
+
+        /**
+         * @brief Sets whether the files can be keyed only by their CRC and size, i.e., without their SHA-256.
+         *
+         * When disabled, the keys without a SHA-256 are refused: the cache does not contain them,
+         * and no file is restored or inserted with them.
+         *
+         * @note Two different files with the same CRC and size would be restored one in place of the other.
+         *
+         * @param enabled whether the CRC-only keys are accepted (false by default).
+         */
+        void setCrcOnlyKeys( bool enabled ) noexcept;
+
+        /**
+         * @param crc  the CRC-32 of the file.
+         * @param size the size of the file.
+         *
+         * @return true if and only if the cache contains the file with the given CRC and size
+         *         (always false if the CRC-only keys are refused).
+         */
+        BIT7Z_NODISCARD bool contains( uint32_t crc, uint64_t size ) const;
+
+        /**
+         * @param crc    the CRC-32 of the file.
+         * @param size   the size of the file.
+         * @param sha256 the lowercase hexadecimal SHA-256 of the file (empty for a CRC-only key).
+         *
+         * @return true if and only if the cache contains the file with the given CRC, size, and SHA-256.
+         */
+        BIT7Z_NODISCARD bool contains( uint32_t crc, uint64_t size, const std::string& sha256 ) const;
+
+        /**
+         * @brief Restores the cached file with the given CRC and size to the given path.
+         *
+         * @param crc      the CRC-32 of the file.
+         * @param size     the size of the file.
+         * @param out_file the path of the file to be created (it must not exist).
+         *
+         * @return true if the file was restored, false if it is not in the cache (or it could not be restored,
+         *         or it failed the verification, or the CRC-only keys are refused).
+         */
+        bool restore( uint32_t crc, uint64_t size, const tstring& out_file ) const;
+
+        /**
+         * @brief Restores the cached file with the given CRC, size, and SHA-256 to the given path.
+         *
+         * @param crc      the CRC-32 of the file.
+         * @param size     the size of the file.
+         * @param sha256   the lowercase hexadecimal SHA-256 of the file (empty for a CRC-only key).
+         * @param out_file the path of the file to be created (it must not exist).
+         *
+         * @return true if the file was restored, false if it is not in the cache (or it could not be restored,
+         *         or it failed the verification, or the key was refused).
+         */
+        bool restore( uint32_t crc, uint64_t size, const std::string& sha256, const tstring& out_file ) const;
+
+        /**
+         * @brief Inserts a copy (or a reflink) of the given file into the cache, if it is not already there
+         *        (and if the CRC-only keys are accepted).
+         *
+         * @note Failing to insert a file is not an error, as the cache is only an optimization.
+         *
+         * @param crc  the CRC-32 of the file.
+         * @param size the size of the file.
+         * @param file the path of the file to be inserted.
+         */
+        void insert( uint32_t crc, uint64_t size, const tstring& file ) const;
+
+        /**
+         * @brief Inserts a copy (or a reflink) of the given file into the cache, if it is not already there,
+         *        and if its content matches the given SHA-256.
+         *
+         * @note Failing to insert a file is not an error, as the cache is only an optimization.
+         *
+         * @param crc    the CRC-32 of the file.
+         * @param size   the size of the file.
+         * @param sha256 the lowercase hexadecimal SHA-256 of the file (empty for a CRC-only key).
+         * @param file   the path of the file to be inserted.
+         */
+        void insert( uint32_t crc, uint64_t size, const std::string& sha256, const tstring& file ) const;
+
+        /**
+         * @return the number of files restored from the cache so far.
+         */
+        BIT7Z_NODISCARD uint64_t hits() const noexcept;
+
+        /**
+         * @return the number of files that were not in the cache when they had to be restored so far.
+         */
+        BIT7Z_NODISCARD uint64_t misses() const noexcept;
+
+    private:
+        const tstring mStoreDirectory;
+        std::atomic< bool > mHardLinks;
+        std::atomic< bool > mHashVerification;
+        std::atomic< bool > mCrcOnlyKeys;
+        mutable std::atomic< uint64_t > mHits;
+        mutable std::atomic< uint64_t > mMisses;
+
+        BIT7Z_NODISCARD bool acceptsKey( const std::string& sha256 ) const noexcept;
+};
+
+}  // namespace bit7z
+
+#endif // BITEXTRACTIONCACHE_HPP
@@ -11,6 +11,7 @@
 #define BITFORMAT_HPP
 
 #include <bitset>
+#include <system_error>
 
 #include <type_traits>
 
@@ -29,7 +30,8 @@ enum struct FormatFeatures : unsigned {
     CompressionLevel = 1 << 2, ///< The format is able to use different compression levels (2^2 = 0000100)
     Encryption = 1 << 3,       ///< The format supports archive encryption                 (2^3 = 0001000)
     HeaderEncryption = 1 << 4, ///< The format can encrypt the file names                  (2^4 = 0010000)
-    MultipleMethods = 1 << 5   ///< The format can use different compression methods       (2^6 = 0100000)
+    MultipleMethods = 1 << 5,  ///< The format can use different compression methods       (2^5 = 0100000)
+    AntiItems = 1 << 6         ///< The format can store anti-items (deletion markers)      (2^6 = 1000000)
 };
 
 template< typename E >
@@ -231,6 +233,19 @@ extern const BitInOutFormat Zip,        ///< ZIP Archive Format
 
 
 #ifdef BIT7Z_AUTO_FORMAT
+/**
+ * @brief Detects the format of the given archive file from its signature or, if the signature is not known,
+ *        from its extension, without throwing exceptions.
+ *
+ * @note Available only when compiling bit7z using the `BIT7Z_AUTO_FORMAT` option.
+ *
+ * @param in_file the path to the archive file.
+ * @param error   the error code set if the format could not be detected (or the file could not be read).
+ *
+ * @return the detected format, or BitFormat::Auto if the format could not be detected.
+ */
+const BitInFormat& detectFormat( const tstring& in_file, std::error_code& error ) noexcept;
+
 #define BIT7Z_DEFAULT_FORMAT = BitFormat::Auto
 #else
 #define BIT7Z_DEFAULT_FORMAT
@@ -0,0 +1,67 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef BITHASHMANIFEST_HPP
+#define BITHASHMANIFEST_HPP
+
+#include <map>
+#include <string>
+
+#include "bitdefines.hpp"
+#include "bittypes.hpp"
+
+namespace bit7z {
+
+/**
+ * @brief The BitHashManifest struct records the SHA-256 of the items of an archive (e.g., in a file shipped
+ *        alongside the archive), so that the extraction cache can key the items by a strong hash rather than
+ *        only by their CRC-32 (see BitAbstractArchiveHandler::setHashManifest).
+ */
+struct BitHashManifest {
+    /**
+     * The paths of the items within the archive, mapped to the lowercase hexadecimal SHA-256 of their content.
+     */
+    std::map< tstring, std::string > items;
+
+    /**
+     * @brief Records the SHA-256 of the given file (e.g., one of the files being compressed) as the one of the item
+     *        with the given path.
+     *
+     * @param item_path the path of the item within the archive.
+     * @param file      the path of the file whose content is the one of the item.
+     */
+    void addFile( const tstring& item_path, const tstring& file );
+
+    /**
+     * @brief Writes the manifest to the given file (UTF-8 text, one line per item).
+     *
+     * @param manifest_file  the path of the manifest file to be written.
+     */
+    void save( const tstring& manifest_file ) const;
+
+    /**
+     * @brief Reads a manifest previously written using the save method.
+     *
+     * @param manifest_file  the path of the manifest file to be read.
+     *
+     * @return the manifest read from the file.
+     */
+    BIT7Z_NODISCARD static BitHashManifest load( const tstring& manifest_file );
+
+    /**
+     * @param item_path  the path of the item within the archive.
+     *
+     * @return the SHA-256 of the given item, or an empty string if the manifest does not contain it.
+     */
+    BIT7Z_NODISCARD std::string hashOf( const tstring& item_path ) const;
+};
+
+}  // namespace bit7z
+
+#endif // BITHASHMANIFEST_HPP
@@ -11,11 +11,16 @@
 
 #include <array>
 #include <map>
+#include <memory>
+#include <system_error>
 
 #include "bitabstractarchivehandler.hpp"
 #include "bitarchiveitemoffset.hpp"
+#include "bitexception.hpp"
 #include "bitformat.hpp"
 #include "bitfs.hpp"
+#include "bititemview.hpp"
+#include "bitmemoryestimate.hpp"
 
 struct IInStream;
 struct IInArchive;
@@ -25,6 +30,9 @@ namespace bit7z {
 
 using std::vector;
 
+class CArchiveInStream;
+class FileExtractCallback;
+
 /**
  * @brief The BitInputArchive class, given a handler object, allows reading/extracting the content of archives.
  */
@@ -80,6 +88,37 @@ class BitInputArchive {
 
         virtual ~BitInputArchive();
 
+        /**
+         * @brief Opens the input file archive without throwing exceptions (e.g., when many files might not be
+         *        valid archives).
+         *
+         * @param handler   the reference to the BitAbstractArchiveHandler object containing all the settings to
+         *                  be used for reading the input archive (it must outlive the returned archive).
+         * @param in_file   the path to the input archive file.
+         * @param error     the error code set if the archive could not be opened.
+         *
+         * @return the opened archive, or nullptr if it could not be opened.
+         */
+        BIT7Z_NODISCARD
+        static std::unique_ptr< BitInputArchive > tryOpen( const BitAbstractArchiveHandler& handler,
+                                                           const tstring& in_file,
+                                                           std::error_code& error ) noexcept;
+
+        /**
+         * @brief Opens the archive given in the input buffer without throwing exceptions.
+         *
+         * @param handler   the reference to the BitAbstractArchiveHandler object containing all the settings to
+         *                  be used for reading the input archive (it must outlive the returned archive).
+         * @param in_buffer the buffer containing the input archive.
+         * @param error     the error code set if the archive could not be opened.
+         *
+         * @return the opened archive, or nullptr if it could not be opened.
+         */
+        BIT7Z_NODISCARD
+        static std::unique_ptr< BitInputArchive > tryOpen( const BitAbstractArchiveHandler& handler,
+                                                           const std::vector< byte_t >& in_buffer,
+                                                           std::error_code& error ) noexcept;
+
         /**
          * @return the detected format of the file.
          */
@@ -124,6 +163,30 @@ class BitInputArchive {
          */
         BIT7Z_NODISCARD bool isItemEncrypted( uint32_t index ) const;
 
+        /**
+         * @brief Calls the visitor for each item in the archive (in index order), passing it only the requested
+         *        metadata of the item.
+         *
+         * Unlike iterating over BitArchiveItemInfo objects, the metadata is read into plain values, and the memory
+         * for the paths is reused between the items, so listing large archives does not allocate memory per item
+         * (except for the path strings returned by the 7-zip format handler itself).
+         *
+         * @param fields  the metadata of the items to be read.
+         * @param visitor the function called for each item (the view passed to it is valid only during the call).
+         */
+        void visitItems( BitItemField fields, const BitItemVisitor& visitor ) const;
+
+        /**
+         * @brief Estimates the memory needed for decoding the archive's items, from the compression methods
+         *        (and their dictionary sizes) reported by their Method property (e.g., "LZMA2:26 BCJ").
+         *
+         * @note The estimate refers to the most demanding item, as the items are decoded one at a time.
+         *       The memory budget of the estimate is the one of the handler's admission controller (if any).
+         *
+         * @return the estimated decoding memory usage, together with the largest dictionary size of the items.
+         */
+        BIT7Z_NODISCARD BitMemoryEstimate memoryEstimate() const;
+
         /**
          * @return the path to the archive (the empty string for buffer/stream archives).
          */
@@ -142,6 +205,24 @@ class BitInputArchive {
          */
         void extract( const tstring& out_dir, const std::vector< uint32_t >& indices = {} ) const;
 
+        /**
+         * @brief Extracts the specified items to the chosen directory, without throwing exceptions.
+         *
+         * Unlike the other extract methods, the items that cannot be decoded (e.g., because of CRC or data errors)
+         * do not stop the extraction: their errors are appended to the failed items, and the next items are extracted.
+         *
+         * @param out_dir       the output directory where the extracted files will be put.
+         * @param indices       the array of indices of the files in the archive that must be extracted
+         *                      (all the files if empty).
+         * @param failed_items  the list where the indices of the failed items, and their errors, are appended.
+         * @param error         the error code set if the extraction failed or, if only some items failed,
+         *                      the error of the first failed item.
+         */
+        void extract( const tstring& out_dir,
+                      const std::vector< uint32_t >& indices,
+                      FailedItems& failed_items,
+                      std::error_code& error ) const noexcept;
+
         /**
          * @brief Extracts a file to the output buffer.
          *
@@ -209,8 +290,27 @@ class BitInputArchive {
          */
         void test() const;
 
+        /**
+         * @brief Tests the archive without throwing exceptions, checking all the items even if some of them fail.
+         *
+         * @param failed_items  the list where the indices of the failed items, and their errors, are appended.
+         * @param error         the error code set if the test failed or, if only some items failed,
+         *                      the error of the first failed item.
+         */
+        void test( FailedItems& failed_items, std::error_code& error ) const noexcept;
+
     protected:
-        IInArchive* openArchiveStream( const fs::path& name, IInStream* in_stream );
+        /* Note: the following constructors do not throw if the archive cannot be opened, they set the error code
+         *       instead (and the object must not be used). */
+        BitInputArchive( const BitAbstractArchiveHandler& handler, const tstring& in_file, std::error_code& error );
+
+        BitInputArchive( const BitAbstractArchiveHandler& handler,
+                         const std::vector< byte_t >& in_buffer,
+                         std::error_code& error );
+
+        IInArchive* openArchiveStream( const fs::path& name, IInStream* archive_stream );
+
+        IInArchive* openArchiveStream( const fs::path& name, IInStream* archive_stream, std::error_code& error );
 
         HRESULT initUpdatableArchive( IOutArchive** newArc ) const;
 
@@ -224,9 +324,17 @@ class BitInputArchive {
 
     private:
         IInArchive* mInArchive;
+        CArchiveInStream* mArchiveStream;
         const BitInFormat* mDetectedFormat;
         const BitAbstractArchiveHandler& mArchiveHandler;
         tstring mArchivePath;
+        /* The decoding estimate of the items (without the memory budget), computed the first time it is needed:
+         * the items of an opened archive do not change, so it is reused by all the operations. */
+        mutable BitMemoryEstimate mDecodingEstimate;
+        mutable bool mHasDecodingEstimate = false;
+
+        // Extracts the items to the callback's directory (restoring the cached ones), returning the Extract result.
+        HRESULT extractToDirectory( FileExtractCallback* callback, const std::vector< uint32_t >& indices ) const;
 
     public:
         /**
@@ -24,6 +24,7 @@ using std::unique_ptr;
 
 namespace filesystem {
 class FSItem;
+class FSItemTable;
 } // namespace filesystem
 
 using filesystem::FSItem;
@@ -43,6 +44,8 @@ struct IndexingOptions {
 /**
  * @brief The BitItemsVector class represents a vector of generic input items, i.e., items that can come
  * from the filesystem, from memory buffers, or from standard streams.
+ *
+ * @note The data of the items found while indexing directories is stored in a compact table.
  */
 class BitItemsVector final {
     public:
@@ -155,9 +158,12 @@ class BitItemsVector final {
         ~BitItemsVector();
 
     private:
-        GenericInputItemVector mItems;
+        std::shared_ptr< filesystem::FSItemTable > mTable; // The data of the items found while indexing directories.
+        GenericInputItemVector mItems; // Note: the items found while indexing directories are views of mTable.
 
         void indexItem( const FSItem& item, IndexingOptions options );
+
+        void indexDirectoryContent( const FSItem& dir_item, const tstring& filter, IndexingOptions options );
 };
 
 }  // namespace bit7z
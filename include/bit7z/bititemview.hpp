@@ -0,0 +1,87 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef BITITEMVIEW_HPP
+#define BITITEMVIEW_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "bitdefines.hpp"
+#include "bitpropvariant.hpp"
+#include "bittypes.hpp"
+
+#if BIT7Z_CPP_STANDARD >= 17
+#include <string_view>
+#endif
+
+namespace bit7z {
+
+/**
+ * @brief The BitItemField enum specifies the metadata of the archive's items to be read by
+ *        BitInputArchive::visitItems (the fields not requested are left to their default values).
+ */
+enum struct BitItemField : unsigned {
+    Path = 1 << 0,          ///< The path of the item within the archive
+    IsDir = 1 << 1,         ///< Whether the item is a folder
+    Size = 1 << 2,          ///< The uncompressed size of the item
+    PackSize = 1 << 3,      ///< The compressed size of the item
+    Crc = 1 << 4,           ///< The CRC-32 of the item
+    Attributes = 1 << 5,    ///< The attributes of the item
+    LastWriteTime = 1 << 6, ///< The last write time of the item
+    IsEncrypted = 1 << 7,   ///< Whether the item is encrypted
+    All = ( 1 << 8 ) - 1    ///< All the above fields
+};
+
+inline constexpr BitItemField operator|( BitItemField lhs, BitItemField rhs ) noexcept {
+    return static_cast< BitItemField >( static_cast< unsigned >( lhs ) | static_cast< unsigned >( rhs ) );
+}
+
+inline constexpr auto operator&( BitItemField lhs, BitItemField rhs ) noexcept -> unsigned {
+    return static_cast< unsigned >( lhs ) & static_cast< unsigned >( rhs );
+}
+
+/**
+ * @brief The BitItemView struct contains the metadata of an archived item visited by BitInputArchive::visitItems.
+ *
+ * @note The view, and the path it points to, are valid only during the visit of the item, as their memory
+ *       is reused for the next items.
+ */
+struct BitItemView {
+    uint32_t index = 0; ///< The index of the item in the archive.
+    const tchar* path = nullptr; ///< The null-terminated path of the item (nullptr if not requested or unknown).
+    std::size_t path_size = 0; ///< The length of the path of the item.
+    bool is_dir = false; ///< Whether the item is a folder.
+    uint64_t size = 0; ///< The uncompressed size of the item (0 if unknown).
+    uint64_t pack_size = 0; ///< The compressed size of the item (0 if unknown).
+    bool has_crc = false; ///< Whether the CRC-32 of the item is known.
+    uint32_t crc = 0; ///< The CRC-32 of the item (if known).
+    uint32_t attributes = 0; ///< The attributes of the item (0 if unknown).
+    time_type last_write_time{}; ///< The last write time of the item (the epoch if unknown).
+    bool is_encrypted = false; ///< Whether the item is encrypted.
+
+#if BIT7Z_CPP_STANDARD >= 17
+    /**
+     * @return a view of the path of the item.
+     */
+    BIT7Z_NODISCARD std::basic_string_view< tchar > pathView() const noexcept {
+        return path != nullptr ? std::basic_string_view< tchar >{ path, path_size } : std::basic_string_view< tchar >{};
+    }
+#endif
+};
+
+/**
+ * @brief A function called for each item visited by BitInputArchive::visitItems.
+ */
+using BitItemVisitor = std::function< void( const BitItemView& ) >;
+
+}  // namespace bit7z
+
+#endif // BITITEMVIEW_HPP
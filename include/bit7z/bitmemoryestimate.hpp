@@ -0,0 +1,32 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef BITMEMORYESTIMATE_HPP
+#define BITMEMORYESTIMATE_HPP
+
+#include <cstdint>
+
+namespace bit7z {
+
+/**
+ * @brief The BitMemoryEstimate struct contains the estimated memory usage of an operation,
+ *        together with the parameters planned for fitting it into the memory budget.
+ */
+struct BitMemoryEstimate {
+    uint64_t memory_usage = 0; ///< The estimated memory usage (in bytes).
+    uint64_t memory_budget = 0; ///< The memory budget (in bytes) of the operation (0 means no budget).
+    uint32_t dictionary_size = 0; ///< The dictionary size used (0 if the method does not use a dictionary).
+    uint32_t threads_count = 0; ///< The number of threads used.
+    bool reduced = false; ///< Whether the dictionary size or the number of threads were reduced to fit the budget.
+    bool fits = true; ///< Whether the estimated memory usage fits the memory budget.
+};
+
+}  // namespace bit7z
+
+#endif // BITMEMORYESTIMATE_HPP
@@ -0,0 +1,132 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef BITMETRICS_HPP
+#define BITMETRICS_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include "bitdefines.hpp"
+
+namespace bit7z {
+
+/**
+ * @brief The operations of an archive handler whose metrics can be collected.
+ */
+enum struct BitOperation {
+    Extract, ///< Extraction of the items of an archive.
+    Test, ///< Test of the items of an archive.
+    Compress ///< Creation or update of an archive.
+};
+
+/**
+ * @brief The BitStreamMetrics struct contains the counters of the I/O calls made on one or more streams.
+ */
+struct BitStreamMetrics {
+    uint64_t bytes_read = 0; ///< The number of bytes read from the stream(s).
+    uint64_t bytes_written = 0; ///< The number of bytes written to the stream(s).
+    uint64_t read_calls = 0; ///< The number of Read calls.
+    uint64_t write_calls = 0; ///< The number of Write calls.
+    uint64_t seek_calls = 0; ///< The number of Seek calls.
+    uint64_t io_time_ns = 0; ///< The time spent inside the Read, Write and Seek calls (in nanoseconds).
+};
+
+/**
+ * @brief The BitLatencyHistogram class is a fixed-size histogram of latencies, with exponential buckets.
+ *
+ * The upper bound of the i-th bucket is 4^i microseconds, while the last bucket has no upper bound.
+ */
+class BitLatencyHistogram {
+    public:
+        static constexpr std::size_t kBucketsCount = 16;
+
+        /**
+         * @brief Records a latency into the histogram.
+         *
+         * @param latency_ns  the latency to be recorded (in nanoseconds).
+         */
+        void record( uint64_t latency_ns ) noexcept;
+
+        /**
+         * @param bucket  the index of the bucket.
+         *
+         * @return the upper bound (in nanoseconds) of the given bucket, or UINT64_MAX for the last bucket.
+         */
+        BIT7Z_NODISCARD static uint64_t bucketUpperBound( std::size_t bucket ) noexcept;
+
+        /**
+         * @param bucket  the index of the bucket.
+         *
+         * @return the number of latencies recorded in the given bucket (not cumulative).
+         */
+        BIT7Z_NODISCARD uint64_t bucketCount( std::size_t bucket ) const noexcept;
+
+        /**
+         * @return the total number of recorded latencies.
+         */
+        BIT7Z_NODISCARD uint64_t count() const noexcept;
+
+        /**
+         * @return the sum of the recorded latencies (in nanoseconds).
+         */
+        BIT7Z_NODISCARD uint64_t sum() const noexcept;
+
+        /**
+         * @return the maximum recorded latency (in nanoseconds).
+         */
+        BIT7Z_NODISCARD uint64_t max() const noexcept;
+
+    private:
+        std::array< uint64_t, kBucketsCount > mBuckets{};
+        uint64_t mCount = 0;
+        uint64_t mSum = 0;
+        uint64_t mMax = 0;
+};
+
+/**
+ * @brief The BitOperationMetrics struct contains the metrics collected during a single operation of
+ *        an archive handler (e.g., an extraction).
+ */
+struct BitOperationMetrics {
+    BitOperation operation = BitOperation::Extract; ///< The operation the metrics refer to.
+    uint64_t total_time_ns = 0; ///< The wall-clock duration of the operation (in nanoseconds).
+    BitStreamMetrics archive_stream; ///< The I/O made on the archive stream.
+    BitStreamMetrics item_streams; ///< The I/O made on the streams of the items (aggregated).
+    uint64_t items_count = 0; ///< The number of items processed.
+    BitLatencyHistogram item_latency; ///< The latencies of the processed items.
+    uint64_t property_calls = 0; ///< The number of item properties requested during the operation.
+    uint64_t peak_buffer_memory = 0; ///< The peak memory allocated by bit7z for in-memory outputs (in bytes).
+    uint64_t stored_bytes = 0; ///< The input bytes stored without compression, as they were incompressible.
+
+    /**
+     * @return the total time spent in I/O on the archive and items streams (in nanoseconds).
+     */
+    BIT7Z_NODISCARD uint64_t ioTimeNs() const noexcept;
+
+    /**
+     * @return the time spent outside the I/O calls, i.e., mostly inside the codec (in nanoseconds).
+     */
+    BIT7Z_NODISCARD uint64_t codecTimeNs() const noexcept;
+};
+
+/**
+ * @brief Formats the given metrics using the Prometheus text exposition format.
+ *
+ * @param metrics  the metrics to be formatted.
+ * @param prefix   the prefix of the names of the exported metrics.
+ *
+ * @return the metrics in the Prometheus text format.
+ */
+std::string toPrometheus( const BitOperationMetrics& metrics, const std::string& prefix = "bit7z" );
+
+}  // namespace bit7z
+
+#endif // BITMETRICS_HPP
@@ -0,0 +1,66 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef BITNULLCODEC_HPP
+#define BITNULLCODEC_HPP
+
+#ifdef BIT7Z_NULL_CODEC
+
+#include <cstdint>
+
+#include "bitformat.hpp"
+#include "bittypes.hpp"
+#include "bitwindows.hpp"
+
+#ifndef _WIN32
+struct GUID;
+#endif
+
+namespace bit7z {
+
+/**
+ * @brief The "copy" archive format implemented in-process by the null codec.
+ *
+ * Items are stored as they are, without any compression, encryption, or checksum:
+ * this format exists only to measure the overhead of bit7z (callbacks, property marshalling, stream adapters)
+ * without the cost of a real codec, and it is not understood by the 7-zip shared libraries.
+ */
+extern const BitInOutFormat BitNullFormat;
+
+/**
+ * @brief The CreateObject function of the null codec, to be used in place of the one exported by 7-zip.
+ *
+ * @note It can create only the archive handler of the BitNullFormat; any other format is reported as unavailable.
+ *
+ * @param clsID        Pointer to the GUID of the archive format.
+ * @param interfaceID  Pointer to the GUID of the requested interface (IID_IInArchive or IID_IOutArchive).
+ * @param out          Pointer to the requested interface.
+ *
+ * @return S_OK if the object was created, an error code otherwise.
+ */
+HRESULT WINAPI nullCodecCreateObject( const GUID* clsID, const GUID* interfaceID, void** out );
+
+/**
+ * @brief Creates an archive of the BitNullFormat made of synthetic items.
+ *
+ * The content of the items is not stored in the resulting buffer, but it is generated on the fly
+ * when the items are extracted, so that archives of any size can be used without allocating them.
+ *
+ * @param items_count  the number of items in the archive.
+ * @param item_size    the size (in bytes) of each item in the archive.
+ *
+ * @return the buffer containing the archive.
+ */
+buffer_t makeNullArchive( uint32_t items_count, uint64_t item_size );
+
+}  // namespace bit7z
+
+#endif
+
+#endif // BITNULLCODEC_HPP
@@ -11,12 +11,15 @@
 #define BITOUTPUTARCHIVE_HPP
 
 #include <istream>
+#include <mutex>
 #include <set>
 
 #include "bitabstractarchivecreator.hpp"
+#include "bitarchivecatalog.hpp"
 #include "bititemsvector.hpp"
 #include "bitexception.hpp" //for FailedFiles
 #include "bitpropvariant.hpp"
+#include "bitshardmanifest.hpp"
 
 struct ISequentialInStream;
 
@@ -48,6 +51,8 @@ using DeletedItems = std::set< uint32_t >;
 enum class input_index : std::uint32_t {};
 
 class UpdateCallback;
+class ItemPrefetcher;
+enum struct Compressibility;
 
 /**
  * @brief The BitOutputArchive class, given a creator object, allows creating new archives.
@@ -176,6 +181,23 @@ class BitOutputArchive {
          */
         void addDirectory( const tstring& in_dir );
 
+        /**
+         * @brief Sets the baseline of a differential archive, i.e., the catalog of a previously created archive.
+         *
+         * When compressing, the added items that are unchanged with respect to the baseline (same type, size,
+         * and last write time, or same CRC if the creator checks the content of the synchronized items) are skipped,
+         * so that only the new and changed items are written to the output archive.
+         * Moreover, if the output format supports anti-items (FormatFeatures::AntiItems), the items of the baseline
+         * that are not among the added items are written as anti-items, i.e., as markers of their deletion.
+         * Extracting a differential archive to the filesystem deletes the files marked by its anti-items only when
+         * the extractor's overwrite mode is OverwriteMode::Overwrite.
+         *
+         * @note Differential archives cannot be compressed to shards.
+         *
+         * @param baseline the catalog of the baseline archive (see BitArchiveCatalog).
+         */
+        void setBaseline( const BitArchiveCatalog& baseline );
+
         /**
          * @brief Compresses all the items added to this object to the specified archive file path.
          *
@@ -200,11 +222,55 @@ class BitOutputArchive {
          */
         void compressTo( std::ostream& out_stream );
 
+        /**
+         * @brief Compresses all the items added to this object into (at most) the given number of shards,
+         *        i.e., independent archives that are created concurrently.
+         *
+         * The items are partitioned by size so that the shards have similar sizes. Each shard is written
+         * to the file `<out_prefix>.<NNN><ext>` (e.g., "backup.001.7z"), while the manifest mapping the items
+         * to the shards is written to the file `<out_prefix>.manifest`.
+         *
+         * @note The progress callbacks receive the aggregated progress of all the shards, while the metrics
+         *       callback is called once per shard, possibly concurrently.
+         *
+         * @note Sharding is supported only when creating new archives (i.e., not when updating an existing one).
+         *
+         * @param out_prefix    the path prefix of the shards and of the manifest files.
+         * @param shards_count  the maximum number of shards to be created (empty shards are not created).
+         *
+         * @return the manifest of the created shards.
+         */
+        BitShardManifest compressToShards( const tstring& out_prefix, uint32_t shards_count );
+
+        /**
+         * @brief Compresses all the items added to this object into shards whose total input size does not exceed
+         *        the given size, i.e., independent archives that are created concurrently.
+         *
+         * @note Items larger than the maximum shard size are compressed into a shard of their own.
+         *       For the rest, this method works as the compressToShards method.
+         *
+         * @param out_prefix      the path prefix of the shards and of the manifest files.
+         * @param max_shard_size  the maximum total size (in bytes) of the items of each shard.
+         *
+         * @return the manifest of the created shards.
+         */
+        BitShardManifest compressToShardsOfSize( const tstring& out_prefix, uint64_t max_shard_size );
+
         /**
          * @return the total number of items added to the output archive object.
          */
         uint32_t itemsCount() const;
 
+        /**
+         * @brief Estimates the memory that compressing the items added so far would use with the current settings.
+         *
+         * @note If the creator has a memory budget (see BitAbstractArchiveCreator::setMemoryBudget), the estimate
+         *       refers to the dictionary size and number of threads planned for fitting it.
+         *
+         * @return the estimated memory usage, together with the planned dictionary size and number of threads.
+         */
+        BIT7Z_NODISCARD BitMemoryEstimate memoryEstimate() const;
+
         /**
          * @return a constant reference to the BitAbstractArchiveHandler object containing the
          *         settings for writing the output archive.
@@ -233,6 +299,8 @@ class BitOutputArchive {
 
         uint32_t indexInArchive( uint32_t index ) const noexcept;
 
+        const GenericInputItem* outputNewItem( uint32_t index ) const;
+
         inline BitInputArchive* inputArchive() const {
             return mInputArchive.get();
         }
@@ -261,8 +329,20 @@ class BitOutputArchive {
             return mNewItemsVector.size() > 0;
         }
 
+        inline const BitItemsVector& newItems() const {
+            return mNewItemsVector;
+        }
+
+        // Whether the item of the input archive at the given index was explicitly edited (e.g., renamed) by the user.
+        virtual bool isEditedIndex( uint32_t index ) const noexcept;
+
+        // Whether the item at the given index of the output archive marks the deletion of a baseline item.
+        bool isAntiItem( uint32_t index ) const noexcept;
+
         friend class UpdateCallback;
 
+        friend class ItemPrefetcher;
+
     private:
         const BitAbstractArchiveCreator& mArchiveCreator;
 
@@ -272,7 +352,20 @@ class BitOutputArchive {
         BitItemsVector mNewItemsVector;
         DeletedItems mDeletedItems;
 
+        /* The baseline of a differential archive, and the paths of its items to be written as anti-items
+         * (with whether they are folders). The anti-items follow the new items, i.e., their input_index values
+         * are in the range [mInputArchiveItemsCount + mNewItemsVector.size(), ...). */
+        unique_ptr< BitArchiveCatalog > mBaseline;
+        std::vector< std::pair< tstring, bool > > mAntiItems;
+
+        /* The compressibility of each new item (in the order of mNewItemsVector), and the entropy threshold
+         * used to estimate it. The new items are only ever appended, so the ones added after the last estimate
+         * are sampled the next time it is needed, and the others keep their cached classification. */
+        mutable std::vector< Compressibility > mNewItemsCompressibility;
+        mutable double mCompressibilityEntropy{ -1.0 };
+
         mutable FailedFiles mFailedFiles;
+        mutable std::mutex mFailedFilesMutex; // Shards of an archive may fail concurrently.
 
         /* mInputIndices:
          *   Position i = index in range [0, itemsCount() - 1] used by UpdateCallback.
@@ -287,7 +380,10 @@ class BitOutputArchive {
          * This vector is either empty, or it has size equal to itemsCount() (thanks to updateInputIndices()). */
         std::vector< input_index > mInputIndices;
 
-        CMyComPtr< IOutArchive > initOutArchive() const;
+        // The threads_limit (if not 0) is the number of threads granted to each archive by the thread governor.
+        CMyComPtr< IOutArchive > initOutArchive( bool store_only = false,
+                                                 std::size_t concurrent_archives = 1,
+                                                 uint32_t threads_limit = 0 ) const;
 
         CMyComPtr< IOutStream > initOutFileStream( const fs::path& out_archive, bool updating_archive ) const;
 
@@ -297,15 +393,64 @@ class BitOutputArchive {
         BitOutputArchive( const BitAbstractArchiveCreator& creator, const fs::path& in_arc );
 #endif
 
-        void compressToFile( const fs::path& out_file, UpdateCallback* update_callback );
+        void compressToFile( const fs::path& out_file, UpdateCallback* update_callback, bool store_only );
 
         void compressOut( IOutArchive* out_arc,
                           IOutStream* out_stream,
-                          UpdateCallback* update_callback );
+                          UpdateCallback* update_callback,
+                          bool in_memory_output = false );
+
+        HRESULT updateItems( IOutArchive* out_arc,
+                             IOutStream* out_stream,
+                             UpdateCallback* update_callback,
+                             uint32_t items_count,
+                             bool in_memory_output ) const;
+
+        void checkUpdateResult( HRESULT result );
+
+        // The shards from first_stored_shard onwards are stored without compression.
+        BitShardManifest compressShards( const tstring& out_prefix,
+                                         std::vector< std::vector< uint32_t > > shards,
+                                         std::size_t first_stored_shard = static_cast< std::size_t >( -1 ) );
 
-        void setArchiveProperties( IOutArchive* out_archive ) const;
+        void setArchiveProperties( IOutArchive* out_archive,
+                                   bool store_only,
+                                   const BitMemoryEstimate& memory_plan,
+                                   uint32_t threads_limit ) const;
+
+        /* The size of the largest input compressed by a single encoder, i.e., of the largest new file,
+         * or of the largest solid block in solid archives. */
+        uint64_t compressionInputSize() const;
+
+        // The memory plan of each of the given number of archives compressed at the same time.
+        BitMemoryEstimate memoryPlan( bool store_only,
+                                      std::size_t concurrent_archives = 1,
+                                      uint32_t threads_limit = 0 ) const;
 
         void updateInputIndices();
+
+        void applySolidOrder();
+
+        void splitIncompressibleItems( std::vector< uint32_t >& compressible_items,
+                                       std::vector< uint32_t >& incompressible_items ) const;
+
+        const std::vector< Compressibility >& newItemsCompressibility() const;
+
+        // Whether the new items are all incompressible, so that the output archive can be stored without compression.
+        bool storesNewItems() const;
+
+        void markUpdatedItems();
+
+        void markSyncedItems();
+
+        void markBaselineItems();
+
+        BitCatalogItem inputCatalogItem( uint32_t old_index ) const;
+
+        bool isUnchangedItem( const GenericInputItem& new_item, const BitCatalogItem& old_item ) const;
+
+        // The index in mAntiItems of the anti-item with the given input_index (or mAntiItems.size() if none).
+        std::size_t antiItemIndex( input_index index ) const noexcept;
 };
 
 }  // namespace bit7z
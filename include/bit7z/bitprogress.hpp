@@ -0,0 +1,106 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef BITPROGRESS_HPP
+#define BITPROGRESS_HPP
+
+#include <atomic>
+#include <cstdint>
+
+#include "bitdefines.hpp"
+
+namespace bit7z {
+
+/**
+ * @brief The BitProgress class holds the progress of the ongoing operation of an archive handler, using atomic
+ *        counters that can be polled lock-free by any thread (e.g., a UI thread) while the operation runs.
+ *
+ * @note The counters are updated with relaxed atomic operations: each counter is always consistent, but
+ *       different counters might be read at slightly different moments of the operation.
+ */
+class BitProgress final {
+    public:
+        /**
+         * @brief The value of currentItem() when no item is being processed.
+         */
+        static constexpr uint32_t kNoItem = static_cast< uint32_t >( -1 );
+
+        BitProgress() noexcept;
+
+        BitProgress( const BitProgress& ) = delete;
+
+        BitProgress( BitProgress&& ) = delete;
+
+        BitProgress& operator=( const BitProgress& ) = delete;
+
+        BitProgress& operator=( BitProgress&& ) = delete;
+
+        ~BitProgress() = default;
+
+        /**
+         * @return the total size of the ongoing operation.
+         */
+        BIT7Z_NODISCARD uint64_t total() const noexcept;
+
+        /**
+         * @return the currently processed size of the ongoing operation.
+         */
+        BIT7Z_NODISCARD uint64_t completed() const noexcept;
+
+        /**
+         * @return the current processed input size of the ongoing operation.
+         */
+        BIT7Z_NODISCARD uint64_t inputBytes() const noexcept;
+
+        /**
+         * @return the current output size of the ongoing operation.
+         */
+        BIT7Z_NODISCARD uint64_t outputBytes() const noexcept;
+
+        /**
+         * @return the index of the item currently being processed, or kNoItem.
+         */
+        BIT7Z_NODISCARD uint32_t currentItem() const noexcept;
+
+        /**
+         * @brief Resets all the counters, e.g., when a new operation starts.
+         */
+        void reset() noexcept;
+
+        /**
+         * @brief Sets the total size of the ongoing operation.
+         */
+        void setTotal( uint64_t total ) noexcept;
+
+        /**
+         * @brief Sets the currently processed size of the ongoing operation.
+         */
+        void setCompleted( uint64_t completed ) noexcept;
+
+        /**
+         * @brief Sets the current processed input size, and the current output size of the ongoing operation.
+         */
+        void setRatioInfo( uint64_t input_bytes, uint64_t output_bytes ) noexcept;
+
+        /**
+         * @brief Sets the index of the item currently being processed.
+         */
+        void setCurrentItem( uint32_t index ) noexcept;
+
+    private:
+        std::atomic< uint64_t > mTotal;
+        std::atomic< uint64_t > mCompleted;
+        std::atomic< uint64_t > mInputBytes;
+        std::atomic< uint64_t > mOutputBytes;
+        std::atomic< uint32_t > mCurrentItem;
+};
+
+}  // namespace bit7z
+
+#endif // BITPROGRESS_HPP
@@ -0,0 +1,117 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef BITSHARDEDARCHIVEREADER_HPP
+#define BITSHARDEDARCHIVEREADER_HPP
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "bitarchivereader.hpp"
+#include "bitshardmanifest.hpp"
+
+namespace bit7z {
+
+/**
+ * @brief The BitShardedArchiveReader class allows reading a set of shards (created using
+ *        BitOutputArchive::compressToShards) as a single logical archive.
+ */
+class BitShardedArchiveReader final {
+    public:
+        /**
+         * @brief Constructs a BitShardedArchiveReader object, opening all the shards listed in the given manifest.
+         *
+         * @param lib            the 7z library used.
+         * @param manifest_file  the path of the manifest of the shards.
+         * @param format         the format of the shards.
+         * @param password       the password needed for opening the shards.
+         */
+        BitShardedArchiveReader( const Bit7zLibrary& lib,
+                                 const tstring& manifest_file,
+                                 const BitInFormat& format BIT7Z_DEFAULT_FORMAT,
+                                 const tstring& password = {} );
+
+        /**
+         * @return the manifest of the shards.
+         */
+        BIT7Z_NODISCARD const BitShardManifest& manifest() const noexcept;
+
+        /**
+         * @return the number of shards.
+         */
+        BIT7Z_NODISCARD uint32_t shardsCount() const noexcept;
+
+        /**
+         * @param index  the index of the shard.
+         *
+         * @return the reader of the shard with the given index.
+         */
+        BIT7Z_NODISCARD const BitArchiveReader& shard( uint32_t index ) const;
+
+        /**
+         * @return the total number of items in the shards.
+         */
+        BIT7Z_NODISCARD uint32_t itemsCount() const;
+
+        /**
+         * @return the total uncompressed size of the items in the shards.
+         */
+        BIT7Z_NODISCARD uint64_t size() const;
+
+        /**
+         * @return the total compressed size of the items in the shards.
+         */
+        BIT7Z_NODISCARD uint64_t packSize() const;
+
+        /**
+         * @param item_path  the path of the item within the logical archive.
+         *
+         * @return true if and only if one of the shards contains the given item.
+         */
+        BIT7Z_NODISCARD bool contains( const tstring& item_path ) const;
+
+        /**
+         * @brief Extracts the content of all the shards to the chosen directory.
+         *
+         * @param out_dir  the output directory where the extracted files will be put.
+         */
+        void extract( const tstring& out_dir ) const;
+
+        /**
+         * @brief Extracts the given item to the output buffer.
+         *
+         * @param item_path   the path of the item within the logical archive.
+         * @param out_buffer  the output buffer where the content of the item will be put.
+         */
+        void extract( const tstring& item_path, std::vector< byte_t >& out_buffer ) const;
+
+        /**
+         * @brief Extracts the content of all the shards to a map of memory buffers, where the keys are the paths
+         *        of the items (in the logical archive), and the values are their decompressed contents.
+         *
+         * @param out_map  the output map.
+         */
+        void extract( std::map< tstring, std::vector< byte_t > >& out_map ) const;
+
+        /**
+         * @brief Tests all the shards without extracting their content.
+         *
+         * It throws an exception if one of the shards is corrupted.
+         */
+        void test() const;
+
+    private:
+        BitShardManifest mManifest;
+        std::vector< std::unique_ptr< BitArchiveReader > > mShards;
+};
+
+}  // namespace bit7z
+
+#endif // BITSHARDEDARCHIVEREADER_HPP
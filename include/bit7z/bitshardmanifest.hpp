@@ -0,0 +1,58 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef BITSHARDMANIFEST_HPP
+#define BITSHARDMANIFEST_HPP
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "bitdefines.hpp"
+#include "bittypes.hpp"
+
+namespace bit7z {
+
+/**
+ * @brief The BitShardManifest struct describes a set of shards, i.e., independent archives that together contain
+ *        the items of a single logical archive (see BitOutputArchive::compressToShards).
+ */
+struct BitShardManifest {
+    std::vector< tstring > shards; ///< The file names of the shards, relative to the folder of the manifest file.
+    std::map< tstring, uint32_t > items; ///< The paths of the items, mapped to the index of the containing shard.
+
+    /**
+     * @brief Writes the manifest to the given file (UTF-8 text, one line per shard and per item).
+     *
+     * @param manifest_file  the path of the manifest file to be written.
+     */
+    void save( const tstring& manifest_file ) const;
+
+    /**
+     * @brief Reads a manifest previously written using the save method.
+     *
+     * @param manifest_file  the path of the manifest file to be read.
+     *
+     * @return the manifest read from the file.
+     */
+    BIT7Z_NODISCARD static BitShardManifest load( const tstring& manifest_file );
+
+    /**
+     * @brief Searches the shard containing the given item.
+     *
+     * @param item_path  the path of the item within the logical archive.
+     *
+     * @return the index of the shard containing the item, or shards.size() if no shard contains it.
+     */
+    BIT7Z_NODISCARD uint32_t shardOf( const tstring& item_path ) const;
+};
+
+}  // namespace bit7z
+
+#endif // BITSHARDMANIFEST_HPP
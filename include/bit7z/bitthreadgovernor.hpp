@@ -0,0 +1,103 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef BITTHREADGOVERNOR_HPP
+#define BITTHREADGOVERNOR_HPP
+
+#include <cstdint>
+#include <mutex>
+
+#include "bitdefines.hpp"
+
+namespace bit7z {
+
+/**
+ * @brief The BitThreadGovernor class shares a pool of thread tokens among the concurrent jobs
+ *        (compressions, extractions, and tests) of the handlers using it, so that they do not start
+ *        more 7-zip worker threads than the available cores.
+ *
+ * When a job starts, it is granted the threads it requested, limited by its fair share of the pool
+ * (i.e., the tokens divided by the number of running jobs, including the new one) and by the tokens
+ * not used by the other jobs. The grant is used as the "mt" property of the job, and the tokens go back
+ * to the pool when the job ends.
+ *
+ * A job starting when no other job is running gets the whole pool (or the threads it requested, if fewer):
+ * 7-zip cannot change the threads of a running job, so the jobs are re-balanced only when they start,
+ * i.e., a job starting while the pool is in use gets fewer threads, while jobs starting after other jobs ended
+ * get the released tokens.
+ *
+ * @note A job is always granted at least one thread, so it never waits for the other jobs to end: a job starting
+ *       when the pool is exhausted gets a single thread in excess of the pool. Hence, the threads in use
+ *       (see tokensInUse) exceed the tokens by at most one thread for each job started with the pool exhausted,
+ *       and they are back within the pool as soon as enough jobs end.
+ */
+class BitThreadGovernor final {
+    public:
+        /**
+         * @brief Constructs a governor with the given number of thread tokens.
+         *
+         * @param tokens the number of threads shared by the jobs (0 means the number of CPU cores).
+         */
+        explicit BitThreadGovernor( uint32_t tokens = 0 );
+
+        BitThreadGovernor( const BitThreadGovernor& ) = delete;
+
+        BitThreadGovernor( BitThreadGovernor&& ) = delete;
+
+        BitThreadGovernor& operator=( const BitThreadGovernor& ) = delete;
+
+        BitThreadGovernor& operator=( BitThreadGovernor&& ) = delete;
+
+        ~BitThreadGovernor() = default;
+
+        /**
+         * @return the number of threads shared by the jobs.
+         */
+        BIT7Z_NODISCARD uint32_t tokens() const noexcept;
+
+        /**
+         * @return the number of threads currently granted to the running jobs
+         *         (more than the tokens, if some jobs started with the pool exhausted).
+         */
+        BIT7Z_NODISCARD uint32_t tokensInUse() const;
+
+        /**
+         * @return the number of jobs currently running.
+         */
+        BIT7Z_NODISCARD uint32_t runningJobs() const;
+
+        /**
+         * @brief Starts a job, granting it some threads of the pool.
+         *
+         * @note Every started job must be ended by calling release with the granted threads.
+         *
+         * @param requested_threads the threads requested by the job (0 means as many as possible).
+         *
+         * @return the threads granted to the job (at least one).
+         */
+        uint32_t acquire( uint32_t requested_threads );
+
+        /**
+         * @brief Ends a job, giving back its threads to the pool.
+         *
+         * @param granted_threads the threads granted to the job.
+         */
+        void release( uint32_t granted_threads ) noexcept;
+
+    private:
+        const uint32_t mTokens;
+
+        mutable std::mutex mMutex;
+        uint32_t mTokensInUse;
+        uint32_t mRunningJobs;
+};
+
+}  // namespace bit7z
+
+#endif // BITTHREADGOVERNOR_HPP
@@ -0,0 +1,113 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef BITTRACERECORDER_HPP
+#define BITTRACERECORDER_HPP
+
+#ifdef BIT7Z_TRACING
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "bitdefines.hpp"
+
+namespace bit7z {
+
+/**
+ * @brief The BitTraceRecorder class records the events of the operations of one or more archive handlers
+ *        into a fixed-size ring buffer, which can be dumped in the Chrome trace-event JSON format
+ *        (e.g., for being inspected using chrome://tracing or Perfetto).
+ *
+ * Recording an event never allocates: once the buffer is full, the oldest events are overwritten.
+ *
+ * @note Events can be recorded concurrently from different threads, but the recorder must not be dumped
+ *       or cleared while an operation is in progress.
+ */
+class BitTraceRecorder final {
+    public:
+        /**
+         * @brief Constructs a recorder retaining at most the given number of events.
+         *
+         * @param capacity  the capacity of the ring buffer.
+         */
+        explicit BitTraceRecorder( std::size_t capacity = 4096 );
+
+        /**
+         * @brief Records the start of a span.
+         *
+         * @param name  the name of the span (it must be a string with static storage duration).
+         * @param arg   an argument of the span (e.g., the index of an item).
+         */
+        void begin( const char* name, uint64_t arg = 0 ) noexcept;
+
+        /**
+         * @brief Records the end of a span.
+         *
+         * @param name  the name of the span (it must be a string with static storage duration).
+         * @param arg   an argument of the span (e.g., the result of the operation).
+         */
+        void end( const char* name, uint64_t arg = 0 ) noexcept;
+
+        /**
+         * @brief Records an instant event.
+         *
+         * @param name  the name of the event (it must be a string with static storage duration).
+         * @param arg   an argument of the event.
+         */
+        void instant( const char* name, uint64_t arg = 0 ) noexcept;
+
+        /**
+         * @return the number of events currently retained by the recorder.
+         */
+        BIT7Z_NODISCARD std::size_t size() const noexcept;
+
+        /**
+         * @return the maximum number of events retained by the recorder.
+         */
+        BIT7Z_NODISCARD std::size_t capacity() const noexcept;
+
+        /**
+         * @return the number of events that have been overwritten since the last clear.
+         */
+        BIT7Z_NODISCARD uint64_t droppedEvents() const noexcept;
+
+        /**
+         * @brief Removes all the recorded events.
+         */
+        void clear() noexcept;
+
+        /**
+         * @return the retained events, from the oldest to the newest, in the Chrome trace-event JSON format.
+         */
+        BIT7Z_NODISCARD std::string toChromeTrace() const;
+
+    private:
+        struct Event {
+            const char* name;
+            char phase;
+            uint32_t thread_id;
+            uint64_t timestamp_ns;
+            uint64_t arg;
+        };
+
+        std::vector< Event > mEvents;
+        std::atomic< uint64_t > mNextEvent;
+        std::chrono::steady_clock::time_point mStartTime;
+
+        void record( const char* name, char phase, uint64_t arg ) noexcept;
+};
+
+}  // namespace bit7z
+
+#endif
+
+#endif // BITTRACERECORDER_HPP
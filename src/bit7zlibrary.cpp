@@ -44,8 +44,17 @@ Bit7zLibrary::Bit7zLibrary( const tstring& library_path ) : mLibrary( Bit7zLoadL
     }
 }
 
+Bit7zLibrary::Bit7zLibrary( CreateObjectFunc create_object_func )
+    : mLibrary( nullptr ), mCreateObjectFunc( create_object_func ) {
+    if ( mCreateObjectFunc == nullptr ) {
+        throw BitException( "Invalid CreateObject function", std::make_error_code( std::errc::invalid_argument ) );
+    }
+}
+
 Bit7zLibrary::~Bit7zLibrary() {
-    FreeLibrary( mLibrary );
+    if ( mLibrary != nullptr ) {
+        FreeLibrary( mLibrary );
+    }
 }
 
 void Bit7zLibrary::createArchiveObject( const GUID* format_ID, const GUID* interface_ID, void** out_object ) const {
@@ -56,6 +65,10 @@ void Bit7zLibrary::createArchiveObject( const GUID* format_ID, const GUID* inter
 }
 
 void Bit7zLibrary::setLargePageMode() {
+    if ( mLibrary == nullptr ) {
+        return;
+    }
+
     using SetLargePageMode = HRESULT ( WINAPI* )();
 
     // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
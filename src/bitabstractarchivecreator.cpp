@@ -16,8 +16,17 @@
 #include "bitexception.hpp"
 #include "internal/archiveproperties.hpp"
 
+#include <algorithm>
+#include <atomic>
+
 using namespace bit7z;
 
+// The memory budget shared by all the archive creators (see setGlobalMemoryBudget).
+inline std::atomic< uint64_t >& globalBudget() noexcept {
+    static std::atomic< uint64_t > budget{ 0 };
+    return budget;
+}
+
 bool isValidCompressionMethod( const BitInOutFormat& format, BitCompressionMethod method ) noexcept {
     switch ( method ) {
         case BitCompressionMethod::Copy:
@@ -122,8 +131,17 @@ BitAbstractArchiveCreator::BitAbstractArchiveCreator( const Bit7zLibrary& lib,
       mWordSize( 0 ),
       mCryptHeaders( false ),
       mSolidMode( false ),
+      mSolidOrder( SolidOrder::None ),
+      mSolidBlockSize( 0 ),
+      mSolidBlockFilesCount( 0 ),
       mVolumeSize( 0 ),
-      mThreadsCount( 0 ) {
+      mThreadsCount( 0 ),
+      mInputPrefetchCount( 0 ),
+      mInputPrefetchBudget( kDefaultInputPrefetchBudget ),
+      mSyncContentCheck( false ),
+      mStoreIncompressible( false ),
+      mIncompressibleEntropy( kDefaultIncompressibleEntropy ),
+      mMemoryBudget( 0 ) {
     setRetainDirectories( false );
 }
 
@@ -159,6 +177,18 @@ bool BitAbstractArchiveCreator::solidMode() const noexcept {
     return mSolidMode;
 }
 
+SolidOrder BitAbstractArchiveCreator::solidOrder() const noexcept {
+    return mSolidOrder;
+}
+
+uint64_t BitAbstractArchiveCreator::solidBlockSize() const noexcept {
+    return mSolidBlockSize;
+}
+
+uint32_t BitAbstractArchiveCreator::solidBlockFilesCount() const noexcept {
+    return mSolidBlockFilesCount;
+}
+
 UpdateMode BitAbstractArchiveCreator::updateMode() const noexcept {
     return mUpdateMode;
 }
@@ -171,6 +201,42 @@ uint32_t BitAbstractArchiveCreator::threadsCount() const noexcept {
     return mThreadsCount;
 }
 
+uint32_t BitAbstractArchiveCreator::inputPrefetchCount() const noexcept {
+    return mInputPrefetchCount;
+}
+
+uint64_t BitAbstractArchiveCreator::inputPrefetchBudget() const noexcept {
+    return mInputPrefetchBudget;
+}
+
+bool BitAbstractArchiveCreator::syncContentCheck() const noexcept {
+    return mSyncContentCheck;
+}
+
+bool BitAbstractArchiveCreator::storeIncompressible() const noexcept {
+    return mStoreIncompressible;
+}
+
+double BitAbstractArchiveCreator::incompressibleEntropy() const noexcept {
+    return mIncompressibleEntropy;
+}
+
+uint64_t BitAbstractArchiveCreator::memoryBudget() const noexcept {
+    return mMemoryBudget;
+}
+
+uint64_t BitAbstractArchiveCreator::globalMemoryBudget() noexcept {
+    return globalBudget().load();
+}
+
+uint64_t BitAbstractArchiveCreator::effectiveMemoryBudget() const noexcept {
+    const uint64_t global_budget = globalBudget().load();
+    if ( mMemoryBudget == 0 || global_budget == 0 ) {
+        return mMemoryBudget + global_budget;
+    }
+    return std::min( mMemoryBudget, global_budget );
+}
+
 void BitAbstractArchiveCreator::setPassword( const tstring& password ) {
     setPassword( password, mCryptHeaders );
 }
@@ -227,6 +293,15 @@ void BitAbstractArchiveCreator::setSolidMode( bool solid_mode ) noexcept {
     mSolidMode = solid_mode;
 }
 
+void BitAbstractArchiveCreator::setSolidOrder( SolidOrder order ) noexcept {
+    mSolidOrder = order;
+}
+
+void BitAbstractArchiveCreator::setSolidBlockLimits( uint64_t max_block_size, uint32_t max_block_files ) noexcept {
+    mSolidBlockSize = max_block_size;
+    mSolidBlockFilesCount = max_block_files;
+}
+
 void BitAbstractArchiveCreator::setUpdateMode( UpdateMode mode ) {
     mUpdateMode = mode;
 }
@@ -244,6 +319,28 @@ void BitAbstractArchiveCreator::setThreadsCount( uint32_t threads_count ) noexce
     mThreadsCount = threads_count;
 }
 
+void BitAbstractArchiveCreator::setInputPrefetch( uint32_t items_count, uint64_t max_bytes ) noexcept {
+    mInputPrefetchCount = items_count;
+    mInputPrefetchBudget = max_bytes;
+}
+
+void BitAbstractArchiveCreator::setSyncContentCheck( bool content_check ) noexcept {
+    mSyncContentCheck = content_check;
+}
+
+void BitAbstractArchiveCreator::setStoreIncompressible( bool store, double min_entropy ) noexcept {
+    mStoreIncompressible = store;
+    mIncompressibleEntropy = min_entropy;
+}
+
+void BitAbstractArchiveCreator::setMemoryBudget( uint64_t max_memory ) noexcept {
+    mMemoryBudget = max_memory;
+}
+
+void BitAbstractArchiveCreator::setGlobalMemoryBudget( uint64_t max_memory ) noexcept {
+    globalBudget().store( max_memory );
+}
+
 const wchar_t* dictionaryPropertyName( const BitInOutFormat& format, BitCompressionMethod method ) {
     if ( format == BitFormat::SevenZip ) {
         return ( method == BitCompressionMethod::Ppmd ? L"0mem" : L"0d" );
@@ -258,12 +355,33 @@ const wchar_t* wordSizePropertyName( const BitInOutFormat& format, BitCompressio
     return ( method == BitCompressionMethod::Ppmd ? L"o" : L"fb" );
 }
 
-ArchiveProperties BitAbstractArchiveCreator::archiveProperties() const {
+// The value of the 7z "s" property, e.g., "100f64m" for blocks of at most 100 files and 64 MiB.
+inline BitPropVariant solidProperty( bool solid_mode, uint64_t block_size, uint32_t block_files ) {
+    if ( !solid_mode || ( block_size == 0 && block_files == 0 ) ) {
+        return BitPropVariant{ solid_mode };
+    }
+    std::wstring result;
+    if ( block_files != 0 ) {
+        result += std::to_wstring( block_files ) + L"f";
+    }
+    if ( block_size != 0 ) {
+        result += std::to_wstring( block_size ) + L"b";
+    }
+    return BitPropVariant{ result };
+}
+
+ArchiveProperties BitAbstractArchiveCreator::archiveProperties( bool store_only,
+                                                                const BitMemoryEstimate* memory_plan,
+                                                                uint32_t threads_limit ) const {
     ArchiveProperties properties = {};
     if ( mCryptHeaders && mFormat.hasFeature( FormatFeatures::HeaderEncryption ) ) {
         properties.setProperty( L"he", true );
     }
-    if ( mFormat.hasFeature( FormatFeatures::CompressionLevel ) ) {
+    // Note: the level 0 means the Copy method for the 7z format, and the Store method for the zip format.
+    store_only = store_only && mFormat.hasFeature( FormatFeatures::MultipleMethods );
+    if ( store_only ) {
+        properties.setProperty( L"x", static_cast< uint32_t >( BitCompressionLevel::None ) );
+    } else if ( mFormat.hasFeature( FormatFeatures::CompressionLevel ) ) {
         properties.setProperty( L"x", static_cast< uint32_t >( mCompressionLevel ) );
 
         if ( mFormat.hasFeature( FormatFeatures::MultipleMethods ) && mCompressionMethod != mFormat.defaultMethod() ) {
@@ -271,7 +389,10 @@ ArchiveProperties BitAbstractArchiveCreator::archiveProperties() const {
         }
     }
     if ( mFormat.hasFeature( FormatFeatures::SolidArchive ) ) {
-        properties.setProperty( L"s", mSolidMode );
+        properties.setProperty( L"s", solidProperty( mSolidMode, mSolidBlockSize, mSolidBlockFilesCount ) );
+        if ( mSolidOrder != SolidOrder::None && mFormat == BitFormat::SevenZip ) {
+            properties.setProperty( L"qs", true ); // The 7z format sorts the items by itself.
+        }
 #ifndef _WIN32
         if ( mSolidMode ) {
             /* NOTE: Apparently, p7zip requires the filters to be set off for the solid compression to work.
@@ -282,14 +403,25 @@ ArchiveProperties BitAbstractArchiveCreator::archiveProperties() const {
         }
 #endif
     }
-    if ( mThreadsCount != 0 ) {
-        properties.setProperty( L"mt", mThreadsCount );
+    uint32_t threads_count = mThreadsCount;
+    uint32_t dictionary_size = mDictionarySize;
+    if ( memory_plan != nullptr && memory_plan->reduced ) { // The settings were reduced to fit the memory budget.
+        threads_count = memory_plan->threads_count;
+        if ( memory_plan->dictionary_size != 0 ) {
+            dictionary_size = memory_plan->dictionary_size;
+        }
+    }
+    if ( threads_limit != 0 ) {
+        threads_count = threads_count != 0 ? std::min( threads_count, threads_limit ) : threads_limit;
+    }
+    if ( threads_count != 0 ) {
+        properties.setProperty( L"mt", threads_count );
     }
-    if ( mDictionarySize != 0 ) {
+    if ( dictionary_size != 0 && !store_only ) {
         properties.setProperty( dictionaryPropertyName( mFormat, mCompressionMethod ),
-                                std::to_wstring( mDictionarySize ) + L"b" );
+                                std::to_wstring( dictionary_size ) + L"b" );
     }
-    if ( mWordSize != 0 ) {
+    if ( mWordSize != 0 && !store_only ) {
         properties.setProperty( wordSizePropertyName( mFormat, mCompressionMethod ), mWordSize );
     }
     properties.addProperties( mExtraProperties );
@@ -12,15 +12,31 @@
 
 #include "bitabstractarchivehandler.hpp"
 
+#include <atomic>
+
 using namespace bit7z;
 
+// The thread governor of the handlers without one (see setGlobalThreadGovernor).
+inline std::atomic< BitThreadGovernor* >& globalGovernor() noexcept {
+    static std::atomic< BitThreadGovernor* > governor{ nullptr };
+    return governor;
+}
+
 BitAbstractArchiveHandler::BitAbstractArchiveHandler( const Bit7zLibrary& lib,
                                                       tstring password,
                                                       OverwriteMode overwrite_mode )
     : mLibrary{ lib },
       mPassword{ std::move( password ) },
       mRetainDirectories{ true },
-      mOverwriteMode{ overwrite_mode } {}
+      mOverwriteMode{ overwrite_mode },
+      mProgressInterval{ 0 },
+      mProgressTracker{ nullptr },
+      mAdmissionController{ nullptr },
+      mThreadGovernor{ nullptr },
+      mCancellationToken{ nullptr },
+      mTimeout{ 0 },
+      mExtractionCache{ nullptr },
+      mHashManifest{ nullptr } {}
 
 const Bit7zLibrary& BitAbstractArchiveHandler::library() const noexcept {
     return mLibrary;
@@ -58,6 +74,48 @@ PasswordCallback BitAbstractArchiveHandler::passwordCallback() const {
     return mPasswordCallback;
 }
 
+MetricsCallback BitAbstractArchiveHandler::metricsCallback() const {
+    return mMetricsCallback;
+}
+
+#ifdef BIT7Z_TRACING
+BitTraceRecorder* BitAbstractArchiveHandler::traceRecorder() const noexcept {
+    return mTraceRecorder;
+}
+#endif
+
+std::chrono::milliseconds BitAbstractArchiveHandler::progressInterval() const noexcept {
+    return mProgressInterval;
+}
+
+BitProgress* BitAbstractArchiveHandler::progressTracker() const noexcept {
+    return mProgressTracker;
+}
+
+BitAdmissionController* BitAbstractArchiveHandler::admissionController() const noexcept {
+    return mAdmissionController;
+}
+
+BitThreadGovernor* BitAbstractArchiveHandler::threadGovernor() const noexcept {
+    return mThreadGovernor != nullptr ? mThreadGovernor : globalGovernor().load();
+}
+
+BitCancellationToken* BitAbstractArchiveHandler::cancellationToken() const noexcept {
+    return mCancellationToken;
+}
+
+std::chrono::milliseconds BitAbstractArchiveHandler::timeout() const noexcept {
+    return mTimeout;
+}
+
+BitExtractionCache* BitAbstractArchiveHandler::extractionCache() const noexcept {
+    return mExtractionCache;
+}
+
+const BitHashManifest* BitAbstractArchiveHandler::hashManifest() const noexcept {
+    return mHashManifest;
+}
+
 OverwriteMode BitAbstractArchiveHandler::overwriteMode() const {
     return mOverwriteMode;
 }
@@ -94,6 +152,52 @@ void BitAbstractArchiveHandler::setPasswordCallback( const PasswordCallback& cal
     mPasswordCallback = callback;
 }
 
+void BitAbstractArchiveHandler::setMetricsCallback( const MetricsCallback& callback ) {
+    mMetricsCallback = callback;
+}
+
+#ifdef BIT7Z_TRACING
+void BitAbstractArchiveHandler::setTraceRecorder( BitTraceRecorder* recorder ) noexcept {
+    mTraceRecorder = recorder;
+}
+#endif
+
+void BitAbstractArchiveHandler::setProgressInterval( std::chrono::milliseconds interval ) noexcept {
+    mProgressInterval = interval;
+}
+
+void BitAbstractArchiveHandler::setProgressTracker( BitProgress* tracker ) noexcept {
+    mProgressTracker = tracker;
+}
+
+void BitAbstractArchiveHandler::setAdmissionController( BitAdmissionController* controller ) noexcept {
+    mAdmissionController = controller;
+}
+
+void BitAbstractArchiveHandler::setThreadGovernor( BitThreadGovernor* governor ) noexcept {
+    mThreadGovernor = governor;
+}
+
+void BitAbstractArchiveHandler::setGlobalThreadGovernor( BitThreadGovernor* governor ) noexcept {
+    globalGovernor().store( governor );
+}
+
+void BitAbstractArchiveHandler::setCancellationToken( BitCancellationToken* token ) noexcept {
+    mCancellationToken = token;
+}
+
+void BitAbstractArchiveHandler::setTimeout( std::chrono::milliseconds timeout ) noexcept {
+    mTimeout = timeout;
+}
+
+void BitAbstractArchiveHandler::setExtractionCache( BitExtractionCache* cache ) noexcept {
+    mExtractionCache = cache;
+}
+
+void BitAbstractArchiveHandler::setHashManifest( const BitHashManifest* manifest ) noexcept {
+    mHashManifest = manifest;
+}
+
 void BitAbstractArchiveHandler::setOverwriteMode( OverwriteMode mode ) {
     mOverwriteMode = mode;
 }
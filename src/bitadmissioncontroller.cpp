@@ -0,0 +1,89 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "bitadmissioncontroller.hpp"
+
+#include "bitexception.hpp"
+
+#include <algorithm>
+
+using namespace bit7z;
+
+BitAdmissionController::BitAdmissionController( uint64_t memory_budget, AdmissionPolicy policy )
+    : mMemoryBudget{ memory_budget },
+      mPolicy{ policy },
+      mMemoryInUse{ 0 },
+      mRunningJobs{ 0 },
+      mNextTicket{ 0 },
+      mServedTicket{ 0 } {}
+
+uint64_t BitAdmissionController::memoryBudget() const noexcept {
+    return mMemoryBudget;
+}
+
+AdmissionPolicy BitAdmissionController::policy() const noexcept {
+    return mPolicy;
+}
+
+uint64_t BitAdmissionController::memoryInUse() const {
+    const std::lock_guard< std::mutex > lock{ mMutex };
+    return mMemoryInUse;
+}
+
+uint32_t BitAdmissionController::runningJobs() const {
+    const std::lock_guard< std::mutex > lock{ mMutex };
+    return mRunningJobs;
+}
+
+uint32_t BitAdmissionController::queuedJobs() const {
+    const std::lock_guard< std::mutex > lock{ mMutex };
+    return static_cast< uint32_t >( mNextTicket - mServedTicket );
+}
+
+void BitAdmissionController::acquire( uint64_t memory_usage ) {
+    if ( memory_usage > mMemoryBudget ) {
+        throw BitException( "The job does not fit into the memory budget",
+                            std::make_error_code( std::errc::not_enough_memory ) );
+    }
+
+    std::unique_lock< std::mutex > lock{ mMutex };
+    const auto fits = [ this, memory_usage ]() {
+        return mMemoryInUse + memory_usage <= mMemoryBudget;
+    };
+    if ( mPolicy == AdmissionPolicy::Reject ) {
+        if ( !fits() ) {
+            throw BitException( "The job does not fit into the memory left by the running jobs",
+                                std::make_error_code( std::errc::resource_unavailable_try_again ) );
+        }
+    } else {
+        // Note: the queue is FIFO, so that small jobs cannot indefinitely delay a large one.
+        const uint64_t ticket = mNextTicket++;
+        mReleased.wait( lock, [ & ]() {
+            return ticket == mServedTicket && fits();
+        } );
+        ++mServedTicket;
+        mReleased.notify_all(); // The next queued job might fit too.
+    }
+    mMemoryInUse += memory_usage;
+    ++mRunningJobs;
+}
+
+void BitAdmissionController::release( uint64_t memory_usage ) noexcept {
+    {
+        const std::lock_guard< std::mutex > lock{ mMutex };
+        mMemoryInUse -= std::min( memory_usage, mMemoryInUse );
+        if ( mRunningJobs > 0 ) {
+            --mRunningJobs;
+        }
+    }
+    mReleased.notify_all();
+}
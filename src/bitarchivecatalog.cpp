@@ -0,0 +1,150 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "bitarchivecatalog.hpp"
+
+#include "bitexception.hpp"
+#include "bitinputarchive.hpp"
+#include "internal/fs.hpp"
+#include "internal/util.hpp"
+
+#include <algorithm>
+#include <locale>
+#include <sstream>
+#include <vector>
+
+using namespace bit7z;
+
+constexpr auto kCatalogHeader = "bit7z-catalog 1";
+
+BitArchiveCatalog::BitArchiveCatalog( const BitInputArchive& archive ) {
+    mItems.reserve( archive.itemsCount() );
+    for ( const auto& item : archive ) {
+        const BitPropVariant is_anti = item.itemProperty( BitProperty::IsAnti );
+        if ( is_anti.isBool() && is_anti.getBool() ) {
+            continue;
+        }
+        BitCatalogItem catalog_item;
+        catalog_item.is_dir = item.isDir();
+        catalog_item.size = item.size();
+        const BitPropVariant last_write_time = item.itemProperty( BitProperty::MTime );
+        if ( last_write_time.isFileTime() ) {
+            catalog_item.last_write_time = last_write_time.getTimePoint();
+        }
+        const BitPropVariant crc = item.itemProperty( BitProperty::CRC );
+        catalog_item.has_crc = crc.isUInt32();
+        catalog_item.crc = catalog_item.has_crc ? crc.getUInt32() : 0;
+        mItems[ item.path() ] = catalog_item;
+    }
+}
+
+void BitArchiveCatalog::addItem( const tstring& path, const BitCatalogItem& item ) {
+    mItems[ path ] = item;
+}
+
+const BitCatalogItem* BitArchiveCatalog::find( const tstring& path ) const {
+    const auto item = mItems.find( path );
+    return item != mItems.end() ? &item->second : nullptr;
+}
+
+std::size_t BitArchiveCatalog::size() const noexcept {
+    return mItems.size();
+}
+
+const std::unordered_map< tstring, BitCatalogItem >& BitArchiveCatalog::items() const noexcept {
+    return mItems;
+}
+
+// Catalog lines: <d or f> <size> <last write time, in nanoseconds since the epoch> <CRC, or -> <path>
+void BitArchiveCatalog::save( const tstring& catalog_file ) const {
+    // The items are written sorted by path, so that the same catalog is always saved to the same file.
+    using CatalogEntry = std::pair< const tstring, BitCatalogItem >;
+    std::vector< const CatalogEntry* > sorted_items;
+    sorted_items.reserve( mItems.size() );
+    for ( const auto& item : mItems ) {
+        sorted_items.push_back( &item );
+    }
+    std::sort( sorted_items.begin(), sorted_items.end(), []( const CatalogEntry* first, const CatalogEntry* second ) {
+        return first->first < second->first;
+    } );
+
+    fs::ofstream catalog{ fs::path{ catalog_file }, std::ios::binary | std::ios::trunc };
+    if ( !catalog.is_open() ) {
+        throw BitException( "Failed to create the catalog", last_error_code(), catalog_file );
+    }
+    catalog.imbue( std::locale::classic() );
+    catalog << kCatalogHeader << '\n';
+    for ( const auto* item : sorted_items ) {
+        const auto& metadata = item->second;
+        const auto nanoseconds = std::chrono::duration_cast< std::chrono::nanoseconds >(
+            metadata.last_write_time.time_since_epoch() ).count();
+        catalog << ( metadata.is_dir ? 'd' : 'f' ) << ' ' << metadata.size << ' ' << nanoseconds << ' ';
+        if ( metadata.has_crc ) {
+            catalog << std::hex << metadata.crc << std::dec;
+        } else {
+            catalog << '-';
+        }
+        catalog << ' ' << escapeLine( toUtf8( item->first ) ) << '\n';
+    }
+
+    catalog.flush();
+    if ( !catalog ) {
+        throw BitException( "Failed to write the catalog", std::make_error_code( std::errc::io_error ),
+                            catalog_file );
+    }
+}
+
+BitArchiveCatalog BitArchiveCatalog::load( const tstring& catalog_file ) {
+    fs::ifstream catalog{ fs::path{ catalog_file }, std::ios::binary };
+    if ( !catalog.is_open() ) {
+        throw BitException( "Failed to open the catalog", last_error_code(), catalog_file );
+    }
+
+    std::string line;
+    if ( !std::getline( catalog, line ) || line != kCatalogHeader ) {
+        throw BitException( "Invalid catalog", std::make_error_code( std::errc::invalid_argument ), catalog_file );
+    }
+
+    BitArchiveCatalog result;
+    while ( std::getline( catalog, line ) ) {
+        if ( line.empty() ) {
+            continue;
+        }
+        std::istringstream fields{ line };
+        fields.imbue( std::locale::classic() );
+        char kind = '\0';
+        BitCatalogItem item;
+        int64_t nanoseconds = 0;
+        std::string crc;
+        fields >> kind >> item.size >> nanoseconds >> crc;
+        if ( fields.fail() || ( kind != 'd' && kind != 'f' ) || fields.get() != ' ' ) {
+            throw BitException( "Invalid catalog", std::make_error_code( std::errc::invalid_argument ),
+                                catalog_file );
+        }
+        item.is_dir = kind == 'd';
+        item.last_write_time = time_type{ std::chrono::duration_cast< time_type::duration >(
+            std::chrono::nanoseconds{ nanoseconds } ) };
+        if ( crc != "-" ) {
+            std::istringstream crc_field{ crc };
+            crc_field >> std::hex >> item.crc;
+            if ( crc_field.fail() ) {
+                throw BitException( "Invalid catalog", std::make_error_code( std::errc::invalid_argument ),
+                                    catalog_file );
+            }
+            item.has_crc = true;
+        }
+        std::string path;
+        std::getline( fields, path );
+        result.mItems[ fromUtf8( unescapeLine( path ) ) ] = item;
+    }
+    return result;
+}
@@ -0,0 +1,192 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "bitarchivediff.hpp"
+
+#include "bitarchivereader.hpp"
+#include "internal/crc32streambuf.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <ostream>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace bit7z;
+
+// Note: an unknown (i.e., epoch) last write time never matches, so the items are considered changed.
+inline bool sameLastWriteTime( const BitCatalogItem& old_item, const BitCatalogItem& new_item ) {
+    return old_item.last_write_time != time_type{} && old_item.last_write_time == new_item.last_write_time;
+}
+
+// Maps the given paths to the indices of the corresponding items of the archive (the last ones, as in the catalogs).
+inline std::unordered_map< tstring, uint32_t > itemsIndices( const BitInputArchive& archive,
+                                                             const std::vector< tstring >& paths ) {
+    const std::unordered_set< tstring > searched_paths( paths.begin(), paths.end() );
+    std::unordered_map< tstring, uint32_t > result;
+    for ( const auto& item : archive ) {
+        tstring path = item.path();
+        if ( searched_paths.find( path ) != searched_paths.end() ) {
+            result[ std::move( path ) ] = item.index();
+        }
+    }
+    return result;
+}
+
+// The CRC of the content of the item, computed by extracting it (without storing it) if it is not known.
+inline uint32_t contentCrc( const BitInputArchive& archive, uint32_t index, const BitCatalogItem& item ) {
+    if ( item.has_crc ) {
+        return item.crc;
+    }
+    Crc32StreamBuf crc_buffer;
+    std::ostream crc_stream{ &crc_buffer };
+    archive.extract( crc_stream, index );
+    return crc_buffer.crc();
+}
+
+BitArchiveDiff::BitArchiveDiff( const BitArchiveCatalog& old_catalog, const BitArchiveCatalog& new_catalog ) {
+    for ( const auto& path : compareCatalogs( old_catalog, new_catalog ) ) {
+        const bool unchanged = sameLastWriteTime( *old_catalog.find( path ), *new_catalog.find( path ) );
+        ( unchanged ? mUnchanged : mChanged ).push_back( path );
+    }
+    sortPaths();
+}
+
+BitArchiveDiff::BitArchiveDiff( const BitInputArchive& old_archive,
+                                const BitInputArchive& new_archive,
+                                bool content_check ) {
+    const BitArchiveCatalog old_catalog{ old_archive };
+    const BitArchiveCatalog new_catalog{ new_archive };
+    const std::vector< tstring > unknown_crc_paths = compareCatalogs( old_catalog, new_catalog );
+    if ( !content_check ) {
+        for ( const auto& path : unknown_crc_paths ) {
+            const bool unchanged = sameLastWriteTime( *old_catalog.find( path ), *new_catalog.find( path ) );
+            ( unchanged ? mUnchanged : mChanged ).push_back( path );
+        }
+        sortPaths();
+        return;
+    }
+
+    // Only the files whose CRC is not known are extracted, one at a time.
+    const auto old_indices = itemsIndices( old_archive, unknown_crc_paths );
+    const auto new_indices = itemsIndices( new_archive, unknown_crc_paths );
+    for ( const auto& path : unknown_crc_paths ) {
+        const uint32_t old_crc = contentCrc( old_archive, old_indices.at( path ), *old_catalog.find( path ) );
+        const uint32_t new_crc = contentCrc( new_archive, new_indices.at( path ), *new_catalog.find( path ) );
+        ( old_crc == new_crc ? mUnchanged : mChanged ).push_back( path );
+    }
+    sortPaths();
+}
+
+std::vector< tstring > BitArchiveDiff::compareCatalogs( const BitArchiveCatalog& old_catalog,
+                                                        const BitArchiveCatalog& new_catalog ) {
+    std::vector< tstring > unknown_crc_paths;
+    for ( const auto& old_entry : old_catalog.items() ) {
+        const tstring& path = old_entry.first;
+        const BitCatalogItem& old_item = old_entry.second;
+        const BitCatalogItem* new_item = new_catalog.find( path );
+        if ( new_item == nullptr ) {
+            mRemoved.push_back( path );
+        } else if ( old_item.is_dir != new_item->is_dir || ( !old_item.is_dir && old_item.size != new_item->size ) ) {
+            mChanged.push_back( path );
+        } else if ( old_item.is_dir ) {
+            mUnchanged.push_back( path );
+        } else if ( old_item.has_crc && new_item->has_crc ) {
+            ( old_item.crc == new_item->crc ? mUnchanged : mChanged ).push_back( path );
+        } else {
+            unknown_crc_paths.push_back( path );
+        }
+    }
+    for ( const auto& new_entry : new_catalog.items() ) {
+        if ( old_catalog.find( new_entry.first ) == nullptr ) {
+            mAdded.push_back( new_entry.first );
+        }
+    }
+    return unknown_crc_paths;
+}
+
+void BitArchiveDiff::sortPaths() {
+    std::sort( mAdded.begin(), mAdded.end() );
+    std::sort( mRemoved.begin(), mRemoved.end() );
+    std::sort( mChanged.begin(), mChanged.end() );
+    std::sort( mUnchanged.begin(), mUnchanged.end() );
+}
+
+const std::vector< tstring >& BitArchiveDiff::added() const noexcept {
+    return mAdded;
+}
+
+const std::vector< tstring >& BitArchiveDiff::removed() const noexcept {
+    return mRemoved;
+}
+
+const std::vector< tstring >& BitArchiveDiff::changed() const noexcept {
+    return mChanged;
+}
+
+const std::vector< tstring >& BitArchiveDiff::unchanged() const noexcept {
+    return mUnchanged;
+}
+
+bool BitArchiveDiff::identical() const noexcept {
+    return mAdded.empty() && mRemoved.empty() && mChanged.empty();
+}
+
+std::vector< BitArchiveDiff > BitArchiveDiff::compare( const Bit7zLibrary& lib,
+                                                       const std::vector< std::pair< tstring, tstring > >& pairs,
+                                                       const BitInFormat& format ) {
+    std::vector< std::unique_ptr< BitArchiveDiff > > diffs( pairs.size() );
+    std::vector< std::exception_ptr > errors( pairs.size() );
+    std::atomic< std::size_t > next_pair{ 0 };
+    const auto compare_pairs = [ & ]() {
+        for ( auto pair = next_pair++; pair < pairs.size(); pair = next_pair++ ) {
+            try {
+                const BitArchiveReader old_archive{ lib, pairs[ pair ].first, format };
+                const BitArchiveReader new_archive{ lib, pairs[ pair ].second, format };
+                diffs[ pair ] = std::make_unique< BitArchiveDiff >( old_archive, new_archive );
+            } catch ( ... ) {
+                errors[ pair ] = std::current_exception();
+            }
+        }
+    };
+
+    const std::size_t workers_count = std::min< std::size_t >( pairs.size(),
+                                                                std::max( std::thread::hardware_concurrency(), 1u ) );
+    std::vector< std::thread > workers;
+    for ( std::size_t worker = 1; worker < workers_count; ++worker ) {
+        try {
+            workers.emplace_back( compare_pairs );
+        } catch ( const std::system_error& ) {
+            break; // Too many threads: the pairs are compared by the workers created so far.
+        }
+    }
+    compare_pairs();
+    for ( auto& worker : workers ) {
+        worker.join();
+    }
+
+    for ( const auto& error : errors ) {
+        if ( error ) {
+            std::rethrow_exception( error );
+        }
+    }
+    std::vector< BitArchiveDiff > result;
+    result.reserve( diffs.size() );
+    for ( auto& diff : diffs ) {
+        result.push_back( std::move( *diff ) );
+    }
+    return result;
+}
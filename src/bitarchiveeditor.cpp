@@ -197,4 +197,8 @@ bool BitArchiveEditor::hasNewProperties( uint32_t index ) const noexcept {
     return mapped_index >= inputArchiveItemsCount() || isEditedItem;
 }
 
+bool BitArchiveEditor::isEditedIndex( uint32_t index ) const noexcept {
+    return mEditedItems.find( index ) != mEditedItems.end();
+}
+
 } // namespace bit7z
@@ -0,0 +1,176 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "bitarchivemerger.hpp"
+
+#include "biterror.hpp"
+#include "bitexception.hpp"
+#include "internal/fs.hpp"
+#include "internal/fsutil.hpp"
+#include "internal/tarmerge.hpp"
+#include "internal/zipmerge.hpp"
+
+#include <unordered_map>
+#include <utility>
+
+using namespace bit7z;
+
+BitArchiveMerger::BitArchiveMerger( const BitInOutFormat& format )
+    : mFormat{ format }, mDuplicatePolicy{ DuplicatePolicy::Fail }, mOverwriteMode{ OverwriteMode::None } {
+    if ( format != BitFormat::Zip && format != BitFormat::Tar ) {
+        throw BitException( "Only Zip and Tar archives can be merged",
+                            make_error_code( BitError::UnsupportedOperation ) );
+    }
+}
+
+const BitInOutFormat& BitArchiveMerger::format() const noexcept {
+    return mFormat;
+}
+
+DuplicatePolicy BitArchiveMerger::duplicatePolicy() const noexcept {
+    return mDuplicatePolicy;
+}
+
+OverwriteMode BitArchiveMerger::overwriteMode() const noexcept {
+    return mOverwriteMode;
+}
+
+void BitArchiveMerger::setDuplicatePolicy( DuplicatePolicy policy ) noexcept {
+    mDuplicatePolicy = policy;
+}
+
+void BitArchiveMerger::setOverwriteMode( OverwriteMode mode ) noexcept {
+    mOverwriteMode = mode;
+}
+
+inline void openMergedArchive( fs::ifstream& archive, const tstring& in_archive ) {
+    using namespace bit7z::filesystem;
+    archive.open( FORMAT_LONG_PATH( fs::path{ in_archive } ), std::ios::binary );
+    if ( !archive.is_open() ) {
+        throw BitException( "Failed to open the archive", last_error_code(), in_archive );
+    }
+}
+
+// Returns, for each merged archive, the indices of its entries to be copied according to the duplicate policy.
+template< typename Entry >
+std::vector< std::vector< std::size_t > > selectEntries( const std::vector< std::vector< Entry > >& entries,
+                                                         const std::vector< tstring >& in_archives,
+                                                         DuplicatePolicy policy ) {
+    using EntryRef = std::pair< std::size_t, std::size_t >; // The indices of the archive and of the entry.
+    std::unordered_map< std::string, EntryRef > kept_entries;
+    for ( std::size_t archive = 0; archive < entries.size(); ++archive ) {
+        for ( std::size_t index = 0; index < entries[ archive ].size(); ++index ) {
+            const Entry& entry = entries[ archive ][ index ];
+            if ( !entry.keyed ) {
+                continue;
+            }
+            const auto kept = kept_entries.emplace( entry.key, EntryRef{ archive, index } );
+            if ( kept.second ) {
+                continue;
+            }
+            const EntryRef& kept_ref = kept.first->second;
+            if ( entry.is_dir && entries[ kept_ref.first ][ kept_ref.second ].is_dir ) {
+                continue; // Folders are merged, keeping the first one.
+            }
+            if ( policy == DuplicatePolicy::Fail ) {
+                throw BitException( "Duplicate item path in the merged archives",
+                                    std::make_error_code( std::errc::file_exists ), in_archives[ archive ] );
+            }
+            if ( policy == DuplicatePolicy::KeepLast ) {
+                kept.first->second = EntryRef{ archive, index };
+            }
+        }
+    }
+
+    std::vector< std::vector< std::size_t > > result( entries.size() );
+    for ( std::size_t archive = 0; archive < entries.size(); ++archive ) {
+        for ( std::size_t index = 0; index < entries[ archive ].size(); ++index ) {
+            const Entry& entry = entries[ archive ][ index ];
+            if ( !entry.keyed || ( policy == DuplicatePolicy::KeepAll && !entry.is_dir ) ||
+                 kept_entries[ entry.key ] == EntryRef{ archive, index } ) {
+                result[ archive ].push_back( index );
+            }
+        }
+    }
+    return result;
+}
+
+template< typename Entry, typename Writer >
+void mergeArchives( const std::vector< tstring >& in_archives,
+                    std::vector< Entry > ( *read_entries )( std::istream&, const tstring& ),
+                    DuplicatePolicy policy,
+                    const fs::path& out_path,
+                    const tstring& out_archive ) {
+    // All the archives are read before creating the output, so that invalid archives or duplicates
+    // are detected before touching any existing file.
+    std::vector< std::vector< Entry > > entries;
+    entries.reserve( in_archives.size() );
+    for ( const auto& in_archive : in_archives ) {
+        fs::ifstream archive;
+        openMergedArchive( archive, in_archive );
+        entries.push_back( read_entries( archive, in_archive ) );
+    }
+    const auto selected_entries = selectEntries( entries, in_archives, policy );
+
+    fs::ofstream out{ out_path, std::ios::binary | std::ios::trunc };
+    if ( !out.is_open() ) {
+        throw BitException( "Failed to create the output archive", last_error_code(), out_archive );
+    }
+    try {
+        Writer writer{ out };
+        for ( std::size_t archive_index = 0; archive_index < in_archives.size(); ++archive_index ) {
+            if ( selected_entries[ archive_index ].empty() ) {
+                continue;
+            }
+            fs::ifstream archive;
+            openMergedArchive( archive, in_archives[ archive_index ] );
+            for ( const auto entry_index : selected_entries[ archive_index ] ) {
+                writer.copyEntry( archive, entries[ archive_index ][ entry_index ], in_archives[ archive_index ] );
+            }
+        }
+        writer.finish();
+    } catch ( const BitException& ) {
+        out.close();
+        std::error_code error;
+        fs::remove( out_path, error );
+        throw;
+    }
+}
+
+void BitArchiveMerger::merge( const std::vector< tstring >& in_archives, const tstring& out_archive ) const {
+    using namespace bit7z::filesystem;
+    const fs::path out_path = FORMAT_LONG_PATH( fs::path{ out_archive } );
+    std::error_code error;
+    for ( const auto& in_archive : in_archives ) {
+        if ( fs::equivalent( FORMAT_LONG_PATH( fs::path{ in_archive } ), out_path, error ) ) {
+            throw BitException( "The output archive cannot be one of the merged archives",
+                                std::make_error_code( std::errc::invalid_argument ), out_archive );
+        }
+    }
+    if ( fs::exists( out_path, error ) ) {
+        if ( mOverwriteMode == OverwriteMode::Skip ) {
+            return;
+        }
+        if ( mOverwriteMode == OverwriteMode::None ) {
+            throw BitException( "The output archive already exists", std::make_error_code( std::errc::file_exists ),
+                                out_archive );
+        }
+    }
+
+    if ( mFormat == BitFormat::Zip ) {
+        mergeArchives< ZipEntry, ZipMergeWriter >( in_archives, &readZipEntries, mDuplicatePolicy,
+                                                   out_path, out_archive );
+    } else {
+        mergeArchives< TarEntry, TarMergeWriter >( in_archives, &readTarEntries, mDuplicatePolicy,
+                                                   out_path, out_archive );
+    }
+}
@@ -12,6 +12,8 @@
 
 #include "bitarchivereader.hpp"
 
+#include "biterror.hpp"
+
 #include <algorithm>
 #include <numeric>
 
@@ -37,6 +39,52 @@ BitArchiveReader::BitArchiveReader( const Bit7zLibrary& lib,
                                     const tstring& password )
     : BitAbstractArchiveOpener( lib, format, password ), BitInputArchive( *this, in_archive ) {}
 
+BitArchiveReader::BitArchiveReader( const Bit7zLibrary& lib,
+                                    const tstring& in_archive,
+                                    const BitInFormat& format,
+                                    const tstring& password,
+                                    std::error_code& error )
+    : BitAbstractArchiveOpener( lib, format, password ), BitInputArchive( *this, in_archive, error ) {}
+
+BitArchiveReader::BitArchiveReader( const Bit7zLibrary& lib,
+                                    const std::vector< byte_t >& in_archive,
+                                    const BitInFormat& format,
+                                    const tstring& password,
+                                    std::error_code& error )
+    : BitAbstractArchiveOpener( lib, format, password ), BitInputArchive( *this, in_archive, error ) {}
+
+std::unique_ptr< BitArchiveReader > BitArchiveReader::tryOpen( const Bit7zLibrary& lib,
+                                                               const tstring& in_archive,
+                                                               std::error_code& error,
+                                                               const BitInFormat& format,
+                                                               const tstring& password ) noexcept try {
+    error.clear();
+    std::unique_ptr< BitArchiveReader > reader{ new BitArchiveReader( lib, in_archive, format, password, error ) };
+    return error ? nullptr : std::move( reader );
+} catch ( const std::system_error& ex ) {
+    error = ex.code();
+    return nullptr;
+} catch ( const std::exception& ) {
+    error = make_error_code( BitError::Fail );
+    return nullptr;
+}
+
+std::unique_ptr< BitArchiveReader > BitArchiveReader::tryOpen( const Bit7zLibrary& lib,
+                                                               const std::vector< byte_t >& in_archive,
+                                                               std::error_code& error,
+                                                               const BitInFormat& format,
+                                                               const tstring& password ) noexcept try {
+    error.clear();
+    std::unique_ptr< BitArchiveReader > reader{ new BitArchiveReader( lib, in_archive, format, password, error ) };
+    return error ? nullptr : std::move( reader );
+} catch ( const std::system_error& ex ) {
+    error = ex.code();
+    return nullptr;
+} catch ( const std::exception& ) {
+    error = make_error_code( BitError::Fail );
+    return nullptr;
+}
+
 map< BitProperty, BitPropVariant > BitArchiveReader::archiveProperties() const {
     map< BitProperty, BitPropVariant > result;
     for ( uint32_t i = kpidNoProperty; i <= kpidCopyLink; ++i ) {
@@ -11,7 +11,12 @@
  */
 
 #include "bitarchivewriter.hpp"
+#include "internal/calibration.hpp"
 #include "internal/fs.hpp"
+#include "internal/genericinputitem.hpp"
+
+#include <algorithm>
+#include <chrono>
 
 namespace bit7z {
 
@@ -39,4 +44,83 @@ BitArchiveWriter::BitArchiveWriter( const Bit7zLibrary& lib,
     : BitAbstractArchiveCreator( lib, format, password, UpdateMode::Append ),
       BitOutputArchive( *this, in_archive ) {}
 
+BitCalibrationResult BitArchiveWriter::calibrate( const BitCalibrationOptions& options ) {
+    const CalibrationSample sample = makeCalibrationSample( newItems(), options.sample_size );
+    if ( sample.size == 0 ) {
+        throw BitException( "Cannot calibrate the compression parameters",
+                            std::make_error_code( std::errc::no_such_file_or_directory ) );
+    }
+
+    uint64_t total_size = 0;
+    for ( const auto& item : newItems() ) {
+        if ( !item->isDir() ) {
+            total_size += item->size();
+        }
+    }
+    const double required_throughput = requiredThroughput( options, total_size );
+    const auto candidates = calibrationCandidates( options );
+    const std::string profile = calibrationProfile( *this, newItems(), sample, candidates, required_throughput );
+
+    BitCalibrationResult chosen;
+    if ( !options.cache_file.empty() && loadCalibration( options.cache_file, profile, chosen ) ) {
+        chosen.meets_target = chosen.throughput >= required_throughput;
+        chosen.cached = true;
+    } else {
+        std::vector< BitCalibrationResult > results;
+        for ( const auto& candidate : candidates ) {
+            BitArchiveWriter trial{ library(), compressionFormat() };
+            if ( compressionFormat().hasFeature( FormatFeatures::MultipleMethods ) ) {
+                trial.setCompressionMethod( compressionMethod() );
+            }
+            trial.setSolidMode( solidMode() );
+            trial.setPassword( password(), cryptHeaders() );
+            try {
+                trial.setCompressionLevel( candidate.level );
+                if ( candidate.dictionary_size != 0 ) {
+                    trial.setDictionarySize( candidate.dictionary_size );
+                }
+                if ( candidate.word_size != 0 ) {
+                    trial.setWordSize( candidate.word_size );
+                }
+            } catch ( const BitException& ) {
+                continue; // The candidate is not valid for the compression method, so it is skipped.
+            }
+            trial.setThreadsCount( candidate.threads_count );
+            for ( std::size_t index = 0; index < sample.contents.size(); ++index ) {
+                trial.addFile( sample.contents[ index ], sample.names[ index ] );
+            }
+
+            buffer_t compressed;
+            const auto start = std::chrono::steady_clock::now();
+            trial.compressTo( compressed );
+            const std::chrono::duration< double > elapsed = std::chrono::steady_clock::now() - start;
+
+            BitCalibrationResult result;
+            result.parameters = candidate;
+            result.ratio = static_cast< double >( compressed.size() ) / static_cast< double >( sample.size );
+            result.throughput = static_cast< double >( sample.size ) / std::max( elapsed.count(), 1e-6 );
+            results.push_back( result );
+        }
+        if ( results.empty() ) {
+            throw BitException( "Cannot calibrate the compression parameters",
+                                std::make_error_code( std::errc::invalid_argument ) );
+        }
+        chosen = chooseCalibration( results, required_throughput );
+        if ( !options.cache_file.empty() ) {
+            storeCalibration( options.cache_file, profile, chosen );
+        }
+    }
+
+    // Note: setting the compression level resets the dictionary and word sizes, so it must be the first setter.
+    setCompressionLevel( chosen.parameters.level );
+    if ( chosen.parameters.dictionary_size != 0 ) {
+        setDictionarySize( chosen.parameters.dictionary_size );
+    }
+    if ( chosen.parameters.word_size != 0 ) {
+        setWordSize( chosen.parameters.word_size );
+    }
+    setThreadsCount( chosen.parameters.threads_count );
+    return chosen;
+}
+
 } // namespace bit7z
\ No newline at end of file
@@ -0,0 +1,41 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "bitcancellationtoken.hpp"
+
+using namespace bit7z;
+
+BitCancellationToken::BitCancellationToken() noexcept
+    : BitCancellationToken( clock::time_point::max() ) {}
+
+BitCancellationToken::BitCancellationToken( clock::time_point deadline ) noexcept
+    : mCancelled{ false }, mDeadline{ deadline.time_since_epoch().count() } {}
+
+void BitCancellationToken::cancel() noexcept {
+    mCancelled.store( true );
+}
+
+void BitCancellationToken::setDeadline( clock::time_point deadline ) noexcept {
+    mDeadline.store( deadline.time_since_epoch().count() );
+}
+
+BitCancellationToken::clock::time_point BitCancellationToken::deadline() const noexcept {
+    return clock::time_point{ clock::duration{ mDeadline.load() } };
+}
+
+bool BitCancellationToken::isCancelled() const noexcept {
+    if ( mCancelled.load( std::memory_order_relaxed ) ) {
+        return true;
+    }
+    const clock::time_point token_deadline = deadline();
+    return token_deadline != clock::time_point::max() && clock::now() >= token_deadline;
+}
@@ -0,0 +1,231 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "bitextractioncache.hpp"
+
+#include "bitexception.hpp"
+#include "internal/fs.hpp"
+#include "internal/fsutil.hpp"
+#include "internal/sha256.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <thread>
+
+using namespace bit7z;
+using namespace bit7z::filesystem;
+
+/* The cached files are spread over 256 subdirectories (by the first byte of their CRC), named "<CRC>-<size>",
+ * or "<CRC>-<size>-<SHA-256>" if their SHA-256 is part of the key. */
+inline fs::path cacheEntryPath( const tstring& store_dir, uint32_t crc, uint64_t size, const std::string& sha256 ) {
+    char crc_hex[ 9 ] = {}; // NOLINT(*-avoid-c-arrays)
+    std::snprintf( crc_hex, sizeof( crc_hex ), "%08x", static_cast< unsigned >( crc ) ); // NOLINT(*-vararg)
+    const std::string crc_string{ crc_hex };
+    std::string entry_name = crc_string + "-" + std::to_string( size );
+    if ( !sha256.empty() ) {
+        entry_name += "-" + sha256;
+    }
+    return fs::path{ store_dir } / crc_string.substr( 0, 2 ) / entry_name;
+}
+
+// The SHA-256 of a cached file is recorded in a sibling file, named as the entry followed by ".sha256".
+inline fs::path entryHashPath( const fs::path& entry_path ) {
+    fs::path result = entry_path;
+    result += ".sha256";
+    return result;
+}
+
+inline std::string readEntryHash( const fs::path& entry_path ) {
+    fs::ifstream file{ entryHashPath( entry_path ) };
+    std::string result;
+    file >> result;
+    return result;
+}
+
+// Note: entries failing the verification are removed, so that the items are inserted again once decoded.
+inline bool verifyEntry( const fs::path& entry_path ) {
+    const std::string recorded_hash = readEntryHash( entry_path );
+    if ( !recorded_hash.empty() && recorded_hash == fileSha256( entry_path ) ) {
+        return true;
+    }
+    std::error_code error;
+    fs::remove( entry_path, error );
+    fs::remove( entryHashPath( entry_path ), error );
+    return false;
+}
+
+// A name for a temporary file that does not clash with the ones of the other threads and processes.
+inline std::string temporaryEntryName() {
+    static std::atomic< uint64_t > counter{ 0 };
+    const auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+    const auto thread_hash = std::hash< std::thread::id >{}( std::this_thread::get_id() );
+    return ".tmp-" + std::to_string( thread_hash ) + "-" + std::to_string( now ) + "-" + std::to_string( counter++ );
+}
+
+// Copies the source file to the (non-existing) destination, as a reflink if possible.
+inline bool cloneOrCopyFile( const fs::path& source, const fs::path& destination ) {
+    if ( fsutil::cloneFile( source, destination ) ) {
+        return true;
+    }
+    std::error_code error;
+    return fs::copy_file( source, destination, error ) && !error;
+}
+
+BitExtractionCache::BitExtractionCache( const tstring& store_dir )
+    : mStoreDirectory{ store_dir },
+      mHardLinks{ false },
+      mHashVerification{ false },
+      mCrcOnlyKeys{ false },
+      mHits{ 0 },
+      mMisses{ 0 } {
+    std::error_code error;
+    fs::create_directories( fs::path{ store_dir }, error );
+    if ( !fs::is_directory( fs::path{ store_dir }, error ) ) {
+        throw BitException( "Failed to create the extraction cache", error ? error : last_error_code(), store_dir );
+    }
+}
+
+const tstring& BitExtractionCache::storeDirectory() const noexcept {
+    return mStoreDirectory;
+}
+
+bool BitExtractionCache::hardLinks() const noexcept {
+    return mHardLinks;
+}
+
+void BitExtractionCache::setHardLinks( bool enabled ) noexcept {
+    mHardLinks = enabled;
+}
+
+bool BitExtractionCache::hashVerification() const noexcept {
+    return mHashVerification;
+}
+
+void BitExtractionCache::setHashVerification( bool enabled ) noexcept {
+    mHashVerification = enabled;
+}
+
+bool BitExtractionCache::crcOnlyKeys() const noexcept {
+    return mCrcOnlyKeys;
+}
+
+void BitExtractionCache::setCrcOnlyKeys( bool enabled ) noexcept {
+    mCrcOnlyKeys = enabled;
+}
+
+// Note: the SHA-256 is also checked to be a digest, as it is part of the name of the entry.
+bool BitExtractionCache::acceptsKey( const std::string& sha256 ) const noexcept {
+    return sha256.empty() ? mCrcOnlyKeys.load() : isSha256Digest( sha256 );
+}
+
+bool BitExtractionCache::contains( uint32_t crc, uint64_t size ) const {
+    return contains( crc, size, std::string{} );
+}
+
+bool BitExtractionCache::contains( uint32_t crc, uint64_t size, const std::string& sha256 ) const {
+    if ( !acceptsKey( sha256 ) ) {
+        return false;
+    }
+    std::error_code error;
+    return fs::is_regular_file( cacheEntryPath( mStoreDirectory, crc, size, sha256 ), error );
+}
+
+bool BitExtractionCache::restore( uint32_t crc, uint64_t size, const tstring& out_file ) const {
+    return restore( crc, size, std::string{}, out_file );
+}
+
+// Note: the refused keys are not counted as misses, as they are never looked up in the cache.
+bool BitExtractionCache::restore( uint32_t crc,
+                                  uint64_t size,
+                                  const std::string& sha256,
+                                  const tstring& out_file ) const {
+    if ( !acceptsKey( sha256 ) ) {
+        return false;
+    }
+    const fs::path entry_path = cacheEntryPath( mStoreDirectory, crc, size, sha256 );
+    const fs::path out_path{ out_file };
+    std::error_code error;
+    bool restored = false;
+    if ( fs::is_regular_file( entry_path, error ) && ( !mHashVerification || verifyEntry( entry_path ) ) ) {
+        restored = fsutil::cloneFile( entry_path, out_path );
+        if ( !restored && mHardLinks ) {
+            fs::create_hard_link( entry_path, out_path, error );
+            restored = !error;
+        }
+        if ( !restored ) {
+            restored = fs::copy_file( entry_path, out_path, error ) && !error;
+        }
+    }
+    if ( restored ) {
+        ++mHits;
+    } else {
+        ++mMisses;
+    }
+    return restored;
+}
+
+void BitExtractionCache::insert( uint32_t crc, uint64_t size, const tstring& file ) const {
+    insert( crc, size, std::string{}, file );
+}
+
+/* Note: the file is first copied to a temporary file, which is then renamed to the entry of the cache,
+ *       so that the other extractions never see partially written entries.
+ *       The recorded hash is renamed first, so that every entry has its hash when the other extractions see it. */
+void BitExtractionCache::insert( uint32_t crc,
+                                 uint64_t size,
+                                 const std::string& sha256,
+                                 const tstring& file ) const {
+    if ( !acceptsKey( sha256 ) ) {
+        return;
+    }
+    const fs::path entry_path = cacheEntryPath( mStoreDirectory, crc, size, sha256 );
+    std::error_code error;
+    if ( fs::exists( entry_path, error ) ) {
+        return;
+    }
+    fs::create_directories( entry_path.parent_path(), error );
+    const fs::path temporary_path = entry_path.parent_path() / temporaryEntryName();
+    if ( !cloneOrCopyFile( fs::path{ file }, temporary_path ) ) {
+        fs::remove( temporary_path, error );
+        return;
+    }
+    const std::string hash = fileSha256( temporary_path );
+    if ( hash.empty() || ( !sha256.empty() && hash != sha256 ) ) { // E.g., the file is not the one of the key.
+        fs::remove( temporary_path, error );
+        return;
+    }
+    const fs::path temporary_hash_path = entry_path.parent_path() / temporaryEntryName();
+    {
+        fs::ofstream hash_file{ temporary_hash_path, std::ios::trunc };
+        hash_file << hash;
+    }
+    fs::rename( temporary_hash_path, entryHashPath( entry_path ), error );
+    if ( error ) {
+        fs::remove( temporary_hash_path, error );
+        fs::remove( temporary_path, error );
+        return;
+    }
+    fs::rename( temporary_path, entry_path, error );
+    if ( error ) { // E.g., another extraction inserted the same entry in the meantime (on Windows).
+        fs::remove( temporary_path, error );
+    }
+}
+
+uint64_t BitExtractionCache::hits() const noexcept {
+    return mHits;
+}
+
+uint64_t BitExtractionCache::misses() const noexcept {
+    return mMisses;
+}
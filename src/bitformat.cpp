@@ -35,7 +35,8 @@ namespace BitFormat {
                                    BitCompressionMethod::Lzma2,
                                    FormatFeatures::MultipleFiles | FormatFeatures::SolidArchive |
                                    FormatFeatures::CompressionLevel | FormatFeatures::Encryption |
-                                   FormatFeatures::HeaderEncryption | FormatFeatures::MultipleMethods );
+                                   FormatFeatures::HeaderEncryption | FormatFeatures::MultipleMethods |
+                                   FormatFeatures::AntiItems );
     const BitInFormat Cab( 0x08 );
     const BitInFormat Nsis( 0x09 );
     const BitInFormat Lzma( 0x0A );
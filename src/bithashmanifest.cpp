@@ -0,0 +1,92 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "bithashmanifest.hpp"
+
+#include "bitexception.hpp"
+#include "internal/fs.hpp"
+#include "internal/sha256.hpp"
+#include "internal/util.hpp"
+
+using namespace bit7z;
+
+constexpr auto kManifestHeader = "bit7z-hashes 1";
+constexpr auto kItemPrefix = "item ";
+constexpr std::size_t kDigestLength = 64;
+
+void BitHashManifest::addFile( const tstring& item_path, const tstring& file ) {
+    std::string hash = fileSha256( fs::path{ file } );
+    if ( hash.empty() ) {
+        throw BitException( "Failed to read the file to be hashed", last_error_code(), file );
+    }
+    items[ item_path ] = std::move( hash );
+}
+
+void BitHashManifest::save( const tstring& manifest_file ) const {
+    fs::ofstream manifest{ fs::path{ manifest_file }, std::ios::binary | std::ios::trunc };
+    if ( !manifest.is_open() ) {
+        throw BitException( "Failed to create the hash manifest", last_error_code(), manifest_file );
+    }
+
+    manifest << kManifestHeader << '\n';
+    for ( const auto& item : items ) {
+        manifest << kItemPrefix << item.second << ' ' << escapeLine( toUtf8( item.first ) ) << '\n';
+    }
+
+    manifest.flush();
+    if ( !manifest ) {
+        throw BitException( "Failed to write the hash manifest", std::make_error_code( std::errc::io_error ),
+                            manifest_file );
+    }
+}
+
+BitHashManifest BitHashManifest::load( const tstring& manifest_file ) {
+    fs::ifstream manifest{ fs::path{ manifest_file }, std::ios::binary };
+    if ( !manifest.is_open() ) {
+        throw BitException( "Failed to open the hash manifest", last_error_code(), manifest_file );
+    }
+
+    const auto invalid_manifest = [ &manifest_file ]() {
+        return BitException( "Invalid hash manifest", std::make_error_code( std::errc::invalid_argument ),
+                             manifest_file );
+    };
+
+    std::string line;
+    if ( !std::getline( manifest, line ) || line != kManifestHeader ) {
+        throw invalid_manifest();
+    }
+
+    BitHashManifest result;
+    const std::size_t prefix_length = std::char_traits< char >::length( kItemPrefix );
+    while ( std::getline( manifest, line ) ) {
+        if ( line.empty() ) {
+            continue;
+        }
+        // Each line is "item <SHA-256> <path>".
+        if ( line.compare( 0, prefix_length, kItemPrefix ) != 0 ||
+             line.size() <= prefix_length + kDigestLength + 1 || line[ prefix_length + kDigestLength ] != ' ' ) {
+            throw invalid_manifest();
+        }
+        std::string hash = line.substr( prefix_length, kDigestLength );
+        if ( !isSha256Digest( hash ) ) {
+            throw invalid_manifest();
+        }
+        const std::string item_path = line.substr( prefix_length + kDigestLength + 1 );
+        result.items[ fromUtf8( unescapeLine( item_path ) ) ] = std::move( hash );
+    }
+    return result;
+}
+
+std::string BitHashManifest::hashOf( const tstring& item_path ) const {
+    const auto item = items.find( item_path );
+    return item != items.end() ? item->second : std::string{};
+}
@@ -18,16 +18,24 @@
 
 #include "biterror.hpp"
 #include "bitexception.hpp"
+#include "internal/admissionguard.hpp"
 #include "internal/bufferextractcallback.hpp"
+#include "internal/carchiveinstream.hpp"
 #include "internal/cbufferinstream.hpp"
 #include "internal/cfileinstream.hpp"
 #include "internal/fileextractcallback.hpp"
 #include "internal/fixedbufferextractcallback.hpp"
+#include "internal/memoryplanner.hpp"
 #include "internal/streamextractcallback.hpp"
+#include "internal/threadslease.hpp"
 #include "internal/opencallback.hpp"
+#include "internal/tracing.hpp"
 #include "internal/util.hpp"
 #include "internal/cmultivolumeinstream.hpp"
 
+#include <algorithm>
+#include <thread>
+
 #ifdef BIT7Z_AUTO_FORMAT
 #include "internal/formatdetect.hpp"
 #endif
@@ -47,50 +55,181 @@ CMyComPtr< IInArchive > initArchiveObject( const Bit7zLibrary& lib, const GUID*
     return arc_object;
 }
 
-void extractArc( IInArchive* in_archive, const vector< uint32_t >& indices, ExtractCallback* extract_callback ) {
+// The memory with which an operation on the given archive is admitted by the handler's admission controller.
+inline uint64_t admissionMemory( const BitInputArchive& input_archive ) {
+    return input_archive.handler().admissionController() != nullptr ? input_archive.memoryEstimate().memory_usage : 0;
+}
+
+/* Sets the number of threads of the archive's decoders, if the format supports it (e.g., 7z and xz);
+ * 0 means the default of 7-zip, i.e., the number of CPU cores.
+ * Note: the property stays set in the opened archive, so it is set by every operation, even by the ones without
+ *       a thread governor, which would otherwise inherit the threads granted to a previous operation. */
+inline void setDecodingThreads( IInArchive* in_archive, uint32_t threads_count ) {
+    if ( threads_count == 0 ) {
+        // Note: querying the CPU cores is not free (e.g., glibc reads them from /sys), so they are queried only once.
+        static const uint32_t cpu_cores = std::max( std::thread::hardware_concurrency(), 1u );
+        threads_count = cpu_cores;
+    }
+    CMyComPtr< ISetProperties > set_properties;
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    if ( in_archive->QueryInterface( ::IID_ISetProperties, reinterpret_cast< void** >( &set_properties ) ) != S_OK ) {
+        return;
+    }
+    const wchar_t* name = L"mt";
+    const BitPropVariant value{ threads_count };
+    // Note: formats without multithreaded decoders might reject the property, but they are single-threaded anyway.
+    set_properties->SetProperties( &name, &value, 1 );
+}
+
+// Extracts the items, returning the result of the archive's Extract method (i.e., without throwing on failures).
+HRESULT extractItems( IInArchive* in_archive,
+                      CArchiveInStream* archive_stream,
+                      const vector< uint32_t >& indices,
+                      ExtractCallback* extract_callback,
+                      uint32_t threads_count ) {
+    setDecodingThreads( in_archive, threads_count );
     const uint32_t* item_indices = indices.empty() ? nullptr : indices.data();
     const uint32_t num_items = indices.empty() ?
                                std::numeric_limits< uint32_t >::max() : static_cast< uint32_t >( indices.size() );
 
+    MetricsRecorder* metrics = extract_callback->metrics();
+    if ( metrics != nullptr ) {
+        metrics->attachArchiveStream( archive_stream );
+    }
+    archive_stream->setCancellation( &extract_callback->cancellation() );
+    BIT7Z_TRACE( extract_callback->traceRecorder(), begin, "extract", num_items );
     const HRESULT res = in_archive->Extract( item_indices, num_items, NExtract::NAskMode::kExtract, extract_callback );
+    BIT7Z_TRACE( extract_callback->traceRecorder(), end, "extract", static_cast< uint32_t >( res ) );
+    archive_stream->setCancellation( nullptr );
+    if ( metrics != nullptr ) {
+        metrics->finish( BitOperation::Extract );
+    }
+    extract_callback->flushProgress();
+    if ( res == E_ABORT && extract_callback->cancellation().isCancelled() ) {
+        extract_callback->discardPartialOutput();
+    }
+    return res;
+}
+
+// Throws the exception stored by the callback of the failed operation, if any, or else a generic one.
+inline void throwOperationError( HRESULT res, const ExtractCallback* extract_callback, const char* message ) {
+    const auto& errorException = extract_callback->errorException();
+    if ( errorException ) {
+        std::rethrow_exception( errorException );
+    }
+    throw BitException( message, make_hresult_code( res ) );
+}
+
+// Converts the result of a failed operation to an error code, without rethrowing the exception stored by the callback.
+inline std::error_code operationErrorCode( HRESULT res, const ExtractCallback* extract_callback ) {
+    return extract_callback->errorCode() ? extract_callback->errorCode() : make_hresult_code( res );
+}
+
+void extractArc( IInArchive* in_archive,
+                 CArchiveInStream* archive_stream,
+                 const vector< uint32_t >& indices,
+                 ExtractCallback* extract_callback,
+                 uint32_t threads_count ) {
+    const HRESULT res = extractItems( in_archive,
+                                      archive_stream,
+                                      indices,
+                                      extract_callback,
+                                      threads_count );
     if ( res != S_OK ) {
-        const auto& errorException = extract_callback->errorException();
-        if ( errorException ) {
-            std::rethrow_exception( errorException );
-        } else {
-            throw BitException( "Could not extract the archive", make_hresult_code( res ) );
-        }
+        throwOperationError( res, extract_callback, "Could not extract the archive" );
     }
 }
 
-void testArc( IInArchive* in_archive, ExtractCallback* extract_callback ) {
+// Tests the items, returning the result of the archive's Extract method (i.e., without throwing on failures).
+HRESULT testItems( IInArchive* in_archive,
+                   CArchiveInStream* archive_stream,
+                   ExtractCallback* extract_callback,
+                   uint32_t threads_count ) {
+    setDecodingThreads( in_archive, threads_count );
+    MetricsRecorder* metrics = extract_callback->metrics();
+    if ( metrics != nullptr ) {
+        metrics->attachArchiveStream( archive_stream );
+    }
+    archive_stream->setCancellation( &extract_callback->cancellation() );
+    BIT7Z_TRACE( extract_callback->traceRecorder(), begin, "test", 0 );
     const HRESULT res = in_archive->Extract( nullptr,
                                              static_cast< uint32_t >( -1 ),
                                              NExtract::NAskMode::kTest,
                                              extract_callback );
+    BIT7Z_TRACE( extract_callback->traceRecorder(), end, "test", static_cast< uint32_t >( res ) );
+    archive_stream->setCancellation( nullptr );
+    if ( metrics != nullptr ) {
+        metrics->finish( BitOperation::Test );
+    }
+    extract_callback->flushProgress();
+    return res;
+}
+
+void testArc( IInArchive* in_archive,
+              CArchiveInStream* archive_stream,
+              ExtractCallback* extract_callback,
+              uint32_t threads_count ) {
+    const HRESULT res = testItems( in_archive, archive_stream, extract_callback, threads_count );
     if ( res != S_OK ) {
-        const auto& errorException = extract_callback->errorException();
-        if ( errorException ) {
-            std::rethrow_exception( errorException );
-        } else {
-            throw BitException( "Could not test the archive", make_hresult_code( res ) );
+        throwOperationError( res, extract_callback, "Could not test the archive" );
+    }
+}
+
+/* Runs an operation that reports its failure as an error code (or as the error of its first failed item),
+ * converting any exception thrown into an error code too. */
+template< typename Operation >
+void runWithErrorCode( const FailedItems& failed_items, std::error_code& error, Operation&& operation ) noexcept {
+    error.clear();
+    const auto failed_items_count = failed_items.size();
+    try {
+        error = operation();
+    } catch ( const std::system_error& ex ) {
+        error = ex.code();
+    } catch ( const std::exception& ) {
+        error = make_error_code( BitError::Fail );
+    }
+    if ( !error && failed_items.size() > failed_items_count ) {
+        error = failed_items[ failed_items_count ].second;
+    }
+}
+
+IInArchive* BitInputArchive::openArchiveStream( const fs::path& name, IInStream* archive_stream ) {
+    std::error_code error;
+    IInArchive* in_archive = openArchiveStream( name, archive_stream, error );
+    if ( in_archive == nullptr ) {
+        if ( error == BitError::NoMatchingSignature ) {
+            throw BitException( "Failed to detect the format of the file", error );
         }
+        throw BitException( "Failed to open the archive", error, name.string< tchar >() );
     }
+    return in_archive;
 }
 
-IInArchive* BitInputArchive::openArchiveStream( const fs::path& name, IInStream* in_stream ) {
+IInArchive* BitInputArchive::openArchiveStream( const fs::path& name,
+                                                IInStream* archive_stream,
+                                                std::error_code& error ) {
+    /* The archive stream is always wrapped, as its metrics and cancellation can be enabled for each operation
+     * after opening it. When they are not enabled, the wrapper simply forwards the calls to the original stream. */
+    BIT7Z_PROBE( archive_open_start );
+    BIT7Z_TRACE( mArchiveHandler.traceRecorder(), begin, "open", 0 );
+
+    CMyComPtr< CArchiveInStream > wrapped_stream = bit7z::make_com< CArchiveInStream >( archive_stream );
+    IInStream* in_stream = wrapped_stream;
 #ifdef BIT7Z_AUTO_FORMAT
     bool detected_by_signature = false;
     if ( *mDetectedFormat == BitFormat::Auto ) {
         // Detecting the format of the input file
-        mDetectedFormat = &( detectFormatFromSig( in_stream ) );
+        mDetectedFormat = &( detectFormatFromSig( in_stream, error ) );
+        if ( error ) {
+            return nullptr;
+        }
         detected_by_signature = true;
     }
     GUID format_GUID = formatGUID( *mDetectedFormat );
 #else
     GUID format_GUID = formatGUID( mArchiveHandler.format() );
 #endif
-    // NOTE: CMyComPtr is still needed: if an error occurs, and an exception is thrown,
+    // NOTE: CMyComPtr is still needed: if an error occurs, and an exception is thrown (or nullptr is returned),
     // the IInArchive object is deleted automatically!
     CMyComPtr< IInArchive > in_archive = initArchiveObject( mArchiveHandler.library(), &format_GUID );
 
@@ -108,17 +247,24 @@ IInArchive* BitInputArchive::openArchiveStream( const fs::path& name, IInStream*
          *       and an exception is thrown (next if)!
          * NOTE 2: If signature detection was already performed (detected_by_signature == false), it detected
          *         a wrong format, no further check can be done, and an exception must be thrown (next if)! */
-        mDetectedFormat = &( detectFormatFromSig( in_stream ) );
+        mDetectedFormat = &( detectFormatFromSig( in_stream, error ) );
+        if ( error ) {
+            return nullptr;
+        }
         format_GUID = formatGUID( *mDetectedFormat );
         in_archive = initArchiveObject( mArchiveHandler.library(), &format_GUID );
         res = in_archive->Open( in_stream, nullptr, open_callback );
     }
 #endif
 
+    BIT7Z_PROBE1( archive_open_done, res );
+    BIT7Z_TRACE( mArchiveHandler.traceRecorder(), end, "open", static_cast< uint32_t >( res ) );
     if ( res != S_OK ) {
-        throw BitException( "Failed to open the archive", make_hresult_code( res ), name.string< tchar >() );
+        error = make_hresult_code( res );
+        return nullptr;
     }
 
+    mArchiveStream = wrapped_stream.Detach();
     return in_archive.Detach();
 }
 
@@ -133,10 +279,12 @@ BitInputArchive::BitInputArchive( const BitAbstractArchiveHandler& handler, cons
 
 #if defined( _WIN32 ) && defined( BIT7Z_AUTO_PREFIX_LONG_PATHS )
 BitInputArchive::BitInputArchive( const BitAbstractArchiveHandler& handler, fs::path arc_path )
-    : mDetectedFormat{ nullptr },
+    : mArchiveStream{ nullptr },
+      mDetectedFormat{ nullptr },
 #else
 BitInputArchive::BitInputArchive( const BitAbstractArchiveHandler& handler, const fs::path& arc_path )
-    : mDetectedFormat{ DETECT_FORMAT( handler.format(), arc_path ) },
+    : mArchiveStream{ nullptr },
+      mDetectedFormat{ DETECT_FORMAT( handler.format(), arc_path ) },
 #endif
       mArchiveHandler{ handler },
       mArchivePath{ arc_path.string< tchar >() } {
@@ -157,19 +305,96 @@ BitInputArchive::BitInputArchive( const BitAbstractArchiveHandler& handler, cons
 }
 
 BitInputArchive::BitInputArchive( const BitAbstractArchiveHandler& handler, const std::vector< byte_t >& in_buffer )
-    : mDetectedFormat{ &handler.format() }, // if auto, detect the format from content, otherwise try the passed format.
+    : mArchiveStream{ nullptr },
+      mDetectedFormat{ &handler.format() }, // if auto, detect the format from content, otherwise try the passed format.
       mArchiveHandler{ handler } {
     auto buf_stream = bit7z::make_com< CBufferInStream, IInStream >( in_buffer );
     mInArchive = openArchiveStream( BIT7Z_STRING( "." ), buf_stream );
 }
 
 BitInputArchive::BitInputArchive( const BitAbstractArchiveHandler& handler, std::istream& in_stream )
-    : mDetectedFormat{ &handler.format() }, // if auto, detect the format from content, otherwise try the passed format.
+    : mArchiveStream{ nullptr },
+      mDetectedFormat{ &handler.format() }, // if auto, detect the format from content, otherwise try the passed format.
       mArchiveHandler{ handler } {
     auto std_stream = bit7z::make_com< CStdInStream, IInStream >( in_stream );
     mInArchive = openArchiveStream( BIT7Z_STRING( "." ), std_stream );
 }
 
+BitInputArchive::BitInputArchive( const BitAbstractArchiveHandler& handler,
+                                  const tstring& in_file,
+                                  std::error_code& error )
+    : mInArchive{ nullptr },
+      mArchiveStream{ nullptr },
+      mDetectedFormat{ &handler.format() },
+      mArchiveHandler{ handler },
+      mArchivePath{ in_file } {
+    fs::path arc_path{ in_file };
+#if defined( _WIN32 ) && defined( BIT7Z_AUTO_PREFIX_LONG_PATHS )
+    if ( filesystem::fsutil::should_format_long_path( arc_path ) ) {
+        arc_path = filesystem::fsutil::format_long_path( arc_path );
+    }
+#endif
+#ifdef BIT7Z_AUTO_FORMAT
+    if ( *mDetectedFormat == BitFormat::Auto ) {
+        // Note: if the extension is not known, the format is detected from the signature when opening the archive.
+        std::error_code extension_error;
+        mDetectedFormat = &detectFormatFromExt( arc_path, extension_error );
+    }
+#endif
+
+    CMyComPtr< IInStream > file_stream;
+    if ( *mDetectedFormat != BitFormat::Split && arc_path.extension() == ".001" ) {
+        file_stream = bit7z::make_com< CMultiVolumeInStream, IInStream >( arc_path );
+    } else {
+        file_stream = bit7z::make_com< CFileInStream, IInStream >( arc_path, error );
+        if ( error ) {
+            return;
+        }
+    }
+    mInArchive = openArchiveStream( arc_path, file_stream, error );
+}
+
+BitInputArchive::BitInputArchive( const BitAbstractArchiveHandler& handler,
+                                  const std::vector< byte_t >& in_buffer,
+                                  std::error_code& error )
+    : mInArchive{ nullptr },
+      mArchiveStream{ nullptr },
+      mDetectedFormat{ &handler.format() },
+      mArchiveHandler{ handler } {
+    auto buf_stream = bit7z::make_com< CBufferInStream, IInStream >( in_buffer );
+    mInArchive = openArchiveStream( BIT7Z_STRING( "." ), buf_stream, error );
+}
+
+/* Note: the archive is constructed with new, since the constructors opening the archive without throwing
+ *       are not public (so they cannot be used by std::make_unique). */
+std::unique_ptr< BitInputArchive > BitInputArchive::tryOpen( const BitAbstractArchiveHandler& handler,
+                                                             const tstring& in_file,
+                                                             std::error_code& error ) noexcept try {
+    error.clear();
+    std::unique_ptr< BitInputArchive > archive{ new BitInputArchive( handler, in_file, error ) };
+    return error ? nullptr : std::move( archive );
+} catch ( const std::system_error& ex ) {
+    error = ex.code();
+    return nullptr;
+} catch ( const std::exception& ) {
+    error = make_error_code( BitError::Fail );
+    return nullptr;
+}
+
+std::unique_ptr< BitInputArchive > BitInputArchive::tryOpen( const BitAbstractArchiveHandler& handler,
+                                                             const std::vector< byte_t >& in_buffer,
+                                                             std::error_code& error ) noexcept try {
+    error.clear();
+    std::unique_ptr< BitInputArchive > archive{ new BitInputArchive( handler, in_buffer, error ) };
+    return error ? nullptr : std::move( archive );
+} catch ( const std::system_error& ex ) {
+    error = ex.code();
+    return nullptr;
+} catch ( const std::exception& ) {
+    error = make_error_code( BitError::Fail );
+    return nullptr;
+}
+
 BitPropVariant BitInputArchive::archiveProperty( BitProperty property ) const {
     BitPropVariant archive_property;
     const HRESULT res = mInArchive->GetArchiveProperty( static_cast<PROPID>( property ), &archive_property );
@@ -208,6 +433,109 @@ bool BitInputArchive::isItemEncrypted( uint32_t index ) const {
     return is_item_encrypted.isBool() && is_item_encrypted.getBool();
 }
 
+/* Note: the same variants and path buffer are reused for all the items; the view points to the path buffer
+ *       (or, with native strings on Windows, directly to the BSTR returned by the archive handler). */
+void BitInputArchive::visitItems( BitItemField fields, const BitItemVisitor& visitor ) const {
+    BitPropVariant path_property;
+    BitPropVariant property;
+#if !defined( _WIN32 ) || !defined( BIT7Z_USE_NATIVE_STRING )
+    std::string path_buffer;
+#endif
+    const auto load_property = [ this ]( uint32_t index, BitProperty item_property, BitPropVariant& value ) {
+        value.clear();
+        const HRESULT res = mInArchive->GetProperty( index, static_cast< PROPID >( item_property ), &value );
+        if ( res != S_OK ) {
+            throw BitException( "Could not retrieve property for item at the index " + std::to_string( index ),
+                                make_hresult_code( res ) );
+        }
+    };
+
+    const uint32_t items_count = itemsCount();
+    for ( uint32_t index = 0; index < items_count; ++index ) {
+        BitItemView item_view;
+        item_view.index = index;
+
+        if ( ( fields & BitItemField::Path ) != 0 ) {
+            load_property( index, BitProperty::Path, path_property );
+            if ( path_property.isString() && path_property.bstrVal != nullptr ) {
+                const auto path_size = static_cast< std::size_t >( ::SysStringLen( path_property.bstrVal ) );
+#if defined( _WIN32 ) && defined( BIT7Z_USE_NATIVE_STRING )
+                item_view.path = path_property.bstrVal;
+                item_view.path_size = path_size;
+#else
+                narrowInto( path_property.bstrVal, path_size, path_buffer );
+                item_view.path = path_buffer.c_str();
+                item_view.path_size = path_buffer.size();
+#endif
+            }
+        }
+        if ( ( fields & BitItemField::IsDir ) != 0 ) {
+            load_property( index, BitProperty::IsDir, property );
+            item_view.is_dir = property.isBool() && property.getBool();
+        }
+        if ( ( fields & BitItemField::Size ) != 0 ) {
+            load_property( index, BitProperty::Size, property );
+            item_view.size = property.isEmpty() ? 0 : property.getUInt64();
+        }
+        if ( ( fields & BitItemField::PackSize ) != 0 ) {
+            load_property( index, BitProperty::PackSize, property );
+            item_view.pack_size = property.isEmpty() ? 0 : property.getUInt64();
+        }
+        if ( ( fields & BitItemField::Crc ) != 0 ) {
+            load_property( index, BitProperty::CRC, property );
+            item_view.has_crc = property.isUInt32();
+            item_view.crc = item_view.has_crc ? property.getUInt32() : 0;
+        }
+        if ( ( fields & BitItemField::Attributes ) != 0 ) {
+            load_property( index, BitProperty::Attrib, property );
+            item_view.attributes = property.isUInt32() ? property.getUInt32() : 0;
+        }
+        if ( ( fields & BitItemField::LastWriteTime ) != 0 ) {
+            load_property( index, BitProperty::MTime, property );
+            if ( property.isFileTime() ) {
+                item_view.last_write_time = property.getTimePoint();
+            }
+        }
+        if ( ( fields & BitItemField::IsEncrypted ) != 0 ) {
+            load_property( index, BitProperty::Encrypted, property );
+            item_view.is_encrypted = property.isBool() && property.getBool();
+        }
+        visitor( item_view );
+    }
+}
+
+/* Note: the items of solid archives usually share the same Method property, so it is parsed only when it changes
+ *       from the one of the previous item. */
+BitMemoryEstimate BitInputArchive::memoryEstimate() const {
+    if ( !mHasDecodingEstimate ) {
+        mDecodingEstimate.threads_count = 1;
+        mDecodingEstimate.memory_usage = decodingMemoryUsage( {}, mDecodingEstimate.dictionary_size );
+        tstring previous_methods;
+        const uint32_t items_count = itemsCount();
+        for ( uint32_t index = 0; index < items_count; ++index ) {
+            const BitPropVariant methods = itemProperty( index, BitProperty::Method );
+            if ( !methods.isString() || methods.getString() == previous_methods ) {
+                continue;
+            }
+            previous_methods = methods.getString();
+            uint32_t dictionary_size = 0;
+            mDecodingEstimate.memory_usage = std::max( mDecodingEstimate.memory_usage,
+                                                       decodingMemoryUsage( previous_methods, dictionary_size ) );
+            mDecodingEstimate.dictionary_size = std::max( mDecodingEstimate.dictionary_size, dictionary_size );
+        }
+        mHasDecodingEstimate = true;
+    }
+
+    // Note: the admission controller of the handler may change between the operations, so the budget is not cached.
+    BitMemoryEstimate estimate = mDecodingEstimate;
+    const BitAdmissionController* controller = mArchiveHandler.admissionController();
+    if ( controller != nullptr ) {
+        estimate.memory_budget = controller->memoryBudget();
+        estimate.fits = estimate.memory_usage <= estimate.memory_budget;
+    }
+    return estimate;
+}
+
 HRESULT BitInputArchive::initUpdatableArchive( IOutArchive** newArc ) const {
     // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
     return mInArchive->QueryInterface( ::IID_IOutArchive, reinterpret_cast< void** >( newArc ) );
@@ -231,9 +559,44 @@ const BitAbstractArchiveHandler& BitInputArchive::handler() const noexcept {
     return mArchiveHandler;
 }
 
+HRESULT BitInputArchive::extractToDirectory( FileExtractCallback* callback,
+                                             const std::vector< uint32_t >& indices ) const {
+    const bool uses_cache = mArchiveHandler.extractionCache() != nullptr;
+    std::vector< uint32_t > uncached_indices;
+    if ( uses_cache ) {
+        // The items restored from the extraction cache are not requested from the decoder at all.
+        uncached_indices = callback->restoreCachedItems( indices );
+        if ( uncached_indices.empty() ) {
+            return S_OK;
+        }
+    }
+    const AdmissionGuard admission{ mArchiveHandler.admissionController(), admissionMemory( *this ) };
+    const ThreadsLease threads{ mArchiveHandler.threadGovernor(), 0 };
+    return extractItems( mInArchive,
+                         mArchiveStream,
+                         uses_cache ? uncached_indices : indices,
+                         callback,
+                         threads.threads() );
+}
+
 void BitInputArchive::extract( const tstring& out_dir, const std::vector< uint32_t >& indices ) const {
-    auto callback = bit7z::make_com< FileExtractCallback, ExtractCallback >( *this, out_dir );
-    extractArc( mInArchive, indices, callback );
+    auto callback = bit7z::make_com< FileExtractCallback >( *this, out_dir );
+    const HRESULT res = extractToDirectory( callback, indices );
+    if ( res != S_OK ) {
+        throwOperationError( res, callback, "Could not extract the archive" );
+    }
+}
+
+void BitInputArchive::extract( const tstring& out_dir,
+                               const std::vector< uint32_t >& indices,
+                               FailedItems& failed_items,
+                               std::error_code& error ) const noexcept {
+    runWithErrorCode( failed_items, error, [ & ]() -> std::error_code {
+        auto callback = bit7z::make_com< FileExtractCallback >( *this, out_dir );
+        callback->setFailedItems( &failed_items );
+        const HRESULT res = extractToDirectory( callback, indices );
+        return res != S_OK ? operationErrorCode( res, callback ) : std::error_code{};
+    } );
 }
 
 void BitInputArchive::extract( std::vector< byte_t >& out_buffer, uint32_t index ) const {
@@ -251,7 +614,9 @@ void BitInputArchive::extract( std::vector< byte_t >& out_buffer, uint32_t index
     const vector< uint32_t > indices( 1, index );
     map< tstring, vector< byte_t > > buffers_map;
     auto extract_callback = bit7z::make_com< BufferExtractCallback, ExtractCallback >( *this, buffers_map );
-    extractArc( mInArchive, indices, extract_callback );
+    const AdmissionGuard admission{ mArchiveHandler.admissionController(), admissionMemory( *this ) };
+    const ThreadsLease threads{ mArchiveHandler.threadGovernor(), 0 };
+    extractArc( mInArchive, mArchiveStream, indices, extract_callback, threads.threads() );
     out_buffer = std::move( buffers_map.begin()->second );
 }
 
@@ -269,7 +634,9 @@ void BitInputArchive::extract( std::ostream& out_stream, uint32_t index ) const
 
     const vector< uint32_t > indices( 1, index );
     auto extract_callback = bit7z::make_com< StreamExtractCallback, ExtractCallback >( *this, out_stream );
-    extractArc( mInArchive, indices, extract_callback );
+    const AdmissionGuard admission{ mArchiveHandler.admissionController(), admissionMemory( *this ) };
+    const ThreadsLease threads{ mArchiveHandler.threadGovernor(), 0 };
+    extractArc( mInArchive, mArchiveStream, indices, extract_callback, threads.threads() );
 }
 
 void BitInputArchive::extract( byte_t* buffer, std::size_t size, uint32_t index ) const {
@@ -292,7 +659,9 @@ void BitInputArchive::extract( byte_t* buffer, std::size_t size, uint32_t index
 
     const vector< uint32_t > indices( 1, index );
     auto extract_callback = bit7z::make_com< FixedBufferExtractCallback, ExtractCallback >( *this, buffer, size );
-    extractArc( mInArchive, indices, extract_callback );
+    const AdmissionGuard admission{ mArchiveHandler.admissionController(), admissionMemory( *this ) };
+    const ThreadsLease threads{ mArchiveHandler.threadGovernor(), 0 };
+    extractArc( mInArchive, mArchiveStream, indices, extract_callback, threads.threads() );
 }
 
 void BitInputArchive::extract( std::map< tstring, std::vector< byte_t > >& out_map ) const {
@@ -305,24 +674,53 @@ void BitInputArchive::extract( std::map< tstring, std::vector< byte_t > >& out_m
     }
 
     auto extract_callback = bit7z::make_com< BufferExtractCallback, ExtractCallback >( *this, out_map );
-    extractArc( mInArchive, files_indices, extract_callback );
+    const AdmissionGuard admission{ mArchiveHandler.admissionController(), admissionMemory( *this ) };
+    const ThreadsLease threads{ mArchiveHandler.threadGovernor(), 0 };
+    extractArc( mInArchive, mArchiveStream, files_indices, extract_callback, threads.threads() );
 }
 
 void BitInputArchive::test() const {
     map< tstring, vector< byte_t > > dummy_map; //output map (not used since we are testing!)
     auto extract_callback = bit7z::make_com< BufferExtractCallback, ExtractCallback >( *this, dummy_map );
-    testArc( mInArchive, extract_callback );
+    const AdmissionGuard admission{ mArchiveHandler.admissionController(), admissionMemory( *this ) };
+    const ThreadsLease threads{ mArchiveHandler.threadGovernor(), 0 };
+    testArc( mInArchive, mArchiveStream, extract_callback, threads.threads() );
+}
+
+void BitInputArchive::test( FailedItems& failed_items, std::error_code& error ) const noexcept {
+    runWithErrorCode( failed_items, error, [ & ]() -> std::error_code {
+        map< tstring, vector< byte_t > > dummy_map; //output map (not used since we are testing!)
+        auto extract_callback = bit7z::make_com< BufferExtractCallback, ExtractCallback >( *this, dummy_map );
+        extract_callback->setFailedItems( &failed_items );
+        const AdmissionGuard admission{ mArchiveHandler.admissionController(), admissionMemory( *this ) };
+        const ThreadsLease threads{ mArchiveHandler.threadGovernor(), 0 };
+        const HRESULT res = testItems( mInArchive, mArchiveStream, extract_callback,
+                                       threads.threads() );
+        return res != S_OK ? operationErrorCode( res, extract_callback ) : std::error_code{};
+    } );
 }
 
 HRESULT BitInputArchive::close() const noexcept {
-    return mInArchive->Close();
+    BIT7Z_PROBE( archive_close );
+    BIT7Z_TRACE( mArchiveHandler.traceRecorder(), instant, "close", 0 );
+    const HRESULT res = mInArchive->Close();
+    if ( mArchiveStream != nullptr ) {
+        // The wrapped archive stream must be released too, so that the archive file is actually closed.
+        mArchiveStream->releaseStream();
+    }
+    return res;
 }
 
 BitInputArchive::~BitInputArchive() {
     if ( mInArchive != nullptr ) {
+        BIT7Z_PROBE( archive_close );
+        BIT7Z_TRACE( mArchiveHandler.traceRecorder(), instant, "close", 0 );
         mInArchive->Close();
         mInArchive->Release();
     }
+    if ( mArchiveStream != nullptr ) {
+        mArchiveStream->Release();
+    }
 }
 
 BitInputArchive::const_iterator BitInputArchive::begin() const noexcept {
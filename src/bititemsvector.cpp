@@ -15,11 +15,16 @@
 #include "bitexception.hpp"
 #include "internal/bufferitem.hpp"
 #include "internal/fsindexer.hpp"
+#include "internal/fsitemtable.hpp"
 #include "internal/stdinputitem.hpp"
 
+#include <limits>
+
 using namespace bit7z;
 using filesystem::FSItem;
 using filesystem::FSIndexer;
+using filesystem::FSItemTable;
+using filesystem::FSTableItem;
 
 void BitItemsVector::indexDirectory( const fs::path& in_dir, const tstring& filter, IndexingOptions options ) {
     //Note: if in_dir is an invalid path, FSItem constructor throws a BitException!
@@ -27,8 +32,7 @@ void BitItemsVector::indexDirectory( const fs::path& in_dir, const tstring& filt
     if ( filter.empty() && !dir_item.inArchivePath().empty() ) {
         mItems.emplace_back( std::make_unique< FSItem >( dir_item ) );
     }
-    FSIndexer indexer{ dir_item, filter, options.only_files };
-    indexer.listDirectoryItems( mItems, options.recursive );
+    indexDirectoryContent( dir_item, filter, options );
 }
 
 void BitItemsVector::indexPaths( const std::vector< tstring >& in_paths, IndexingOptions options ) {
@@ -52,8 +56,7 @@ void BitItemsVector::indexItem( const FSItem& item, IndexingOptions options ) {
         if ( !item.inArchivePath().empty() ) {
             mItems.emplace_back( std::make_unique< FSItem >( item ) );
         }
-        FSIndexer indexer{ item, {}, options.only_files };
-        indexer.listDirectoryItems( mItems, true );
+        indexDirectoryContent( item, {}, options );
     } else {
         // No action needed
     }
@@ -75,6 +78,24 @@ void BitItemsVector::indexStream( std::istream& in_stream, const tstring& name )
     mItems.emplace_back( std::make_unique< StdInputItem >( in_stream, name ) );
 }
 
+void BitItemsVector::indexDirectoryContent( const FSItem& dir_item, const tstring& filter, IndexingOptions options ) {
+    if ( !mTable ) {
+        mTable = std::make_shared< FSItemTable >();
+    }
+    const std::size_t first_index = mTable->size();
+    FSIndexer indexer{ dir_item, filter, options.only_files };
+    indexer.listDirectoryItems( *mTable, options.recursive );
+
+    if ( static_cast< uint64_t >( mTable->size() ) > std::numeric_limits< uint32_t >::max() ) {
+        throw BitException( "Cannot index the items", std::make_error_code( std::errc::value_too_large ) );
+    }
+    // Each view has only the index of the item (and a pointer to the table), which stores all the item's data.
+    mItems.reserve( mItems.size() + ( mTable->size() - first_index ) );
+    for ( auto index = first_index; index < mTable->size(); ++index ) {
+        mItems.push_back( std::make_unique< FSTableItem >( *mTable, static_cast< uint32_t >( index ) ) );
+    }
+}
+
 size_t BitItemsVector::size() const {
     return mItems.size();
 }
@@ -0,0 +1,183 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "bitmetrics.hpp"
+
+#include <iomanip>
+#include <limits>
+#include <locale>
+#include <sstream>
+
+using namespace bit7z;
+
+constexpr std::size_t BitLatencyHistogram::kBucketsCount;
+
+// Upper bound of the first bucket of the latency histograms, i.e., 1 microsecond.
+constexpr uint64_t kFirstBucketBoundNs = 1000;
+
+void BitLatencyHistogram::record( uint64_t latency_ns ) noexcept {
+    std::size_t bucket = 0;
+    uint64_t bound = kFirstBucketBoundNs;
+    while ( bucket < kBucketsCount - 1 && latency_ns > bound ) {
+        bound *= 4;
+        ++bucket;
+    }
+    ++mBuckets[ bucket ];
+    ++mCount;
+    mSum += latency_ns;
+    if ( latency_ns > mMax ) {
+        mMax = latency_ns;
+    }
+}
+
+uint64_t BitLatencyHistogram::bucketUpperBound( std::size_t bucket ) noexcept {
+    if ( bucket >= kBucketsCount - 1 ) {
+        return ( std::numeric_limits< uint64_t >::max )();
+    }
+    return kFirstBucketBoundNs << ( 2 * bucket );
+}
+
+uint64_t BitLatencyHistogram::bucketCount( std::size_t bucket ) const noexcept {
+    return bucket < kBucketsCount ? mBuckets[ bucket ] : 0;
+}
+
+uint64_t BitLatencyHistogram::count() const noexcept {
+    return mCount;
+}
+
+uint64_t BitLatencyHistogram::sum() const noexcept {
+    return mSum;
+}
+
+uint64_t BitLatencyHistogram::max() const noexcept {
+    return mMax;
+}
+
+uint64_t BitOperationMetrics::ioTimeNs() const noexcept {
+    return archive_stream.io_time_ns + item_streams.io_time_ns;
+}
+
+uint64_t BitOperationMetrics::codecTimeNs() const noexcept {
+    const uint64_t io_time = ioTimeNs();
+    return total_time_ns > io_time ? total_time_ns - io_time : 0;
+}
+
+inline const char* operationName( BitOperation operation ) {
+    switch ( operation ) {
+        case BitOperation::Test:
+            return "test";
+        case BitOperation::Compress:
+            return "compress";
+        case BitOperation::Extract:
+        default:
+            return "extract";
+    }
+}
+
+inline double toSeconds( uint64_t nanoseconds ) {
+    return static_cast< double >( nanoseconds ) / 1e9;
+}
+
+class PrometheusWriter {
+    public:
+        PrometheusWriter( const std::string& prefix, BitOperation operation )
+            : mPrefix{ prefix }, mOperationLabel{ std::string{ "operation=\"" } + operationName( operation ) + "\"" } {
+            mOutput.imbue( std::locale::classic() );
+            mOutput << std::setprecision( 12 );
+        }
+
+        void family( const char* name, const char* type, const char* help ) {
+            mOutput << "# HELP " << mPrefix << '_' << name << ' ' << help << '\n';
+            mOutput << "# TYPE " << mPrefix << '_' << name << ' ' << type << '\n';
+        }
+
+        template< typename T >
+        void sample( const std::string& name, T value, const std::string& labels = {} ) {
+            mOutput << mPrefix << '_' << name << '{' << mOperationLabel;
+            if ( !labels.empty() ) {
+                mOutput << ',' << labels;
+            }
+            mOutput << "} " << value << '\n';
+        }
+
+        void streamSamples( const char* name, uint64_t archive_value, uint64_t items_value ) {
+            sample( name, archive_value, "stream=\"archive\"" );
+            sample( name, items_value, "stream=\"items\"" );
+        }
+
+        void streamSamples( const char* name, double archive_value, double items_value ) {
+            sample( name, archive_value, "stream=\"archive\"" );
+            sample( name, items_value, "stream=\"items\"" );
+        }
+
+        std::string str() const {
+            return mOutput.str();
+        }
+
+    private:
+        const std::string& mPrefix;
+        std::string mOperationLabel;
+        std::ostringstream mOutput;
+};
+
+std::string bit7z::toPrometheus( const BitOperationMetrics& metrics, const std::string& prefix ) {
+    const auto& archive = metrics.archive_stream;
+    const auto& items = metrics.item_streams;
+
+    PrometheusWriter writer{ prefix, metrics.operation };
+    writer.family( "operation_duration_seconds", "gauge", "Wall-clock duration of the operation." );
+    writer.sample( "operation_duration_seconds", toSeconds( metrics.total_time_ns ) );
+    writer.family( "io_time_seconds", "gauge", "Time spent in I/O calls on the archive and items streams." );
+    writer.sample( "io_time_seconds", toSeconds( metrics.ioTimeNs() ) );
+    writer.family( "codec_time_seconds", "gauge", "Time spent outside the I/O calls." );
+    writer.sample( "codec_time_seconds", toSeconds( metrics.codecTimeNs() ) );
+
+    writer.family( "stream_bytes_read_total", "counter", "Bytes read from the streams." );
+    writer.streamSamples( "stream_bytes_read_total", archive.bytes_read, items.bytes_read );
+    writer.family( "stream_bytes_written_total", "counter", "Bytes written to the streams." );
+    writer.streamSamples( "stream_bytes_written_total", archive.bytes_written, items.bytes_written );
+    writer.family( "stream_read_calls_total", "counter", "Read calls made on the streams." );
+    writer.streamSamples( "stream_read_calls_total", archive.read_calls, items.read_calls );
+    writer.family( "stream_write_calls_total", "counter", "Write calls made on the streams." );
+    writer.streamSamples( "stream_write_calls_total", archive.write_calls, items.write_calls );
+    writer.family( "stream_seek_calls_total", "counter", "Seek calls made on the streams." );
+    writer.streamSamples( "stream_seek_calls_total", archive.seek_calls, items.seek_calls );
+    writer.family( "stream_io_time_seconds", "gauge", "Time spent in I/O calls on the streams." );
+    writer.streamSamples( "stream_io_time_seconds", toSeconds( archive.io_time_ns ), toSeconds( items.io_time_ns ) );
+
+    writer.family( "items_total", "counter", "Items processed by the operation." );
+    writer.sample( "items_total", metrics.items_count );
+    writer.family( "property_calls_total", "counter", "Item properties requested during the operation." );
+    writer.sample( "property_calls_total", metrics.property_calls );
+    writer.family( "peak_buffer_memory_bytes", "gauge", "Peak memory allocated by bit7z for in-memory outputs." );
+    writer.sample( "peak_buffer_memory_bytes", metrics.peak_buffer_memory );
+    writer.family( "stored_bytes_total", "counter", "Input bytes stored without compression, as incompressible." );
+    writer.sample( "stored_bytes_total", metrics.stored_bytes );
+
+    const auto& latency = metrics.item_latency;
+    writer.family( "item_latency_seconds", "histogram", "Processing time of the single items." );
+    uint64_t cumulative_count = 0;
+    for ( std::size_t bucket = 0; bucket < BitLatencyHistogram::kBucketsCount; ++bucket ) {
+        cumulative_count += latency.bucketCount( bucket );
+        std::ostringstream bound;
+        bound.imbue( std::locale::classic() );
+        if ( bucket == BitLatencyHistogram::kBucketsCount - 1 ) {
+            bound << "+Inf";
+        } else {
+            bound << std::setprecision( 12 ) << toSeconds( BitLatencyHistogram::bucketUpperBound( bucket ) );
+        }
+        writer.sample( "item_latency_seconds_bucket", cumulative_count, "le=\"" + bound.str() + "\"" );
+    }
+    writer.sample( "item_latency_seconds_sum", toSeconds( latency.sum() ) );
+    writer.sample( "item_latency_seconds_count", latency.count() );
+    return writer.str();
+}
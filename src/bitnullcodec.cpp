@@ -0,0 +1,76 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifdef BIT7Z_NULL_CODEC
+
+#include "bitnullcodec.hpp"
+
+#include "internal/cnullarchive.hpp"
+#include "internal/guiddef.hpp"
+#include "internal/util.hpp"
+
+#include <new>
+#include <string>
+
+#ifndef _WIN32
+constexpr auto CLASS_E_CLASSNOTAVAILABLE = static_cast< HRESULT >( 0x80040111L );
+#endif
+
+namespace bit7z {
+
+const BitInOutFormat BitNullFormat( 0xB7, BIT7Z_STRING( ".null" ),
+                                    BitCompressionMethod::Copy,
+                                    FormatFeatures::MultipleFiles | FormatFeatures::AntiItems );
+
+// Last write time of the synthetic items (i.e., 2022-01-01 00:00:00 UTC, as a FILETIME).
+constexpr uint64_t kSyntheticItemTime = 132854688000000000ULL;
+
+HRESULT WINAPI nullCodecCreateObject( const GUID* clsID, const GUID* interfaceID, void** out ) {
+    if ( clsID == nullptr || interfaceID == nullptr || out == nullptr ) {
+        return E_INVALIDARG;
+    }
+    *out = nullptr;
+
+    if ( *clsID != formatGUID( BitNullFormat ) ) {
+        return CLASS_E_CLASSNOTAVAILABLE;
+    }
+    if ( *interfaceID != ::IID_IInArchive && *interfaceID != ::IID_IOutArchive ) {
+        return E_NOINTERFACE;
+    }
+
+    try {
+        auto archive = bit7z::make_com< CNullArchive, IInArchive >();
+        return archive->QueryInterface( *interfaceID, out );
+    } catch ( const std::bad_alloc& ) {
+        return E_OUTOFMEMORY;
+    }
+}
+
+buffer_t makeNullArchive( uint32_t items_count, uint64_t item_size ) {
+    buffer_t result;
+    writeNullSignature( result );
+    for ( uint32_t index = 0; index < items_count; ++index ) {
+        NullItem item{};
+        item.offset = index;
+        item.size = item_size;
+        item.mtime = kSyntheticItemTime;
+        item.flags = kNullItemSynthetic;
+        item.path = "item" + std::to_string( index ) + ".bin";
+        writeNullItem( result, item );
+    }
+    writeNullFooter( result, kNullSignatureSize, items_count );
+    return result;
+}
+
+}  // namespace bit7z
+
+#endif
@@ -15,13 +15,32 @@
 #include "biterror.hpp"
 #include "bitexception.hpp"
 #include "internal/archiveproperties.hpp"
+#include "internal/carchiveinstream.hpp"
 #include "internal/cbufferoutstream.hpp"
+#include "internal/ccancellableoutstream.hpp"
+#include "internal/cmetricsoutstream.hpp"
 #include "internal/cmultivolumeoutstream.hpp"
+#include "internal/crc32.hpp"
+#include "internal/dateutil.hpp"
 #include "internal/fsutil.hpp"
 #include "internal/genericinputitem.hpp"
+#include "internal/itemsampling.hpp"
+#include "internal/memoryplanner.hpp"
+#include "internal/shardedprogress.hpp"
+#include "internal/shardplanner.hpp"
+#include "internal/solidorder.hpp"
+#include "internal/threadslease.hpp"
+#include "internal/tracing.hpp"
 #include "internal/updatecallback.hpp"
 #include "internal/util.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
 namespace bit7z {
 
 BitOutputArchive::BitOutputArchive( const BitAbstractArchiveCreator& creator )
@@ -131,7 +150,23 @@ void BitOutputArchive::addDirectory( const tstring& in_dir ) {
     mNewItemsVector.indexDirectory( in_dir, BIT7Z_STRING( "" ), options );
 }
 
-CMyComPtr< IOutArchive > BitOutputArchive::initOutArchive() const {
+inline void checkMemoryPlan( const BitMemoryEstimate& memory_plan ) {
+    if ( !memory_plan.fits ) {
+        throw BitException( "Cannot compress the items within the memory budget",
+                            std::make_error_code( std::errc::not_enough_memory ) );
+    }
+}
+
+void BitOutputArchive::setBaseline( const BitArchiveCatalog& baseline ) {
+    mBaseline = std::make_unique< BitArchiveCatalog >( baseline );
+}
+
+CMyComPtr< IOutArchive > BitOutputArchive::initOutArchive( bool store_only,
+                                                           std::size_t concurrent_archives,
+                                                           uint32_t threads_limit ) const {
+    const BitMemoryEstimate memory_plan = memoryPlan( store_only, concurrent_archives, threads_limit );
+    checkMemoryPlan( memory_plan );
+
     CMyComPtr< IOutArchive > new_arc;
     if ( mInputArchive == nullptr ) {
         const GUID format_GUID = formatGUID( mArchiveCreator.format() );
@@ -140,7 +175,7 @@ CMyComPtr< IOutArchive > BitOutputArchive::initOutArchive() const {
     } else {
         mInputArchive->initUpdatableArchive( &new_arc );
     }
-    setArchiveProperties( new_arc );
+    setArchiveProperties( new_arc, store_only, memory_plan, threads_limit );
     return new_arc;
 }
 
@@ -160,19 +195,65 @@ CMyComPtr< IOutStream > BitOutputArchive::initOutFileStream( const fs::path& out
 
 void BitOutputArchive::compressOut( IOutArchive* out_arc,
                                     IOutStream* out_stream,
-                                    UpdateCallback* update_callback ) {
+                                    UpdateCallback* update_callback,
+                                    bool in_memory_output ) {
     if ( mInputArchive != nullptr && mArchiveCreator.updateMode() == UpdateMode::Update ) {
-        for ( const auto& new_item : mNewItemsVector ) {
-            auto updated_item = mInputArchive->find( new_item->inArchivePath().string< tchar >() );
-            if ( updated_item != mInputArchive->cend() ) {
-                setDeletedIndex( updated_item->index() );
-            }
-        }
+        markUpdatedItems();
+    } else if ( mInputArchive != nullptr && mArchiveCreator.updateMode() == UpdateMode::Sync ) {
+        markSyncedItems();
+    }
+    if ( mBaseline != nullptr ) {
+        markBaselineItems();
     }
     updateInputIndices();
+    applySolidOrder();
 
-    const HRESULT result = out_arc->UpdateItems( out_stream, itemsCount(), update_callback );
+    checkUpdateResult( updateItems( out_arc, out_stream, update_callback, itemsCount(), in_memory_output ) );
+}
 
+HRESULT BitOutputArchive::updateItems( IOutArchive* out_arc,
+                                       IOutStream* out_stream,
+                                       UpdateCallback* update_callback,
+                                       uint32_t items_count,
+                                       bool in_memory_output ) const {
+    MetricsRecorder* metrics = update_callback->metrics();
+    CMyComPtr< IOutStream > metrics_stream;
+    if ( metrics != nullptr ) {
+        metrics_stream = bit7z::make_com< CMetricsOutStream, IOutStream >( out_stream,
+                                                                           metrics->archiveStream(),
+                                                                           in_memory_output ? metrics : nullptr );
+        out_stream = metrics_stream;
+        if ( mInputArchive != nullptr ) {
+            metrics->attachArchiveStream( mInputArchive->mArchiveStream );
+        }
+    }
+
+    const OperationCancellation& cancellation = update_callback->cancellation();
+    CMyComPtr< IOutStream > cancellable_stream;
+    if ( cancellation.isEnabled() ) {
+        cancellable_stream = bit7z::make_com< CCancellableOutStream, IOutStream >( out_stream, cancellation );
+        out_stream = cancellable_stream;
+        if ( mInputArchive != nullptr ) {
+            mInputArchive->mArchiveStream->setCancellation( &cancellation );
+        }
+    }
+
+    BIT7Z_TRACE( update_callback->traceRecorder(), begin, "compress", items_count );
+    const HRESULT result = out_arc->UpdateItems( out_stream, items_count, update_callback );
+    BIT7Z_TRACE( update_callback->traceRecorder(), end, "compress", static_cast< uint32_t >( result ) );
+
+    if ( cancellation.isEnabled() && mInputArchive != nullptr ) {
+        mInputArchive->mArchiveStream->setCancellation( nullptr );
+    }
+
+    if ( metrics != nullptr ) {
+        metrics->finish( BitOperation::Compress );
+    }
+    update_callback->flushProgress();
+    return result;
+}
+
+void BitOutputArchive::checkUpdateResult( HRESULT result ) {
     if ( result == E_NOTIMPL ) {
         throw BitException( bit7z::kUnsupportedOperation, bit7z::make_hresult_code( result ) );
     }
@@ -182,13 +263,51 @@ void BitOutputArchive::compressOut( IOutArchive* out_arc,
     }
 }
 
-void BitOutputArchive::compressToFile( const fs::path& out_file, UpdateCallback* update_callback ) {
+/* Note: operations aborted by the user's progress callback fail with E_ABORT too, but they are not cancellations,
+ * so their partial output is kept, as it was before the cancellation tokens. */
+inline bool isCancellation( const BitException& ex, const OperationCancellation& cancellation ) noexcept {
+    return ex.hresultCode() == E_ABORT && cancellation.isCancelled();
+}
+
+// Removes the output of a cancelled compression (i.e., the archive file, or all its volumes).
+inline void removePartialArchive( const fs::path& out_file, bool multi_volume ) {
+    std::error_code error;
+    if ( !multi_volume ) {
+        fs::remove( out_file, error );
+        return;
+    }
+    for ( uint64_t volume = 1; volume < 1000; ++volume ) {
+        tstring extension = to_tstring( volume );
+        extension.insert( extension.begin(), 3 - extension.length(), BIT7Z_STRING( '0' ) );
+        fs::path volume_file = out_file;
+        volume_file += BIT7Z_STRING( '.' ) + extension;
+        if ( !fs::remove( volume_file, error ) ) {
+            break;
+        }
+    }
+}
+
+void BitOutputArchive::compressToFile( const fs::path& out_file, UpdateCallback* update_callback, bool store_only ) {
     // Note: if mInputArchive != nullptr, new_arc will actually point to the same IInArchive object used by the old_arc
     // (see initUpdatableArchive function of BitInputArchive)!
     const bool updating_archive = mInputArchive != nullptr && mInputArchive->archivePath() == out_file;
-    const CMyComPtr< IOutArchive > new_arc = initOutArchive();
+    const ThreadsLease threads{ mArchiveCreator.threadGovernor(), mArchiveCreator.threadsCount() };
+    const CMyComPtr< IOutArchive > new_arc = initOutArchive( store_only, 1, threads.threads() );
     CMyComPtr< IOutStream > out_stream = initOutFileStream( out_file, updating_archive );
-    compressOut( new_arc, out_stream, update_callback );
+    try {
+        compressOut( new_arc, out_stream, update_callback );
+    } catch ( const BitException& ex ) {
+        if ( isCancellation( ex, update_callback->cancellation() ) ) {
+            // Note: when updating an archive in place, only the temporary file is removed, keeping the old archive.
+            out_stream.Release();
+            fs::path partial_file = out_file;
+            if ( updating_archive && mArchiveCreator.volumeSize() == 0 ) {
+                partial_file += ".tmp";
+            }
+            removePartialArchive( partial_file, mArchiveCreator.volumeSize() > 0 );
+        }
+        throw;
+    }
 
     if ( updating_archive ) { //we updated the input archive
         auto close_result = mInputArchive->close();
@@ -220,14 +339,12 @@ void BitOutputArchive::compressToFile( const fs::path& out_file, UpdateCallback*
     }
 }
 
-void BitOutputArchive::compressTo( const tstring& out_file ) {
-    using namespace bit7z::filesystem;
-    const fs::path out_path = FORMAT_LONG_PATH( out_file );
+// Returns false if the output file already exists, and it must be skipped.
+inline bool prepareOutputFile( const fs::path& out_path, const tstring& out_file, OverwriteMode overwrite_mode ) {
     std::error_code error;
     if ( fs::exists( out_path, error ) ) {
-        const OverwriteMode overwrite_mode = mArchiveCreator.overwriteMode();
         if ( overwrite_mode == OverwriteMode::Skip ) { // Skipping if the output file already exists
-            return;
+            return false;
         }
         if ( overwrite_mode == OverwriteMode::Overwrite && !fs::remove( out_path, error ) ) {
             throw BitException( "Failed to delete the old archive file", error, out_file );
@@ -235,9 +352,20 @@ void BitOutputArchive::compressTo( const tstring& out_file ) {
         // Note: if overwrite_mode is OverwriteMode::None, an exception will be thrown by the CFileOutStream constructor
         // called by the initOutFileStream function.
     }
+    return true;
+}
+
+void BitOutputArchive::compressTo( const tstring& out_file ) {
+    using namespace bit7z::filesystem;
+    const fs::path out_path = FORMAT_LONG_PATH( out_file );
+    const bool store_only = storesNewItems();
+    checkMemoryPlan( memoryPlan( store_only ) ); // Before deleting the old archive file.
+    if ( !prepareOutputFile( out_path, out_file, mArchiveCreator.overwriteMode() ) ) {
+        return;
+    }
 
-    auto update_callback = bit7z::make_com< UpdateCallback >( *this );
-    compressToFile( out_path, update_callback );
+    auto update_callback = bit7z::make_com< UpdateCallback >( *this, nullptr, store_only );
+    compressToFile( out_path, update_callback, store_only );
 }
 
 void BitOutputArchive::compressTo( std::vector< byte_t >& out_buffer ) {
@@ -253,21 +381,260 @@ void BitOutputArchive::compressTo( std::vector< byte_t >& out_buffer ) {
         }
     }
 
-    const CMyComPtr< IOutArchive > new_arc = initOutArchive();
+    const bool store_only = storesNewItems();
+    const ThreadsLease threads{ mArchiveCreator.threadGovernor(), mArchiveCreator.threadsCount() };
+    const CMyComPtr< IOutArchive > new_arc = initOutArchive( store_only, 1, threads.threads() );
     auto out_mem_stream = bit7z::make_com< CBufferOutStream, IOutStream >( out_buffer );
-    auto update_callback = bit7z::make_com< UpdateCallback >( *this );
-    compressOut( new_arc, out_mem_stream, update_callback );
+    auto update_callback = bit7z::make_com< UpdateCallback >( *this, nullptr, store_only );
+    try {
+        compressOut( new_arc, out_mem_stream, update_callback, true );
+    } catch ( const BitException& ex ) {
+        if ( isCancellation( ex, update_callback->cancellation() ) ) {
+            out_buffer.clear();
+        }
+        throw;
+    }
 }
 
 void BitOutputArchive::compressTo( std::ostream& out_stream ) {
-    const CMyComPtr< IOutArchive > new_arc = initOutArchive();
+    const bool store_only = storesNewItems();
+    const ThreadsLease threads{ mArchiveCreator.threadGovernor(), mArchiveCreator.threadsCount() };
+    const CMyComPtr< IOutArchive > new_arc = initOutArchive( store_only, 1, threads.threads() );
     auto out_std_stream = bit7z::make_com< CStdOutStream, IOutStream >( out_stream );
-    auto update_callback = bit7z::make_com< UpdateCallback >( *this );
+    auto update_callback = bit7z::make_com< UpdateCallback >( *this, nullptr, store_only );
     compressOut( new_arc, out_std_stream, update_callback );
 }
 
-void BitOutputArchive::setArchiveProperties( IOutArchive* out_archive ) const {
-    const ArchiveProperties properties = mArchiveCreator.archiveProperties();
+inline tstring shardFileName( const tstring& prefix_name, std::size_t shard, const tchar* extension ) {
+    tstring number = to_tstring( shard + 1 );
+    if ( number.length() < 3 ) {
+        // Adding leading zeros for a total length of 3, as done for the volumes of an archive (e.g., 42 -> 042).
+        number.insert( number.begin(), 3 - number.length(), BIT7Z_STRING( '0' ) );
+    }
+    return prefix_name + BIT7Z_STRING( '.' ) + number + extension;
+}
+
+inline std::vector< uint64_t > itemSizes( const BitItemsVector& items ) {
+    std::vector< uint64_t > sizes;
+    sizes.reserve( items.size() );
+    for ( const auto& item : items ) {
+        sizes.push_back( item->size() );
+    }
+    return sizes;
+}
+
+// Plans the shards of the given subset of the items, returning the indices of the items in the whole vector.
+template< typename Planner >
+inline ShardPlan planSubset( const std::vector< uint64_t >& sizes,
+                             const std::vector< uint32_t >& subset,
+                             const Planner& planner ) {
+    if ( subset.empty() ) {
+        return {};
+    }
+    std::vector< uint64_t > subset_sizes;
+    subset_sizes.reserve( subset.size() );
+    for ( const auto index : subset ) {
+        subset_sizes.push_back( sizes[ index ] );
+    }
+    ShardPlan plan = planner( subset_sizes );
+    for ( auto& shard : plan ) {
+        for ( auto& index : shard ) {
+            index = subset[ index ];
+        }
+    }
+    return plan;
+}
+
+BitShardManifest BitOutputArchive::compressToShards( const tstring& out_prefix, uint32_t shards_count ) {
+    const auto sizes = itemSizes( mNewItemsVector );
+    if ( !mArchiveCreator.storeIncompressible() ) {
+        return compressShards( out_prefix, planShardsByCount( sizes, shards_count ) );
+    }
+
+    // Storing the incompressible items is I/O bound, so they are stored into a single shard.
+    std::vector< uint32_t > compressible_items;
+    std::vector< uint32_t > incompressible_items;
+    splitIncompressibleItems( compressible_items, incompressible_items );
+    ShardPlan plan = planSubset( sizes, compressible_items, [ shards_count ]( const std::vector< uint64_t >& subset ) {
+        return planShardsByCount( subset, shards_count );
+    } );
+    const std::size_t first_stored_shard = plan.size();
+    if ( !incompressible_items.empty() ) {
+        plan.push_back( std::move( incompressible_items ) );
+    }
+    return compressShards( out_prefix, std::move( plan ), first_stored_shard );
+}
+
+BitShardManifest BitOutputArchive::compressToShardsOfSize( const tstring& out_prefix, uint64_t max_shard_size ) {
+    const auto sizes = itemSizes( mNewItemsVector );
+    if ( !mArchiveCreator.storeIncompressible() ) {
+        return compressShards( out_prefix, planShardsBySize( sizes, max_shard_size ) );
+    }
+
+    std::vector< uint32_t > compressible_items;
+    std::vector< uint32_t > incompressible_items;
+    splitIncompressibleItems( compressible_items, incompressible_items );
+    const auto planner = [ max_shard_size ]( const std::vector< uint64_t >& subset ) {
+        return planShardsBySize( subset, max_shard_size );
+    };
+    ShardPlan plan = planSubset( sizes, compressible_items, planner );
+    const std::size_t first_stored_shard = plan.size();
+    for ( auto& shard : planSubset( sizes, incompressible_items, planner ) ) {
+        plan.push_back( std::move( shard ) );
+    }
+    return compressShards( out_prefix, std::move( plan ), first_stored_shard );
+}
+
+BitShardManifest BitOutputArchive::compressShards( const tstring& out_prefix,
+                                                   ShardPlan shards,
+                                                   std::size_t first_stored_shard ) {
+    if ( mInputArchive != nullptr ) {
+        throw BitException( "Cannot compress an updated archive to shards",
+                            make_error_code( BitError::UnsupportedOperation ) );
+    }
+    if ( mBaseline != nullptr ) {
+        throw BitException( "Cannot compress a differential archive to shards",
+                            make_error_code( BitError::UnsupportedOperation ) );
+    }
+
+    if ( mArchiveCreator.solidOrder() != SolidOrder::None ) {
+        const auto ranks = solidOrderRanks( mNewItemsVector, mArchiveCreator.solidOrder() );
+        for ( auto& shard : shards ) {
+            std::sort( shard.begin(), shard.end(), [ &ranks ]( uint32_t first, uint32_t second ) {
+                return ranks[ first ] < ranks[ second ];
+            } );
+        }
+    }
+
+    const fs::path prefix_path = FORMAT_LONG_PATH( out_prefix );
+    fs::path manifest_path = prefix_path;
+    manifest_path += BIT7Z_STRING( ".manifest" );
+    const OverwriteMode overwrite_mode = mArchiveCreator.overwriteMode();
+    if ( !prepareOutputFile( manifest_path, manifest_path.string< tchar >(), overwrite_mode ) ) {
+        return BitShardManifest::load( manifest_path.string< tchar >() );
+    }
+
+    // Note: the items are new and none is deleted, so the indices of the output archive are the ones of the items.
+    BitShardManifest manifest;
+    const tstring prefix_name = prefix_path.filename().string< tchar >();
+    const tchar* extension = mArchiveCreator.compressionFormat().extension();
+    std::vector< uint64_t > shard_totals;
+    for ( std::size_t shard = 0; shard < shards.size(); ++shard ) {
+        manifest.shards.push_back( shardFileName( prefix_name, shard, extension ) );
+        uint64_t shard_total = 0;
+        for ( const auto index : shards[ shard ] ) {
+            const BitPropVariant path = outputItemProperty( index, BitProperty::Path );
+            manifest.items.emplace( path.getString(), static_cast< uint32_t >( shard ) );
+            shard_total += mNewItemsVector[ index ].size();
+        }
+        shard_totals.push_back( shard_total );
+    }
+
+    // The archives and the output streams are created upfront, so that only the compression runs concurrently.
+    ShardedProgress progress{ mArchiveCreator, shard_totals };
+    std::vector< UpdateShard > update_shards;
+    std::vector< CMyComPtr< IOutArchive > > out_archives;
+    std::vector< CMyComPtr< IOutStream > > out_streams;
+    std::vector< CMyComPtr< UpdateCallback > > update_callbacks;
+    const OverwriteMode shard_overwrite_mode = overwrite_mode == OverwriteMode::Skip ? OverwriteMode::None
+                                                                                     : overwrite_mode;
+    std::size_t workers_count = std::min< std::size_t >( shards.size(),
+                                                          std::max( std::thread::hardware_concurrency(), 1u ) );
+    // If the memory budget is not enough for compressing all the workers' shards at once, fewer workers are used.
+    const bool stores_all_shards = first_stored_shard == 0;
+    while ( workers_count > 1 && !memoryPlan( stores_all_shards, workers_count ).fits ) {
+        --workers_count;
+    }
+    /* The workers' archives are compressed at the same time, so they are a single job for the thread governor,
+     * requesting the creator's threads for each of them, and splitting evenly the threads granted to the job. */
+    const uint32_t workers_threads = mArchiveCreator.threadsCount() * static_cast< uint32_t >( workers_count );
+    const ThreadsLease threads{ mArchiveCreator.threadGovernor(), workers_threads };
+    const uint32_t archive_threads = threads.threads() != 0 ?
+                                     std::max( threads.threads() / static_cast< uint32_t >( workers_count ), 1u ) : 0;
+    update_shards.reserve( shards.size() ); // The callbacks keep a pointer to their shard.
+    for ( std::size_t shard = 0; shard < shards.size(); ++shard ) {
+        // Note: existing shards are never skipped, since they would not match the new manifest.
+        const fs::path shard_path = prefix_path.parent_path() / manifest.shards[ shard ];
+        prepareOutputFile( shard_path, shard_path.string< tchar >(), shard_overwrite_mode );
+        update_shards.push_back( UpdateShard{ shard, shards[ shard ], progress } );
+        const bool store_only = shard >= first_stored_shard;
+        out_archives.push_back( initOutArchive( store_only, workers_count, archive_threads ) );
+        out_streams.push_back( initOutFileStream( shard_path, false ) );
+        update_callbacks.push_back( bit7z::make_com< UpdateCallback >( *this, &update_shards.back(), store_only ) );
+    }
+
+    std::vector< HRESULT > results( shards.size(), S_OK );
+    std::vector< std::exception_ptr > errors( shards.size() );
+    std::atomic< std::size_t > next_shard{ 0 };
+    const auto compress_shards = [ & ]() {
+        for ( auto shard = next_shard++; shard < shards.size(); shard = next_shard++ ) {
+            try {
+                results[ shard ] = updateItems( out_archives[ shard ],
+                                                out_streams[ shard ],
+                                                update_callbacks[ shard ],
+                                                static_cast< uint32_t >( shards[ shard ].size() ),
+                                                false );
+            } catch ( ... ) {
+                errors[ shard ] = std::current_exception();
+                results[ shard ] = E_FAIL;
+            }
+            if ( results[ shard ] != S_OK ) {
+                progress.abort(); // No point in compressing the other shards.
+            }
+        }
+    };
+
+    std::vector< std::thread > workers;
+    for ( std::size_t worker = 1; worker < workers_count; ++worker ) {
+        try {
+            workers.emplace_back( compress_shards );
+        } catch ( const std::system_error& ) {
+            break; // Too many threads: the shards are compressed by the workers created so far.
+        }
+    }
+    compress_shards();
+    for ( auto& worker : workers ) {
+        worker.join();
+    }
+    progress.flush();
+    const bool cancelled = std::any_of( update_callbacks.cbegin(), update_callbacks.cend(),
+                                        []( const CMyComPtr< UpdateCallback >& callback ) -> bool {
+                                            return callback->cancellation().isCancelled();
+                                        } );
+
+    // Closing the shards' files before reporting any error.
+    update_callbacks.clear();
+    out_streams.clear();
+    out_archives.clear();
+
+    for ( const auto& error : errors ) {
+        if ( error ) {
+            std::rethrow_exception( error );
+        }
+    }
+    HRESULT result = S_OK;
+    for ( const auto shard_result : results ) {
+        // Shards aborted because of another shard's failure do not hide the original error.
+        if ( shard_result != S_OK && ( result == S_OK || result == E_ABORT ) ) {
+            result = shard_result;
+        }
+    }
+    if ( result == E_ABORT && cancelled ) { // The compression was cancelled, so none of the shards is kept.
+        for ( const auto& shard_name : manifest.shards ) {
+            removePartialArchive( prefix_path.parent_path() / shard_name, false );
+        }
+    }
+    checkUpdateResult( result );
+
+    manifest.save( manifest_path.string< tchar >() );
+    return manifest;
+}
+
+void BitOutputArchive::setArchiveProperties( IOutArchive* out_archive,
+                                             bool store_only,
+                                             const BitMemoryEstimate& memory_plan,
+                                             uint32_t threads_limit ) const {
+    const ArchiveProperties properties = mArchiveCreator.archiveProperties( store_only, &memory_plan, threads_limit );
     if ( properties.empty() ) {
         return;
     }
@@ -302,21 +669,296 @@ void BitOutputArchive::updateInputIndices() {
     }
 }
 
+void BitOutputArchive::splitIncompressibleItems( std::vector< uint32_t >& compressible_items,
+                                                 std::vector< uint32_t >& incompressible_items ) const {
+    const auto& compressibility = newItemsCompressibility();
+    for ( uint32_t index = 0; index < static_cast< uint32_t >( compressibility.size() ); ++index ) {
+        if ( compressibility[ index ] == Compressibility::Incompressible ) {
+            incompressible_items.push_back( index );
+        } else {
+            compressible_items.push_back( index );
+        }
+    }
+}
+
+const std::vector< Compressibility >& BitOutputArchive::newItemsCompressibility() const {
+    const double min_entropy = mArchiveCreator.incompressibleEntropy();
+    if ( min_entropy != mCompressibilityEntropy ) {
+        mNewItemsCompressibility.clear();
+        mCompressibilityEntropy = min_entropy;
+    }
+    mNewItemsCompressibility.reserve( mNewItemsVector.size() );
+    for ( std::size_t index = mNewItemsCompressibility.size(); index < mNewItemsVector.size(); ++index ) {
+        mNewItemsCompressibility.push_back( estimateCompressibility( mNewItemsVector[ index ], min_entropy ) );
+    }
+    return mNewItemsCompressibility;
+}
+
+/* Note: the items whose compressibility is unknown (e.g., small files) do not prevent storing the archive,
+ *       as compressing them would not make a significant difference. */
+bool BitOutputArchive::storesNewItems() const {
+    if ( !mArchiveCreator.storeIncompressible() ) {
+        return false;
+    }
+    bool has_incompressible_items = false;
+    for ( const auto compressibility : newItemsCompressibility() ) {
+        switch ( compressibility ) {
+            case Compressibility::Compressible:
+                return false;
+            case Compressibility::Incompressible:
+                has_incompressible_items = true;
+                break;
+            case Compressibility::Unknown:
+            default:
+                break;
+        }
+    }
+    return has_incompressible_items;
+}
+
+uint64_t BitOutputArchive::compressionInputSize() const {
+    uint64_t largest_file = 0;
+    uint64_t total_size = 0;
+    for ( const auto& item : mNewItemsVector ) {
+        if ( !item->isDir() ) {
+            largest_file = std::max( largest_file, item->size() );
+            total_size += item->size();
+        }
+    }
+    const auto& format = mArchiveCreator.compressionFormat();
+    if ( !mArchiveCreator.solidMode() || !format.hasFeature( FormatFeatures::SolidArchive ) ) {
+        return largest_file;
+    }
+    const uint64_t solid_block_size = mArchiveCreator.solidBlockSize();
+    return solid_block_size == 0 ? total_size : std::min( total_size, std::max( solid_block_size, largest_file ) );
+}
+
+/* Note: the budget is split evenly among the archives compressed at the same time (i.e., the shards),
+ *       and each archive is planned for the largest input among all of them. */
+BitMemoryEstimate BitOutputArchive::memoryPlan( bool store_only,
+                                                std::size_t concurrent_archives,
+                                                uint32_t threads_limit ) const {
+    uint64_t memory_budget = mArchiveCreator.effectiveMemoryBudget();
+    if ( memory_budget != 0 && concurrent_archives > 1 ) {
+        // Note: the budget is at least one byte, so that it is still a budget (even if surely not enough).
+        memory_budget = std::max< uint64_t >( memory_budget / concurrent_archives, 1 );
+    }
+    return planCompressionMemory( mArchiveCreator, compressionInputSize(), memory_budget, store_only, threads_limit );
+}
+
+BitMemoryEstimate BitOutputArchive::memoryEstimate() const {
+    return memoryPlan( storesNewItems() );
+}
+
+/* Note: the new items always follow the old ones in the output archive, so only the new items are reordered,
+ *       keeping the slots of the output archive that they occupy. */
+void BitOutputArchive::applySolidOrder() {
+    if ( mArchiveCreator.solidOrder() == SolidOrder::None || mNewItemsVector.size() < 2 ) {
+        return;
+    }
+
+    if ( mInputIndices.empty() ) {
+        mInputIndices.reserve( itemsCount() );
+        for ( uint32_t new_index = 0; new_index < itemsCount(); ++new_index ) {
+            mInputIndices.push_back( static_cast< input_index >( new_index ) );
+        }
+    }
+
+    const auto ranks = solidOrderRanks( mNewItemsVector, mArchiveCreator.solidOrder() );
+    const auto is_new_item = [ this ]( input_index index ) {
+        return static_cast< uint32_t >( index ) >= mInputArchiveItemsCount;
+    };
+    const auto new_items_begin = std::find_if( mInputIndices.begin(), mInputIndices.end(), is_new_item );
+    // The anti-items (if any) follow the new items, and they are not reordered.
+    const auto anti_items_begin = mInputIndices.end() - static_cast< std::ptrdiff_t >( mAntiItems.size() );
+    std::sort( new_items_begin, anti_items_begin, [ this, &ranks ]( input_index first, input_index second ) {
+        return ranks[ static_cast< uint32_t >( first ) - mInputArchiveItemsCount ] <
+               ranks[ static_cast< uint32_t >( second ) - mInputArchiveItemsCount ];
+    } );
+}
+
+// Maps the paths of the items in the input archive to their indices (the first ones, in case of duplicates).
+inline std::unordered_map< tstring, uint32_t > inputItemsIndex( const BitInputArchive& input_archive ) {
+    std::unordered_map< tstring, uint32_t > result;
+    result.reserve( input_archive.itemsCount() );
+    for ( const auto& item : input_archive ) {
+        result.emplace( item.path(), item.index() );
+    }
+    return result;
+}
+
+void BitOutputArchive::markUpdatedItems() {
+    const auto input_items = inputItemsIndex( *mInputArchive );
+    for ( const auto& new_item : mNewItemsVector ) {
+        const auto updated_item = input_items.find( new_item->inArchivePath().string< tchar >() );
+        if ( updated_item != input_items.end() ) {
+            setDeletedIndex( updated_item->second );
+        }
+    }
+}
+
+/* Note: the unchanged new items are marked as deleted (their input_index is >= mInputArchiveItemsCount),
+ *       so that the corresponding old items are kept in the output archive as they are. */
+void BitOutputArchive::markSyncedItems() {
+    const auto input_items = inputItemsIndex( *mInputArchive );
+    std::vector< bool > synced_items( mInputArchiveItemsCount, false );
+    uint32_t new_index = 0;
+    for ( const auto& new_item : mNewItemsVector ) {
+        const auto old_item = input_items.find( new_item->inArchivePath().string< tchar >() );
+        if ( old_item != input_items.end() ) {
+            synced_items[ old_item->second ] = true;
+            if ( isUnchangedItem( *new_item, inputCatalogItem( old_item->second ) ) ) {
+                setDeletedIndex( mInputArchiveItemsCount + new_index );
+            } else {
+                setDeletedIndex( old_item->second );
+            }
+        }
+        ++new_index;
+    }
+
+    // The old items whose source is not among the new items anymore are deleted.
+    for ( uint32_t old_index = 0; old_index < mInputArchiveItemsCount; ++old_index ) {
+        if ( !synced_items[ old_index ] && !isEditedIndex( old_index ) ) {
+            setDeletedIndex( old_index );
+        }
+    }
+}
+
+/* Note: the unchanged new items are skipped (i.e., marked as deleted, as in markSyncedItems),
+ *       while the baseline items that are not among the new items become anti-items. */
+void BitOutputArchive::markBaselineItems() {
+    mAntiItems.clear();
+    std::unordered_set< tstring > new_paths;
+    new_paths.reserve( mNewItemsVector.size() );
+    uint32_t new_index = 0;
+    for ( const auto& new_item : mNewItemsVector ) {
+        const tstring path = new_item->inArchivePath().string< tchar >();
+        const BitCatalogItem* old_item = mBaseline->find( path );
+        if ( old_item != nullptr && isUnchangedItem( *new_item, *old_item ) ) {
+            setDeletedIndex( mInputArchiveItemsCount + new_index );
+        }
+        new_paths.insert( path );
+        ++new_index;
+    }
+
+    if ( !mArchiveCreator.compressionFormat().hasFeature( FormatFeatures::AntiItems ) ) {
+        return;
+    }
+    for ( const auto& old_item : mBaseline->items() ) {
+        if ( new_paths.find( old_item.first ) == new_paths.end() ) {
+            mAntiItems.emplace_back( old_item.first, old_item.second.is_dir );
+        }
+    }
+    // The anti-items are sorted by path, so that the same baseline always produces the same archive.
+    std::sort( mAntiItems.begin(), mAntiItems.end() );
+}
+
+BitCatalogItem BitOutputArchive::inputCatalogItem( uint32_t old_index ) const {
+    BitCatalogItem result;
+    const BitPropVariant old_is_dir = mInputArchive->itemProperty( old_index, BitProperty::IsDir );
+    result.is_dir = old_is_dir.isBool() && old_is_dir.getBool();
+    const BitPropVariant old_size = mInputArchive->itemProperty( old_index, BitProperty::Size );
+    result.size = old_size.isEmpty() ? 0 : old_size.getUInt64();
+    const BitPropVariant old_mtime = mInputArchive->itemProperty( old_index, BitProperty::MTime );
+    if ( old_mtime.isFileTime() ) {
+        result.last_write_time = old_mtime.getTimePoint();
+    }
+    const BitPropVariant old_crc = mInputArchive->itemProperty( old_index, BitProperty::CRC );
+    result.has_crc = old_crc.isUInt32();
+    result.crc = result.has_crc ? old_crc.getUInt32() : 0;
+    return result;
+}
+
+inline HRESULT streamCrc32( ISequentialInStream* stream, uint32_t& crc ) {
+    constexpr auto kBufferSize = 1u << 16u;
+    std::vector< byte_t > buffer( kBufferSize );
+    crc = 0;
+    UInt32 read = 0;
+    do {
+        RINOK( stream->Read( buffer.data(), kBufferSize, &read ) )
+        crc = crc32( crc, buffer.data(), read );
+    } while ( read > 0 );
+    return S_OK;
+}
+
+bool BitOutputArchive::isUnchangedItem( const GenericInputItem& new_item, const BitCatalogItem& old_item ) const {
+    if ( old_item.is_dir != new_item.isDir() ) {
+        return false;
+    }
+    if ( !new_item.isDir() && old_item.size != new_item.size() ) {
+        return false;
+    }
+
+    if ( mArchiveCreator.syncContentCheck() && !new_item.isDir() && old_item.has_crc ) {
+        CMyComPtr< ISequentialInStream > in_stream;
+        uint32_t new_crc = 0;
+        return new_item.getStream( &in_stream ) == S_OK && in_stream != nullptr &&
+               streamCrc32( in_stream, new_crc ) == S_OK && new_crc == old_item.crc;
+    }
+
+    if ( old_item.last_write_time == time_type{} ) { // Unknown last write time.
+        return false;
+    }
+    using std::chrono::duration_cast;
+    using std::chrono::seconds;
+    const auto old_time = old_item.last_write_time.time_since_epoch();
+    const auto new_time = FILETIME_to_time_type( new_item.lastWriteTime() ).time_since_epoch();
+    if ( mArchiveCreator.compressionFormat() == BitFormat::Zip ) {
+        // Zip archives usually store the DOS time of the items, which has a two seconds precision.
+        const auto difference = old_time > new_time ? old_time - new_time : new_time - old_time;
+        return difference < seconds{ 2 };
+    }
+    return duration_cast< seconds >( old_time ) == duration_cast< seconds >( new_time );
+}
+
+bool BitOutputArchive::isEditedIndex( uint32_t /*index*/ ) const noexcept {
+    return false;
+}
+
 uint32_t BitOutputArchive::itemsCount() const {
-    auto result = static_cast< uint32_t >( mNewItemsVector.size() );
+    auto result = static_cast< uint32_t >( mNewItemsVector.size() + mAntiItems.size() );
     if ( mInputArchive != nullptr ) {
-        result += mInputArchive->itemsCount() - static_cast< uint32_t >( mDeletedItems.size() );
+        result += mInputArchive->itemsCount();
     }
-    return result;
+    return result - static_cast< uint32_t >( mDeletedItems.size() );
+}
+
+std::size_t BitOutputArchive::antiItemIndex( input_index index ) const noexcept {
+    const auto anti_items_begin = static_cast< size_t >( mInputArchiveItemsCount ) + mNewItemsVector.size();
+    const auto item_index = static_cast< size_t >( index );
+    return item_index >= anti_items_begin ? item_index - anti_items_begin : mAntiItems.size();
+}
+
+bool BitOutputArchive::isAntiItem( uint32_t index ) const noexcept {
+    return antiItemIndex( itemInputIndex( index ) ) < mAntiItems.size();
 }
 
 BitPropVariant BitOutputArchive::itemProperty( input_index index, BitProperty propID ) const {
+    const auto anti_item_index = antiItemIndex( index );
+    if ( anti_item_index < mAntiItems.size() ) {
+        const auto& anti_item = mAntiItems[ anti_item_index ];
+        switch ( propID ) {
+            case BitProperty::Path:
+                return BitPropVariant{ WIDEN( anti_item.first ) };
+            case BitProperty::IsDir:
+                return BitPropVariant{ anti_item.second };
+            case BitProperty::Size:
+                return BitPropVariant{ uint64_t{ 0 } };
+            case BitProperty::IsAnti:
+                return BitPropVariant{ true };
+            default:
+                return BitPropVariant{};
+        }
+    }
     const auto new_item_index = static_cast< size_t >( index ) - static_cast< size_t >( mInputArchiveItemsCount );
     const GenericInputItem& new_item = mNewItemsVector[ new_item_index ];
     return new_item.itemProperty( propID );
 }
 
 HRESULT BitOutputArchive::itemStream( input_index index, ISequentialInStream** inStream ) const {
+    if ( antiItemIndex( index ) < mAntiItems.size() ) { // Anti-items have no data.
+        return S_OK;
+    }
     const auto new_item_index = static_cast< size_t >( index ) - static_cast< size_t >( mInputArchiveItemsCount );
     const GenericInputItem& new_item = mNewItemsVector[ new_item_index ];
 
@@ -327,6 +969,7 @@ HRESULT BitOutputArchive::itemStream( input_index index, ISequentialInStream** i
         if ( fs::exists( path, error ) ) {
             error = std::make_error_code( std::errc::file_exists );
         }
+        const std::lock_guard< std::mutex > lock{ mFailedFilesMutex };
         mFailedFiles.emplace_back( path, error );
     }
     return res;
@@ -367,6 +1010,14 @@ uint32_t BitOutputArchive::indexInArchive( uint32_t index ) const noexcept {
     return original_index < mInputArchiveItemsCount ? original_index : static_cast< uint32_t >( -1 );
 }
 
+const GenericInputItem* BitOutputArchive::outputNewItem( uint32_t index ) const {
+    const auto original_index = static_cast< uint32_t >( itemInputIndex( index ) );
+    if ( original_index < mInputArchiveItemsCount || antiItemIndex( itemInputIndex( index ) ) < mAntiItems.size() ) {
+        return nullptr;
+    }
+    return &mNewItemsVector[ original_index - mInputArchiveItemsCount ];
+}
+
 const BitAbstractArchiveHandler& BitOutputArchive::handler() const noexcept {
     return mArchiveCreator;
 }
@@ -0,0 +1,65 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "bitprogress.hpp"
+
+using namespace bit7z;
+
+constexpr uint32_t BitProgress::kNoItem;
+
+BitProgress::BitProgress() noexcept
+    : mTotal{ 0 }, mCompleted{ 0 }, mInputBytes{ 0 }, mOutputBytes{ 0 }, mCurrentItem{ kNoItem } {}
+
+uint64_t BitProgress::total() const noexcept {
+    return mTotal.load( std::memory_order_relaxed );
+}
+
+uint64_t BitProgress::completed() const noexcept {
+    return mCompleted.load( std::memory_order_relaxed );
+}
+
+uint64_t BitProgress::inputBytes() const noexcept {
+    return mInputBytes.load( std::memory_order_relaxed );
+}
+
+uint64_t BitProgress::outputBytes() const noexcept {
+    return mOutputBytes.load( std::memory_order_relaxed );
+}
+
+uint32_t BitProgress::currentItem() const noexcept {
+    return mCurrentItem.load( std::memory_order_relaxed );
+}
+
+void BitProgress::reset() noexcept {
+    mTotal.store( 0, std::memory_order_relaxed );
+    mCompleted.store( 0, std::memory_order_relaxed );
+    mInputBytes.store( 0, std::memory_order_relaxed );
+    mOutputBytes.store( 0, std::memory_order_relaxed );
+    mCurrentItem.store( kNoItem, std::memory_order_relaxed );
+}
+
+void BitProgress::setTotal( uint64_t total ) noexcept {
+    mTotal.store( total, std::memory_order_relaxed );
+}
+
+void BitProgress::setCompleted( uint64_t completed ) noexcept {
+    mCompleted.store( completed, std::memory_order_relaxed );
+}
+
+void BitProgress::setRatioInfo( uint64_t input_bytes, uint64_t output_bytes ) noexcept {
+    mInputBytes.store( input_bytes, std::memory_order_relaxed );
+    mOutputBytes.store( output_bytes, std::memory_order_relaxed );
+}
+
+void BitProgress::setCurrentItem( uint32_t index ) noexcept {
+    mCurrentItem.store( index, std::memory_order_relaxed );
+}
@@ -0,0 +1,111 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "bitshardedarchivereader.hpp"
+
+#include "biterror.hpp"
+#include "bitexception.hpp"
+#include "internal/fs.hpp"
+#include "internal/fsutil.hpp"
+
+using namespace bit7z;
+
+BitShardedArchiveReader::BitShardedArchiveReader( const Bit7zLibrary& lib,
+                                                  const tstring& manifest_file,
+                                                  const BitInFormat& format,
+                                                  const tstring& password )
+    : mManifest{ BitShardManifest::load( manifest_file ) } {
+    const fs::path shards_folder = fs::path{ FORMAT_LONG_PATH( manifest_file ) }.parent_path();
+    mShards.reserve( mManifest.shards.size() );
+    for ( const auto& shard_name : mManifest.shards ) {
+        const fs::path shard_path = shards_folder / shard_name;
+        mShards.push_back( std::make_unique< BitArchiveReader >( lib,
+                                                                 shard_path.string< tchar >(),
+                                                                 format,
+                                                                 password ) );
+    }
+}
+
+const BitShardManifest& BitShardedArchiveReader::manifest() const noexcept {
+    return mManifest;
+}
+
+uint32_t BitShardedArchiveReader::shardsCount() const noexcept {
+    return static_cast< uint32_t >( mShards.size() );
+}
+
+const BitArchiveReader& BitShardedArchiveReader::shard( uint32_t index ) const {
+    if ( index >= mShards.size() ) {
+        throw BitException( "Cannot get the shard", make_error_code( BitError::InvalidIndex ) );
+    }
+    return *mShards[ index ];
+}
+
+uint32_t BitShardedArchiveReader::itemsCount() const {
+    uint32_t result = 0;
+    for ( const auto& shard : mShards ) {
+        result += shard->itemsCount();
+    }
+    return result;
+}
+
+uint64_t BitShardedArchiveReader::size() const {
+    uint64_t result = 0;
+    for ( const auto& shard : mShards ) {
+        result += shard->size();
+    }
+    return result;
+}
+
+uint64_t BitShardedArchiveReader::packSize() const {
+    uint64_t result = 0;
+    for ( const auto& shard : mShards ) {
+        result += shard->packSize();
+    }
+    return result;
+}
+
+bool BitShardedArchiveReader::contains( const tstring& item_path ) const {
+    return mManifest.shardOf( item_path ) < mShards.size();
+}
+
+void BitShardedArchiveReader::extract( const tstring& out_dir ) const {
+    for ( const auto& shard : mShards ) {
+        shard->extract( out_dir );
+    }
+}
+
+void BitShardedArchiveReader::extract( const tstring& item_path, std::vector< byte_t >& out_buffer ) const {
+    const uint32_t shard_index = mManifest.shardOf( item_path );
+    if ( shard_index >= mShards.size() ) {
+        throw BitException( "Cannot extract the item", make_error_code( BitError::NoMatchingItems ), item_path );
+    }
+
+    const BitArchiveReader& shard = *mShards[ shard_index ];
+    auto item = shard.find( item_path );
+    if ( item == shard.cend() ) {
+        throw BitException( "Cannot extract the item", make_error_code( BitError::NoMatchingItems ), item_path );
+    }
+    shard.extract( out_buffer, item->index() );
+}
+
+void BitShardedArchiveReader::extract( std::map< tstring, std::vector< byte_t > >& out_map ) const {
+    for ( const auto& shard : mShards ) {
+        shard->extract( out_map );
+    }
+}
+
+void BitShardedArchiveReader::test() const {
+    for ( const auto& shard : mShards ) {
+        shard->test();
+    }
+}
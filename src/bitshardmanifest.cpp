@@ -0,0 +1,106 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "bitshardmanifest.hpp"
+
+#include "bitexception.hpp"
+#include "internal/fs.hpp"
+#include "internal/util.hpp"
+
+#include <string>
+
+using namespace bit7z;
+
+constexpr auto kManifestHeader = "bit7z-shards 1";
+constexpr auto kShardPrefix = "shard ";
+constexpr auto kItemPrefix = "item ";
+
+inline bool startsWith( const std::string& str, const char* prefix ) {
+    return str.compare( 0, std::char_traits< char >::length( prefix ), prefix ) == 0;
+}
+
+void BitShardManifest::save( const tstring& manifest_file ) const {
+    fs::ofstream manifest{ fs::path{ manifest_file }, std::ios::binary | std::ios::trunc };
+    if ( !manifest.is_open() ) {
+        throw BitException( "Failed to create the shard manifest", last_error_code(), manifest_file );
+    }
+
+    manifest << kManifestHeader << '\n';
+    for ( const auto& shard : shards ) {
+        manifest << kShardPrefix << escapeLine( toUtf8( shard ) ) << '\n';
+    }
+    for ( const auto& item : items ) {
+        manifest << kItemPrefix << item.second << ' ' << escapeLine( toUtf8( item.first ) ) << '\n';
+    }
+
+    manifest.flush();
+    if ( !manifest ) {
+        throw BitException( "Failed to write the shard manifest", std::make_error_code( std::errc::io_error ),
+                            manifest_file );
+    }
+}
+
+BitShardManifest BitShardManifest::load( const tstring& manifest_file ) {
+    fs::ifstream manifest{ fs::path{ manifest_file }, std::ios::binary };
+    if ( !manifest.is_open() ) {
+        throw BitException( "Failed to open the shard manifest", last_error_code(), manifest_file );
+    }
+
+    const auto invalid_manifest = [ &manifest_file ]() {
+        return BitException( "Invalid shard manifest", std::make_error_code( std::errc::invalid_argument ),
+                             manifest_file );
+    };
+
+    std::string line;
+    if ( !std::getline( manifest, line ) || line != kManifestHeader ) {
+        throw invalid_manifest();
+    }
+
+    BitShardManifest result;
+    while ( std::getline( manifest, line ) ) {
+        if ( line.empty() ) {
+            continue;
+        }
+        if ( startsWith( line, kShardPrefix ) ) {
+            const std::string shard_name = line.substr( std::char_traits< char >::length( kShardPrefix ) );
+            result.shards.push_back( fromUtf8( unescapeLine( shard_name ) ) );
+            continue;
+        }
+        if ( !startsWith( line, kItemPrefix ) ) {
+            throw invalid_manifest();
+        }
+
+        const std::size_t index_start = std::char_traits< char >::length( kItemPrefix );
+        const std::size_t index_end = line.find( ' ', index_start );
+        if ( index_end == std::string::npos || index_end == index_start ) {
+            throw invalid_manifest();
+        }
+        uint64_t shard = 0;
+        for ( std::size_t i = index_start; i < index_end; ++i ) {
+            if ( line[ i ] < '0' || line[ i ] > '9' ) {
+                throw invalid_manifest();
+            }
+            shard = shard * 10 + static_cast< uint64_t >( line[ i ] - '0' );
+            if ( shard >= result.shards.size() ) {
+                throw invalid_manifest(); // Items must refer to shards listed before them.
+            }
+        }
+        const std::string item_path = line.substr( index_end + 1 );
+        result.items.emplace( fromUtf8( unescapeLine( item_path ) ), static_cast< uint32_t >( shard ) );
+    }
+    return result;
+}
+
+uint32_t BitShardManifest::shardOf( const tstring& item_path ) const {
+    const auto item = items.find( item_path );
+    return item != items.end() ? item->second : static_cast< uint32_t >( shards.size() );
+}
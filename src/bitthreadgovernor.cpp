@@ -0,0 +1,61 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "bitthreadgovernor.hpp"
+
+#include <algorithm>
+#include <thread>
+
+using namespace bit7z;
+
+BitThreadGovernor::BitThreadGovernor( uint32_t tokens )
+    : mTokens{ tokens != 0 ? tokens : std::max( std::thread::hardware_concurrency(), 1u ) },
+      mTokensInUse{ 0 },
+      mRunningJobs{ 0 } {}
+
+uint32_t BitThreadGovernor::tokens() const noexcept {
+    return mTokens;
+}
+
+uint32_t BitThreadGovernor::tokensInUse() const {
+    const std::lock_guard< std::mutex > lock{ mMutex };
+    return mTokensInUse;
+}
+
+uint32_t BitThreadGovernor::runningJobs() const {
+    const std::lock_guard< std::mutex > lock{ mMutex };
+    return mRunningJobs;
+}
+
+uint32_t BitThreadGovernor::acquire( uint32_t requested_threads ) {
+    const std::lock_guard< std::mutex > lock{ mMutex };
+    ++mRunningJobs;
+    const uint32_t fair_share = std::max( mTokens / mRunningJobs, 1u );
+    const uint32_t free_tokens = mTokens > mTokensInUse ? mTokens - mTokensInUse : 0;
+    uint32_t granted_threads = std::min( fair_share, free_tokens );
+    if ( requested_threads != 0 ) {
+        granted_threads = std::min( granted_threads, requested_threads );
+    }
+    /* Note: when the pool is exhausted, the job still runs single-threaded rather than waiting,
+     *       oversubscribing the pool by one thread until some tokens are released. */
+    granted_threads = std::max( granted_threads, 1u );
+    mTokensInUse += granted_threads;
+    return granted_threads;
+}
+
+void BitThreadGovernor::release( uint32_t granted_threads ) noexcept {
+    const std::lock_guard< std::mutex > lock{ mMutex };
+    mTokensInUse -= std::min( granted_threads, mTokensInUse );
+    if ( mRunningJobs > 0 ) {
+        --mRunningJobs;
+    }
+}
@@ -0,0 +1,101 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifdef BIT7Z_TRACING
+
+#include "bittracerecorder.hpp"
+
+#include <functional>
+#include <iomanip>
+#include <locale>
+#include <sstream>
+#include <thread>
+
+using namespace bit7z;
+
+inline uint32_t currentThreadId() noexcept {
+    return static_cast< uint32_t >( std::hash< std::thread::id >{}( std::this_thread::get_id() ) );
+}
+
+BitTraceRecorder::BitTraceRecorder( std::size_t capacity )
+    : mEvents( capacity > 0 ? capacity : 1 ), mNextEvent{ 0 }, mStartTime{ std::chrono::steady_clock::now() } {}
+
+void BitTraceRecorder::record( const char* name, char phase, uint64_t arg ) noexcept {
+    const auto elapsed = std::chrono::steady_clock::now() - mStartTime;
+    const uint64_t slot = mNextEvent.fetch_add( 1, std::memory_order_relaxed ) % mEvents.size();
+    auto& event = mEvents[ static_cast< std::size_t >( slot ) ];
+    event.name = name;
+    event.phase = phase;
+    event.thread_id = currentThreadId();
+    event.timestamp_ns = static_cast< uint64_t >(
+        std::chrono::duration_cast< std::chrono::nanoseconds >( elapsed ).count()
+    );
+    event.arg = arg;
+}
+
+void BitTraceRecorder::begin( const char* name, uint64_t arg ) noexcept {
+    record( name, 'B', arg );
+}
+
+void BitTraceRecorder::end( const char* name, uint64_t arg ) noexcept {
+    record( name, 'E', arg );
+}
+
+void BitTraceRecorder::instant( const char* name, uint64_t arg ) noexcept {
+    record( name, 'i', arg );
+}
+
+std::size_t BitTraceRecorder::size() const noexcept {
+    const uint64_t recorded = mNextEvent.load( std::memory_order_relaxed );
+    return recorded < mEvents.size() ? static_cast< std::size_t >( recorded ) : mEvents.size();
+}
+
+std::size_t BitTraceRecorder::capacity() const noexcept {
+    return mEvents.size();
+}
+
+uint64_t BitTraceRecorder::droppedEvents() const noexcept {
+    return mNextEvent.load( std::memory_order_relaxed ) - size();
+}
+
+void BitTraceRecorder::clear() noexcept {
+    mNextEvent.store( 0, std::memory_order_relaxed );
+}
+
+std::string BitTraceRecorder::toChromeTrace() const {
+    const uint64_t recorded = mNextEvent.load( std::memory_order_acquire );
+    const std::size_t count = size();
+
+    std::ostringstream output;
+    output.imbue( std::locale::classic() );
+    output << std::fixed << std::setprecision( 3 );
+    output << R"({"displayTimeUnit":"ns","traceEvents":[)";
+    for ( std::size_t index = 0; index < count; ++index ) {
+        // The oldest retained event is the one after the last recorded.
+        const auto slot = static_cast< std::size_t >( ( recorded - count + index ) % mEvents.size() );
+        const auto& event = mEvents[ slot ];
+        if ( index > 0 ) {
+            output << ',';
+        }
+        output << R"({"name":")" << event.name << R"(","cat":"bit7z","ph":")" << event.phase << '"';
+        if ( event.phase == 'i' ) {
+            output << R"(,"s":"t")";
+        }
+        output << R"(,"ts":)" << static_cast< double >( event.timestamp_ns ) / 1000.0;
+        output << R"(,"pid":0,"tid":)" << event.thread_id;
+        output << R"(,"args":{"value":)" << event.arg << "}}";
+    }
+    output << "]}";
+    return output.str();
+}
+
+#endif
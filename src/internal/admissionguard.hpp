@@ -0,0 +1,50 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef ADMISSIONGUARD_HPP
+#define ADMISSIONGUARD_HPP
+
+#include <cstdint>
+
+#include "bitadmissioncontroller.hpp"
+
+namespace bit7z {
+
+// Keeps a job admitted by the given controller (if any) for the lifetime of the guard.
+class AdmissionGuard final {
+    public:
+        AdmissionGuard( BitAdmissionController* controller, uint64_t memory_usage )
+            : mController{ controller }, mMemoryUsage{ memory_usage } {
+            if ( mController != nullptr ) {
+                mController->acquire( mMemoryUsage );
+            }
+        }
+
+        AdmissionGuard( const AdmissionGuard& ) = delete;
+
+        AdmissionGuard( AdmissionGuard&& ) = delete;
+
+        AdmissionGuard& operator=( const AdmissionGuard& ) = delete;
+
+        AdmissionGuard& operator=( AdmissionGuard&& ) = delete;
+
+        ~AdmissionGuard() {
+            if ( mController != nullptr ) {
+                mController->release( mMemoryUsage );
+            }
+        }
+
+    private:
+        BitAdmissionController* mController;
+        uint64_t mMemoryUsage;
+};
+
+}  // namespace bit7z
+
+#endif // ADMISSIONGUARD_HPP
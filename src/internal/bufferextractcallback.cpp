@@ -50,9 +50,7 @@ HRESULT BufferExtractCallback::getOutStream( uint32_t index, ISequentialOutStrea
         return E_FAIL;
     }
 
-    if ( mHandler.fileCallback() ) {
-        mHandler.fileCallback()( fullPath );
-    }
+    progressReporter().reportFile( fullPath );
 
     //Note: using [] operator it creates the buffer if it does not already exist!
     auto& out_buffer = mBuffersMap[ fullPath ];
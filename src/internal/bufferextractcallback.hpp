@@ -39,6 +39,10 @@ class BufferExtractCallback final : public ExtractCallback {
         map< tstring, vector< byte_t > >& mBuffersMap;
         CMyComPtr< ISequentialOutStream > mOutMemStream;
 
+        BIT7Z_NODISCARD bool isMemoryOutput() const noexcept override {
+            return true;
+        }
+
         void releaseStream() override;
 
         HRESULT getOutStream( uint32_t index, ISequentialOutStream** outStream ) override;
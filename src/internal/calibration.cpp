@@ -0,0 +1,277 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "internal/calibration.hpp"
+
+#include "bitexception.hpp"
+#include "internal/fs.hpp"
+#include "internal/genericinputitem.hpp"
+#include "internal/itemsampling.hpp"
+#include "internal/util.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <locale>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+using namespace bit7z;
+
+// Each file contributes to the sample with at most its first MiB, so that a few large files do not fill the sample.
+constexpr uint64_t kMaxCalibrationItemSample = 1024 * 1024;
+
+// The number of main extensions (by size) that are part of the profile of the input files.
+constexpr std::size_t kProfileExtensions = 3;
+
+constexpr auto kCacheHeader = "bit7z-calibrations 1";
+
+inline bool isSampleableFile( const GenericInputItem& item ) {
+    return !item.isDir() && item.size() > 0 && item.isPrefetchable();
+}
+
+CalibrationSample bit7z::makeCalibrationSample( const BitItemsVector& items, uint64_t max_size ) {
+    uint64_t sampleable_size = 0;
+    for ( const auto& item : items ) {
+        if ( isSampleableFile( *item ) ) {
+            sampleable_size += std::min( item->size(), kMaxCalibrationItemSample );
+        }
+    }
+
+    CalibrationSample sample;
+    if ( sampleable_size == 0 || max_size == 0 ) {
+        return sample;
+    }
+
+    // Taking one file every stride files, so that the sample covers all the input files, not only the first ones.
+    const uint64_t stride = sampleable_size > max_size ? ( sampleable_size + max_size - 1 ) / max_size : 1;
+    uint64_t file_number = 0;
+    for ( std::size_t index = 0; index < items.size() && sample.size < max_size; ++index ) {
+        const GenericInputItem& item = items[ index ];
+        if ( !isSampleableFile( item ) || file_number++ % stride != 0 ) {
+            continue;
+        }
+        const auto sample_size = std::min( kMaxCalibrationItemSample, max_size - sample.size );
+        buffer_t content;
+        if ( !readItemSample( item, static_cast< std::size_t >( sample_size ), content ) ) {
+            continue;
+        }
+        sample.size += content.size();
+        sample.contents.push_back( std::move( content ) );
+        sample.names.push_back( BIT7Z_STRING( "sample" ) + to_tstring( index ) +
+                                item.inArchivePath().extension().string< tchar >() );
+    }
+    return sample;
+}
+
+double bit7z::requiredThroughput( const BitCalibrationOptions& options, uint64_t total_size ) noexcept {
+    double result = options.min_throughput;
+    if ( options.deadline.count() > 0 ) {
+        const double deadline_seconds = static_cast< double >( options.deadline.count() ) / 1000.0;
+        result = std::max( result, static_cast< double >( total_size ) / deadline_seconds );
+    }
+    return result;
+}
+
+std::vector< BitCompressionParameters > bit7z::calibrationCandidates( const BitCalibrationOptions& options ) {
+    if ( !options.candidates.empty() ) {
+        return options.candidates;
+    }
+    std::vector< BitCompressionParameters > result;
+    for ( const auto level : { BitCompressionLevel::Fastest,
+                               BitCompressionLevel::Fast,
+                               BitCompressionLevel::Normal,
+                               BitCompressionLevel::Max,
+                               BitCompressionLevel::Ultra } ) {
+        BitCompressionParameters parameters;
+        parameters.level = level;
+        result.push_back( parameters );
+    }
+    return result;
+}
+
+BitCalibrationResult bit7z::chooseCalibration( const std::vector< BitCalibrationResult >& results,
+                                               double required_throughput ) {
+    const BitCalibrationResult* best = nullptr;
+    for ( const auto& result : results ) {
+        if ( result.throughput < required_throughput ) {
+            continue;
+        }
+        if ( best == nullptr || result.ratio < best->ratio ||
+             ( result.ratio == best->ratio && result.throughput > best->throughput ) ) {
+            best = &result;
+        }
+    }
+    if ( best != nullptr ) {
+        BitCalibrationResult chosen = *best;
+        chosen.meets_target = true;
+        return chosen;
+    }
+
+    const auto fastest = std::max_element( results.begin(), results.end(),
+                                           []( const BitCalibrationResult& first,
+                                               const BitCalibrationResult& second ) {
+                                               return first.throughput < second.throughput;
+                                           } );
+    BitCalibrationResult chosen = *fastest;
+    chosen.meets_target = false;
+    return chosen;
+}
+
+inline std::string profileExtension( const tstring& extension ) {
+    std::string result;
+    for ( const auto character : extension ) {
+        if ( character >= BIT7Z_STRING( 'A' ) && character <= BIT7Z_STRING( 'Z' ) ) {
+            result += static_cast< char >( character - BIT7Z_STRING( 'A' ) + 'a' );
+        } else if ( ( character >= BIT7Z_STRING( 'a' ) && character <= BIT7Z_STRING( 'z' ) ) ||
+                    ( character >= BIT7Z_STRING( '0' ) && character <= BIT7Z_STRING( '9' ) ) ) {
+            result += static_cast< char >( character );
+        }
+    }
+    return result.empty() ? "none" : result;
+}
+
+inline uint64_t parametersHash( const std::vector< BitCompressionParameters >& candidates ) {
+    uint64_t hash = 0xCBF29CE484222325ull; // FNV-1a
+    const auto mix = [ &hash ]( uint64_t value ) {
+        hash = ( hash ^ value ) * 0x100000001B3ull;
+    };
+    for ( const auto& candidate : candidates ) {
+        mix( static_cast< uint64_t >( candidate.level ) );
+        mix( candidate.dictionary_size );
+        mix( candidate.word_size );
+        mix( candidate.threads_count );
+    }
+    return hash;
+}
+
+std::string bit7z::calibrationProfile( const BitAbstractArchiveCreator& creator,
+                                       const BitItemsVector& items,
+                                       const CalibrationSample& sample,
+                                       const std::vector< BitCompressionParameters >& candidates,
+                                       double required_throughput ) {
+    std::map< std::string, uint64_t > extension_sizes;
+    uint64_t total_size = 0;
+    for ( const auto& item : items ) {
+        if ( !item->isDir() ) {
+            extension_sizes[ profileExtension( item->inArchivePath().extension().string< tchar >() ) ] += item->size();
+            total_size += item->size();
+        }
+    }
+    std::vector< std::pair< std::string, uint64_t > > main_extensions{ extension_sizes.begin(),
+                                                                       extension_sizes.end() };
+    std::stable_sort( main_extensions.begin(), main_extensions.end(),
+                      []( const std::pair< std::string, uint64_t >& first,
+                          const std::pair< std::string, uint64_t >& second ) {
+                          return first.second > second.second;
+                      } );
+    main_extensions.resize( std::min( main_extensions.size(), kProfileExtensions ) );
+
+    double entropy = 0;
+    for ( const auto& content : sample.contents ) {
+        entropy += byteEntropy( content.data(), content.size() ) * static_cast< double >( content.size() );
+    }
+    if ( sample.size > 0 ) {
+        entropy /= static_cast< double >( sample.size );
+    }
+
+    std::ostringstream profile;
+    profile.imbue( std::locale::classic() );
+    profile << "f" << static_cast< unsigned >( creator.compressionFormat().value() )
+            << "-m" << static_cast< unsigned >( creator.compressionMethod() )
+            << "-s" << ( creator.solidMode() ? 1 : 0 )
+            << "-x";
+    for ( const auto& extension : main_extensions ) {
+        // The share of each extension is rounded to tenths, so that small changes of the input keep the profile.
+        const auto share = total_size > 0 ? ( extension.second * 10 + total_size / 2 ) / total_size : 0;
+        profile << ':' << extension.first << '=' << share;
+    }
+    // The entropy is rounded to half bits per byte, and the throughput to powers of two.
+    profile << "-e" << static_cast< int >( std::lround( entropy * 2 ) )
+            << "-t" << ( required_throughput > 0 ? static_cast< int >( std::floor( std::log2( required_throughput ) ) )
+                                                 : -1 )
+            << "-c" << std::hex << parametersHash( candidates ) << std::dec
+            << "-h" << std::thread::hardware_concurrency();
+    return profile.str();
+}
+
+// Cache lines: <profile> <level> <dictionary size> <word size> <threads count> <ratio> <throughput>
+inline bool parseCacheLine( const std::string& line, std::string& profile, BitCalibrationResult& result ) {
+    std::istringstream stream{ line };
+    stream.imbue( std::locale::classic() );
+    unsigned level = 0;
+    stream >> profile >> level >> result.parameters.dictionary_size >> result.parameters.word_size
+           >> result.parameters.threads_count >> result.ratio >> result.throughput;
+    result.parameters.level = static_cast< BitCompressionLevel >( level );
+    return !stream.fail();
+}
+
+inline std::vector< std::string > readCacheLines( const tstring& cache_file ) {
+    std::vector< std::string > lines;
+    fs::ifstream cache{ fs::path{ cache_file }, std::ios::binary };
+    std::string line;
+    if ( !cache.is_open() || !std::getline( cache, line ) || line != kCacheHeader ) {
+        return lines; // A missing or invalid cache is just empty.
+    }
+    while ( std::getline( cache, line ) ) {
+        if ( !line.empty() ) {
+            lines.push_back( line );
+        }
+    }
+    return lines;
+}
+
+bool bit7z::loadCalibration( const tstring& cache_file, const std::string& profile, BitCalibrationResult& result ) {
+    for ( const auto& line : readCacheLines( cache_file ) ) {
+        std::string line_profile;
+        BitCalibrationResult line_result;
+        if ( parseCacheLine( line, line_profile, line_result ) && line_profile == profile ) {
+            result = line_result;
+            return true;
+        }
+    }
+    return false;
+}
+
+void bit7z::storeCalibration( const tstring& cache_file,
+                              const std::string& profile,
+                              const BitCalibrationResult& result ) {
+    std::vector< std::string > lines = readCacheLines( cache_file );
+    lines.erase( std::remove_if( lines.begin(), lines.end(), [ &profile ]( const std::string& line ) {
+        std::string line_profile;
+        BitCalibrationResult line_result;
+        return !parseCacheLine( line, line_profile, line_result ) || line_profile == profile;
+    } ), lines.end() );
+
+    std::ostringstream line;
+    line.imbue( std::locale::classic() );
+    line.precision( 17 );
+    line << profile << ' ' << static_cast< unsigned >( result.parameters.level )
+         << ' ' << result.parameters.dictionary_size << ' ' << result.parameters.word_size
+         << ' ' << result.parameters.threads_count << ' ' << result.ratio << ' ' << result.throughput;
+    lines.push_back( line.str() );
+
+    fs::ofstream cache{ fs::path{ cache_file }, std::ios::binary | std::ios::trunc };
+    if ( !cache.is_open() ) {
+        throw BitException( "Failed to create the calibration cache", last_error_code(), cache_file );
+    }
+    cache << kCacheHeader << '\n';
+    for ( const auto& cache_line : lines ) {
+        cache << cache_line << '\n';
+    }
+    cache.flush();
+    if ( !cache ) {
+        throw BitException( "Failed to write the calibration cache", std::make_error_code( std::errc::io_error ),
+                            cache_file );
+    }
+}
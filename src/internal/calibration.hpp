@@ -0,0 +1,58 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CALIBRATION_HPP
+#define CALIBRATION_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "bitabstractarchivecreator.hpp"
+#include "bitcalibration.hpp"
+#include "bititemsvector.hpp"
+
+namespace bit7z {
+
+/* The sample of the input files compressed by a calibration: it is kept in memory,
+ * so that the calibration measures the compressor rather than the storage. */
+struct CalibrationSample {
+    std::vector< buffer_t > contents;
+    std::vector< tstring > names;
+    uint64_t size = 0;
+};
+
+/* Takes (at most) max_size bytes from the files among the given items, spreading the sample over all of them;
+ * each file contributes at most its first kMaxCalibrationItemSample bytes. */
+CalibrationSample makeCalibrationSample( const BitItemsVector& items, uint64_t max_size );
+
+// The minimum throughput required by the given options, for compressing items of the given total size.
+BIT7Z_NODISCARD double requiredThroughput( const BitCalibrationOptions& options, uint64_t total_size ) noexcept;
+
+std::vector< BitCompressionParameters > calibrationCandidates( const BitCalibrationOptions& options );
+
+/* Chooses the candidate with the best ratio among the ones reaching the required throughput,
+ * or the fastest one if none of them reaches it. The results must not be empty. */
+BitCalibrationResult chooseCalibration( const std::vector< BitCalibrationResult >& results,
+                                        double required_throughput );
+
+// A key describing the input data and the calibration settings; the calibrations are cached by this key.
+std::string calibrationProfile( const BitAbstractArchiveCreator& creator,
+                                const BitItemsVector& items,
+                                const CalibrationSample& sample,
+                                const std::vector< BitCompressionParameters >& candidates,
+                                double required_throughput );
+
+bool loadCalibration( const tstring& cache_file, const std::string& profile, BitCalibrationResult& result );
+
+void storeCalibration( const tstring& cache_file, const std::string& profile, const BitCalibrationResult& result );
+
+}  // namespace bit7z
+
+#endif // CALIBRATION_HPP
@@ -14,4 +14,9 @@
 
 using namespace bit7z;
 
-Callback::Callback( const BitAbstractArchiveHandler& handler ) : mHandler( handler ) {}
\ No newline at end of file
+#ifdef BIT7Z_TRACING
+Callback::Callback( const BitAbstractArchiveHandler& handler )
+    : mHandler( handler ), mTraceRecorder( handler.traceRecorder() ) {}
+#else
+Callback::Callback( const BitAbstractArchiveHandler& handler ) : mHandler( handler ) {}
+#endif
\ No newline at end of file
@@ -14,6 +14,7 @@
 
 #include "bitabstractarchivehandler.hpp"
 #include "internal/guids.hpp"
+#include "internal/tracing.hpp"
 
 #include <Common/MyCom.h>
 
@@ -46,10 +47,20 @@ class Callback : protected CMyUnknownImp {
 
         CALLBACK_DESTRUCTOR( ~Callback() ) = default;
 
+#ifdef BIT7Z_TRACING
+        BIT7Z_NODISCARD
+        inline BitTraceRecorder* traceRecorder() const noexcept {
+            return mTraceRecorder;
+        }
+#endif
+
     protected:
         explicit Callback( const BitAbstractArchiveHandler& handler ); // Abstract class
 
         const BitAbstractArchiveHandler& mHandler;
+#ifdef BIT7Z_TRACING
+        BitTraceRecorder* mTraceRecorder;
+#endif
 };
 
 }  // namespace bit7z
@@ -0,0 +1,62 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "internal/carchiveinstream.hpp"
+
+#include "internal/metricsrecorder.hpp"
+
+using namespace bit7z;
+
+CArchiveInStream::CArchiveInStream( IInStream* stream )
+    : mStream{ stream }, mMetrics{ nullptr }, mCancellation{ nullptr }, mObserved{ false } {}
+
+COM_DECLSPEC_NOTHROW
+STDMETHODIMP CArchiveInStream::Read( void* data, UInt32 size, UInt32* processedSize ) {
+    if ( !mObserved ) {
+        return mStream->Read( data, size, processedSize );
+    }
+
+    if ( mCancellation != nullptr && mCancellation->isCancelled() ) {
+        if ( processedSize != nullptr ) {
+            *processedSize = 0;
+        }
+        return E_ABORT;
+    }
+    if ( mMetrics == nullptr ) {
+        return mStream->Read( data, size, processedSize );
+    }
+
+    UInt32 processed = 0;
+    const auto start = metrics_clock::now();
+    const HRESULT res = mStream->Read( data, size, &processed );
+    mMetrics->io_time_ns += elapsedNs( start );
+    mMetrics->bytes_read += processed;
+    ++mMetrics->read_calls;
+
+    if ( processedSize != nullptr ) {
+        *processedSize = processed;
+    }
+    return res;
+}
+
+COM_DECLSPEC_NOTHROW
+STDMETHODIMP CArchiveInStream::Seek( Int64 offset, UInt32 seekOrigin, UInt64* newPosition ) {
+    if ( mMetrics == nullptr ) {
+        return mStream->Seek( offset, seekOrigin, newPosition );
+    }
+
+    const auto start = metrics_clock::now();
+    const HRESULT res = mStream->Seek( offset, seekOrigin, newPosition );
+    mMetrics->io_time_ns += elapsedNs( start );
+    ++mMetrics->seek_calls;
+    return res;
+}
@@ -0,0 +1,70 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CARCHIVEINSTREAM_HPP
+#define CARCHIVEINSTREAM_HPP
+
+#include "bitmetrics.hpp"
+#include "internal/guids.hpp"
+#include "internal/macros.hpp"
+#include "internal/operationcancellation.hpp"
+
+#include <7zip/IStream.h>
+#include <Common/MyCom.h>
+
+namespace bit7z {
+
+/* The stream of an opened archive, whose metrics and cancellation are enabled for each operation after opening it.
+ * When neither of them is enabled, Read and Seek are forwarded to the wrapped stream after a single branch. */
+class CArchiveInStream final : public IInStream, public CMyUnknownImp {
+    public:
+        explicit CArchiveInStream( IInStream* stream );
+
+        CArchiveInStream( const CArchiveInStream& ) = delete;
+
+        CArchiveInStream( CArchiveInStream&& ) = delete;
+
+        CArchiveInStream& operator=( const CArchiveInStream& ) = delete;
+
+        CArchiveInStream& operator=( CArchiveInStream&& ) = delete;
+
+        MY_UNKNOWN_DESTRUCTOR( ~CArchiveInStream() ) = default;
+
+        MY_UNKNOWN_IMP1( IInStream ) // NOLINT(modernize-use-noexcept)
+
+        inline void setMetrics( BitStreamMetrics* metrics ) noexcept {
+            mMetrics = metrics;
+            mObserved = mMetrics != nullptr || mCancellation != nullptr;
+        }
+
+        inline void setCancellation( const OperationCancellation* cancellation ) noexcept {
+            mCancellation = cancellation;
+            mObserved = mMetrics != nullptr || mCancellation != nullptr;
+        }
+
+        // Note: the stream must not be read anymore after releasing the wrapped stream.
+        inline void releaseStream() noexcept {
+            mStream.Release();
+        }
+
+        // IInStream
+        BIT7Z_STDMETHOD( Read, void* data, UInt32 size, UInt32* processedSize );
+
+        BIT7Z_STDMETHOD( Seek, Int64 offset, UInt32 seekOrigin, UInt64* newPosition );
+
+    private:
+        CMyComPtr< IInStream > mStream;
+        BitStreamMetrics* mMetrics;
+        const OperationCancellation* mCancellation;
+        bool mObserved; // Whether either the metrics or the cancellation are enabled.
+};
+
+}  // namespace bit7z
+
+#endif // CARCHIVEINSTREAM_HPP
@@ -18,6 +18,7 @@
 
 #include "internal/cbufferinstream.hpp"
 #include "internal/bufferutil.hpp"
+#include "internal/tracing.hpp"
 
 #include <algorithm> //for std::copy_n
 #include <cstdint>
@@ -29,6 +30,8 @@ CBufferInStream::CBufferInStream( const vector< byte_t >& in_buffer )
 
 COM_DECLSPEC_NOTHROW
 STDMETHODIMP CBufferInStream::Read( void* data, UInt32 size, UInt32* processedSize ) {
+    BIT7Z_PROBE1( stream_read, size );
+
     if ( processedSize != nullptr ) {
         *processedSize = 0;
     }
@@ -12,6 +12,7 @@
 
 #include "internal/cbufferoutstream.hpp"
 #include "internal/bufferutil.hpp"
+#include "internal/tracing.hpp"
 
 #include <cstdint>
 #include <algorithm> //for std::copy_n
@@ -54,6 +55,8 @@ STDMETHODIMP CBufferOutStream::Seek( Int64 offset, UInt32 seekOrigin, UInt64* ne
 
 COM_DECLSPEC_NOTHROW
 STDMETHODIMP CBufferOutStream::Write( const void* data, UInt32 size, UInt32* processedSize ) {
+    BIT7Z_PROBE1( stream_write, size );
+
     if ( processedSize != nullptr ) {
         *processedSize = 0;
     }
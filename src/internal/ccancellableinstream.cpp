@@ -0,0 +1,34 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "internal/ccancellableinstream.hpp"
+
+using namespace bit7z;
+
+CCancellableInStream::CCancellableInStream( IInStream* stream, const OperationCancellation* cancellation )
+    : mStream{ stream }, mCancellation{ cancellation } {}
+
+COM_DECLSPEC_NOTHROW
+STDMETHODIMP CCancellableInStream::Read( void* data, UInt32 size, UInt32* processedSize ) {
+    if ( mCancellation != nullptr && mCancellation->isCancelled() ) {
+        if ( processedSize != nullptr ) {
+            *processedSize = 0;
+        }
+        return E_ABORT;
+    }
+    return mStream->Read( data, size, processedSize );
+}
+
+COM_DECLSPEC_NOTHROW
+STDMETHODIMP CCancellableInStream::Seek( Int64 offset, UInt32 seekOrigin, UInt64* newPosition ) {
+    return mStream->Seek( offset, seekOrigin, newPosition );
+}
@@ -0,0 +1,56 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CCANCELLABLEINSTREAM_HPP
+#define CCANCELLABLEINSTREAM_HPP
+
+#include "internal/guids.hpp"
+#include "internal/macros.hpp"
+#include "internal/operationcancellation.hpp"
+
+#include <7zip/IStream.h>
+#include <Common/MyCom.h>
+
+namespace bit7z {
+
+/* Input stream decorator failing the reads with E_ABORT once its operation has been cancelled.
+ * When no cancellation is set, the calls are simply forwarded to the wrapped stream. */
+class CCancellableInStream final : public IInStream, public CMyUnknownImp {
+    public:
+        explicit CCancellableInStream( IInStream* stream, const OperationCancellation* cancellation = nullptr );
+
+        CCancellableInStream( const CCancellableInStream& ) = delete;
+
+        CCancellableInStream( CCancellableInStream&& ) = delete;
+
+        CCancellableInStream& operator=( const CCancellableInStream& ) = delete;
+
+        CCancellableInStream& operator=( CCancellableInStream&& ) = delete;
+
+        MY_UNKNOWN_DESTRUCTOR( ~CCancellableInStream() ) = default;
+
+        MY_UNKNOWN_IMP1( IInStream ) // NOLINT(modernize-use-noexcept)
+
+        inline void setCancellation( const OperationCancellation* cancellation ) noexcept {
+            mCancellation = cancellation;
+        }
+
+        // IInStream
+        BIT7Z_STDMETHOD( Read, void* data, UInt32 size, UInt32* processedSize );
+
+        BIT7Z_STDMETHOD( Seek, Int64 offset, UInt32 seekOrigin, UInt64* newPosition );
+
+    private:
+        CMyComPtr< IInStream > mStream;
+        const OperationCancellation* mCancellation;
+};
+
+}  // namespace bit7z
+
+#endif // CCANCELLABLEINSTREAM_HPP
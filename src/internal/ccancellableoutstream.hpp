@@ -0,0 +1,53 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CCANCELLABLEOUTSTREAM_HPP
+#define CCANCELLABLEOUTSTREAM_HPP
+
+#include "internal/guids.hpp"
+#include "internal/macros.hpp"
+#include "internal/operationcancellation.hpp"
+
+#include <7zip/IStream.h>
+#include <Common/MyCom.h>
+
+namespace bit7z {
+
+// Output stream decorator failing the writes with E_ABORT once its operation has been cancelled.
+class CCancellableOutStream final : public IOutStream, public CMyUnknownImp {
+    public:
+        CCancellableOutStream( IOutStream* stream, const OperationCancellation& cancellation );
+
+        CCancellableOutStream( const CCancellableOutStream& ) = delete;
+
+        CCancellableOutStream( CCancellableOutStream&& ) = delete;
+
+        CCancellableOutStream& operator=( const CCancellableOutStream& ) = delete;
+
+        CCancellableOutStream& operator=( CCancellableOutStream&& ) = delete;
+
+        MY_UNKNOWN_DESTRUCTOR( ~CCancellableOutStream() ) = default;
+
+        MY_UNKNOWN_IMP1( IOutStream ) // NOLINT(modernize-use-noexcept)
+
+        // IOutStream
+        BIT7Z_STDMETHOD( Write, const void* data, UInt32 size, UInt32* processedSize );
+
+        BIT7Z_STDMETHOD( Seek, Int64 offset, UInt32 seekOrigin, UInt64* newPosition );
+
+        BIT7Z_STDMETHOD( SetSize, UInt64 newSize );
+
+    private:
+        CMyComPtr< IOutStream > mStream;
+        const OperationCancellation& mCancellation;
+};
+
+}  // namespace bit7z
+
+#endif // CCANCELLABLEOUTSTREAM_HPP
@@ -26,6 +26,16 @@ CFileInStream::CFileInStream( const fs::path& filePath ) : CStdInStream( mFileSt
     mFileStream.rdbuf()->pubsetbuf( mBuffer.data(), buffer_size );
 }
 
+CFileInStream::CFileInStream( const fs::path& filePath, std::error_code& error )
+    : CStdInStream( mFileStream ), mBuffer{} {
+    mFileStream.open( filePath, std::ios::in | std::ios::binary );
+    if ( mFileStream.fail() ) {
+        error = make_hresult_code( HRESULT_FROM_WIN32( ERROR_OPEN_FAILED ) );
+        return;
+    }
+    mFileStream.rdbuf()->pubsetbuf( mBuffer.data(), buffer_size );
+}
+
 void CFileInStream::open( const fs::path& filePath ) {
     mFileStream.open( filePath, std::ios::in | std::ios::binary );
     if ( mFileStream.fail() ) {
@@ -11,6 +11,7 @@
 #define CFILEINSTREAM_HPP
 
 #include <array>
+#include <system_error>
 
 #include "bitdefines.hpp"
 #include "internal/cstdinstream.hpp"
@@ -22,6 +23,9 @@ class CFileInStream : public CStdInStream {
     public:
         explicit CFileInStream( const fs::path& filePath );
 
+        // Note: this constructor does not throw if the file cannot be opened, it sets the error code instead.
+        CFileInStream( const fs::path& filePath, std::error_code& error );
+
         void open( const fs::path& filePath );
 
     private:
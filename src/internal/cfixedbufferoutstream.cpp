@@ -16,6 +16,7 @@
 
 #include "biterror.hpp"
 #include "bitexception.hpp"
+#include "internal/tracing.hpp"
 #include "internal/util.hpp"
 
 using namespace bit7z;
@@ -129,6 +130,8 @@ STDMETHODIMP CFixedBufferOutStream::Seek( Int64 offset, UInt32 seekOrigin, UInt6
 
 COM_DECLSPEC_NOTHROW
 STDMETHODIMP CFixedBufferOutStream::Write( const void* data, UInt32 size, UInt32* processedSize ) {
+    BIT7Z_PROBE1( stream_write, size );
+
     if ( processedSize != nullptr ) {
         *processedSize = 0;
     }
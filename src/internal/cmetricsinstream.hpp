@@ -0,0 +1,61 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CMETRICSINSTREAM_HPP
+#define CMETRICSINSTREAM_HPP
+
+#include "bitmetrics.hpp"
+#include "internal/guids.hpp"
+#include "internal/macros.hpp"
+
+#include <7zip/IStream.h>
+#include <Common/MyCom.h>
+
+namespace bit7z {
+
+/* Input stream decorator counting and timing the calls made on the wrapped stream.
+ * When no metrics are set, the calls are simply forwarded to the wrapped stream. */
+class CMetricsInStream final : public IInStream, public CMyUnknownImp {
+    public:
+        explicit CMetricsInStream( IInStream* stream, BitStreamMetrics* metrics = nullptr );
+
+        CMetricsInStream( const CMetricsInStream& ) = delete;
+
+        CMetricsInStream( CMetricsInStream&& ) = delete;
+
+        CMetricsInStream& operator=( const CMetricsInStream& ) = delete;
+
+        CMetricsInStream& operator=( CMetricsInStream&& ) = delete;
+
+        MY_UNKNOWN_DESTRUCTOR( ~CMetricsInStream() ) = default;
+
+        MY_UNKNOWN_IMP1( IInStream ) // NOLINT(modernize-use-noexcept)
+
+        inline void setMetrics( BitStreamMetrics* metrics ) noexcept {
+            mMetrics = metrics;
+        }
+
+        // Note: the stream must not be read anymore after releasing the wrapped stream.
+        inline void releaseStream() noexcept {
+            mStream.Release();
+        }
+
+        // IInStream
+        BIT7Z_STDMETHOD( Read, void* data, UInt32 size, UInt32* processedSize );
+
+        BIT7Z_STDMETHOD( Seek, Int64 offset, UInt32 seekOrigin, UInt64* newPosition );
+
+    private:
+        CMyComPtr< IInStream > mStream;
+        BitStreamMetrics* mMetrics;
+};
+
+}  // namespace bit7z
+
+#endif // CMETRICSINSTREAM_HPP
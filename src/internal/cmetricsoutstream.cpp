@@ -0,0 +1,78 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "internal/cmetricsoutstream.hpp"
+
+#include "internal/metricsrecorder.hpp"
+
+using namespace bit7z;
+
+CMetricsOutStream::CMetricsOutStream( IOutStream* stream, BitStreamMetrics& metrics, MetricsRecorder* memory_recorder )
+    : mStream{ stream },
+      mMetrics{ metrics },
+      mMemoryRecorder{ memory_recorder },
+      mPosition{ 0 },
+      mAllocatedSize{ 0 } {}
+
+void CMetricsOutStream::updateAllocatedSize( uint64_t size ) noexcept {
+    if ( mMemoryRecorder != nullptr && size > mAllocatedSize ) {
+        mMemoryRecorder->addBufferMemory( size - mAllocatedSize );
+        mAllocatedSize = size;
+    }
+}
+
+COM_DECLSPEC_NOTHROW
+STDMETHODIMP CMetricsOutStream::Write( const void* data, UInt32 size, UInt32* processedSize ) {
+    UInt32 processed = 0;
+    const auto start = metrics_clock::now();
+    const HRESULT res = mStream->Write( data, size, &processed );
+    mMetrics.io_time_ns += elapsedNs( start );
+    mMetrics.bytes_written += processed;
+    ++mMetrics.write_calls;
+
+    mPosition += processed;
+    updateAllocatedSize( mPosition );
+
+    if ( processedSize != nullptr ) {
+        *processedSize = processed;
+    }
+    return res;
+}
+
+COM_DECLSPEC_NOTHROW
+STDMETHODIMP CMetricsOutStream::Seek( Int64 offset, UInt32 seekOrigin, UInt64* newPosition ) {
+    UInt64 position = 0;
+    const auto start = metrics_clock::now();
+    const HRESULT res = mStream->Seek( offset, seekOrigin, &position );
+    mMetrics.io_time_ns += elapsedNs( start );
+    ++mMetrics.seek_calls;
+
+    if ( res == S_OK ) {
+        mPosition = position;
+    }
+    if ( newPosition != nullptr ) {
+        *newPosition = position;
+    }
+    return res;
+}
+
+COM_DECLSPEC_NOTHROW
+STDMETHODIMP CMetricsOutStream::SetSize( UInt64 newSize ) {
+    const auto start = metrics_clock::now();
+    const HRESULT res = mStream->SetSize( newSize );
+    mMetrics.io_time_ns += elapsedNs( start );
+
+    if ( res == S_OK ) {
+        updateAllocatedSize( newSize );
+    }
+    return res;
+}
@@ -0,0 +1,62 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CMETRICSOUTSTREAM_HPP
+#define CMETRICSOUTSTREAM_HPP
+
+#include "bitmetrics.hpp"
+#include "internal/guids.hpp"
+#include "internal/macros.hpp"
+
+#include <7zip/IStream.h>
+#include <Common/MyCom.h>
+
+namespace bit7z {
+
+class MetricsRecorder;
+
+/* Output stream decorator counting and timing the calls made on the wrapped stream.
+ * If a recorder is passed, the wrapped stream is an in-memory output (e.g., a CBufferOutStream), and its growth
+ * is reported to the recorder as buffer memory allocated by bit7z. */
+class CMetricsOutStream final : public IOutStream, public CMyUnknownImp {
+    public:
+        CMetricsOutStream( IOutStream* stream, BitStreamMetrics& metrics, MetricsRecorder* memory_recorder = nullptr );
+
+        CMetricsOutStream( const CMetricsOutStream& ) = delete;
+
+        CMetricsOutStream( CMetricsOutStream&& ) = delete;
+
+        CMetricsOutStream& operator=( const CMetricsOutStream& ) = delete;
+
+        CMetricsOutStream& operator=( CMetricsOutStream&& ) = delete;
+
+        MY_UNKNOWN_DESTRUCTOR( ~CMetricsOutStream() ) = default;
+
+        MY_UNKNOWN_IMP1( IOutStream ) // NOLINT(modernize-use-noexcept)
+
+        // IOutStream
+        BIT7Z_STDMETHOD( Write, const void* data, UInt32 size, UInt32* processedSize );
+
+        BIT7Z_STDMETHOD( Seek, Int64 offset, UInt32 seekOrigin, UInt64* newPosition );
+
+        BIT7Z_STDMETHOD( SetSize, UInt64 newSize );
+
+    private:
+        CMyComPtr< IOutStream > mStream;
+        BitStreamMetrics& mMetrics;
+        MetricsRecorder* mMemoryRecorder;
+        uint64_t mPosition;
+        uint64_t mAllocatedSize;
+
+        void updateAllocatedSize( uint64_t size ) noexcept;
+};
+
+}  // namespace bit7z
+
+#endif // CMETRICSOUTSTREAM_HPP
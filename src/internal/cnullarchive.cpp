@@ -0,0 +1,591 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifdef BIT7Z_NULL_CODEC
+
+#include "internal/cnullarchive.hpp"
+
+#include "bitpropvariant.hpp"
+#include "internal/crc32.hpp"
+#include "internal/util.hpp"
+
+#include <algorithm>
+#include <cwchar>
+#include <limits>
+
+using namespace bit7z;
+using namespace NArchive;
+
+constexpr auto kNullBufferSize = 1u << 16u;
+
+constexpr auto kNullEndSignature = 0x4C4C554EU; // "NULL"
+
+constexpr unsigned char kNullSignature[ kNullSignatureSize ] = { 'b', 'i', 't', '7', 'z', 0, 0, 1 }; // NOLINT
+
+constexpr auto kNullItemHeaderSize = 8 + 8 + 8 + 4 + 1 + 4;
+
+struct NullPropertyInfo {
+    PROPID id;
+    VARTYPE type;
+};
+
+constexpr NullPropertyInfo kNullItemProperties[] = { // NOLINT(cppcoreguidelines-avoid-c-arrays)
+    { kpidPath, VT_BSTR },
+    { kpidIsDir, VT_BOOL },
+    { kpidSize, VT_UI8 },
+    { kpidPackSize, VT_UI8 },
+    { kpidMTime, VT_FILETIME },
+    { kpidAttrib, VT_UI4 },
+    { kpidMethod, VT_BSTR },
+    { kpidIsAnti, VT_BOOL },
+    { kpidCRC, VT_UI4 }
+};
+
+constexpr auto kNullItemPropertiesCount = sizeof( kNullItemProperties ) / sizeof( NullPropertyInfo );
+
+inline void putUInt( buffer_t& out, uint64_t value, unsigned bytes ) {
+    for ( unsigned i = 0; i < bytes; ++i ) {
+        out.push_back( static_cast< byte_t >( ( value >> ( 8u * i ) ) & 0xFFu ) );
+    }
+}
+
+inline uint64_t getUInt( const byte_t* data, unsigned bytes ) {
+    uint64_t result = 0;
+    for ( unsigned i = 0; i < bytes; ++i ) {
+        result |= static_cast< uint64_t >( data[ i ] ) << ( 8u * i ); // NOLINT(*-pro-bounds-pointer-arithmetic)
+    }
+    return result;
+}
+
+inline HRESULT readFully( ISequentialInStream* stream, void* data, size_t size, size_t& processed ) {
+    processed = 0;
+    auto* buffer = static_cast< byte_t* >( data );
+    while ( processed < size ) {
+        const auto chunk = static_cast< UInt32 >( std::min< size_t >( size - processed,
+                                                                      std::numeric_limits< UInt32 >::max() ) );
+        UInt32 read = 0;
+        RINOK( stream->Read( buffer + processed, chunk, &read ) ) // NOLINT(*-pro-bounds-pointer-arithmetic)
+        if ( read == 0 ) {
+            break;
+        }
+        processed += read;
+    }
+    return S_OK;
+}
+
+inline HRESULT writeFully( ISequentialOutStream* stream, const void* data, size_t size ) {
+    const auto* buffer = static_cast< const byte_t* >( data );
+    while ( size > 0 ) {
+        const auto chunk = static_cast< UInt32 >( std::min< size_t >( size, std::numeric_limits< UInt32 >::max() ) );
+        UInt32 written = 0;
+        RINOK( stream->Write( buffer, chunk, &written ) )
+        if ( written == 0 ) {
+            return E_FAIL;
+        }
+        buffer += written; // NOLINT(*-pro-bounds-pointer-arithmetic)
+        size -= written;
+    }
+    return S_OK;
+}
+
+/* Copies at most max_size bytes from in_stream to out_stream (if any), reporting the progress.
+ * Returns the number of bytes actually copied in the copied argument. */
+inline HRESULT copyStream( ISequentialInStream* in_stream,
+                           ISequentialOutStream* out_stream,
+                           buffer_t& buffer,
+                           uint64_t max_size,
+                           IProgress* progress,
+                           UInt64& completed,
+                           uint64_t& copied ) {
+    copied = 0;
+    while ( copied < max_size ) {
+        const auto chunk = static_cast< size_t >( std::min< uint64_t >( max_size - copied, buffer.size() ) );
+        size_t read = 0;
+        RINOK( readFully( in_stream, buffer.data(), chunk, read ) )
+        if ( read == 0 ) {
+            break;
+        }
+        if ( out_stream != nullptr ) {
+            RINOK( writeFully( out_stream, buffer.data(), read ) )
+        }
+        copied += read;
+        completed += read;
+        RINOK( progress->SetCompleted( &completed ) )
+        if ( read < chunk ) {
+            break;
+        }
+    }
+    return S_OK;
+}
+
+// The CRC of the data generated for a synthetic item.
+inline uint32_t syntheticItemCrc( const NullItem& item ) {
+    const buffer_t chunk( static_cast< size_t >( std::min< uint64_t >( item.size, kNullBufferSize ) ),
+                          static_cast< byte_t >( item.offset & 0xFFu ) );
+    uint32_t crc = 0;
+    for ( uint64_t remaining = item.size; remaining > 0; ) {
+        const auto chunk_size = static_cast< size_t >( std::min< uint64_t >( remaining, chunk.size() ) );
+        crc = crc32( crc, chunk.data(), chunk_size );
+        remaining -= chunk_size;
+    }
+    return crc;
+}
+
+namespace bit7z {
+
+void writeNullSignature( buffer_t& out ) {
+    for ( const auto signature_byte : kNullSignature ) {
+        out.push_back( static_cast< byte_t >( signature_byte ) );
+    }
+}
+
+void writeNullItem( buffer_t& out, const NullItem& item ) {
+    putUInt( out, item.offset, 8 );
+    putUInt( out, item.size, 8 );
+    putUInt( out, item.mtime, 8 );
+    putUInt( out, item.attributes, 4 );
+    putUInt( out, item.flags, 1 );
+    putUInt( out, item.path.size(), 4 );
+    for ( const auto path_char : item.path ) {
+        out.push_back( static_cast< byte_t >( path_char ) );
+    }
+}
+
+void writeNullFooter( buffer_t& out, uint64_t index_offset, uint32_t items_count ) {
+    putUInt( out, index_offset, 8 );
+    putUInt( out, items_count, 4 );
+    putUInt( out, kNullEndSignature, 4 );
+}
+
+} // namespace bit7z
+
+HRESULT CNullArchive::readIndex( IInStream* stream ) {
+    UInt64 archive_size = 0;
+    RINOK( stream->Seek( 0, STREAM_SEEK_END, &archive_size ) )
+    if ( archive_size < kNullSignatureSize + kNullFooterSize ) {
+        return S_FALSE;
+    }
+
+    byte_t signature[ kNullSignatureSize ]; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+    size_t read = 0;
+    RINOK( stream->Seek( 0, STREAM_SEEK_SET, nullptr ) )
+    RINOK( readFully( stream, signature, kNullSignatureSize, read ) )
+    if ( read != kNullSignatureSize ||
+         !std::equal( std::begin( signature ), std::end( signature ), std::begin( kNullSignature ),
+                      []( byte_t lhs, unsigned char rhs ) { return static_cast< unsigned char >( lhs ) == rhs; } ) ) {
+        return S_FALSE;
+    }
+
+    byte_t footer[ kNullFooterSize ]; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+    const UInt64 footer_offset = archive_size - kNullFooterSize;
+    RINOK( stream->Seek( static_cast< Int64 >( footer_offset ), STREAM_SEEK_SET, nullptr ) )
+    RINOK( readFully( stream, footer, kNullFooterSize, read ) )
+    const uint64_t index_offset = getUInt( footer, 8 );
+    const auto items_count = static_cast< uint32_t >( getUInt( footer + 8, 4 ) ); // NOLINT(*-pointer-arithmetic)
+    if ( read != kNullFooterSize || getUInt( footer + 12, 4 ) != kNullEndSignature || // NOLINT(*-pointer-arithmetic)
+         index_offset < kNullSignatureSize || index_offset > footer_offset ) {
+        return S_FALSE;
+    }
+
+    buffer_t index( static_cast< size_t >( footer_offset - index_offset ) );
+    RINOK( stream->Seek( static_cast< Int64 >( index_offset ), STREAM_SEEK_SET, nullptr ) )
+    RINOK( readFully( stream, index.data(), index.size(), read ) )
+    if ( read != index.size() ) {
+        return S_FALSE;
+    }
+
+    std::vector< NullItem > items;
+    items.reserve( std::min< size_t >( items_count, index.size() / kNullItemHeaderSize ) );
+    size_t position = 0;
+    for ( uint32_t i = 0; i < items_count; ++i ) {
+        if ( index.size() - position < kNullItemHeaderSize ) {
+            return S_FALSE;
+        }
+        const byte_t* header = &index[ position ];
+        NullItem item{};
+        item.offset = getUInt( header, 8 );
+        item.size = getUInt( header + 8, 8 ); // NOLINT(*-pro-bounds-pointer-arithmetic)
+        item.mtime = getUInt( header + 16, 8 ); // NOLINT(*-pro-bounds-pointer-arithmetic)
+        item.attributes = static_cast< uint32_t >( getUInt( header + 24, 4 ) ); // NOLINT(*-pointer-arithmetic)
+        item.flags = static_cast< uint8_t >( getUInt( header + 28, 1 ) ); // NOLINT(*-pointer-arithmetic)
+        const auto path_size = static_cast< size_t >( getUInt( header + 29, 4 ) ); // NOLINT(*-pointer-arithmetic)
+        position += kNullItemHeaderSize;
+
+        if ( index.size() - position < path_size ) {
+            return S_FALSE;
+        }
+        item.path.reserve( path_size );
+        for ( size_t j = 0; j < path_size; ++j ) {
+            item.path.push_back( static_cast< char >( index[ position + j ] ) );
+        }
+        position += path_size;
+
+        if ( ( item.flags & kNullItemSynthetic ) == 0 &&
+             ( item.offset < kNullSignatureSize || item.offset > index_offset ||
+               item.size > index_offset - item.offset ) ) {
+            return S_FALSE;
+        }
+        items.push_back( std::move( item ) );
+    }
+    mItems = std::move( items );
+    return S_OK;
+}
+
+HRESULT CNullArchive::copyItemData( const NullItem& item,
+                                    ISequentialOutStream* out_stream,
+                                    buffer_t& buffer,
+                                    IProgress* progress,
+                                    UInt64& completed ) const {
+    if ( buffer.empty() ) {
+        buffer.resize( kNullBufferSize );
+    }
+
+    if ( ( item.flags & kNullItemSynthetic ) != 0 ) {
+        const auto fill_size = static_cast< size_t >( std::min< uint64_t >( item.size, buffer.size() ) );
+        std::fill_n( buffer.begin(), fill_size, static_cast< byte_t >( item.offset & 0xFFu ) );
+
+        uint64_t remaining = item.size;
+        while ( remaining > 0 ) {
+            const auto chunk = static_cast< size_t >( std::min< uint64_t >( remaining, fill_size ) );
+            if ( out_stream != nullptr ) {
+                RINOK( writeFully( out_stream, buffer.data(), chunk ) )
+            }
+            remaining -= chunk;
+            completed += chunk;
+            RINOK( progress->SetCompleted( &completed ) )
+        }
+        return S_OK;
+    }
+
+    if ( mStream == nullptr ) {
+        return E_FAIL;
+    }
+    RINOK( mStream->Seek( static_cast< Int64 >( item.offset ), STREAM_SEEK_SET, nullptr ) )
+    uint64_t copied = 0;
+    RINOK( copyStream( mStream, out_stream, buffer, item.size, progress, completed, copied ) )
+    return copied == item.size ? S_OK : S_FALSE;
+}
+
+COM_DECLSPEC_NOTHROW
+STDMETHODIMP CNullArchive::Open( IInStream* stream,
+                                 const UInt64* /*maxCheckStartPosition*/,
+                                 IArchiveOpenCallback* /*openCallback*/ ) {
+    Close();
+    if ( stream == nullptr ) {
+        return E_INVALIDARG;
+    }
+
+    const HRESULT res = readIndex( stream );
+    if ( res != S_OK ) {
+        mItems.clear();
+        return res;
+    }
+    mStream = stream;
+    return S_OK;
+}
+
+COM_DECLSPEC_NOTHROW
+STDMETHODIMP CNullArchive::Close() noexcept {
+    mStream.Release();
+    mItems.clear();
+    mSyntheticCrcs.clear();
+    return S_OK;
+}
+
+COM_DECLSPEC_NOTHROW
+STDMETHODIMP CNullArchive::GetNumberOfItems( UInt32* numItems ) noexcept {
+    *numItems = static_cast< UInt32 >( mItems.size() );
+    return S_OK;
+}
+
+COM_DECLSPEC_NOTHROW
+STDMETHODIMP CNullArchive::GetProperty( UInt32 index, PROPID propID, PROPVARIANT* value ) {
+    if ( index >= mItems.size() ) {
+        return E_INVALIDARG;
+    }
+
+    const NullItem& item = mItems[ index ];
+    BitPropVariant prop;
+    switch ( propID ) {
+        case kpidPath:
+            prop = widen( item.path );
+            break;
+        case kpidIsDir:
+            prop = ( item.flags & kNullItemDirectory ) != 0;
+            break;
+        case kpidSize:
+            prop = item.size;
+            break;
+        case kpidPackSize:
+            prop = ( item.flags & kNullItemSynthetic ) != 0 ? uint64_t{ 0 } : item.size;
+            break;
+        case kpidMTime: {
+            FILETIME mtime{};
+            mtime.dwLowDateTime = static_cast< DWORD >( item.mtime & 0xFFFFFFFFu );
+            mtime.dwHighDateTime = static_cast< DWORD >( item.mtime >> 32u );
+            prop = mtime;
+            break;
+        }
+        case kpidAttrib:
+            prop = item.attributes;
+            break;
+        case kpidMethod:
+            if ( ( item.flags & ( kNullItemDirectory | kNullItemAnti ) ) == 0 ) {
+                prop = std::wstring{ L"Copy" };
+            }
+            break;
+        case kpidIsAnti:
+            prop = ( item.flags & kNullItemAnti ) != 0;
+            break;
+        case kpidCRC:
+            if ( ( item.flags & kNullItemSynthetic ) != 0 ) {
+                auto crc_it = mSyntheticCrcs.find( index );
+                if ( crc_it == mSyntheticCrcs.end() ) {
+                    crc_it = mSyntheticCrcs.emplace( index, syntheticItemCrc( item ) ).first;
+                }
+                prop = crc_it->second;
+            }
+            break;
+        default:
+            break;
+    }
+    *value = prop;
+    prop.bstrVal = nullptr;
+    return S_OK;
+}
+
+COM_DECLSPEC_NOTHROW
+STDMETHODIMP CNullArchive::Extract( const UInt32* indices,
+                                    UInt32 numItems,
+                                    Int32 testMode,
+                                    IArchiveExtractCallback* extractCallback ) {
+    const bool all_items = numItems == static_cast< UInt32 >( -1 );
+    if ( all_items ) {
+        numItems = static_cast< UInt32 >( mItems.size() );
+    } else if ( indices == nullptr && numItems > 0 ) {
+        return E_INVALIDARG;
+    }
+
+    UInt64 total_size = 0;
+    for ( UInt32 i = 0; i < numItems; ++i ) {
+        const UInt32 index = all_items ? i : indices[ i ]; // NOLINT(*-pro-bounds-pointer-arithmetic)
+        if ( index >= mItems.size() ) {
+            return E_INVALIDARG;
+        }
+        total_size += mItems[ index ].size;
+    }
+    RINOK( extractCallback->SetTotal( total_size ) )
+
+    const Int32 ask_mode = testMode != 0 ? NExtract::NAskMode::kTest : NExtract::NAskMode::kExtract;
+    buffer_t buffer;
+    UInt64 completed = 0;
+    for ( UInt32 i = 0; i < numItems; ++i ) {
+        RINOK( extractCallback->SetCompleted( &completed ) )
+
+        const UInt32 index = all_items ? i : indices[ i ]; // NOLINT(*-pro-bounds-pointer-arithmetic)
+        const NullItem& item = mItems[ index ];
+        CMyComPtr< ISequentialOutStream > out_stream;
+        RINOK( extractCallback->GetStream( index, &out_stream, ask_mode ) )
+        if ( testMode == 0 && out_stream == nullptr ) {
+            completed += item.size;
+            continue;
+        }
+
+        RINOK( extractCallback->PrepareOperation( ask_mode ) )
+        Int32 result = NExtract::NOperationResult::kOK;
+        if ( ( item.flags & kNullItemDirectory ) == 0 ) {
+            const HRESULT res = copyItemData( item, out_stream, buffer, extractCallback, completed );
+            if ( res == S_FALSE ) {
+                result = NExtract::NOperationResult::kUnexpectedEnd;
+            } else if ( res != S_OK ) {
+                return res;
+            }
+        }
+        out_stream.Release();
+        RINOK( extractCallback->SetOperationResult( result ) )
+    }
+    return extractCallback->SetCompleted( &completed );
+}
+
+COM_DECLSPEC_NOTHROW
+STDMETHODIMP CNullArchive::GetArchiveProperty( PROPID /*propID*/, PROPVARIANT* value ) noexcept {
+    value->vt = VT_EMPTY;
+    return S_OK;
+}
+
+COM_DECLSPEC_NOTHROW
+STDMETHODIMP CNullArchive::GetNumberOfProperties( UInt32* numProps ) noexcept {
+    *numProps = static_cast< UInt32 >( kNullItemPropertiesCount );
+    return S_OK;
+}
+
+COM_DECLSPEC_NOTHROW
+STDMETHODIMP CNullArchive::GetPropertyInfo( UInt32 index, BSTR* name, PROPID* propID, VARTYPE* varType ) noexcept {
+    if ( index >= kNullItemPropertiesCount ) {
+        return E_INVALIDARG;
+    }
+    *name = nullptr;
+    *propID = kNullItemProperties[ index ].id; // NOLINT(*-pro-bounds-constant-array-index)
+    *varType = kNullItemProperties[ index ].type; // NOLINT(*-pro-bounds-constant-array-index)
+    return S_OK;
+}
+
+COM_DECLSPEC_NOTHROW
+STDMETHODIMP CNullArchive::GetNumberOfArchiveProperties( UInt32* numProps ) noexcept {
+    *numProps = 0;
+    return S_OK;
+}
+
+COM_DECLSPEC_NOTHROW
+STDMETHODIMP CNullArchive::GetArchivePropertyInfo( UInt32 /*index*/,
+                                                   BSTR* /*name*/,
+                                                   PROPID* /*propID*/,
+                                                   VARTYPE* /*varType*/ ) noexcept {
+    return E_INVALIDARG;
+}
+
+COM_DECLSPEC_NOTHROW
+STDMETHODIMP CNullArchive::UpdateItems( ISequentialOutStream* outStream,
+                                        UInt32 numItems,
+                                        IArchiveUpdateCallback* updateCallback ) {
+    if ( outStream == nullptr || updateCallback == nullptr ) {
+        return E_INVALIDARG;
+    }
+
+    struct UpdateInfo {
+        Int32 new_data;
+        Int32 new_properties;
+        UInt32 index_in_archive;
+    };
+
+    std::vector< UpdateInfo > infos( numItems );
+    UInt64 total_size = 0;
+    for ( UInt32 i = 0; i < numItems; ++i ) {
+        UpdateInfo& info = infos[ i ];
+        RINOK( updateCallback->GetUpdateItemInfo( i, &info.new_data, &info.new_properties, &info.index_in_archive ) )
+        if ( ( info.new_data == 0 || info.new_properties == 0 ) && info.index_in_archive >= mItems.size() ) {
+            return E_INVALIDARG;
+        }
+        if ( info.new_data != 0 ) {
+            BitPropVariant size;
+            RINOK( updateCallback->GetProperty( i, kpidSize, &size ) )
+            total_size += size.isEmpty() ? 0 : size.getUInt64();
+        } else {
+            total_size += mItems[ info.index_in_archive ].size;
+        }
+    }
+    RINOK( updateCallback->SetTotal( total_size ) )
+
+    buffer_t header;
+    writeNullSignature( header );
+    RINOK( writeFully( outStream, header.data(), header.size() ) )
+
+    std::vector< NullItem > items;
+    items.reserve( numItems );
+    buffer_t buffer( kNullBufferSize );
+    UInt64 completed = 0;
+    uint64_t offset = kNullSignatureSize;
+    for ( UInt32 i = 0; i < numItems; ++i ) {
+        const UpdateInfo& info = infos[ i ];
+        NullItem item = info.new_properties == 0 ? mItems[ info.index_in_archive ] : NullItem{};
+        if ( info.new_properties != 0 ) {
+            BitPropVariant prop;
+            RINOK( updateCallback->GetProperty( i, kpidPath, &prop ) )
+            if ( prop.isString() && prop.bstrVal != nullptr ) {
+                item.path = narrow( prop.bstrVal, std::wcslen( prop.bstrVal ) );
+            }
+            prop.clear();
+            RINOK( updateCallback->GetProperty( i, kpidIsDir, &prop ) )
+            if ( prop.isBool() && prop.getBool() ) {
+                item.flags = kNullItemDirectory;
+            }
+            prop.clear();
+            RINOK( updateCallback->GetProperty( i, kpidMTime, &prop ) )
+            if ( prop.isFileTime() ) {
+                const FILETIME mtime = prop.getFileTime();
+                item.mtime = ( static_cast< uint64_t >( mtime.dwHighDateTime ) << 32u ) | mtime.dwLowDateTime;
+            }
+            prop.clear();
+            RINOK( updateCallback->GetProperty( i, kpidAttrib, &prop ) )
+            if ( prop.isUInt32() ) {
+                item.attributes = prop.getUInt32();
+            }
+            prop.clear();
+            RINOK( updateCallback->GetProperty( i, kpidIsAnti, &prop ) )
+            if ( prop.isBool() && prop.getBool() ) {
+                item.flags = static_cast< uint8_t >( item.flags | kNullItemAnti );
+            }
+            if ( info.new_data == 0 ) {
+                const NullItem& old_item = mItems[ info.index_in_archive ];
+                item.offset = old_item.offset;
+                item.size = old_item.size;
+                item.flags = static_cast< uint8_t >( item.flags | ( old_item.flags & kNullItemSynthetic ) );
+            }
+        }
+
+        if ( info.new_data != 0 ) {
+            item.offset = offset;
+            item.size = 0;
+            item.flags = static_cast< uint8_t >( item.flags & ~kNullItemSynthetic );
+            if ( ( item.flags & ( kNullItemDirectory | kNullItemAnti ) ) == 0 ) {
+                CMyComPtr< ISequentialInStream > in_stream;
+                const HRESULT res = updateCallback->GetStream( i, &in_stream );
+                if ( res != S_OK && res != S_FALSE ) {
+                    return res;
+                }
+                if ( in_stream != nullptr ) {
+                    RINOK( copyStream( in_stream, outStream, buffer, std::numeric_limits< uint64_t >::max(),
+                                       updateCallback, completed, item.size ) )
+                }
+            }
+            RINOK( updateCallback->SetOperationResult( NUpdate::NOperationResult::kOK ) )
+        } else if ( ( item.flags & kNullItemSynthetic ) == 0 ) {
+            const NullItem& old_item = mItems[ info.index_in_archive ];
+            item.offset = offset;
+            const HRESULT res = copyItemData( old_item, outStream, buffer, updateCallback, completed );
+            if ( res != S_OK ) {
+                return res == S_FALSE ? E_FAIL : res;
+            }
+        } else {
+            completed += item.size;
+        }
+
+        if ( ( item.flags & kNullItemSynthetic ) == 0 ) {
+            offset += item.size;
+        }
+        items.push_back( std::move( item ) );
+    }
+
+    buffer_t index;
+    for ( const auto& item : items ) {
+        writeNullItem( index, item );
+    }
+    writeNullFooter( index, offset, static_cast< uint32_t >( items.size() ) );
+    RINOK( writeFully( outStream, index.data(), index.size() ) )
+    return updateCallback->SetCompleted( &completed );
+}
+
+COM_DECLSPEC_NOTHROW
+STDMETHODIMP CNullArchive::GetFileTimeType( UInt32* type ) noexcept {
+    *type = NFileTimeType::kWindows;
+    return S_OK;
+}
+
+COM_DECLSPEC_NOTHROW
+STDMETHODIMP CNullArchive::SetProperties( const wchar_t* const* /*names*/,
+                                          const PROPVARIANT* /*values*/,
+                                          UInt32 /*numProps*/ ) noexcept {
+    // The null codec has no settings: all the properties (e.g., the compression level) are ignored.
+    return S_OK;
+}
+
+#endif
@@ -0,0 +1,142 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CNULLARCHIVE_HPP
+#define CNULLARCHIVE_HPP
+
+#ifdef BIT7Z_NULL_CODEC
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bittypes.hpp"
+#include "internal/guids.hpp"
+#include "internal/macros.hpp"
+
+#include <7zip/Archive/IArchive.h>
+#include <Common/MyCom.h>
+
+namespace bit7z {
+
+/* Layout of the archives of the null codec (all the integers are little-endian):
+ *   - the signature "bit7z\0\0\1" (8 bytes);
+ *   - the raw data of the stored items, one after the other;
+ *   - the index of the items, i.e., for each item:
+ *       - the offset of its data from the start of the archive (8 bytes);
+ *       - the size of the item (8 bytes);
+ *       - the last write time, as a FILETIME (8 bytes);
+ *       - the attributes (4 bytes);
+ *       - the flags of the item (1 byte, e.g., kNullItemDirectory);
+ *       - the length of the path (4 bytes), followed by the UTF-8 path;
+ *   - the footer, i.e., the offset of the index (8 bytes), the number of items (4 bytes),
+ *     and the end signature "NULL" (4 bytes). */
+constexpr auto kNullSignatureSize = 8;
+constexpr auto kNullFooterSize = 16;
+
+constexpr uint8_t kNullItemDirectory = 1u << 0u;
+
+/* The data of a synthetic item is not stored in the archive, but it is generated when extracting it:
+ * in this case, the offset field of the item is the value of all the bytes of its data.
+ * Unlike the stored items, synthetic items report the CRC of their data (like in the formats storing CRCs). */
+constexpr uint8_t kNullItemSynthetic = 1u << 1u;
+
+// An anti-item marks the deletion of the item with the same path (e.g., in a differential archive); it has no data.
+constexpr uint8_t kNullItemAnti = 1u << 2u;
+
+struct NullItem {
+    uint64_t offset;
+    uint64_t size;
+    uint64_t mtime;
+    uint32_t attributes;
+    uint8_t flags;
+    std::string path;
+};
+
+void writeNullSignature( buffer_t& out );
+
+void writeNullItem( buffer_t& out, const NullItem& item );
+
+void writeNullFooter( buffer_t& out, uint64_t index_offset, uint32_t items_count );
+
+class CNullArchive final : public IInArchive, public IOutArchive, public ISetProperties, public CMyUnknownImp {
+    public:
+        CNullArchive() = default;
+
+        CNullArchive( const CNullArchive& ) = delete;
+
+        CNullArchive( CNullArchive&& ) = delete;
+
+        CNullArchive& operator=( const CNullArchive& ) = delete;
+
+        CNullArchive& operator=( CNullArchive&& ) = delete;
+
+        MY_UNKNOWN_DESTRUCTOR( ~CNullArchive() ) = default;
+
+        MY_UNKNOWN_IMP3( IInArchive, IOutArchive, ISetProperties ) // NOLINT(modernize-use-noexcept)
+
+        // IInArchive
+        BIT7Z_STDMETHOD( Open,
+                         IInStream* stream,
+                         const UInt64* maxCheckStartPosition,
+                         IArchiveOpenCallback* openCallback );
+
+        BIT7Z_STDMETHOD_NOEXCEPT( Close );
+
+        BIT7Z_STDMETHOD_NOEXCEPT( GetNumberOfItems, UInt32* numItems );
+
+        BIT7Z_STDMETHOD( GetProperty, UInt32 index, PROPID propID, PROPVARIANT* value );
+
+        BIT7Z_STDMETHOD( Extract, const UInt32* indices, UInt32 numItems, Int32 testMode,
+                         IArchiveExtractCallback* extractCallback );
+
+        BIT7Z_STDMETHOD_NOEXCEPT( GetArchiveProperty, PROPID propID, PROPVARIANT* value );
+
+        BIT7Z_STDMETHOD_NOEXCEPT( GetNumberOfProperties, UInt32* numProps );
+
+        BIT7Z_STDMETHOD_NOEXCEPT( GetPropertyInfo, UInt32 index, BSTR* name, PROPID* propID, VARTYPE* varType );
+
+        BIT7Z_STDMETHOD_NOEXCEPT( GetNumberOfArchiveProperties, UInt32* numProps );
+
+        BIT7Z_STDMETHOD_NOEXCEPT( GetArchivePropertyInfo, UInt32 index, BSTR* name, PROPID* propID, VARTYPE* varType );
+
+        // IOutArchive
+        BIT7Z_STDMETHOD( UpdateItems, ISequentialOutStream* outStream, UInt32 numItems,
+                         IArchiveUpdateCallback* updateCallback );
+
+        BIT7Z_STDMETHOD_NOEXCEPT( GetFileTimeType, UInt32* type );
+
+        // ISetProperties
+        BIT7Z_STDMETHOD_NOEXCEPT( SetProperties,
+                                  const wchar_t* const* names,
+                                  const PROPVARIANT* values,
+                                  UInt32 numProps );
+
+    private:
+        CMyComPtr< IInStream > mStream;
+        std::vector< NullItem > mItems;
+
+        // The CRCs of the synthetic items, computed once when their kpidCRC property is first read.
+        std::unordered_map< UInt32, uint32_t > mSyntheticCrcs;
+
+        HRESULT readIndex( IInStream* stream );
+
+        HRESULT copyItemData( const NullItem& item,
+                              ISequentialOutStream* out_stream,
+                              buffer_t& buffer,
+                              IProgress* progress,
+                              UInt64& completed ) const;
+};
+
+}  // namespace bit7z
+
+#endif
+
+#endif // CNULLARCHIVE_HPP
@@ -0,0 +1,52 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CPREFETCHEDINSTREAM_HPP
+#define CPREFETCHEDINSTREAM_HPP
+
+#include "bittypes.hpp"
+#include "internal/guids.hpp"
+#include "internal/macros.hpp"
+
+#include <7zip/IStream.h>
+#include <Common/MyCom.h>
+
+namespace bit7z {
+
+// An input stream over the content of an item that was read in advance (see ItemPrefetcher).
+// Unlike CBufferInStream, the stream owns the buffer it reads from.
+class CPrefetchedInStream final : public IInStream, public CMyUnknownImp {
+    public:
+        explicit CPrefetchedInStream( buffer_t&& content );
+
+        CPrefetchedInStream( const CPrefetchedInStream& ) = delete;
+
+        CPrefetchedInStream( CPrefetchedInStream&& ) = delete;
+
+        CPrefetchedInStream& operator=( const CPrefetchedInStream& ) = delete;
+
+        CPrefetchedInStream& operator=( CPrefetchedInStream&& ) = delete;
+
+        MY_UNKNOWN_DESTRUCTOR( ~CPrefetchedInStream() ) = default;
+
+        MY_UNKNOWN_IMP1( IInStream ) // NOLINT(modernize-use-noexcept)
+
+        // IInStream
+        BIT7Z_STDMETHOD( Read, void* data, UInt32 size, UInt32* processedSize );
+
+        BIT7Z_STDMETHOD( Seek, Int64 offset, UInt32 seekOrigin, UInt64* newPosition );
+
+    private:
+        buffer_t mContent;
+        CMyComPtr< IInStream > mContentStream;
+};
+
+}  // namespace bit7z
+
+#endif // CPREFETCHEDINSTREAM_HPP
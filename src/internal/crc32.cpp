@@ -0,0 +1,40 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "internal/crc32.hpp"
+
+#include <array>
+
+constexpr uint32_t kCrc32Polynomial = 0xEDB88320u;
+
+inline std::array< uint32_t, 256 > makeCrc32Table() noexcept {
+    std::array< uint32_t, 256 > table{};
+    for ( uint32_t i = 0; i < table.size(); ++i ) {
+        uint32_t value = i;
+        for ( int bit = 0; bit < 8; ++bit ) {
+            value = ( value & 1u ) != 0 ? ( value >> 1u ) ^ kCrc32Polynomial : value >> 1u;
+        }
+        table[ i ] = value;
+    }
+    return table;
+}
+
+uint32_t bit7z::crc32( uint32_t crc, const byte_t* data, std::size_t size ) noexcept {
+    static const auto table = makeCrc32Table();
+
+    crc = ~crc;
+    for ( std::size_t i = 0; i < size; ++i ) {
+        const auto byte = static_cast< uint8_t >( data[ i ] ); // NOLINT(*-pro-bounds-pointer-arithmetic)
+        crc = table[ ( crc ^ byte ) & 0xFFu ] ^ ( crc >> 8u );
+    }
+    return ~crc;
+}
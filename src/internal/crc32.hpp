@@ -0,0 +1,26 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CRC32_HPP
+#define CRC32_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "bitdefines.hpp"
+#include "bittypes.hpp"
+
+namespace bit7z {
+
+// Updates the given CRC-32 (IEEE 802.3, the one used by 7-zip) with the given data; the initial CRC is 0.
+BIT7Z_NODISCARD uint32_t crc32( uint32_t crc, const byte_t* data, std::size_t size ) noexcept;
+
+}  // namespace bit7z
+
+#endif //CRC32_HPP
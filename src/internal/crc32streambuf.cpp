@@ -0,0 +1,46 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "internal/crc32streambuf.hpp"
+
+#include "internal/crc32.hpp"
+
+namespace bit7z {
+
+uint32_t Crc32StreamBuf::crc() const noexcept {
+    return mCrc;
+}
+
+auto Crc32StreamBuf::overflow( int_type character ) -> int_type {
+    if ( traits_type::eq_int_type( character, traits_type::eof() ) ) {
+        return traits_type::not_eof( character );
+    }
+    const auto value = static_cast< byte_t >( traits_type::to_char_type( character ) );
+    mCrc = crc32( mCrc, &value, 1 );
+    ++mSize;
+    return character;
+}
+
+std::streamsize Crc32StreamBuf::xsputn( const char_type* data, std::streamsize size ) {
+    mCrc = crc32( mCrc, reinterpret_cast< const byte_t* >( data ), static_cast< std::size_t >( size ) );
+    mSize += size;
+    return size;
+}
+
+auto Crc32StreamBuf::seekoff( off_type offset, std::ios_base::seekdir way, std::ios_base::openmode which ) -> pos_type {
+    if ( offset != 0 || way != std::ios_base::cur || ( which & std::ios_base::out ) == 0 ) {
+        return pos_type( off_type( -1 ) );
+    }
+    return pos_type( mSize );
+}
+
+}  // namespace bit7z
@@ -0,0 +1,40 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CRC32STREAMBUF_HPP
+#define CRC32STREAMBUF_HPP
+
+#include <cstdint>
+#include <streambuf>
+
+#include "bitdefines.hpp"
+
+namespace bit7z {
+
+// A stream buffer computing the CRC-32 of the data written to it, without storing it.
+class Crc32StreamBuf final : public std::streambuf {
+    public:
+        BIT7Z_NODISCARD uint32_t crc() const noexcept;
+
+    protected:
+        int_type overflow( int_type character ) override;
+
+        std::streamsize xsputn( const char_type* data, std::streamsize size ) override;
+
+        // Only the current position can be queried (e.g., via tellp), as the data is not stored.
+        pos_type seekoff( off_type offset, std::ios_base::seekdir way, std::ios_base::openmode which ) override;
+
+    private:
+        uint32_t mCrc = 0;
+        std::streamsize mSize = 0;
+};
+
+}  // namespace bit7z
+
+#endif //CRC32STREAMBUF_HPP
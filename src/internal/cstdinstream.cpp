@@ -13,6 +13,7 @@
 #include "internal/cstdinstream.hpp"
 
 #include "internal/streamutil.hpp"
+#include "internal/tracing.hpp"
 
 using namespace bit7z;
 
@@ -20,6 +21,8 @@ CStdInStream::CStdInStream( istream& inputStream ) : mInputStream( inputStream )
 
 COM_DECLSPEC_NOTHROW
 STDMETHODIMP CStdInStream::Read( void* data, UInt32 size, UInt32* processedSize ) {
+    BIT7Z_PROBE1( stream_read, size );
+
     mInputStream.clear();
 
     if ( processedSize != nullptr ) {
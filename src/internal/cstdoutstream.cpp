@@ -13,6 +13,7 @@
 #include "internal/cstdoutstream.hpp"
 
 #include "internal/streamutil.hpp"
+#include "internal/tracing.hpp"
 
 #include <iterator>
 
@@ -22,6 +23,8 @@ CStdOutStream::CStdOutStream( std::ostream& outputStream ) : mOutputStream( outp
 
 COM_DECLSPEC_NOTHROW
 STDMETHODIMP CStdOutStream::Write( const void* data, UInt32 size, UInt32* processedSize ) {
+    BIT7Z_PROBE1( stream_write, size );
+
     if ( processedSize != nullptr ) {
         *processedSize = 0;
     }
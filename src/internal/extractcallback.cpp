@@ -13,6 +13,8 @@
 #include "internal/extractcallback.hpp"
 
 #include "bitexception.hpp"
+#include "internal/ccancellableoutstream.hpp"
+#include "internal/cmetricsoutstream.hpp"
 #include "internal/util.hpp"
 
 using namespace bit7z;
@@ -20,7 +22,12 @@ using namespace bit7z;
 ExtractCallback::ExtractCallback( const BitInputArchive& inputArchive )
     : Callback( inputArchive.handler() ),
       mInputArchive( inputArchive ),
-      mExtractMode( ExtractMode::Extract ) {}
+      mExtractMode( ExtractMode::Extract ),
+      mFailedItems( nullptr ),
+      mCurrentIndex( 0 ),
+      mProgressReporter( mHandler ),
+      mMetrics( MetricsRecorder::create( mHandler ) ),
+      mCancellation( mHandler ) {}
 
 HRESULT ExtractCallback::finishOperation( OperationResult operation_result ) {
     releaseStream();
@@ -29,24 +36,25 @@ HRESULT ExtractCallback::finishOperation( OperationResult operation_result ) {
 
 COM_DECLSPEC_NOTHROW
 STDMETHODIMP ExtractCallback::SetTotal( UInt64 size ) {
-    if ( mHandler.totalCallback() ) {
-        mHandler.totalCallback()( size );
-    }
+    mProgressReporter.reportTotal( size );
     return S_OK;
 }
 
 COM_DECLSPEC_NOTHROW
 STDMETHODIMP ExtractCallback::SetCompleted( const UInt64* completeValue ) {
-    if ( mHandler.progressCallback() && completeValue != nullptr ) {
-        return mHandler.progressCallback()( *completeValue ) ? S_OK : E_ABORT;
+    if ( mCancellation.isCancelled() ) {
+        return E_ABORT;
+    }
+    if ( completeValue != nullptr ) {
+        return mProgressReporter.reportCompleted( *completeValue ) ? S_OK : E_ABORT;
     }
     return S_OK;
 }
 
 COM_DECLSPEC_NOTHROW
 STDMETHODIMP ExtractCallback::SetRatioInfo( const UInt64* inSize, const UInt64* outSize ) {
-    if ( mHandler.ratioCallback() && inSize != nullptr && outSize != nullptr ) {
-        mHandler.ratioCallback()( *inSize, *outSize );
+    if ( inSize != nullptr && outSize != nullptr ) {
+        mProgressReporter.reportRatio( *inSize, *outSize );
     }
     return S_OK;
 }
@@ -61,19 +69,38 @@ STDMETHODIMP ExtractCallback::PrepareOperation( Int32 askExtractMode ) noexcept
 
 COM_DECLSPEC_NOTHROW
 STDMETHODIMP ExtractCallback::GetStream( UInt32 index, ISequentialOutStream** outStream, Int32 askExtractMode ) try {
+    BIT7Z_PROBE2( extract_get_stream, index, askExtractMode );
+    BIT7Z_TRACE( mTraceRecorder, begin, "item", index );
     *outStream = nullptr;
+    mCurrentIndex = index;
     releaseStream();
+    if ( mCancellation.isCancelled() ) {
+        return E_ABORT;
+    }
+    mProgressReporter.reportCurrentItem( index );
+
+    if ( mMetrics ) {
+        mMetrics->beginItem();
+    }
 
     if ( askExtractMode != NArchive::NExtract::NAskMode::kExtract ) {
         return S_OK;
     }
 
-    return getOutStream( index, outStream );
+    if ( applyAntiItem( index ) ) { // Anti-items have no data, they only mark a deleted item.
+        return S_OK;
+    }
+
+    const HRESULT res = getOutStream( index, outStream );
+    if ( res == S_OK && *outStream != nullptr ) {
+        wrapOutStream( outStream );
+    }
+    return res;
 } catch ( const BitException& ex ) {
-    mErrorException = std::make_exception_ptr( ex );
+    setErrorException( ex );
     return ex.hresultCode();
 } catch ( const std::runtime_error& ) {
-    mErrorException = std::make_exception_ptr( BitException( "Failed to get the stream", make_hresult_code( E_ABORT ) ) );
+    setErrorException( BitException( "Failed to get the stream", make_hresult_code( E_ABORT ) ) );
     return E_ABORT;
 }
 
@@ -85,31 +112,66 @@ STDMETHODIMP ExtractCallback::SetOperationResult( Int32 operationResult ) {
     constexpr auto kDataError = "Data Error";
     constexpr auto kUnknownError = "Unknown Error";
 
+    BIT7Z_PROBE1( extract_set_result, operationResult );
+    BIT7Z_TRACE( mTraceRecorder, end, "item", static_cast< uint64_t >( operationResult ) );
+
     auto result = static_cast< OperationResult >( operationResult );
-    if ( result != OperationResult::Success ) {
+    const bool collect_error = result != OperationResult::Success && mFailedItems != nullptr;
+    if ( collect_error ) {
+        mFailedItems->emplace_back( mCurrentIndex, make_error_code( result ) );
+    } else if ( result != OperationResult::Success ) {
         switch ( result ) {
             case OperationResult::UnsupportedMethod:
-                mErrorException = std::make_exception_ptr( BitException( kUnsupportedMethod,
-                                                                         make_hresult_code( E_FAIL ) ) );
+                setErrorException( BitException( kUnsupportedMethod, make_hresult_code( E_FAIL ) ) );
                 break;
 
             case OperationResult::CRCError:
-                mErrorException = std::make_exception_ptr( BitException( kCRCFailed,
-                                                                         make_hresult_code( E_FAIL ) ) );
+                setErrorException( BitException( kCRCFailed, make_hresult_code( E_FAIL ) ) );
                 break;
 
             case OperationResult::DataError:
-                mErrorException = std::make_exception_ptr( BitException( kDataError,
-                                                                         make_hresult_code( E_FAIL ) ) );
+                setErrorException( BitException( kDataError, make_hresult_code( E_FAIL ) ) );
                 break;
 
             default:
-                mErrorException = std::make_exception_ptr( BitException( kUnknownError,
-                                                                         make_hresult_code( E_FAIL ) ) );
+                setErrorException( BitException( kUnknownError, make_hresult_code( E_FAIL ) ) );
         }
     }
 
-    return finishOperation( result );
+    if ( mMetrics ) {
+        mMetrics->endItem();
+    }
+
+    const HRESULT res = finishOperation( result );
+    return collect_error ? S_OK : res; // The collected errors do not stop the operation.
+}
+
+void ExtractCallback::setErrorException( const BitException& ex ) {
+    mErrorException = std::make_exception_ptr( ex );
+    mErrorCode = ex.code();
+}
+
+void ExtractCallback::wrapOutStream( ISequentialOutStream** outStream ) {
+    if ( !mMetrics && !mCancellation.isEnabled() ) {
+        return;
+    }
+
+    CMyComPtr< IOutStream > out_stream;
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    if ( ( *outStream )->QueryInterface( ::IID_IOutStream, reinterpret_cast< void** >( &out_stream ) ) != S_OK ) {
+        return; // Only bit7z's output streams are wrapped, and they are all seekable.
+    }
+
+    if ( mMetrics ) {
+        out_stream = bit7z::make_com< CMetricsOutStream, IOutStream >(
+            out_stream, mMetrics->itemStreams(), isMemoryOutput() ? mMetrics.get() : nullptr
+        );
+    }
+    if ( mCancellation.isEnabled() ) {
+        out_stream = bit7z::make_com< CCancellableOutStream, IOutStream >( out_stream, mCancellation );
+    }
+    ( *outStream )->Release();
+    *outStream = out_stream.Detach();
 }
 
 COM_DECLSPEC_NOTHROW
@@ -121,8 +183,7 @@ STDMETHODIMP ExtractCallback::CryptoGetTextPassword( BSTR* password ) {
         }
 
         if ( pass.empty() ) {
-            mErrorException = std::make_exception_ptr( BitException( kPasswordNotDefined,
-                                                                     make_hresult_code( E_FAIL ) ) );
+            setErrorException( BitException( kPasswordNotDefined, make_hresult_code( E_FAIL ) ) );
             return E_FAIL;
         }
     } else {
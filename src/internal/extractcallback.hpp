@@ -10,9 +10,16 @@
 #ifndef EXTRACTCALLBACK_HPP
 #define EXTRACTCALLBACK_HPP
 
+#include <memory>
+
+#include "bitexception.hpp"
 #include "bitinputarchive.hpp"
 #include "internal/callback.hpp"
 #include "internal/macros.hpp"
+#include "internal/metricsrecorder.hpp"
+#include "internal/operationcancellation.hpp"
+#include "internal/operationresult.hpp"
+#include "internal/progressreporter.hpp"
 
 #include <7zip/Archive/IArchive.h>
 #include <7zip/ICoder.h>
@@ -28,19 +35,6 @@ enum struct ExtractMode {
     Skip = NAskMode::kSkip
 };
 
-enum struct OperationResult {
-    Success = NOperationResult::kOK,
-    UnsupportedMethod = NOperationResult::kUnsupportedMethod,
-    DataError = NOperationResult::kDataError,
-    CRCError = NOperationResult::kCRCError,
-    Unavailable = NOperationResult::kUnavailable,
-    UnexpectedEnd = NOperationResult::kUnexpectedEnd,
-    DataAfterEnd = NOperationResult::kDataAfterEnd,
-    IsNotArc = NOperationResult::kIsNotArc,
-    HeadersError = NOperationResult::kHeadersError,
-    WrongPassword = NOperationResult::kWrongPassword
-};
-
 class ExtractCallback : public Callback,
                         public IArchiveExtractCallback,
                         public ICompressProgressInfo,
@@ -83,6 +77,37 @@ class ExtractCallback : public Callback,
             return mErrorException;
         }
 
+        // The error code of the stored exception (if any), which can be read without rethrowing the exception.
+        BIT7Z_NODISCARD
+        inline const std::error_code& errorCode() const noexcept {
+            return mErrorCode;
+        }
+
+        /* Makes the callback collect the errors of the items (without creating exceptions for them),
+         * continuing the operation with the next items. */
+        inline void setFailedItems( FailedItems* failed_items ) noexcept {
+            mFailedItems = failed_items;
+        }
+
+        // Note: the recorder is null if the handler has no metrics callback.
+        BIT7Z_NODISCARD
+        inline MetricsRecorder* metrics() const noexcept {
+            return mMetrics.get();
+        }
+
+        BIT7Z_NODISCARD
+        inline const OperationCancellation& cancellation() const noexcept {
+            return mCancellation;
+        }
+
+        // Delivers the progress coalesced by the reporter when the operation finishes.
+        inline void flushProgress() {
+            mProgressReporter.flush();
+        }
+
+        // Discards the output of the item being extracted when the operation was aborted (by default, nothing).
+        virtual void discardPartialOutput() {}
+
     protected:
         explicit ExtractCallback( const BitInputArchive& inputArchive );
 
@@ -93,11 +118,17 @@ class ExtractCallback : public Callback,
 
         BIT7Z_NODISCARD
         inline bool isItemFolder( uint32_t index ) const {
+            if ( mMetrics ) {
+                mMetrics->addPropertyCall();
+            }
             return mInputArchive.isItemFolder( index );
         }
 
         BIT7Z_NODISCARD
         inline BitPropVariant itemProperty( uint32_t index, BitProperty property ) const {
+            if ( mMetrics ) {
+                mMetrics->addPropertyCall();
+            }
             return mInputArchive.itemProperty( index, property );
         }
 
@@ -106,16 +137,43 @@ class ExtractCallback : public Callback,
             return mInputArchive;
         }
 
+        BIT7Z_NODISCARD
+        inline ProgressReporter& progressReporter() noexcept {
+            return mProgressReporter;
+        }
+
+        // Whether the output streams of the items are allocated in memory by bit7z.
+        BIT7Z_NODISCARD
+        virtual bool isMemoryOutput() const noexcept {
+            return false;
+        }
+
         virtual HRESULT finishOperation( OperationResult operation_result );
 
         virtual void releaseStream() = 0;
 
+        /* Applies the deletion marked by the item at the given index, if it is an anti-item, returning whether it is.
+         * By default, items are never considered anti-items, so their IsAnti property is not even read. */
+        virtual bool applyAntiItem( uint32_t /*index*/ ) {
+            return false;
+        }
+
         virtual HRESULT getOutStream( UInt32 index, ISequentialOutStream** outStream ) = 0;
 
     private:
         const BitInputArchive& mInputArchive;
         ExtractMode mExtractMode;
         std::exception_ptr mErrorException;
+        std::error_code mErrorCode;
+        FailedItems* mFailedItems;
+        uint32_t mCurrentIndex;
+        ProgressReporter mProgressReporter;
+        std::unique_ptr< MetricsRecorder > mMetrics;
+        OperationCancellation mCancellation;
+
+        void wrapOutStream( ISequentialOutStream** outStream );
+
+        void setErrorException( const BitException& ex );
 };
 
 }  // namespace bit7z
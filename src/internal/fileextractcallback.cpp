@@ -27,7 +27,12 @@ FileExtractCallback::FileExtractCallback( const BitInputArchive& inputArchive, c
     : ExtractCallback( inputArchive ),
       mInFilePath( inputArchive.archivePath() ),
       mDirectoryPath( directoryPath ),
-      mRetainDirectories( inputArchive.handler().retainDirectories() ) {}
+      mRetainDirectories( inputArchive.handler().retainDirectories() ),
+      mExtractionCache( inputArchive.handler().extractionCache() ),
+      mHashManifest( inputArchive.handler().hashManifest() ),
+      mCachingItem( false ),
+      mCachedCrc( 0 ),
+      mCachedSize( 0 ) {}
 
 void FileExtractCallback::releaseStream() {
     mFileOutStream.Release(); // We need to release the file to change its modified time!
@@ -49,6 +54,18 @@ HRESULT FileExtractCallback::finishOperation( OperationResult operation_result )
         return result;
     }
 
+    /* Note: the CRC of the extracted file was checked by the decoder, so the file can be safely cached
+     *       (and the cache checks that it matches the SHA-256 in the hash manifest, if any). */
+    if ( mCachingItem && result == S_OK ) {
+        mExtractionCache->insert( mCachedCrc, mCachedSize, mCachedSha256, mFilePathOnDisk.string< tchar >() );
+    }
+    mCachingItem = false;
+
+    applyItemMetadata();
+    return result;
+}
+
+void FileExtractCallback::applyItemMetadata() {
     if ( mCurrentItem.isModifiedTimeDefined() ) {
         filesystem::fsutil::setFileModifiedTime( mFilePathOnDisk, mCurrentItem.modifiedTime() );
     }
@@ -56,9 +73,95 @@ HRESULT FileExtractCallback::finishOperation( OperationResult operation_result )
     if ( mCurrentItem.areAttributesDefined() ) {
         filesystem::fsutil::setFileAttributes( mFilePathOnDisk, mCurrentItem.attributes() );
     }
+}
+
+bool FileExtractCallback::loadCacheKey( uint32_t index ) {
+    if ( mExtractionCache == nullptr || isItemFolder( index ) ) {
+        return false;
+    }
+    const BitPropVariant crc = itemProperty( index, BitProperty::CRC );
+    const BitPropVariant size = itemProperty( index, BitProperty::Size );
+    if ( !crc.isUInt32() || size.isEmpty() ) {
+        return false;
+    }
+    mCachedCrc = crc.getUInt32();
+    mCachedSize = size.getUInt64();
+    mCachedSha256.clear();
+    if ( mHashManifest != nullptr ) {
+        mCachedSha256 = mHashManifest->hashOf( itemProperty( index, BitProperty::Path ).getString() );
+    }
+    return !mCachedSha256.empty() || mExtractionCache->crcOnlyKeys();
+}
+
+/* Note: if the item is not in the cache, it is marked for being inserted into the cache once extracted. */
+bool FileExtractCallback::restoreCachedItem( uint32_t index ) {
+    mCachingItem = false;
+    if ( !loadCacheKey( index ) ) {
+        return false;
+    }
+    if ( mExtractionCache->restore( mCachedCrc, mCachedSize, mCachedSha256, mFilePathOnDisk.string< tchar >() ) ) {
+        // Note: the metadata of a hard link would be applied to the cached file (and to the other links to it).
+        std::error_code error;
+        if ( fs::hard_link_count( mFilePathOnDisk, error ) <= 1 || error ) {
+            applyItemMetadata();
+        }
+        return true;
+    }
+    mCachingItem = true;
+    return false;
+}
+
+std::vector< uint32_t > FileExtractCallback::restoreCachedItems( const std::vector< uint32_t >& indices ) {
+    std::vector< uint32_t > result;
+    const auto items_count = indices.empty() ? inputArchive().itemsCount() : static_cast< uint32_t >( indices.size() );
+    for ( uint32_t position = 0; position < items_count; ++position ) {
+        const uint32_t index = indices.empty() ? position : indices[ position ];
+        if ( !loadCacheKey( index ) || !mExtractionCache->contains( mCachedCrc, mCachedSize, mCachedSha256 ) ) {
+            result.push_back( index );
+            continue;
+        }
+
+        CMyComPtr< ISequentialOutStream > out_stream;
+        getOutStream( index, &out_stream );
+        if ( out_stream != nullptr ) { // The item was removed from the cache in the meantime, so it must be extracted.
+            out_stream.Release();
+            releaseStream();
+            std::error_code error;
+            fs::remove( mFilePathOnDisk, error );
+            result.push_back( index );
+        }
+    }
+    mCachingItem = false;
     return result;
 }
 
+void FileExtractCallback::discardPartialOutput() {
+    // Note: the stream of the current item is released only when its extraction ends.
+    if ( mFileOutStream == nullptr ) {
+        return;
+    }
+    mFileOutStream.Release();
+    std::error_code error;
+    fs::remove( mFilePathOnDisk, error );
+}
+
+/* Note: anti-items are handled only if the handler can overwrite the existing files, so that the IsAnti property
+ *       of the items is not read otherwise; folders are removed only if they are empty. */
+bool FileExtractCallback::applyAntiItem( uint32_t index ) {
+    if ( mHandler.overwriteMode() != OverwriteMode::Overwrite ) {
+        return false;
+    }
+    const BitPropVariant is_anti = itemProperty( index, BitProperty::IsAnti );
+    if ( !is_anti.isBool() || !is_anti.getBool() ) {
+        return false;
+    }
+    mCurrentItem.loadItemInfo( inputArchive(), index );
+    const fs::path item_path = mDirectoryPath / getCurrentItemPath();
+    std::error_code error;
+    fs::remove( item_path, error );
+    return true;
+}
+
 fs::path FileExtractCallback::getCurrentItemPath() const {
     fs::path filePath = mCurrentItem.path();
     if ( filePath.empty() ) {
@@ -72,6 +175,7 @@ fs::path FileExtractCallback::getCurrentItemPath() const {
 }
 
 HRESULT FileExtractCallback::getOutStream( uint32_t index, ISequentialOutStream** outStream ) {
+    mCachingItem = false;
     mCurrentItem.loadItemInfo( inputArchive(), index );
 
     auto filePath = getCurrentItemPath();
@@ -84,8 +188,8 @@ HRESULT FileExtractCallback::getOutStream( uint32_t index, ISequentialOutStream*
 #endif
 
     if ( !isItemFolder( index ) ) { // File
-        if ( mHandler.fileCallback() ) {
-            mHandler.fileCallback()( filePath.string< tchar >() );
+        if ( progressReporter().hasFileCallback() ) {
+            progressReporter().reportFile( filePath.string< tchar >() );
         }
 
         std::error_code error;
@@ -115,6 +219,10 @@ HRESULT FileExtractCallback::getOutStream( uint32_t index, ISequentialOutStream*
             }
         }
 
+        if ( restoreCachedItem( index ) ) {
+            return S_OK;
+        }
+
         auto outStreamLoc = bit7z::make_com< CFileOutStream >( mFilePathOnDisk, true );
         mFileOutStream = outStreamLoc;
         *outStream = outStreamLoc.Detach();
@@ -11,6 +11,7 @@
 #define FILEEXTRACTCALLBACK_HPP
 
 #include <string>
+#include <vector>
 
 #include "internal/cfileoutstream.hpp"
 #include "internal/extractcallback.hpp"
@@ -34,6 +35,12 @@ class FileExtractCallback final : public ExtractCallback {
 
         ~FileExtractCallback() override = default;
 
+        void discardPartialOutput() override;
+
+        /* Restores the given items (all the items if empty) that are in the handler's extraction cache,
+         * returning the indices of the other items, i.e., the ones to be extracted (if any). */
+        std::vector< uint32_t > restoreCachedItems( const std::vector< uint32_t >& indices );
+
     private:
         fs::path mInFilePath;     // Input file path
         fs::path mDirectoryPath;  // Output directory
@@ -44,12 +51,29 @@ class FileExtractCallback final : public ExtractCallback {
 
         CMyComPtr< CFileOutStream > mFileOutStream;
 
+        BitExtractionCache* mExtractionCache;
+        const BitHashManifest* mHashManifest;
+        bool mCachingItem; // Whether the item being extracted must be inserted into the cache once extracted.
+        uint32_t mCachedCrc;
+        uint64_t mCachedSize;
+        std::string mCachedSha256; // Empty if the item is not in the hash manifest.
+
         HRESULT finishOperation( OperationResult operation_result ) override;
 
         void releaseStream() override;
 
+        bool applyAntiItem( uint32_t index ) override;
+
         fs::path getCurrentItemPath() const;
 
+        void applyItemMetadata();
+
+        /* Whether the file at the given index has a cache key accepted by the cache, i.e., a known CRC, and a SHA-256
+         * in the hash manifest (unless the cache accepts the CRC-only keys), which is then stored for caching it. */
+        bool loadCacheKey( uint32_t index );
+
+        bool restoreCachedItem( uint32_t index );
+
         HRESULT getOutStream( uint32_t index, ISequentialOutStream** outStream ) override;
 };
 
@@ -44,9 +44,7 @@ HRESULT FixedBufferExtractCallback::getOutStream( uint32_t index, ISequentialOut
         return E_FAIL;
     }
 
-    if ( mHandler.fileCallback() ) {
-        mHandler.fileCallback()( fullPath );
-    }
+    progressReporter().reportFile( fullPath );
 
     auto outStreamLoc = bit7z::make_com< CFixedBufferOutStream, ISequentialOutStream >( mBuffer, mSize );
     mOutMemStream = outStreamLoc;
@@ -23,7 +23,9 @@
 
 #include "biterror.hpp"
 #include "bitexception.hpp"
+#include "internal/cfileinstream.hpp"
 #include "internal/fsutil.hpp"
+#include "internal/util.hpp"
 #ifndef _WIN32
 #include "internal/guiddef.hpp"
 #endif
@@ -450,6 +452,16 @@ uint64_t readSignature( IInStream* stream, uint32_t size ) noexcept {
 }
 
 const BitInFormat& detectFormatFromSig( IInStream* stream ) {
+    std::error_code error;
+    const BitInFormat& format = detectFormatFromSig( stream, error );
+    if ( error ) {
+        throw BitException( "Failed to detect the format of the file", error );
+    }
+    return format;
+}
+
+const BitInFormat& detectFormatFromSig( IInStream* stream, std::error_code& error ) noexcept {
+    error.clear();
     constexpr auto SIGNATURE_SIZE = 8U;
     constexpr auto BASE_SIGNATURE_MASK = 0xFFFFFFFFFFFFFFFFULL;
     constexpr auto BYTE_SHIFT = 8ULL;
@@ -504,8 +516,8 @@ const BitInFormat& detectFormatFromSig( IInStream* stream ) {
     }
 
     stream->Seek( 0, 0, nullptr );
-    throw BitException( "Failed to detect the format of the file",
-                        make_error_code( BitError::NoMatchingSignature ) );
+    error = make_error_code( BitError::NoMatchingSignature );
+    return BitFormat::Auto;
 }
 
 #if defined(BIT7Z_USE_NATIVE_STRING) && defined(_WIN32)
@@ -523,10 +535,20 @@ inline auto to_lower( unsigned char character ) -> char {
 #endif
 
 const BitInFormat& detectFormatFromExt( const fs::path& in_file ) {
+    std::error_code error;
+    const BitInFormat& format = detectFormatFromExt( in_file, error );
+    if ( error ) {
+        throw BitException( "Failed to detect the archive format from the extension", error );
+    }
+    return format;
+}
+
+const BitInFormat& detectFormatFromExt( const fs::path& in_file, std::error_code& error ) {
+    error.clear();
     tstring ext = filesystem::fsutil::extension( in_file );
     if ( ext.empty() ) {
-        throw BitException( "Failed to detect the archive format from the extension",
-                            make_error_code( BitError::NoMatchingExtension ) );
+        error = make_error_code( BitError::NoMatchingExtension );
+        return BitFormat::Auto;
     }
     std::transform( ext.cbegin(), ext.cend(), ext.begin(), to_lower );
 
@@ -548,6 +570,34 @@ const BitInFormat& detectFormatFromExt( const fs::path& in_file ) {
     // The extension did not match any known format extension, delegating the decision to the client.
     return BitFormat::Auto;
 }
+
+const BitInFormat& detectFormat( const tstring& in_file, std::error_code& error ) noexcept try {
+    error.clear();
+    const fs::path file_path{ in_file };
+    auto file_stream = bit7z::make_com< CFileInStream, IInStream >( file_path, error );
+    if ( error ) {
+        return BitFormat::Auto;
+    }
+
+    std::error_code signature_error;
+    const BitInFormat& format = detectFormatFromSig( file_stream, signature_error );
+    if ( !signature_error ) {
+        return format;
+    }
+
+    // Some formats have no (known) signature, so the extension is the last resort.
+    const BitInFormat& extension_format = detectFormatFromExt( file_path, error );
+    if ( !error && extension_format == BitFormat::Auto ) {
+        error = signature_error;
+    }
+    return extension_format;
+} catch ( const std::system_error& ex ) {
+    error = ex.code();
+    return BitFormat::Auto;
+} catch ( const std::exception& ) {
+    error = make_error_code( BitError::Fail );
+    return BitFormat::Auto;
+}
 }  // namespace bit7z
 
 #endif
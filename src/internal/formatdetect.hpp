@@ -12,6 +12,8 @@
 
 #ifdef BIT7Z_AUTO_FORMAT
 
+#include <system_error>
+
 #include "bitformat.hpp"
 #include "bitfs.hpp"
 
@@ -23,6 +25,11 @@ const BitInFormat& detectFormatFromExt( const fs::path& in_file );
 
 const BitInFormat& detectFormatFromSig( IInStream* stream );
 
+// Note: the following overloads do not throw if the format cannot be detected, they return BitFormat::Auto instead.
+const BitInFormat& detectFormatFromExt( const fs::path& in_file, std::error_code& error );
+
+const BitInFormat& detectFormatFromSig( IInStream* stream, std::error_code& error ) noexcept;
+
 } // namespace bit7z
 
 #endif
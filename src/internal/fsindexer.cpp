@@ -12,13 +12,220 @@
 
 #include "internal/fsindexer.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
 #include "bitexception.hpp"
 #include "internal/fsutil.hpp"
 
-using bit7z::GenericInputItem;
 using bit7z::tstring;
 using namespace bit7z::filesystem;
 
+// The maximum number of threads listing the directories in parallel.
+constexpr unsigned kMaxIndexingThreads = 8;
+
+struct FSIndexer::DirectoryListing {
+    struct Entry {
+        tstring name;
+        bool matches; // Whether the entry matched the filter, i.e., it is an item to be indexed.
+        bool is_dir;
+        WIN32_FILE_ATTRIBUTE_DATA metadata; // Read only if the entry matched the filter.
+        uint64_t size;
+        unique_ptr< DirectoryListing > subdirectory; // Null if the entry is not a directory to be listed.
+    };
+
+    fs::path prefix; // The path of the listed directory, relative to the indexed one.
+    bool recursive;
+    vector< Entry > entries; // Sorted by name, so the index order does not depend on the filesystem.
+
+    DirectoryListing( fs::path listing_prefix, bool listing_recursive )
+        : prefix{ std::move( listing_prefix ) }, recursive{ listing_recursive } {}
+
+    // Adds the items to the table, in the same (pre-)order of a single-threaded depth-first visit.
+    void flatten( FSItemTable& result, uint32_t parent_node ) { // NOLINT(misc-no-recursion)
+        for ( auto& entry : entries ) {
+            const uint32_t node = result.addNode( parent_node, entry.name );
+            if ( entry.matches ) {
+                result.addItem( node, entry.is_dir, entry.metadata, entry.size );
+            }
+            if ( entry.subdirectory ) {
+                entry.subdirectory->flatten( result, node );
+                entry.subdirectory.reset();
+            }
+        }
+        vector< Entry >().swap( entries );
+    }
+
+    BIT7Z_NODISCARD std::size_t itemsCount() const noexcept { // NOLINT(misc-no-recursion)
+        std::size_t result = entries.size();
+        for ( const auto& entry : entries ) {
+            if ( entry.subdirectory ) {
+                result += entry.subdirectory->itemsCount();
+            }
+        }
+        return result;
+    }
+};
+
+/* Visits a tree of tasks (here, the directories to be listed) using a pool of threads.
+ * Each worker takes the tasks from the back of its own queue (i.e., depth-first, which keeps the directories it lists
+ * close to each other), and steals them from the front of the other workers' queues when its own queue is empty
+ * (i.e., the shallowest directories, which likely have the largest subtrees to be listed). */
+template< typename Task >
+class WorkStealingWalker final {
+    public:
+        explicit WorkStealingWalker( unsigned workers_count ) : mQueues( std::max( workers_count, 1u ) ) {}
+
+        template< typename Visitor >
+        void run( Task& root, const Visitor& visit ) {
+            // The root is visited by the calling thread alone, so no thread is started for flat directories.
+            vector< Task* > subtasks;
+            visit( root, subtasks );
+            if ( subtasks.empty() ) {
+                return;
+            }
+            push( 0, subtasks );
+
+            vector< std::thread > helpers;
+            try {
+                for ( std::size_t id = 1; id < mQueues.size(); ++id ) {
+                    helpers.emplace_back( [ this, id, &visit ]() {
+                        work( id, visit );
+                    } );
+                }
+            } catch ( const std::system_error& ) {
+                // We could not start all the threads, so we make do with the ones we have.
+            }
+            work( 0, visit );
+            for ( auto& helper : helpers ) {
+                helper.join();
+            }
+            if ( mError ) {
+                std::rethrow_exception( mError );
+            }
+        }
+
+    private:
+        struct TaskQueue {
+            std::mutex mutex;
+            std::deque< Task* > tasks;
+        };
+
+        vector< TaskQueue > mQueues;
+        std::atomic< std::size_t > mPending{ 0 }; // The tasks either queued or being visited.
+        std::atomic< std::size_t > mQueued{ 0 };
+        std::atomic< bool > mFailed{ false };
+        std::exception_ptr mError;
+        std::mutex mIdleMutex;
+        std::condition_variable mIdleCondition;
+
+        template< typename Visitor >
+        void work( std::size_t id, const Visitor& visit ) {
+            vector< Task* > subtasks;
+            while ( Task* task = next( id ) ) {
+                subtasks.clear();
+                try {
+                    visit( *task, subtasks );
+                } catch ( ... ) {
+                    fail( std::current_exception() );
+                    return;
+                }
+                push( id, subtasks );
+                if ( --mPending == 0 ) {
+                    wakeIdleWorkers();
+                }
+            }
+        }
+
+        Task* next( std::size_t id ) {
+            while ( !mFailed ) {
+                Task* task = pop( id );
+                if ( task == nullptr ) {
+                    task = steal( id );
+                }
+                if ( task != nullptr ) {
+                    return task;
+                }
+
+                std::unique_lock< std::mutex > lock{ mIdleMutex };
+                if ( mPending == 0 ) {
+                    break;
+                }
+                mIdleCondition.wait( lock, [ this ]() {
+                    return mQueued > 0 || mPending == 0 || mFailed;
+                } );
+            }
+            return nullptr;
+        }
+
+        void push( std::size_t id, const vector< Task* >& tasks ) {
+            if ( tasks.empty() ) {
+                return;
+            }
+            mPending += tasks.size();
+            {
+                std::lock_guard< std::mutex > lock{ mQueues[ id ].mutex };
+                mQueues[ id ].tasks.insert( mQueues[ id ].tasks.end(), tasks.begin(), tasks.end() );
+            }
+            mQueued += tasks.size();
+            wakeIdleWorkers();
+        }
+
+        Task* pop( std::size_t id ) {
+            auto& queue = mQueues[ id ];
+            std::lock_guard< std::mutex > lock{ queue.mutex };
+            if ( queue.tasks.empty() ) {
+                return nullptr;
+            }
+            Task* task = queue.tasks.back();
+            queue.tasks.pop_back();
+            --mQueued;
+            return task;
+        }
+
+        Task* steal( std::size_t thief_id ) {
+            for ( std::size_t offset = 1; offset < mQueues.size(); ++offset ) {
+                auto& queue = mQueues[ ( thief_id + offset ) % mQueues.size() ];
+                std::lock_guard< std::mutex > lock{ queue.mutex };
+                if ( !queue.tasks.empty() ) {
+                    Task* task = queue.tasks.front();
+                    queue.tasks.pop_front();
+                    --mQueued;
+                    return task;
+                }
+            }
+            return nullptr;
+        }
+
+        void fail( std::exception_ptr error ) {
+            {
+                std::lock_guard< std::mutex > lock{ mIdleMutex };
+                if ( !mError ) {
+                    mError = std::move( error );
+                }
+                mFailed = true;
+            }
+            mIdleCondition.notify_all();
+        }
+
+        void wakeIdleWorkers() {
+            // Note: locking the mutex ensures that the notification is not lost by a worker about to wait.
+            { std::lock_guard< std::mutex > lock{ mIdleMutex }; }
+            mIdleCondition.notify_all();
+        }
+};
+
+inline unsigned indexingThreadsCount() {
+    const unsigned hardware_threads = std::thread::hardware_concurrency();
+    return hardware_threads == 0 ? 1 : std::min( hardware_threads, kMaxIndexingThreads );
+}
+
 FSIndexer::FSIndexer( FSItem directory, tstring filter, bool only_files )
     : mDirItem( std::move( directory ) ), mFilter( std::move( filter ) ), mOnlyFiles{ only_files } {
     if ( !mDirItem.isDir() ) {
@@ -27,42 +234,80 @@ FSIndexer::FSIndexer( FSItem directory, tstring filter, bool only_files )
 }
 
 // NOTE: It indexes all the items whose metadata are needed in the archive to be created!
-// NOLINTNEXTLINE(misc-no-recursion)
-void FSIndexer::listDirectoryItems( vector< unique_ptr< GenericInputItem > >& result,
-                                    bool recursive,
-                                    const fs::path& prefix ) {
-    fs::path path = mDirItem.path();
-    if ( !prefix.empty() ) {
-        path = path / prefix;
-    }
+void FSIndexer::listDirectoryItems( FSItemTable& result, bool recursive ) {
     const bool include_root_path = mFilter.empty() ||
                                    fs::path{ mDirItem.path() }.parent_path().empty() ||
                                    mDirItem.inArchivePath().filename() != mDirItem.name();
+
+    DirectoryListing root{ fs::path{}, recursive };
+    WorkStealingWalker< DirectoryListing > walker{ recursive ? indexingThreadsCount() : 1 };
+    walker.run( root, [ this ]( DirectoryListing& listing, vector< DirectoryListing* >& subdirectories ) {
+        listDirectory( listing, subdirectories );
+    } );
+
+    result.reserve( root.itemsCount() );
+    const uint32_t root_node = result.addRoot( mDirItem.path(),
+                                               include_root_path ? mDirItem.inArchivePath() : fs::path() );
+    root.flatten( result, root_node );
+}
+
+void FSIndexer::listDirectory( DirectoryListing& listing, vector< DirectoryListing* >& subdirectories ) const {
+    fs::path path = mDirItem.path();
+    if ( !listing.prefix.empty() ) {
+        path = path / listing.prefix;
+    }
+
+    /* Note: the directory iterator caches the type of the entries it reads (e.g., from the d_type field of the dirent
+     *       structs returned by getdents64 on Linux), so we know whether an entry is a directory without reading its
+     *       metadata (except for symbolic links). The metadata are read only for the matching items. */
     std::error_code error;
     for ( const auto& current_entry : fs::directory_iterator( path, error ) ) {
-        auto search_path = include_root_path ? mDirItem.inArchivePath() : fs::path();
-        if ( !prefix.empty() ) {
-            search_path = search_path.empty() ? prefix : search_path / prefix;
-        }
+        DirectoryListing::Entry entry{};
+        entry.name = current_entry.path().filename().string< tchar >();
+        std::error_code type_error;
+        entry.is_dir = current_entry.is_directory( type_error ) && !type_error;
 
-        const FSItem current_item{ current_entry, search_path };
         /* An item matches if:
          *  - Its name matches the wildcard pattern, and
          *  - Either is a file, or we are interested also to include folders in the index.
          *
          * Note: The boolean expression uses short-circuiting to optimize the evaluation. */
-        const bool item_matches = ( !mOnlyFiles || !current_item.isDir() ) &&
-                                  fsutil::wildcardMatch( mFilter, current_item.name() );
-        if ( item_matches ) {
-            result.emplace_back( std::make_unique< FSItem >( current_item ) );
+        entry.matches = ( !mOnlyFiles || !entry.is_dir ) && fsutil::wildcardMatch( mFilter, entry.name );
+        if ( entry.matches ) {
+            if ( !fsutil::getFileAttributesEx( current_entry.path(), entry.metadata, &entry.size ) ) {
+                throw BitException( "Could not retrieve file attributes",
+                                    last_error_code(),
+                                    current_entry.path().string< tchar >() );
+            }
+            if ( entry.is_dir ) {
+                entry.size = 0;
+            } else if ( current_entry.is_symlink( type_error ) ) {
+                // The content of a symbolic link is the one of the target, and so is its size.
+                entry.size = current_entry.file_size( type_error );
+                if ( type_error ) {
+                    entry.size = 0;
+                }
+            }
         }
 
-        if ( current_item.isDir() && ( recursive || item_matches ) ) {
+        if ( entry.is_dir && ( listing.recursive || entry.matches ) ) {
             //currentItem is a directory, and we must list it only if:
             // > indexing is done recursively
             // > indexing is not recursive, but the directory name matched the filter.
-            const fs::path next_dir = prefix.empty() ? fs::path( current_item.name() ) : prefix / current_item.name();
-            listDirectoryItems( result, true, next_dir );
+            fs::path next_dir = listing.prefix.empty() ? fs::path( entry.name ) : listing.prefix / entry.name;
+            entry.subdirectory = std::make_unique< DirectoryListing >( std::move( next_dir ), true );
+        }
+        if ( entry.matches || entry.subdirectory ) {
+            listing.entries.push_back( std::move( entry ) );
         }
     }
-}
\ No newline at end of file
+    std::sort( listing.entries.begin(), listing.entries.end(),
+               []( const DirectoryListing::Entry& first, const DirectoryListing::Entry& second ) {
+                   return first.name < second.name;
+               } );
+    for ( auto& entry : listing.entries ) {
+        if ( entry.subdirectory ) {
+            subdirectories.push_back( entry.subdirectory.get() );
+        }
+    }
+}
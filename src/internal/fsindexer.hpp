@@ -15,6 +15,7 @@
 #include <map>
 
 #include "internal/fsitem.hpp"
+#include "internal/fsitemtable.hpp"
 
 namespace bit7z { // NOLINT(modernize-concat-nested-namespaces)
 namespace filesystem {
@@ -26,14 +27,16 @@ class FSIndexer final {
     public:
         explicit FSIndexer( FSItem directory, tstring filter = {}, bool only_files = false );
 
-        void listDirectoryItems( vector< unique_ptr< GenericInputItem > >& result,
-                                 bool recursive,
-                                 const fs::path& prefix = fs::path() );
+        void listDirectoryItems( FSItemTable& result, bool recursive );
 
     private:
+        struct DirectoryListing;
+
         FSItem mDirItem;
         tstring mFilter;
         bool mOnlyFiles;
+
+        void listDirectory( DirectoryListing& listing, vector< DirectoryListing* >& subdirectories ) const;
 };
 
 }  // namespace filesystem
@@ -94,6 +94,11 @@ FILETIME FSItem::lastWriteTime() const noexcept {
 }
 
 tstring FSItem::name() const {
+    const auto filename = mFileEntry.path().filename();
+    if ( !filename.empty() && filename != "." && filename != ".." ) {
+        return filename.string< tchar >();
+    }
+    // Only paths given by the user (e.g., "." or "foo/") need to be resolved to get the actual name of the item.
     BIT7Z_MAYBE_UNUSED std::error_code error;
     return fs::canonical( mFileEntry.path(), error ).filename().string< tchar >();
 }
@@ -141,3 +146,7 @@ HRESULT FSItem::getStream( ISequentialInStream** inStream ) const {
     }
     return S_OK;
 }
+
+bool FSItem::isPrefetchable() const noexcept {
+    return !isDir(); // Each stream opens its own handle to the file, so files can be read on any thread.
+}
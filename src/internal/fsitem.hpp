@@ -44,6 +44,8 @@ class FSItem final : public GenericInputItem {
 
         BIT7Z_NODISCARD HRESULT getStream( ISequentialInStream** inStream ) const override;
 
+        BIT7Z_NODISCARD bool isPrefetchable() const noexcept override;
+
     private:
         fs::directory_entry mFileEntry;
         WIN32_FILE_ATTRIBUTE_DATA mFileAttributeData;
@@ -0,0 +1,207 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "internal/fsitemtable.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include "bitexception.hpp"
+#include "internal/cfileinstream.hpp"
+#include "internal/fsutil.hpp"
+#include "internal/util.hpp"
+
+using bit7z::tstring;
+using bit7z::filesystem::FSItemTable;
+using bit7z::filesystem::FSTableItem;
+
+constexpr uint32_t FSItemTable::kNoNode;
+
+FSTableItem::FSTableItem( const FSItemTable& table, uint32_t index ) noexcept
+    : mTable{ &table }, mIndex{ index } {}
+
+bool FSTableItem::isDir() const noexcept {
+    return mTable->itemIsDir( mIndex );
+}
+
+uint64_t FSTableItem::size() const noexcept {
+    return mTable->itemSize( mIndex );
+}
+
+FILETIME FSTableItem::creationTime() const noexcept {
+    return mTable->itemCreationTime( mIndex );
+}
+
+FILETIME FSTableItem::lastAccessTime() const noexcept {
+    return mTable->itemLastAccessTime( mIndex );
+}
+
+FILETIME FSTableItem::lastWriteTime() const noexcept {
+    return mTable->itemLastWriteTime( mIndex );
+}
+
+tstring FSTableItem::name() const {
+    return mTable->itemName( mIndex );
+}
+
+tstring FSTableItem::path() const {
+    return mTable->itemPath( mIndex ).string< tchar >();
+}
+
+fs::path FSTableItem::inArchivePath() const {
+    return mTable->itemInArchivePath( mIndex );
+}
+
+uint32_t FSTableItem::attributes() const noexcept {
+    return mTable->itemAttributes( mIndex );
+}
+
+HRESULT FSTableItem::getStream( ISequentialInStream** inStream ) const {
+    if ( isDir() ) {
+        return S_OK;
+    }
+
+    try {
+        auto inStreamLoc = bit7z::make_com< CFileInStream >( mTable->itemPath( mIndex ) );
+        *inStream = inStreamLoc.Detach();
+    } catch ( const BitException& ex ) {
+        return ex.nativeCode();
+    }
+    return S_OK;
+}
+
+bool FSTableItem::isPrefetchable() const noexcept {
+    return !isDir();
+}
+
+uint32_t FSItemTable::addRoot( const fs::path& directory, fs::path search_root ) {
+    const uint32_t node = addNode( kNoNode, directory.string< tchar >() );
+    mRoots.emplace_back( node, std::move( search_root ) );
+    return node;
+}
+
+uint32_t FSItemTable::addNode( uint32_t parent, const tstring& name ) {
+    if ( mNodes.size() >= kNoNode ||
+         mNamesArena.size() + name.size() > ( std::numeric_limits< uint32_t >::max )() ) {
+        throw BitException( "Cannot index the items", std::make_error_code( std::errc::value_too_large ) );
+    }
+    const auto node = static_cast< uint32_t >( mNodes.size() );
+    const auto name_offset = static_cast< uint32_t >( mNamesArena.size() );
+    mNodes.push_back( { parent, name_offset, static_cast< uint32_t >( name.size() ) } );
+    mNamesArena += name;
+    return node;
+}
+
+void FSItemTable::addItem( uint32_t node, bool is_dir, const WIN32_FILE_ATTRIBUTE_DATA& metadata, uint64_t size ) {
+    const auto index = static_cast< uint32_t >( mItemNodes.size() );
+    mItemNodes.push_back( node );
+    mItemIsDir.push_back( is_dir );
+    mItemSizes.push_back( size );
+    mItemAttributes.push_back( metadata.dwFileAttributes );
+    mItemCreationTimes.push_back( metadata.ftCreationTime );
+    mItemAccessTimes.push_back( metadata.ftLastAccessTime );
+    mItemWriteTimes.push_back( metadata.ftLastWriteTime );
+    mItems.emplace_back( *this, index );
+}
+
+void FSItemTable::reserve( std::size_t items_count ) {
+    mNodes.reserve( mNodes.size() + items_count );
+    mItemNodes.reserve( mItemNodes.size() + items_count );
+    mItemIsDir.reserve( mItemIsDir.size() + items_count );
+    mItemSizes.reserve( mItemSizes.size() + items_count );
+    mItemAttributes.reserve( mItemAttributes.size() + items_count );
+    mItemCreationTimes.reserve( mItemCreationTimes.size() + items_count );
+    mItemAccessTimes.reserve( mItemAccessTimes.size() + items_count );
+    mItemWriteTimes.reserve( mItemWriteTimes.size() + items_count );
+    mItems.reserve( mItems.size() + items_count );
+}
+
+std::size_t FSItemTable::size() const noexcept {
+    return mItems.size();
+}
+
+const FSTableItem& FSItemTable::operator[]( std::size_t index ) const noexcept {
+    return mItems[ index ];
+}
+
+tstring FSItemTable::itemName( uint32_t index ) const {
+    return nodeName( mItemNodes[ index ] );
+}
+
+fs::path FSItemTable::itemPath( uint32_t index ) const {
+    vector< uint32_t > chain;
+    nodeChain( mItemNodes[ index ], chain );
+
+    fs::path result;
+    for ( const auto node : chain ) {
+        result /= nodeName( node );
+    }
+    return result;
+}
+
+fs::path FSItemTable::itemInArchivePath( uint32_t index ) const {
+    vector< uint32_t > chain;
+    fs::path search_path = nodeChain( mItemNodes[ index ], chain );
+
+    fs::path item_path = nodeName( chain.front() );
+    for ( auto node = chain.begin() + 1; node != chain.end(); ++node ) {
+        item_path /= nodeName( *node );
+        if ( node + 1 != chain.end() ) {
+            search_path = search_path.empty() ? fs::path( nodeName( *node ) ) : search_path / nodeName( *node );
+        }
+    }
+    // Note: the same algorithm used for the FSItem objects, so the paths in the archive do not change.
+    return fsutil::inArchivePath( item_path, search_path );
+}
+
+bool FSItemTable::itemIsDir( uint32_t index ) const noexcept {
+    return mItemIsDir[ index ];
+}
+
+uint64_t FSItemTable::itemSize( uint32_t index ) const noexcept {
+    return mItemSizes[ index ];
+}
+
+uint32_t FSItemTable::itemAttributes( uint32_t index ) const noexcept {
+    return mItemAttributes[ index ];
+}
+
+FILETIME FSItemTable::itemCreationTime( uint32_t index ) const noexcept {
+    return mItemCreationTimes[ index ];
+}
+
+FILETIME FSItemTable::itemLastAccessTime( uint32_t index ) const noexcept {
+    return mItemAccessTimes[ index ];
+}
+
+FILETIME FSItemTable::itemLastWriteTime( uint32_t index ) const noexcept {
+    return mItemWriteTimes[ index ];
+}
+
+tstring FSItemTable::nodeName( uint32_t node ) const {
+    const auto& path_node = mNodes[ node ];
+    return mNamesArena.substr( path_node.name_offset, path_node.name_size );
+}
+
+const fs::path& FSItemTable::nodeChain( uint32_t node, vector< uint32_t >& chain ) const {
+    for ( ; mNodes[ node ].parent != kNoNode; node = mNodes[ node ].parent ) {
+        chain.push_back( node );
+    }
+    chain.push_back( node );
+    std::reverse( chain.begin(), chain.end() );
+
+    const auto root = std::lower_bound( mRoots.begin(), mRoots.end(), node,
+                                        []( const std::pair< uint32_t, fs::path >& entry, uint32_t root_node ) {
+                                            return entry.first < root_node;
+                                        } );
+    return root->second;
+}
@@ -0,0 +1,144 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef FSITEMTABLE_HPP
+#define FSITEMTABLE_HPP
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "internal/genericinputitem.hpp"
+#include "internal/windows.hpp"
+
+namespace bit7z { // NOLINT(modernize-concat-nested-namespaces)
+namespace filesystem {
+
+using std::vector;
+
+class FSItemTable;
+
+/* A lightweight view of an item stored in a FSItemTable.
+ * It has no state other than its index in the table: its paths are built only when requested. */
+class FSTableItem final : public GenericInputItem {
+    public:
+        FSTableItem( const FSItemTable& table, uint32_t index ) noexcept;
+
+        BIT7Z_NODISCARD bool isDir() const noexcept override;
+
+        BIT7Z_NODISCARD uint64_t size() const noexcept override;
+
+        BIT7Z_NODISCARD FILETIME creationTime() const noexcept override;
+
+        BIT7Z_NODISCARD FILETIME lastAccessTime() const noexcept override;
+
+        BIT7Z_NODISCARD FILETIME lastWriteTime() const noexcept override;
+
+        BIT7Z_NODISCARD tstring name() const override;
+
+        BIT7Z_NODISCARD tstring path() const override;
+
+        BIT7Z_NODISCARD fs::path inArchivePath() const override;
+
+        BIT7Z_NODISCARD uint32_t attributes() const noexcept override;
+
+        BIT7Z_NODISCARD HRESULT getStream( ISequentialInStream** inStream ) const override;
+
+        BIT7Z_NODISCARD bool isPrefetchable() const noexcept override;
+
+    private:
+        const FSItemTable* mTable;
+        uint32_t mIndex;
+};
+
+/* A compact table of the filesystem items found while indexing directories.
+ *  - Paths are stored in a trie: each node has only its own name (stored in a single arena of characters) and the
+ *    index of its parent node, so each directory is stored once, whatever the number of items it contains.
+ *    The root nodes are the indexed directories, whose names are their full paths.
+ *  - The metadata of the items are stored as a struct of arrays, accessed by the index of the item. */
+class FSItemTable final {
+    public:
+        static constexpr uint32_t kNoNode = UINT32_MAX;
+
+        FSItemTable() = default;
+
+        FSItemTable( const FSItemTable& ) = delete;
+
+        FSItemTable( FSItemTable&& ) = delete;
+
+        FSItemTable& operator=( const FSItemTable& ) = delete;
+
+        FSItemTable& operator=( FSItemTable&& ) = delete;
+
+        ~FSItemTable() = default;
+
+        // Adds the node of an indexed directory; search_root is the path in the archive of the found items.
+        uint32_t addRoot( const fs::path& directory, fs::path search_root );
+
+        uint32_t addNode( uint32_t parent, const tstring& name );
+
+        void addItem( uint32_t node, bool is_dir, const WIN32_FILE_ATTRIBUTE_DATA& metadata, uint64_t size );
+
+        // Reserves the space for the given number of further items (and the nodes of their paths).
+        void reserve( std::size_t items_count );
+
+        BIT7Z_NODISCARD std::size_t size() const noexcept;
+
+        BIT7Z_NODISCARD const FSTableItem& operator[]( std::size_t index ) const noexcept;
+
+        BIT7Z_NODISCARD tstring itemName( uint32_t index ) const;
+
+        BIT7Z_NODISCARD fs::path itemPath( uint32_t index ) const;
+
+        BIT7Z_NODISCARD fs::path itemInArchivePath( uint32_t index ) const;
+
+        BIT7Z_NODISCARD bool itemIsDir( uint32_t index ) const noexcept;
+
+        BIT7Z_NODISCARD uint64_t itemSize( uint32_t index ) const noexcept;
+
+        BIT7Z_NODISCARD uint32_t itemAttributes( uint32_t index ) const noexcept;
+
+        BIT7Z_NODISCARD FILETIME itemCreationTime( uint32_t index ) const noexcept;
+
+        BIT7Z_NODISCARD FILETIME itemLastAccessTime( uint32_t index ) const noexcept;
+
+        BIT7Z_NODISCARD FILETIME itemLastWriteTime( uint32_t index ) const noexcept;
+
+    private:
+        struct PathNode {
+            uint32_t parent;
+            uint32_t name_offset;
+            uint32_t name_size;
+        };
+
+        // Path trie
+        tstring mNamesArena;
+        vector< PathNode > mNodes;
+        vector< std::pair< uint32_t, fs::path > > mRoots; // The root nodes (sorted), with their search roots.
+
+        // Items metadata
+        vector< uint32_t > mItemNodes;
+        vector< bool > mItemIsDir;
+        vector< uint64_t > mItemSizes;
+        vector< uint32_t > mItemAttributes;
+        vector< FILETIME > mItemCreationTimes;
+        vector< FILETIME > mItemAccessTimes;
+        vector< FILETIME > mItemWriteTimes;
+        vector< FSTableItem > mItems;
+
+        BIT7Z_NODISCARD tstring nodeName( uint32_t node ) const;
+
+        // Fills the given vector with the nodes from the root to the given node, returning the root's search path.
+        const fs::path& nodeChain( uint32_t node, vector< uint32_t >& chain ) const;
+};
+
+}  // namespace filesystem
+}  // namespace bit7z
+
+#endif // FSITEMTABLE_HPP
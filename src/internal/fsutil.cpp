@@ -15,9 +15,20 @@
 #include <algorithm> //for std::adjacent_find
 
 #ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
+#if defined( __linux__ ) && defined( STATX_BASIC_STATS )
+#define BIT7Z_HAS_STATX
+#endif
+
+#ifdef __linux__
+#include <linux/fs.h> // for FICLONE
+#include <sys/ioctl.h>
+#endif
+
 #include "internal/dateutil.hpp"
 #endif
 
@@ -225,34 +236,112 @@ bool fsutil::setFileModifiedTime( const fs::path& filePath, const FILETIME& ftMo
 #endif
 }
 
-bool fsutil::getFileAttributesEx( const fs::path& filePath, WIN32_FILE_ATTRIBUTE_DATA& fileMetadata ) noexcept {
+#ifndef _WIN32
+struct FileStatus {
+    mode_t mode;
+    uint64_t size;
+    std::time_t creation_time;
+    std::time_t access_time;
+    std::time_t write_time;
+};
+
+// Note: like lstat, symbolic links are not followed.
+inline bool readFileStatus( const fs::path& filePath, FileStatus& status ) noexcept {
+#ifdef BIT7Z_HAS_STATX
+    // We ask only for the fields we need, so that the filesystem can avoid computing (or syncing) the others.
+    struct statx statx_info{};
+    constexpr auto statx_mask = STATX_TYPE | STATX_MODE | STATX_SIZE | STATX_ATIME | STATX_MTIME | STATX_CTIME;
+    if ( statx( AT_FDCWD, filePath.c_str(), AT_SYMLINK_NOFOLLOW | AT_STATX_DONT_SYNC, statx_mask, &statx_info ) == 0 ) {
+        status.mode = statx_info.stx_mode;
+        status.size = statx_info.stx_size;
+        status.creation_time = static_cast< std::time_t >( statx_info.stx_ctime.tv_sec );
+        status.access_time = static_cast< std::time_t >( statx_info.stx_atime.tv_sec );
+        status.write_time = static_cast< std::time_t >( statx_info.stx_mtime.tv_sec );
+        return true;
+    }
+    if ( errno != ENOSYS ) { // Kernels older than 4.11 do not support statx, so we fall back to lstat.
+        return false;
+    }
+#endif
+    struct stat stat_info{};
+    if ( lstat( filePath.c_str(), &stat_info ) != 0 ) {
+        return false;
+    }
+    status.mode = stat_info.st_mode;
+    status.size = static_cast< uint64_t >( stat_info.st_size );
+    status.creation_time = stat_info.st_ctime;
+    status.access_time = stat_info.st_atime;
+    status.write_time = stat_info.st_mtime;
+    return true;
+}
+#endif
+
+bool fsutil::getFileAttributesEx( const fs::path& filePath,
+                                  WIN32_FILE_ATTRIBUTE_DATA& fileMetadata,
+                                  uint64_t* fileSize ) noexcept {
     if ( filePath.empty() ) {
         return false;
     }
 
 #ifdef _WIN32
-    return ::GetFileAttributesEx( filePath.c_str(), GetFileExInfoStandard, &fileMetadata ) != FALSE;
+    if ( ::GetFileAttributesEx( filePath.c_str(), GetFileExInfoStandard, &fileMetadata ) == FALSE ) {
+        return false;
+    }
+    if ( fileSize != nullptr ) {
+        *fileSize = ( static_cast< uint64_t >( fileMetadata.nFileSizeHigh ) << 32u ) | fileMetadata.nFileSizeLow;
+    }
+    return true;
 #else
-    struct stat stat_info{};
-    if ( lstat( filePath.c_str(), &stat_info ) != 0 ) {
+    FileStatus status{};
+    if ( !readFileStatus( filePath, status ) ) {
         return false;
     }
+    if ( fileSize != nullptr ) {
+        *fileSize = status.size;
+    }
 
     // File attributes
-    fileMetadata.dwFileAttributes = S_ISDIR( stat_info.st_mode ) ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_ARCHIVE;
-    if ( ( stat_info.st_mode & S_IWUSR ) == 0 ) {
+    fileMetadata.dwFileAttributes = S_ISDIR( status.mode ) ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_ARCHIVE;
+    if ( ( status.mode & S_IWUSR ) == 0 ) {
         fileMetadata.dwFileAttributes |= FILE_ATTRIBUTE_READONLY;
     }
-    fileMetadata.dwFileAttributes |= FILE_ATTRIBUTE_UNIX_EXTENSION + ( ( stat_info.st_mode & 0xFFFF ) << 16 );
+    fileMetadata.dwFileAttributes |= FILE_ATTRIBUTE_UNIX_EXTENSION + ( ( status.mode & 0xFFFF ) << 16 );
 
     // File times
-    fileMetadata.ftCreationTime = time_to_FILETIME( stat_info.st_ctime );
-    fileMetadata.ftLastAccessTime = time_to_FILETIME( stat_info.st_atime );
-    fileMetadata.ftLastWriteTime = time_to_FILETIME( stat_info.st_mtime );
+    fileMetadata.ftCreationTime = time_to_FILETIME( status.creation_time );
+    fileMetadata.ftLastAccessTime = time_to_FILETIME( status.access_time );
+    fileMetadata.ftLastWriteTime = time_to_FILETIME( status.write_time );
     return true;
 #endif
 }
 
+bool fsutil::cloneFile( const fs::path& source, const fs::path& destination ) noexcept {
+#if defined( __linux__ ) && defined( FICLONE )
+    const int source_fd = open( source.c_str(), O_RDONLY | O_CLOEXEC ); // NOLINT(*-vararg)
+    if ( source_fd < 0 ) {
+        return false;
+    }
+    // NOLINTNEXTLINE(*-vararg)
+    const int destination_fd = open( destination.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644 );
+    if ( destination_fd < 0 ) {
+        close( source_fd );
+        return false;
+    }
+    const bool cloned = ioctl( destination_fd, FICLONE, source_fd ) == 0; // NOLINT(*-vararg)
+    close( destination_fd );
+    close( source_fd );
+    if ( !cloned ) { // E.g., the filesystem does not support reflinks, or the files are on different filesystems.
+        std::error_code error;
+        fs::remove( destination, error );
+    }
+    return cloned;
+#else
+    static_cast< void >( source );
+    static_cast< void >( destination );
+    return false;
+#endif
+}
+
 #if defined( _WIN32 ) && defined( BIT7Z_AUTO_PREFIX_LONG_PATHS )
 
 constexpr auto LONG_PATH_PREFIX = R"(\\?\)";
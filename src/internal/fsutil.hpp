@@ -27,13 +27,18 @@ BIT7Z_NODISCARD tstring extension( const fs::path& path );
 
 BIT7Z_NODISCARD bool wildcardMatch( const tstring& pattern, const tstring& str );
 
+// Note: like lstat, it does not follow symbolic links, so the optional fileSize is the one of the link itself.
 BIT7Z_NODISCARD bool getFileAttributesEx( const fs::path& filePath,
-                                          WIN32_FILE_ATTRIBUTE_DATA& fileMetadata ) noexcept;
+                                          WIN32_FILE_ATTRIBUTE_DATA& fileMetadata,
+                                          uint64_t* fileSize = nullptr ) noexcept;
 
 bool setFileModifiedTime( const fs::path& filePath, const FILETIME& ftModified ) noexcept;
 
 bool setFileAttributes( const fs::path& filePath, DWORD attributes ) noexcept;
 
+// Creates the destination file as a reflink (i.e., a copy-on-write clone) of the source one, if supported.
+bool cloneFile( const fs::path& source, const fs::path& destination ) noexcept;
+
 BIT7Z_NODISCARD fs::path inArchivePath( const fs::path& file_path,
                                         const fs::path& search_path = fs::path() );
 
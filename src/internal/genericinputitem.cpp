@@ -17,6 +17,10 @@ bool GenericInputItem::hasNewData() const noexcept {
     return true;
 }
 
+bool GenericInputItem::isPrefetchable() const noexcept {
+    return false;
+}
+
 BitPropVariant GenericInputItem::itemProperty( BitProperty propID ) const {
     BitPropVariant prop;
     switch ( propID ) {
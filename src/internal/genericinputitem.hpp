@@ -32,6 +32,9 @@ struct GenericInputItem : public BitGenericItem {
 
     BIT7Z_NODISCARD virtual bool hasNewData() const noexcept;
 
+    // Whether the item's stream can be safely read in advance on another thread.
+    BIT7Z_NODISCARD virtual bool isPrefetchable() const noexcept;
+
     BIT7Z_NODISCARD BitPropVariant itemProperty( BitProperty propID ) const override;
 
     ~GenericInputItem() override = default;
@@ -0,0 +1,189 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "internal/itemprefetcher.hpp"
+
+#include "internal/cprefetchedinstream.hpp"
+#include "internal/genericinputitem.hpp"
+#include "internal/util.hpp"
+
+#include <algorithm>
+#include <limits>
+
+using namespace bit7z;
+
+// The prefetched items are read by a few threads, as reading them is I/O bound.
+constexpr uint32_t kMaxPrefetchWorkers = 4;
+
+// Size of the chunk read when the file turns out to be larger than its size when it was indexed.
+constexpr std::size_t kGrowthChunkSize = 64 * 1024;
+
+ItemPrefetcher::ItemPrefetcher( const BitOutputArchive& output,
+                                const std::vector< uint32_t >* output_indices,
+                                uint32_t items_count,
+                                uint32_t lookahead,
+                                uint64_t budget )
+    : mOutputArchive{ output },
+      mOutputIndices{ output_indices },
+      mItemsCount{ items_count },
+      mLookahead{ lookahead },
+      mBudget{ budget },
+      mReservedBytes{ 0 },
+      mNextIndex{ 0 },
+      mStopped{ false } {
+    {
+        const std::lock_guard< std::mutex > lock{ mMutex };
+        // Prefetching the first items, which will be requested as soon as the compression starts.
+        scheduleFrom( 0 );
+    }
+
+    const uint32_t workers_count = std::min( mLookahead, kMaxPrefetchWorkers );
+    for ( uint32_t worker = 0; worker < workers_count; ++worker ) {
+        try {
+            mWorkers.emplace_back( &ItemPrefetcher::prefetchItems, this );
+        } catch ( const std::system_error& ) {
+            break; // The items not prefetched will be read by the compressor.
+        }
+    }
+}
+
+ItemPrefetcher::~ItemPrefetcher() {
+    {
+        const std::lock_guard< std::mutex > lock{ mMutex };
+        mStopped = true;
+    }
+    mWorkAvailable.notify_all();
+    for ( auto& worker : mWorkers ) {
+        worker.join();
+    }
+}
+
+void ItemPrefetcher::scheduleFrom( uint32_t first_index ) {
+    const uint64_t window_end = std::min< uint64_t >( mItemsCount,
+                                                      static_cast< uint64_t >( first_index ) + mLookahead );
+    if ( mNextIndex < first_index ) {
+        mNextIndex = first_index;
+    }
+    for ( ; mNextIndex < window_end; ++mNextIndex ) {
+        if ( mEntries.find( mNextIndex ) != mEntries.end() ) {
+            continue;
+        }
+        const GenericInputItem* item = mOutputArchive.outputNewItem( outputIndex( mNextIndex ) );
+        if ( item == nullptr || !item->isPrefetchable() || item->size() > mBudget ) {
+            continue;
+        }
+        const uint64_t size = item->size();
+        if ( mReservedBytes + size > mBudget ) {
+            break; // The item will be scheduled once enough memory is released by the consumed items.
+        }
+        mReservedBytes += size;
+        mEntries[ mNextIndex ].reserved_bytes = size;
+        mQueue.push_back( mNextIndex );
+        mWorkAvailable.notify_one();
+    }
+}
+
+void ItemPrefetcher::prefetchItems() {
+    std::unique_lock< std::mutex > lock{ mMutex };
+    while ( true ) {
+        mWorkAvailable.wait( lock, [ this ]() {
+            return mStopped || !mQueue.empty();
+        } );
+        if ( mStopped ) {
+            return;
+        }
+
+        const uint32_t index = mQueue.front();
+        mQueue.pop_front();
+        // Note: entries being read are never erased, so the reference stays valid while the mutex is unlocked.
+        Entry& entry = mEntries[ index ];
+        entry.state = EntryState::Reading;
+
+        lock.unlock();
+        buffer_t content;
+        const HRESULT result = readItem( index, content );
+        lock.lock();
+
+        entry.content = std::move( content );
+        entry.result = result;
+        entry.state = EntryState::Ready;
+        mEntryReady.notify_all();
+    }
+}
+
+HRESULT ItemPrefetcher::readItem( uint32_t index, buffer_t& content ) const {
+    const GenericInputItem* item = mOutputArchive.outputNewItem( outputIndex( index ) );
+    CMyComPtr< ISequentialInStream > stream;
+    const HRESULT res = item->getStream( &stream );
+    if ( res != S_OK || stream == nullptr ) {
+        return res != S_OK ? res : E_FAIL;
+    }
+
+    try {
+        content.resize( static_cast< std::size_t >( item->size() ) );
+        std::size_t total_read = 0;
+        while ( true ) {
+            if ( total_read == content.size() ) {
+                content.resize( total_read + kGrowthChunkSize );
+            }
+            const auto chunk_size = static_cast< UInt32 >(
+                std::min< std::size_t >( content.size() - total_read, ( std::numeric_limits< UInt32 >::max )() )
+            );
+            UInt32 read_size = 0;
+            RINOK( stream->Read( &content[ total_read ], chunk_size, &read_size ) )
+            if ( read_size == 0 ) {
+                break;
+            }
+            total_read += read_size;
+        }
+        content.resize( total_read );
+    } catch ( const std::bad_alloc& ) {
+        return E_OUTOFMEMORY;
+    }
+    return S_OK;
+}
+
+HRESULT ItemPrefetcher::getStream( uint32_t index, ISequentialInStream** inStream ) {
+    std::unique_lock< std::mutex > lock{ mMutex };
+    auto entry = mEntries.find( index );
+    if ( entry != mEntries.end() && entry->second.state == EntryState::Queued ) {
+        // No worker started reading the item yet: the compressor reads it as usual, without waiting.
+        mQueue.erase( std::find( mQueue.begin(), mQueue.end(), index ) );
+        mReservedBytes -= entry->second.reserved_bytes;
+        mEntries.erase( entry );
+        entry = mEntries.end();
+    }
+    scheduleFrom( index + 1 );
+
+    if ( entry == mEntries.end() ) {
+        lock.unlock();
+        return mOutputArchive.outputItemStream( outputIndex( index ), inStream );
+    }
+
+    mEntryReady.wait( lock, [ &entry ]() {
+        return entry->second.state == EntryState::Ready;
+    } );
+    buffer_t content = std::move( entry->second.content );
+    const HRESULT result = entry->second.result;
+    mReservedBytes -= entry->second.reserved_bytes;
+    mEntries.erase( entry );
+    scheduleFrom( index + 1 );
+    lock.unlock();
+
+    if ( result != S_OK ) {
+        // Reading the item again, so that any failure is handled (and reported) as usual.
+        return mOutputArchive.outputItemStream( outputIndex( index ), inStream );
+    }
+    auto prefetched_stream = bit7z::make_com< CPrefetchedInStream, ISequentialInStream >( std::move( content ) );
+    *inStream = prefetched_stream.Detach();
+    return S_OK;
+}
@@ -0,0 +1,100 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef ITEMPREFETCHER_HPP
+#define ITEMPREFETCHER_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "bitoutputarchive.hpp"
+
+#include <Common/MyCom.h>
+
+namespace bit7z {
+
+/* Reads the input files of an output archive ahead of the compressor, on background threads.
+ * The files following the one requested by the compressor (in the order of the update callback's indices)
+ * are read into memory, up to the given number of items and memory budget; the compressor then receives
+ * an in-memory stream, rather than having to wait for the file to be opened and read.
+ * Items that cannot be prefetched (e.g., buffers or standard streams), items larger than the budget,
+ * and items whose reading failed are read by the compressor as usual. */
+class ItemPrefetcher final {
+    public:
+        /* Note: output_indices maps the update callback's indices to the output archive's indices
+         *       (nullptr if they are the same). */
+        ItemPrefetcher( const BitOutputArchive& output,
+                        const std::vector< uint32_t >* output_indices,
+                        uint32_t items_count,
+                        uint32_t lookahead,
+                        uint64_t budget );
+
+        ItemPrefetcher( const ItemPrefetcher& ) = delete;
+
+        ItemPrefetcher( ItemPrefetcher&& ) = delete;
+
+        ItemPrefetcher& operator=( const ItemPrefetcher& ) = delete;
+
+        ItemPrefetcher& operator=( ItemPrefetcher&& ) = delete;
+
+        ~ItemPrefetcher();
+
+        HRESULT getStream( uint32_t index, ISequentialInStream** inStream );
+
+    private:
+        enum struct EntryState {
+            Queued,
+            Reading,
+            Ready
+        };
+
+        struct Entry {
+            EntryState state = EntryState::Queued;
+            uint64_t reserved_bytes = 0;
+            buffer_t content;
+            HRESULT result = S_OK;
+        };
+
+        const BitOutputArchive& mOutputArchive;
+        const std::vector< uint32_t >* mOutputIndices;
+        uint32_t mItemsCount;
+        uint32_t mLookahead;
+        uint64_t mBudget;
+
+        std::mutex mMutex;
+        std::condition_variable mWorkAvailable;
+        std::condition_variable mEntryReady;
+        std::map< uint32_t, Entry > mEntries;
+        std::deque< uint32_t > mQueue;
+        uint64_t mReservedBytes;
+        uint32_t mNextIndex;
+        bool mStopped;
+        std::vector< std::thread > mWorkers;
+
+        BIT7Z_NODISCARD
+        inline uint32_t outputIndex( uint32_t index ) const noexcept {
+            return mOutputIndices == nullptr ? index : ( *mOutputIndices )[ index ];
+        }
+
+        // Note: must be called while holding the mutex.
+        void scheduleFrom( uint32_t first_index );
+
+        void prefetchItems();
+
+        HRESULT readItem( uint32_t index, buffer_t& content ) const;
+};
+
+}  // namespace bit7z
+
+#endif // ITEMPREFETCHER_HPP
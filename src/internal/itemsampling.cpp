@@ -0,0 +1,87 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "internal/itemsampling.hpp"
+
+#include "internal/util.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include <7zip/IStream.h>
+
+using namespace bit7z;
+
+// The entropy is estimated on the first bytes of the files, like the "file" utility does for detecting their type.
+constexpr std::size_t kEntropySampleSize = 8 * 1024;
+
+// On fewer bytes, the entropy of random data is noticeably lower than 8 bits per byte.
+constexpr std::size_t kMinEntropySampleSize = 1024;
+
+bool bit7z::readItemSample( const GenericInputItem& item, std::size_t max_size, buffer_t& sample ) {
+    sample.clear();
+    if ( !item.isPrefetchable() || item.size() == 0 ) {
+        return false;
+    }
+    CMyComPtr< ISequentialInStream > stream;
+    if ( item.getStream( &stream ) != S_OK || stream == nullptr ) {
+        return false;
+    }
+
+    sample.resize( static_cast< std::size_t >( std::min< uint64_t >( item.size(), max_size ) ) );
+    std::size_t total_read = 0;
+    while ( total_read < sample.size() ) {
+        UInt32 read_size = 0;
+        if ( stream->Read( &sample[ total_read ], static_cast< UInt32 >( sample.size() - total_read ),
+                           &read_size ) != S_OK ) {
+            sample.clear();
+            return false;
+        }
+        if ( read_size == 0 ) {
+            break;
+        }
+        total_read += read_size;
+    }
+    sample.resize( total_read );
+    return total_read > 0;
+}
+
+double bit7z::byteEntropy( const byte_t* data, std::size_t size ) noexcept {
+    if ( size == 0 ) {
+        return 0.0;
+    }
+    std::array< std::size_t, 256 > frequencies{};
+    for ( std::size_t index = 0; index < size; ++index ) {
+        ++frequencies[ static_cast< uint8_t >( data[ index ] ) ];
+    }
+    double entropy = 0.0;
+    for ( const auto frequency : frequencies ) {
+        if ( frequency > 0 ) {
+            const double probability = static_cast< double >( frequency ) / static_cast< double >( size );
+            entropy -= probability * std::log2( probability );
+        }
+    }
+    return entropy;
+}
+
+Compressibility bit7z::estimateCompressibility( const GenericInputItem& item, double min_entropy ) {
+    if ( item.isDir() || item.size() < kMinEntropySampleSize ) {
+        return Compressibility::Unknown;
+    }
+    buffer_t sample;
+    if ( !readItemSample( item, kEntropySampleSize, sample ) || sample.size() < kMinEntropySampleSize ) {
+        return Compressibility::Unknown;
+    }
+    return byteEntropy( sample.data(), sample.size() ) >= min_entropy ? Compressibility::Incompressible
+                                                                      : Compressibility::Compressible;
+}
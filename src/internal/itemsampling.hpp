@@ -0,0 +1,40 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef ITEMSAMPLING_HPP
+#define ITEMSAMPLING_HPP
+
+#include <cstddef>
+
+#include "bitdefines.hpp"
+#include "bittypes.hpp"
+#include "internal/genericinputitem.hpp"
+
+namespace bit7z {
+
+enum struct Compressibility {
+    Unknown, // The item is a directory, it is too small, or it cannot be sampled.
+    Compressible,
+    Incompressible
+};
+
+/* Reads (at most) the first max_size bytes of the given item into the sample, returning whether any byte was read.
+ * Only the files on the filesystem are sampled, as the streams of the other items might be readable only once. */
+bool readItemSample( const GenericInputItem& item, std::size_t max_size, buffer_t& sample );
+
+// The Shannon entropy of the bytes of the given data, in bits per byte (i.e., from 0 to 8).
+BIT7Z_NODISCARD double byteEntropy( const byte_t* data, std::size_t size ) noexcept;
+
+/* Estimates whether compressing the given item is worth it, from the entropy of its first bytes:
+ * already compressed data (e.g., media files and packages) has an entropy close to 8 bits per byte. */
+BIT7Z_NODISCARD Compressibility estimateCompressibility( const GenericInputItem& item, double min_entropy );
+
+}  // namespace bit7z
+
+#endif // ITEMSAMPLING_HPP
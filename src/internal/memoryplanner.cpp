@@ -0,0 +1,377 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "internal/memoryplanner.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace bit7z;
+
+constexpr uint64_t kMiB = 1024 * 1024;
+
+// The memory used by the archive handler (headers, I/O buffers) regardless of the method.
+constexpr uint64_t kHandlerMemory = 4 * kMiB;
+
+constexpr uint64_t kCopyMemory = 1 * kMiB;
+constexpr uint64_t kDeflateMemory = 4 * kMiB;
+constexpr uint64_t kBZip2ThreadMemory = 10 * kMiB;
+constexpr uint64_t kPpmdStateMemory = 1 * kMiB;
+
+// The LZMA encoder state (e.g., the price tables), and the read-ahead buffer of its sliding window.
+constexpr uint64_t kLzmaEncoderMemory = 1 * kMiB;
+constexpr uint64_t kLzmaWindowReserve = 512 * 1024;
+constexpr uint64_t kLzmaFixedHashSize = ( 1u << 10u ) + ( 1u << 16u );
+constexpr uint32_t kMinLzmaDictionarySize = 4096;
+
+constexpr uint64_t kMinLzma2BlockSize = 1 * kMiB;
+constexpr uint64_t kMaxLzma2BlockSize = 256 * kMiB;
+
+// The dictionary is never reduced below this size, as the compression ratio would drop too much.
+constexpr uint32_t kMinPlannedDictionarySize = 64 * 1024;
+
+inline bool usesDictionary( BitCompressionMethod method ) noexcept {
+    return method == BitCompressionMethod::Lzma || method == BitCompressionMethod::Lzma2 ||
+           method == BitCompressionMethod::Ppmd;
+}
+
+uint32_t bit7z::defaultDictionarySize( BitCompressionMethod method, BitCompressionLevel level ) noexcept {
+    switch ( method ) {
+        case BitCompressionMethod::Lzma:
+        case BitCompressionMethod::Lzma2:
+            switch ( level ) {
+                case BitCompressionLevel::None:
+                    return 0;
+                case BitCompressionLevel::Fastest:
+                    return 64 * 1024;
+                case BitCompressionLevel::Fast:
+                    return 1024 * 1024;
+                case BitCompressionLevel::Normal:
+                    return 16 * 1024 * 1024;
+                case BitCompressionLevel::Max:
+                    return 32 * 1024 * 1024;
+                default:
+                    return 64 * 1024 * 1024;
+            }
+        case BitCompressionMethod::Ppmd:
+            switch ( level ) {
+                case BitCompressionLevel::None:
+                    return 0;
+                case BitCompressionLevel::Fastest:
+                case BitCompressionLevel::Fast:
+                    return 4 * 1024 * 1024;
+                case BitCompressionLevel::Normal:
+                    return 16 * 1024 * 1024;
+                case BitCompressionLevel::Max:
+                    return 64 * 1024 * 1024;
+                default:
+                    return 192 * 1024 * 1024;
+            }
+        default:
+            return 0;
+    }
+}
+
+// The number of entries of the hash table of the LZMA match finder (as computed by 7-zip's LzFind.c).
+inline uint64_t lzmaHashSize( uint32_t dictionary_size ) noexcept {
+    uint32_t hash_size = dictionary_size - 1;
+    hash_size |= ( hash_size >> 1u );
+    hash_size |= ( hash_size >> 2u );
+    hash_size |= ( hash_size >> 4u );
+    hash_size |= ( hash_size >> 8u );
+    hash_size >>= 1u;
+    hash_size |= 0xFFFFu;
+    if ( hash_size > ( 1u << 24u ) ) {
+        hash_size >>= 1u;
+    }
+    return static_cast< uint64_t >( hash_size ) + 1 + kLzmaFixedHashSize;
+}
+
+// Like 7-zip, only the (power of two) dictionary needed by the input is allocated.
+inline uint32_t allocatedDictionarySize( uint32_t dictionary_size, uint64_t input_size ) noexcept {
+    if ( input_size == 0 ) {
+        return dictionary_size;
+    }
+    uint64_t allocated = kMinLzmaDictionarySize;
+    while ( allocated < input_size && allocated < dictionary_size ) {
+        allocated <<= 1u;
+    }
+    return static_cast< uint32_t >( std::min< uint64_t >( allocated, dictionary_size ) );
+}
+
+/* The binary tree match finder (used from the Normal level) stores two links per position of the window,
+ * the hash chain one (used by the faster levels) only one. */
+inline uint64_t lzmaMemoryUsage( uint32_t dictionary_size, bool binary_tree ) noexcept {
+    dictionary_size = std::max( dictionary_size, kMinLzmaDictionarySize );
+    const uint64_t dictionary = dictionary_size;
+    const uint64_t links = ( binary_tree ? 2 : 1 ) * ( dictionary + 1 );
+    return ( lzmaHashSize( dictionary_size ) + links ) * 4 + dictionary + ( dictionary / 2 ) + kLzmaWindowReserve +
+           kLzmaEncoderMemory;
+}
+
+inline uint64_t lzma2BlockSize( uint32_t dictionary_size ) noexcept {
+    const uint64_t block_size = std::min( std::max( uint64_t{ dictionary_size } * 4, kMinLzma2BlockSize ),
+                                          kMaxLzma2BlockSize );
+    return std::max< uint64_t >( block_size, dictionary_size );
+}
+
+/* LZMA2 compresses blocks of its input in parallel, each one with an LZMA encoder using one thread
+ * (or two, with the binary tree match finder), and with its own input and output buffers. */
+inline uint64_t lzma2MemoryUsage( uint32_t dictionary_size,
+                                  bool binary_tree,
+                                  uint32_t threads_count,
+                                  uint64_t input_size ) noexcept {
+    const uint64_t block_size = lzma2BlockSize( dictionary_size );
+    uint64_t block_threads = std::max( threads_count / ( binary_tree ? 2u : 1u ), 1u );
+    if ( input_size != 0 ) {
+        block_threads = std::min( block_threads, ( input_size + block_size - 1 ) / block_size );
+    }
+    const uint64_t encoder = lzmaMemoryUsage( allocatedDictionarySize( dictionary_size, input_size ), binary_tree );
+    if ( block_threads <= 1 ) {
+        return encoder;
+    }
+    return block_threads * ( encoder + 2 * block_size );
+}
+
+inline uint64_t encoderMemoryUsage( BitCompressionMethod method,
+                                    BitCompressionLevel level,
+                                    uint32_t dictionary_size,
+                                    uint32_t threads_count,
+                                    uint64_t input_size ) noexcept {
+    const bool binary_tree = level >= BitCompressionLevel::Normal;
+    switch ( method ) {
+        case BitCompressionMethod::Deflate:
+        case BitCompressionMethod::Deflate64:
+            return kDeflateMemory;
+        case BitCompressionMethod::BZip2:
+            return threads_count * kBZip2ThreadMemory;
+        case BitCompressionMethod::Lzma:
+            return lzmaMemoryUsage( allocatedDictionarySize( dictionary_size, input_size ), binary_tree );
+        case BitCompressionMethod::Lzma2:
+            return lzma2MemoryUsage( dictionary_size, binary_tree, threads_count, input_size );
+        case BitCompressionMethod::Ppmd:
+            return uint64_t{ dictionary_size } + kPpmdStateMemory;
+        default:
+            return kCopyMemory;
+    }
+}
+
+uint64_t bit7z::compressionMemoryUsage( const BitInOutFormat& format,
+                                        BitCompressionMethod method,
+                                        BitCompressionLevel level,
+                                        uint32_t dictionary_size,
+                                        uint32_t threads_count,
+                                        uint64_t input_size ) noexcept {
+    threads_count = std::max( threads_count, 1u );
+    if ( format == BitFormat::Zip ) {
+        // The zip format compresses several files in parallel, each one with a single-threaded encoder.
+        return kHandlerMemory + threads_count * encoderMemoryUsage( method, level, dictionary_size, 1, input_size );
+    }
+    return kHandlerMemory + encoderMemoryUsage( method, level, dictionary_size, threads_count, input_size );
+}
+
+// The largest power of two smaller than the given dictionary size, but not smaller than kMinPlannedDictionarySize.
+inline uint32_t halvedDictionarySize( uint32_t dictionary_size ) noexcept {
+    uint32_t result = kMinPlannedDictionarySize;
+    while ( result < dictionary_size / 2 ) {
+        result <<= 1u;
+    }
+    return result;
+}
+
+BitMemoryEstimate bit7z::planCompressionMemory( const BitAbstractArchiveCreator& creator,
+                                                uint64_t input_size,
+                                                uint64_t memory_budget,
+                                                bool store_only,
+                                                uint32_t threads_limit ) noexcept {
+    const BitInOutFormat& format = creator.compressionFormat();
+    const BitCompressionLevel level = creator.compressionLevel();
+    BitCompressionMethod method = creator.compressionMethod();
+    const bool stores_items = level == BitCompressionLevel::None &&
+                              format.hasFeature( FormatFeatures::CompressionLevel );
+    if ( store_only || stores_items ) {
+        method = BitCompressionMethod::Copy;
+    }
+
+    BitMemoryEstimate estimate;
+    estimate.memory_budget = memory_budget;
+    if ( usesDictionary( method ) ) {
+        estimate.dictionary_size = creator.dictionarySize() != 0 ? creator.dictionarySize()
+                                                                 : defaultDictionarySize( method, level );
+    }
+    estimate.threads_count = creator.threadsCount() != 0 ? creator.threadsCount()
+                                                         : std::max( std::thread::hardware_concurrency(), 1u );
+    if ( threads_limit != 0 ) {
+        estimate.threads_count = std::min( estimate.threads_count, threads_limit );
+    }
+    const auto usage = [ & ]() {
+        return compressionMemoryUsage( format, method, level, estimate.dictionary_size, estimate.threads_count,
+                                       input_size );
+    };
+    estimate.memory_usage = usage();
+    if ( memory_budget == 0 ) {
+        return estimate;
+    }
+
+    // Fewer threads only make the compression slower, while a smaller dictionary also worsens the ratio.
+    while ( estimate.memory_usage > memory_budget && estimate.threads_count > 1 ) {
+        --estimate.threads_count;
+        estimate.memory_usage = usage();
+        estimate.reduced = true;
+    }
+    while ( estimate.memory_usage > memory_budget && estimate.dictionary_size > kMinPlannedDictionarySize ) {
+        estimate.dictionary_size = halvedDictionarySize( estimate.dictionary_size );
+        estimate.memory_usage = usage();
+        estimate.reduced = true;
+    }
+    estimate.fits = estimate.memory_usage <= memory_budget;
+    return estimate;
+}
+
+// The state of the LZMA and PPMd decoders (e.g., the probabilities), and their input buffer.
+constexpr uint64_t kDecoderStateMemory = 1 * kMiB;
+constexpr uint64_t kDeflateDecoderMemory = 1 * kMiB;
+constexpr uint64_t kBZip2DecoderMemory = 8 * kMiB;
+constexpr uint64_t kBcj2DecoderMemory = 4 * kMiB;
+
+// The filters (e.g., BCJ and Delta) and the ciphers only need small buffers.
+constexpr uint64_t kFilterMemory = 256 * 1024;
+
+// The memory assumed for the coders not known by the estimator.
+constexpr uint64_t kUnknownCoderMemory = 4 * kMiB;
+
+/* Parses a size as printed by 7-zip in the Method property: either the exponent of a power of two (e.g., "24"),
+ * or a number followed by its unit (e.g., "1536m"). Returns 0 if the value is not a size. */
+inline uint64_t parseMethodSize( const tstring& value ) noexcept {
+    constexpr uint64_t kMaxExponent = 40;
+    uint64_t number = 0;
+    std::size_t position = 0;
+    for ( ; position < value.size() && value[ position ] >= BIT7Z_STRING( '0' ) &&
+            value[ position ] <= BIT7Z_STRING( '9' ); ++position ) {
+        number = ( number * 10 ) + static_cast< uint64_t >( value[ position ] - BIT7Z_STRING( '0' ) );
+        if ( number > ( uint64_t{ 1 } << kMaxExponent ) ) {
+            return 0;
+        }
+    }
+    if ( position == 0 ) {
+        return 0;
+    }
+    if ( position == value.size() ) {
+        return number <= kMaxExponent ? uint64_t{ 1 } << number : 0;
+    }
+    if ( position + 1 != value.size() ) {
+        return 0;
+    }
+    switch ( value[ position ] ) {
+        case BIT7Z_STRING( 'b' ):
+        case BIT7Z_STRING( 'B' ):
+            return number;
+        case BIT7Z_STRING( 'k' ):
+        case BIT7Z_STRING( 'K' ):
+            return number << 10u;
+        case BIT7Z_STRING( 'm' ):
+        case BIT7Z_STRING( 'M' ):
+            return number << 20u;
+        case BIT7Z_STRING( 'g' ):
+        case BIT7Z_STRING( 'G' ):
+            return number << 30u;
+        default:
+            return 0;
+    }
+}
+
+inline std::string uppercaseName( const tstring& name ) {
+    std::string result;
+    for ( const auto character : name ) {
+        if ( character >= BIT7Z_STRING( 'a' ) && character <= BIT7Z_STRING( 'z' ) ) {
+            result += static_cast< char >( character - BIT7Z_STRING( 'a' ) + 'A' );
+        } else if ( static_cast< uint32_t >( character ) < 0x80 ) {
+            result += static_cast< char >( character );
+        }
+    }
+    return result;
+}
+
+inline bool isFilterName( const std::string& name ) {
+    static const char* const kFilterNames[] = { // NOLINT(*-avoid-c-arrays)
+        "COPY", "STORE", "BCJ", "ARM", "ARM64", "ARMT", "PPC", "SPARC", "IA64", "DELTA", "SWAP2", "SWAP4",
+        "7ZAES", "ZIPCRYPTO"
+    };
+    if ( name.compare( 0, 3, "AES" ) == 0 ) {
+        return true;
+    }
+    return std::find( std::begin( kFilterNames ), std::end( kFilterNames ), name ) != std::end( kFilterNames );
+}
+
+// The memory used by a single coder of a Method property (e.g., "LZMA2:26").
+inline uint64_t coderMemoryUsage( const tstring& coder, uint64_t& dictionary_size ) {
+    std::vector< tstring > parts;
+    std::size_t begin = 0;
+    for ( std::size_t separator = coder.find( BIT7Z_STRING( ':' ) ); separator != tstring::npos;
+          separator = coder.find( BIT7Z_STRING( ':' ), begin ) ) {
+        parts.push_back( coder.substr( begin, separator - begin ) );
+        begin = separator + 1;
+    }
+    parts.push_back( coder.substr( begin ) );
+
+    const std::string name = uppercaseName( parts.front() );
+    dictionary_size = 0;
+    if ( name == "LZMA" || name == "LZMA2" ) {
+        dictionary_size = parts.size() > 1 ? parseMethodSize( parts[ 1 ] ) : 0;
+        return dictionary_size != 0 ? dictionary_size + kDecoderStateMemory : kUnknownCoderMemory;
+    }
+    if ( name == "PPMD" ) {
+        for ( std::size_t part = 1; part < parts.size(); ++part ) {
+            if ( uppercaseName( parts[ part ].substr( 0, 3 ) ) == "MEM" ) {
+                dictionary_size = parseMethodSize( parts[ part ].substr( 3 ) );
+            }
+        }
+        return dictionary_size != 0 ? dictionary_size + kDecoderStateMemory : kUnknownCoderMemory;
+    }
+    if ( name == "DEFLATE" || name == "DEFLATE64" ) {
+        return kDeflateDecoderMemory;
+    }
+    if ( name == "BZIP2" ) {
+        return kBZip2DecoderMemory;
+    }
+    if ( name == "BCJ2" ) {
+        return kBcj2DecoderMemory;
+    }
+    return isFilterName( name ) ? kFilterMemory : kUnknownCoderMemory;
+}
+
+/* Note: the coders of an item are chained (e.g., a filter followed by a compressor), so they are all allocated
+ *       at the same time. */
+uint64_t bit7z::decodingMemoryUsage( const tstring& methods, uint32_t& dictionary_size ) {
+    uint64_t usage = kHandlerMemory;
+    uint64_t largest_dictionary = 0;
+    std::size_t begin = 0;
+    while ( begin < methods.size() ) {
+        std::size_t end = methods.find( BIT7Z_STRING( ' ' ), begin );
+        if ( end == tstring::npos ) {
+            end = methods.size();
+        }
+        if ( end > begin ) {
+            uint64_t coder_dictionary = 0;
+            usage += coderMemoryUsage( methods.substr( begin, end - begin ), coder_dictionary );
+            largest_dictionary = std::max( largest_dictionary, coder_dictionary );
+        }
+        begin = end + 1;
+    }
+    dictionary_size = static_cast< uint32_t >( std::min< uint64_t >( largest_dictionary,
+                                                                     ( std::numeric_limits< uint32_t >::max )() ) );
+    return usage;
+}
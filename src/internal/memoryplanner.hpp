@@ -0,0 +1,49 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef MEMORYPLANNER_HPP
+#define MEMORYPLANNER_HPP
+
+#include <cstdint>
+
+#include "bitabstractarchivecreator.hpp"
+#include "bitmemoryestimate.hpp"
+
+namespace bit7z {
+
+// The dictionary size used by 7-zip when it is not set by the user (0 if the method does not use a dictionary).
+BIT7Z_NODISCARD uint32_t defaultDictionarySize( BitCompressionMethod method, BitCompressionLevel level ) noexcept;
+
+/* Estimates the memory used by 7-zip for compressing input_size bytes (0 if unknown) with the given parameters.
+ * The input size bounds both the dictionary actually allocated and the number of LZMA2 blocks compressed
+ * in parallel; for solid archives, it is the size of the largest solid block, otherwise of the largest file. */
+BIT7Z_NODISCARD uint64_t compressionMemoryUsage( const BitInOutFormat& format,
+                                                 BitCompressionMethod method,
+                                                 BitCompressionLevel level,
+                                                 uint32_t dictionary_size,
+                                                 uint32_t threads_count,
+                                                 uint64_t input_size ) noexcept;
+
+/* Estimates the memory used by the creator's settings, reducing first the number of threads, and then
+ * the dictionary size, until the estimate fits the given memory budget (0 means no budget).
+ * The threads are also limited to threads_limit (e.g., the ones granted by a thread governor), if not 0. */
+BIT7Z_NODISCARD BitMemoryEstimate planCompressionMemory( const BitAbstractArchiveCreator& creator,
+                                                         uint64_t input_size,
+                                                         uint64_t memory_budget,
+                                                         bool store_only = false,
+                                                         uint32_t threads_limit = 0 ) noexcept;
+
+/* Estimates the memory used by 7-zip for decoding an item with the coders described by its Method property
+ * (e.g., "BCJ2 LZMA2:26 LZMA:20", "PPMD:o6:mem24", or "LZMA:1536m"), and stores the largest dictionary
+ * size of the coders in the given variable. */
+BIT7Z_NODISCARD uint64_t decodingMemoryUsage( const tstring& methods, uint32_t& dictionary_size );
+
+}  // namespace bit7z
+
+#endif // MEMORYPLANNER_HPP
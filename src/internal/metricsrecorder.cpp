@@ -0,0 +1,77 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "internal/metricsrecorder.hpp"
+
+#include "internal/carchiveinstream.hpp"
+
+using namespace bit7z;
+
+std::unique_ptr< MetricsRecorder > MetricsRecorder::create( const BitAbstractArchiveHandler& handler ) {
+    MetricsCallback callback = handler.metricsCallback();
+    if ( !callback ) {
+        return nullptr;
+    }
+    return std::make_unique< MetricsRecorder >( std::move( callback ) );
+}
+
+MetricsRecorder::MetricsRecorder( MetricsCallback callback )
+    : mCallback{ std::move( callback ) },
+      mStartTime{ metrics_clock::now() },
+      mItemPending{ false },
+      mArchiveStream{ nullptr },
+      mStoreOnly{ false } {}
+
+MetricsRecorder::~MetricsRecorder() {
+    detachArchiveStream();
+}
+
+void MetricsRecorder::attachArchiveStream( CArchiveInStream* archive_stream ) noexcept {
+    detachArchiveStream();
+    mArchiveStream = archive_stream;
+    if ( mArchiveStream != nullptr ) {
+        mArchiveStream->setMetrics( &mMetrics.archive_stream );
+    }
+}
+
+void MetricsRecorder::detachArchiveStream() noexcept {
+    if ( mArchiveStream != nullptr ) {
+        mArchiveStream->setMetrics( nullptr );
+        mArchiveStream = nullptr;
+    }
+}
+
+void MetricsRecorder::beginItem() noexcept {
+    endItem(); // 7-zip may skip an item without setting its operation result.
+    mItemStartTime = metrics_clock::now();
+    mItemPending = true;
+}
+
+void MetricsRecorder::endItem() noexcept {
+    if ( !mItemPending ) {
+        return;
+    }
+    mItemPending = false;
+    ++mMetrics.items_count;
+    mMetrics.item_latency.record( elapsedNs( mItemStartTime ) );
+}
+
+void MetricsRecorder::finish( BitOperation operation ) {
+    endItem();
+    detachArchiveStream();
+    mMetrics.operation = operation;
+    mMetrics.total_time_ns = elapsedNs( mStartTime );
+    if ( mStoreOnly ) {
+        mMetrics.stored_bytes = mMetrics.item_streams.bytes_read;
+    }
+    mCallback( mMetrics );
+}
@@ -0,0 +1,97 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef METRICSRECORDER_HPP
+#define METRICSRECORDER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include "bitabstractarchivehandler.hpp"
+#include "bitmetrics.hpp"
+
+namespace bit7z {
+
+using metrics_clock = std::chrono::steady_clock;
+
+inline uint64_t elapsedNs( metrics_clock::time_point start ) noexcept {
+    const auto elapsed = std::chrono::duration_cast< std::chrono::nanoseconds >( metrics_clock::now() - start );
+    return static_cast< uint64_t >( elapsed.count() );
+}
+
+class CArchiveInStream;
+
+/* Collects the metrics of a single operation of an archive handler.
+ * A recorder is created only if the handler has a metrics callback: the hooks in the callbacks and streams
+ * check for a null recorder, so that collecting metrics costs nothing more than a branch when disabled. */
+class MetricsRecorder final {
+    public:
+        static std::unique_ptr< MetricsRecorder > create( const BitAbstractArchiveHandler& handler );
+
+        explicit MetricsRecorder( MetricsCallback callback );
+
+        MetricsRecorder( const MetricsRecorder& ) = delete;
+
+        MetricsRecorder( MetricsRecorder&& ) = delete;
+
+        MetricsRecorder& operator=( const MetricsRecorder& ) = delete;
+
+        MetricsRecorder& operator=( MetricsRecorder&& ) = delete;
+
+        ~MetricsRecorder();
+
+        BIT7Z_NODISCARD
+        inline BitStreamMetrics& itemStreams() noexcept {
+            return mMetrics.item_streams;
+        }
+
+        BIT7Z_NODISCARD
+        inline BitStreamMetrics& archiveStream() noexcept {
+            return mMetrics.archive_stream;
+        }
+
+        inline void addPropertyCall() noexcept {
+            ++mMetrics.property_calls;
+        }
+
+        // Note: in-memory outputs only grow during an operation, hence the peak is the total allocated memory.
+        inline void addBufferMemory( uint64_t size ) noexcept {
+            mMetrics.peak_buffer_memory += size;
+        }
+
+        // The input items are stored without compression, so all the bytes read from them count as stored.
+        inline void setStoreOnly() noexcept {
+            mStoreOnly = true;
+        }
+
+        // The archive stream will report its I/O to this recorder until the operation is finished.
+        void attachArchiveStream( CArchiveInStream* archive_stream ) noexcept;
+
+        void beginItem() noexcept;
+
+        void endItem() noexcept;
+
+        void finish( BitOperation operation );
+
+    private:
+        MetricsCallback mCallback;
+        BitOperationMetrics mMetrics;
+        metrics_clock::time_point mStartTime;
+        metrics_clock::time_point mItemStartTime;
+        bool mItemPending;
+        CArchiveInStream* mArchiveStream;
+        bool mStoreOnly;
+
+        void detachArchiveStream() noexcept;
+};
+
+}  // namespace bit7z
+
+#endif // METRICSRECORDER_HPP
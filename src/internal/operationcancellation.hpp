@@ -0,0 +1,52 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef OPERATIONCANCELLATION_HPP
+#define OPERATIONCANCELLATION_HPP
+
+#include <chrono>
+
+#include "bitabstractarchivehandler.hpp"
+#include "bitcancellationtoken.hpp"
+
+namespace bit7z {
+
+/* The cancellation state of an operation: the handler's cancellation token, and the deadline given by
+ * the handler's timeout, which starts when the operation does (i.e., when this object is constructed). */
+class OperationCancellation final {
+    public:
+        explicit OperationCancellation( const BitAbstractArchiveHandler& handler )
+            : mToken{ handler.cancellationToken() },
+              mDeadline{ handler.timeout().count() > 0 ? clock::now() + handler.timeout()
+                                                       : clock::time_point::max() } {}
+
+        // Whether the operation can be cancelled at all, i.e., whether its streams must be checked.
+        BIT7Z_NODISCARD
+        inline bool isEnabled() const noexcept {
+            return mToken != nullptr || mDeadline != clock::time_point::max();
+        }
+
+        BIT7Z_NODISCARD
+        inline bool isCancelled() const noexcept {
+            if ( mToken != nullptr && mToken->isCancelled() ) {
+                return true;
+            }
+            return mDeadline != clock::time_point::max() && clock::now() >= mDeadline;
+        }
+
+    private:
+        using clock = std::chrono::steady_clock;
+
+        const BitCancellationToken* mToken;
+        clock::time_point mDeadline;
+};
+
+}  // namespace bit7z
+
+#endif // OPERATIONCANCELLATION_HPP
@@ -0,0 +1,76 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "internal/operationcategory.hpp"
+#include "internal/operationresult.hpp"
+
+using bit7z::operation_category_t;
+using bit7z::OperationResult;
+
+const char* operation_category_t::name() const noexcept {
+    return "operation_result";
+}
+
+std::string operation_category_t::message( int error_value ) const noexcept {
+    switch ( static_cast< OperationResult >( error_value ) ) {
+        case OperationResult::Success:
+            return "Success.";
+        case OperationResult::UnsupportedMethod:
+            return "Unsupported method.";
+        case OperationResult::DataError:
+            return "Data error.";
+        case OperationResult::CRCError:
+            return "CRC failed.";
+        case OperationResult::Unavailable:
+            return "Unavailable data.";
+        case OperationResult::UnexpectedEnd:
+            return "Unexpected end of data.";
+        case OperationResult::DataAfterEnd:
+            return "There is some data after the end of the payload data.";
+        case OperationResult::IsNotArc:
+            return "Is not an archive.";
+        case OperationResult::HeadersError:
+            return "Headers error.";
+        case OperationResult::WrongPassword:
+            return "Wrong password.";
+        default:
+            return "Unknown error.";
+    }
+}
+
+std::error_condition operation_category_t::default_error_condition( int error_value ) const noexcept {
+    switch ( static_cast< OperationResult >( error_value ) ) {
+        case OperationResult::UnsupportedMethod:
+            return std::make_error_condition( std::errc::function_not_supported );
+        case OperationResult::DataError:
+        case OperationResult::CRCError:
+        case OperationResult::UnexpectedEnd:
+        case OperationResult::DataAfterEnd:
+        case OperationResult::HeadersError:
+            return std::make_error_condition( std::errc::io_error );
+        case OperationResult::IsNotArc:
+            return std::make_error_condition( std::errc::invalid_argument );
+        case OperationResult::WrongPassword:
+            return std::make_error_condition( std::errc::operation_not_permitted );
+        default:
+            return error_category::default_error_condition( error_value );
+    }
+}
+
+const std::error_category& bit7z::operation_category() noexcept {
+    static const operation_category_t instance{};
+    return instance;
+}
+
+std::error_code bit7z::make_error_code( OperationResult result ) noexcept {
+    return { static_cast< int >( result ), operation_category() };
+}
@@ -0,0 +1,37 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef OPERATIONRESULT_HPP
+#define OPERATIONRESULT_HPP
+
+#include <system_error>
+
+#include <7zip/Archive/IArchive.h>
+
+namespace bit7z {
+
+enum struct OperationResult {
+    Success = NArchive::NExtract::NOperationResult::kOK,
+    UnsupportedMethod = NArchive::NExtract::NOperationResult::kUnsupportedMethod,
+    DataError = NArchive::NExtract::NOperationResult::kDataError,
+    CRCError = NArchive::NExtract::NOperationResult::kCRCError,
+    Unavailable = NArchive::NExtract::NOperationResult::kUnavailable,
+    UnexpectedEnd = NArchive::NExtract::NOperationResult::kUnexpectedEnd,
+    DataAfterEnd = NArchive::NExtract::NOperationResult::kDataAfterEnd,
+    IsNotArc = NArchive::NExtract::NOperationResult::kIsNotArc,
+    HeadersError = NArchive::NExtract::NOperationResult::kHeadersError,
+    WrongPassword = NArchive::NExtract::NOperationResult::kWrongPassword
+};
+
+// The error code of the given (failed) result of the extraction of an item.
+std::error_code make_error_code( OperationResult result ) noexcept;
+
+}  // namespace bit7z
+
+#endif //OPERATIONRESULT_HPP
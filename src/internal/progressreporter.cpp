@@ -0,0 +1,116 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "internal/progressreporter.hpp"
+
+using namespace bit7z;
+
+ProgressReporter::ProgressReporter( const BitAbstractArchiveHandler& handler )
+    : mTotalCallback{ handler.totalCallback() },
+      mProgressCallback{ handler.progressCallback() },
+      mRatioCallback{ handler.ratioCallback() },
+      mFileCallback{ handler.fileCallback() },
+      mProgress{ handler.progressTracker() },
+      mInterval{ handler.progressInterval() },
+      mLastProgress{},
+      mLastRatio{},
+      mTotal{ 0 },
+      mHasPendingProgress{ false },
+      mPendingCompleted{ 0 },
+      mHasPendingRatio{ false },
+      mPendingInputBytes{ 0 },
+      mPendingOutputBytes{ 0 } {
+    if ( mProgress != nullptr ) {
+        mProgress->reset();
+    }
+}
+
+bool ProgressReporter::shouldDeliver( clock::time_point& last_delivery ) const noexcept {
+    if ( mInterval == clock::duration::zero() ) {
+        return true;
+    }
+    const auto now = clock::now();
+    if ( now - last_delivery < mInterval ) {
+        return false;
+    }
+    last_delivery = now;
+    return true;
+}
+
+void ProgressReporter::reportTotal( uint64_t total ) {
+    mTotal = total;
+    if ( mProgress != nullptr ) {
+        mProgress->setTotal( total );
+    }
+    if ( mTotalCallback ) {
+        mTotalCallback( total );
+    }
+}
+
+bool ProgressReporter::reportCompleted( uint64_t completed ) {
+    if ( mProgress != nullptr ) {
+        mProgress->setCompleted( completed );
+    }
+    if ( !mProgressCallback ) {
+        return true;
+    }
+    // The final progress is always delivered, even if it comes sooner than the progress interval.
+    const bool is_final = mTotal > 0 && completed >= mTotal;
+    if ( !is_final && !shouldDeliver( mLastProgress ) ) {
+        mHasPendingProgress = true;
+        mPendingCompleted = completed;
+        return true;
+    }
+    mHasPendingProgress = false;
+    return mProgressCallback( completed );
+}
+
+void ProgressReporter::reportRatio( uint64_t input_bytes, uint64_t output_bytes ) {
+    if ( mProgress != nullptr ) {
+        mProgress->setRatioInfo( input_bytes, output_bytes );
+    }
+    if ( !mRatioCallback ) {
+        return;
+    }
+    if ( !shouldDeliver( mLastRatio ) ) {
+        mHasPendingRatio = true;
+        mPendingInputBytes = input_bytes;
+        mPendingOutputBytes = output_bytes;
+        return;
+    }
+    mHasPendingRatio = false;
+    mRatioCallback( input_bytes, output_bytes );
+}
+
+void ProgressReporter::reportCurrentItem( uint32_t index ) noexcept {
+    if ( mProgress != nullptr ) {
+        mProgress->setCurrentItem( index );
+    }
+}
+
+void ProgressReporter::reportFile( const tstring& path ) {
+    if ( mFileCallback ) {
+        mFileCallback( path );
+    }
+}
+
+void ProgressReporter::flush() {
+    if ( mHasPendingProgress ) {
+        mHasPendingProgress = false;
+        // Note: the operation is already finished, so the result of the callback is ignored.
+        mProgressCallback( mPendingCompleted );
+    }
+    if ( mHasPendingRatio ) {
+        mHasPendingRatio = false;
+        mRatioCallback( mPendingInputBytes, mPendingOutputBytes );
+    }
+}
@@ -0,0 +1,71 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef PROGRESSREPORTER_HPP
+#define PROGRESSREPORTER_HPP
+
+#include <chrono>
+#include <cstdint>
+
+#include "bitabstractarchivehandler.hpp"
+#include "bitprogress.hpp"
+
+namespace bit7z {
+
+/* Delivers the progress of an operation to the callbacks and to the progress tracker of a handler.
+ * The callbacks are copied once when the operation starts (rather than at every notification), and the
+ * notifications of the progress and ratio callbacks are coalesced to the handler's progress interval;
+ * the last coalesced values are delivered by flush() when the operation finishes. */
+class ProgressReporter final {
+    public:
+        explicit ProgressReporter( const BitAbstractArchiveHandler& handler );
+
+        void reportTotal( uint64_t total );
+
+        // Returns false if the progress callback requested to stop the operation.
+        BIT7Z_NODISCARD bool reportCompleted( uint64_t completed );
+
+        void reportRatio( uint64_t input_bytes, uint64_t output_bytes );
+
+        void reportCurrentItem( uint32_t index ) noexcept;
+
+        BIT7Z_NODISCARD
+        inline bool hasFileCallback() const noexcept {
+            return static_cast< bool >( mFileCallback );
+        }
+
+        void reportFile( const tstring& path );
+
+        // Delivers the last progress and ratio values that were coalesced (i.e., not delivered yet), if any.
+        void flush();
+
+    private:
+        using clock = std::chrono::steady_clock;
+
+        TotalCallback mTotalCallback;
+        ProgressCallback mProgressCallback;
+        RatioCallback mRatioCallback;
+        FileCallback mFileCallback;
+        BitProgress* mProgress;
+        clock::duration mInterval;
+        clock::time_point mLastProgress;
+        clock::time_point mLastRatio;
+        uint64_t mTotal;
+        bool mHasPendingProgress;
+        uint64_t mPendingCompleted;
+        bool mHasPendingRatio;
+        uint64_t mPendingInputBytes;
+        uint64_t mPendingOutputBytes;
+
+        BIT7Z_NODISCARD bool shouldDeliver( clock::time_point& last_delivery ) const noexcept;
+};
+
+}  // namespace bit7z
+
+#endif // PROGRESSREPORTER_HPP
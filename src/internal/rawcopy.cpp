@@ -0,0 +1,66 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "internal/rawcopy.hpp"
+
+#include "bitexception.hpp"
+
+#include <algorithm>
+
+using namespace bit7z;
+
+void bit7z::readRaw( std::istream& archive, byte_t* data, std::size_t size, const tstring& archive_path ) {
+    if ( size > 0 && !archive.read( reinterpret_cast< char* >( data ), static_cast< std::streamsize >( size ) ) ) {
+        throw BitException( "Unexpected end of the archive", std::make_error_code( std::errc::io_error ),
+                            archive_path );
+    }
+}
+
+void bit7z::writeRaw( std::ostream& out, const byte_t* data, std::size_t size ) {
+    if ( size > 0 && !out.write( reinterpret_cast< const char* >( data ), static_cast< std::streamsize >( size ) ) ) {
+        throw BitException( "Failed to write the output archive", std::make_error_code( std::errc::io_error ) );
+    }
+}
+
+void bit7z::copyRaw( std::istream& archive,
+                     std::ostream& out,
+                     uint64_t size,
+                     buffer_t& buffer,
+                     const tstring& archive_path ) {
+    if ( buffer.size() < kRawCopyBufferSize ) {
+        buffer.resize( kRawCopyBufferSize );
+    }
+    while ( size > 0 ) {
+        const auto chunk_size = static_cast< std::size_t >( std::min< uint64_t >( size, buffer.size() ) );
+        readRaw( archive, buffer.data(), chunk_size, archive_path );
+        writeRaw( out, buffer.data(), chunk_size );
+        size -= chunk_size;
+    }
+}
+
+std::string bit7z::rawItemKey( const std::string& item_path ) {
+    std::size_t begin = 0;
+    while ( begin < item_path.size() ) {
+        if ( item_path[ begin ] == '/' ) {
+            ++begin;
+        } else if ( item_path.compare( begin, 2, "./" ) == 0 ) {
+            begin += 2;
+        } else {
+            break;
+        }
+    }
+    std::size_t end = item_path.size();
+    while ( end > begin && item_path[ end - 1 ] == '/' ) {
+        --end;
+    }
+    return item_path.substr( begin, end - begin );
+}
@@ -0,0 +1,41 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef RAWCOPY_HPP
+#define RAWCOPY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+
+#include "bittypes.hpp"
+
+namespace bit7z {
+
+// The size of the buffer used for copying the raw data of the items between archives.
+constexpr std::size_t kRawCopyBufferSize = 1024 * 1024;
+
+// Reads exactly size bytes from the archive, throwing a BitException if the archive is truncated.
+void readRaw( std::istream& archive, byte_t* data, std::size_t size, const tstring& archive_path );
+
+// Writes the given bytes to the output archive, throwing a BitException on failure.
+void writeRaw( std::ostream& out, const byte_t* data, std::size_t size );
+
+// Copies size bytes from the current position of the archive to the output, using the given buffer.
+void copyRaw( std::istream& archive, std::ostream& out, uint64_t size, buffer_t& buffer, const tstring& archive_path );
+
+/* Returns the path of an archive item as it must be compared for detecting duplicates,
+ * i.e., without the leading "./" and "/" components, and without the trailing slashes. */
+std::string rawItemKey( const std::string& item_path );
+
+}  // namespace bit7z
+
+#endif // RAWCOPY_HPP
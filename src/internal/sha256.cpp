@@ -0,0 +1,138 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "internal/sha256.hpp"
+
+#include <algorithm>
+
+using namespace bit7z;
+
+constexpr std::array< uint32_t, 64 > kRoundConstants = {
+    0x428a2f98u, 0x71374491u, 0xb5c0fbcfu, 0xe9b5dba5u, 0x3956c25bu, 0x59f111f1u, 0x923f82a4u, 0xab1c5ed5u,
+    0xd807aa98u, 0x12835b01u, 0x243185beu, 0x550c7dc3u, 0x72be5d74u, 0x80deb1feu, 0x9bdc06a7u, 0xc19bf174u,
+    0xe49b69c1u, 0xefbe4786u, 0x0fc19dc6u, 0x240ca1ccu, 0x2de92c6fu, 0x4a7484aau, 0x5cb0a9dcu, 0x76f988dau,
+    0x983e5152u, 0xa831c66du, 0xb00327c8u, 0xbf597fc7u, 0xc6e00bf3u, 0xd5a79147u, 0x06ca6351u, 0x14292967u,
+    0x27b70a85u, 0x2e1b2138u, 0x4d2c6dfcu, 0x53380d13u, 0x650a7354u, 0x766a0abbu, 0x81c2c92eu, 0x92722c85u,
+    0xa2bfe8a1u, 0xa81a664bu, 0xc24b8b70u, 0xc76c51a3u, 0xd192e819u, 0xd6990624u, 0xf40e3585u, 0x106aa070u,
+    0x19a4c116u, 0x1e376c08u, 0x2748774cu, 0x34b0bcb5u, 0x391c0cb3u, 0x4ed8aa4au, 0x5b9cca4fu, 0x682e6ff3u,
+    0x748f82eeu, 0x78a5636fu, 0x84c87814u, 0x8cc70208u, 0x90befffau, 0xa4506cebu, 0xbef9a3f7u, 0xc67178f2u
+};
+
+inline uint32_t rotateRight( uint32_t value, unsigned bits ) noexcept {
+    return ( value >> bits ) | ( value << ( 32u - bits ) );
+}
+
+Sha256::Sha256() noexcept
+    : mState{ 0x6a09e667u, 0xbb67ae85u, 0x3c6ef372u, 0xa54ff53au, 0x510e527fu, 0x9b05688cu, 0x1f83d9abu, 0x5be0cd19u },
+      mBlock{},
+      mBlockSize{ 0 },
+      mTotalSize{ 0 } {}
+
+void Sha256::update( const byte_t* data, std::size_t size ) noexcept {
+    mTotalSize += size;
+    for ( std::size_t i = 0; i < size; ++i ) {
+        mBlock[ mBlockSize++ ] = static_cast< uint8_t >( data[ i ] ); // NOLINT(*-pro-bounds-pointer-arithmetic)
+        if ( mBlockSize == mBlock.size() ) {
+            processBlock();
+            mBlockSize = 0;
+        }
+    }
+}
+
+std::string Sha256::hexDigest() noexcept {
+    const uint64_t total_bits = mTotalSize * 8u;
+    const byte_t padding = static_cast< byte_t >( 0x80u );
+    update( &padding, 1 );
+    const byte_t zero = static_cast< byte_t >( 0u );
+    while ( mBlockSize != 56 ) {
+        update( &zero, 1 );
+    }
+    for ( int shift = 56; shift >= 0; shift -= 8 ) {
+        const auto length_byte = static_cast< byte_t >( ( total_bits >> static_cast< unsigned >( shift ) ) & 0xFFu );
+        update( &length_byte, 1 );
+    }
+
+    static constexpr const char* kHexDigits = "0123456789abcdef";
+    std::string result;
+    result.reserve( mState.size() * 8 );
+    for ( const uint32_t word : mState ) {
+        for ( int shift = 28; shift >= 0; shift -= 4 ) {
+            result.push_back( kHexDigits[ ( word >> static_cast< unsigned >( shift ) ) & 0xFu ] );
+        }
+    }
+    return result;
+}
+
+void Sha256::processBlock() noexcept {
+    std::array< uint32_t, 64 > words{};
+    for ( std::size_t i = 0; i < 16; ++i ) {
+        words[ i ] = ( static_cast< uint32_t >( mBlock[ i * 4 ] ) << 24u ) |
+                     ( static_cast< uint32_t >( mBlock[ i * 4 + 1 ] ) << 16u ) |
+                     ( static_cast< uint32_t >( mBlock[ i * 4 + 2 ] ) << 8u ) |
+                     static_cast< uint32_t >( mBlock[ i * 4 + 3 ] );
+    }
+    for ( std::size_t i = 16; i < words.size(); ++i ) {
+        const uint32_t s0 = rotateRight( words[ i - 15 ], 7 ) ^ rotateRight( words[ i - 15 ], 18 ) ^
+                            ( words[ i - 15 ] >> 3u );
+        const uint32_t s1 = rotateRight( words[ i - 2 ], 17 ) ^ rotateRight( words[ i - 2 ], 19 ) ^
+                            ( words[ i - 2 ] >> 10u );
+        words[ i ] = words[ i - 16 ] + s0 + words[ i - 7 ] + s1;
+    }
+
+    std::array< uint32_t, 8 > state = mState;
+    for ( std::size_t i = 0; i < words.size(); ++i ) {
+        const uint32_t sum1 = rotateRight( state[ 4 ], 6 ) ^ rotateRight( state[ 4 ], 11 ) ^
+                              rotateRight( state[ 4 ], 25 );
+        const uint32_t choice = ( state[ 4 ] & state[ 5 ] ) ^ ( ~state[ 4 ] & state[ 6 ] );
+        const uint32_t temp1 = state[ 7 ] + sum1 + choice + kRoundConstants[ i ] + words[ i ];
+        const uint32_t sum0 = rotateRight( state[ 0 ], 2 ) ^ rotateRight( state[ 0 ], 13 ) ^
+                              rotateRight( state[ 0 ], 22 );
+        const uint32_t majority = ( state[ 0 ] & state[ 1 ] ) ^ ( state[ 0 ] & state[ 2 ] ) ^
+                                  ( state[ 1 ] & state[ 2 ] );
+        const uint32_t temp2 = sum0 + majority;
+        state[ 7 ] = state[ 6 ];
+        state[ 6 ] = state[ 5 ];
+        state[ 5 ] = state[ 4 ];
+        state[ 4 ] = state[ 3 ] + temp1;
+        state[ 3 ] = state[ 2 ];
+        state[ 2 ] = state[ 1 ];
+        state[ 1 ] = state[ 0 ];
+        state[ 0 ] = temp1 + temp2;
+    }
+    for ( std::size_t i = 0; i < mState.size(); ++i ) {
+        mState[ i ] += state[ i ];
+    }
+}
+
+namespace bit7z {
+
+std::string fileSha256( const fs::path& file_path ) {
+    fs::ifstream file{ file_path, std::ios::binary };
+    if ( !file.is_open() ) {
+        return {};
+    }
+    Sha256 hash;
+    std::array< char, 64 * 1024 > chunk{};
+    while ( file.read( chunk.data(), static_cast< std::streamsize >( chunk.size() ) ) || file.gcount() > 0 ) {
+        hash.update( reinterpret_cast< const byte_t* >( chunk.data() ), // NOLINT(*-pro-type-reinterpret-cast)
+                     static_cast< std::size_t >( file.gcount() ) );
+    }
+    return file.bad() ? std::string{} : hash.hexDigest();
+}
+
+bool isSha256Digest( const std::string& digest ) noexcept {
+    return digest.size() == 64 && std::all_of( digest.begin(), digest.end(), []( char character ) {
+        return ( character >= '0' && character <= '9' ) || ( character >= 'a' && character <= 'f' );
+    } );
+}
+
+}  // namespace bit7z
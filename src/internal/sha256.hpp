@@ -0,0 +1,51 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef SHA256_HPP
+#define SHA256_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "bitdefines.hpp"
+#include "bittypes.hpp"
+#include "internal/fs.hpp"
+
+namespace bit7z {
+
+// Incremental SHA-256 (FIPS 180-4) of some data.
+class Sha256 final {
+    public:
+        Sha256() noexcept;
+
+        void update( const byte_t* data, std::size_t size ) noexcept;
+
+        // The lowercase hexadecimal digest of the data; no other data can be added after calling it.
+        BIT7Z_NODISCARD std::string hexDigest() noexcept;
+
+    private:
+        std::array< uint32_t, 8 > mState;
+        std::array< uint8_t, 64 > mBlock;
+        std::size_t mBlockSize;
+        uint64_t mTotalSize;
+
+        void processBlock() noexcept;
+};
+
+// The SHA-256 of the given file, or an empty string if it could not be read.
+std::string fileSha256( const fs::path& file_path );
+
+// Whether the given string is a lowercase hexadecimal SHA-256 digest (as returned by Sha256::hexDigest).
+BIT7Z_NODISCARD bool isSha256Digest( const std::string& digest ) noexcept;
+
+}  // namespace bit7z
+
+#endif //SHA256_HPP
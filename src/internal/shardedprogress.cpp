@@ -0,0 +1,78 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "internal/shardedprogress.hpp"
+
+using namespace bit7z;
+
+ShardedProgress::ShardedProgress( const BitAbstractArchiveHandler& handler,
+                                  const std::vector< uint64_t >& shard_totals )
+    : mReporter{ handler }, mShards( shard_totals.size() ), mSum{}, mAborted{ false } {
+    for ( std::size_t shard = 0; shard < shard_totals.size(); ++shard ) {
+        mShards[ shard ].total = shard_totals[ shard ];
+        mSum.total += shard_totals[ shard ];
+    }
+    // The planned total is known before any shard starts, so it is reported upfront.
+    mReporter.reportTotal( mSum.total );
+}
+
+void ShardedProgress::reportTotal( std::size_t shard, uint64_t total ) {
+    const std::lock_guard< std::mutex > lock{ mMutex };
+    auto& state = mShards[ shard ];
+    if ( state.total == total ) {
+        return;
+    }
+    mSum.total = mSum.total - state.total + total;
+    state.total = total;
+    mReporter.reportTotal( mSum.total );
+}
+
+bool ShardedProgress::reportCompleted( std::size_t shard, uint64_t completed ) {
+    if ( isAborted() ) {
+        return false;
+    }
+
+    const std::lock_guard< std::mutex > lock{ mMutex };
+    auto& state = mShards[ shard ];
+    mSum.completed = mSum.completed - state.completed + completed;
+    state.completed = completed;
+    if ( !mReporter.reportCompleted( mSum.completed ) ) {
+        abort();
+        return false;
+    }
+    return true;
+}
+
+void ShardedProgress::reportRatio( std::size_t shard, uint64_t input_bytes, uint64_t output_bytes ) {
+    const std::lock_guard< std::mutex > lock{ mMutex };
+    auto& state = mShards[ shard ];
+    mSum.input_bytes = mSum.input_bytes - state.input_bytes + input_bytes;
+    mSum.output_bytes = mSum.output_bytes - state.output_bytes + output_bytes;
+    state.input_bytes = input_bytes;
+    state.output_bytes = output_bytes;
+    mReporter.reportRatio( mSum.input_bytes, mSum.output_bytes );
+}
+
+void ShardedProgress::reportCurrentItem( uint32_t index ) noexcept {
+    // Note: the progress tracker is made of atomics, so no locking is needed.
+    mReporter.reportCurrentItem( index );
+}
+
+void ShardedProgress::reportFile( const tstring& path ) {
+    const std::lock_guard< std::mutex > lock{ mMutex };
+    mReporter.reportFile( path );
+}
+
+void ShardedProgress::flush() {
+    const std::lock_guard< std::mutex > lock{ mMutex };
+    mReporter.flush();
+}
@@ -0,0 +1,74 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef SHARDEDPROGRESS_HPP
+#define SHARDEDPROGRESS_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "internal/progressreporter.hpp"
+
+namespace bit7z {
+
+/* Aggregates the progress of the shards of an archive that are compressed concurrently, so that the handler's
+ * callbacks see a single operation: the values reported by each shard are summed, and the callbacks are never
+ * invoked concurrently. Stopping the operation (or a failure in a shard) aborts all the shards. */
+class ShardedProgress final {
+    public:
+        ShardedProgress( const BitAbstractArchiveHandler& handler, const std::vector< uint64_t >& shard_totals );
+
+        void reportTotal( std::size_t shard, uint64_t total );
+
+        // Returns false if the operation must be stopped.
+        BIT7Z_NODISCARD bool reportCompleted( std::size_t shard, uint64_t completed );
+
+        void reportRatio( std::size_t shard, uint64_t input_bytes, uint64_t output_bytes );
+
+        void reportCurrentItem( uint32_t index ) noexcept;
+
+        BIT7Z_NODISCARD
+        inline bool hasFileCallback() const noexcept {
+            return mReporter.hasFileCallback();
+        }
+
+        void reportFile( const tstring& path );
+
+        // Delivers the progress coalesced by the reporter, once all the shards are finished.
+        void flush();
+
+        inline void abort() noexcept {
+            mAborted.store( true, std::memory_order_relaxed );
+        }
+
+        BIT7Z_NODISCARD
+        inline bool isAborted() const noexcept {
+            return mAborted.load( std::memory_order_relaxed );
+        }
+
+    private:
+        struct ShardState {
+            uint64_t total = 0;
+            uint64_t completed = 0;
+            uint64_t input_bytes = 0;
+            uint64_t output_bytes = 0;
+        };
+
+        std::mutex mMutex;
+        ProgressReporter mReporter;
+        std::vector< ShardState > mShards;
+        ShardState mSum;
+        std::atomic< bool > mAborted;
+};
+
+}  // namespace bit7z
+
+#endif // SHARDEDPROGRESS_HPP
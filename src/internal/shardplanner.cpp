@@ -0,0 +1,84 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "internal/shardplanner.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <numeric>
+#include <queue>
+#include <utility>
+
+using namespace bit7z;
+
+inline std::vector< uint32_t > indicesBySizeDescending( const std::vector< uint64_t >& sizes ) {
+    std::vector< uint32_t > indices( sizes.size() );
+    std::iota( indices.begin(), indices.end(), 0 );
+    std::stable_sort( indices.begin(), indices.end(), [ &sizes ]( uint32_t first, uint32_t second ) {
+        return sizes[ first ] > sizes[ second ];
+    } );
+    return indices;
+}
+
+inline ShardPlan finalizePlan( ShardPlan&& plan ) {
+    plan.erase( std::remove_if( plan.begin(), plan.end(), []( const std::vector< uint32_t >& shard ) {
+        return shard.empty();
+    } ), plan.end() );
+    // Keeping the items of each shard in their original order preserves the locality of the input files.
+    for ( auto& shard : plan ) {
+        std::sort( shard.begin(), shard.end() );
+    }
+    return std::move( plan );
+}
+
+ShardPlan bit7z::planShardsByCount( const std::vector< uint64_t >& sizes, uint32_t shards_count ) {
+    ShardPlan plan( std::max< uint32_t >( shards_count, 1 ) );
+
+    // Min-heap of the shards by their current total size (ties broken by the shard index).
+    using ShardLoad = std::pair< uint64_t, std::size_t >;
+    std::priority_queue< ShardLoad, std::vector< ShardLoad >, std::greater< ShardLoad > > loads;
+    for ( std::size_t shard = 0; shard < plan.size(); ++shard ) {
+        loads.emplace( 0, shard );
+    }
+
+    for ( const auto index : indicesBySizeDescending( sizes ) ) {
+        const ShardLoad lightest = loads.top();
+        loads.pop();
+        plan[ lightest.second ].push_back( index );
+        loads.emplace( lightest.first + sizes[ index ], lightest.second );
+    }
+    return finalizePlan( std::move( plan ) );
+}
+
+ShardPlan bit7z::planShardsBySize( const std::vector< uint64_t >& sizes, uint64_t max_shard_size ) {
+    ShardPlan plan;
+
+    // The shards created so far, keyed by their remaining capacity.
+    std::multimap< uint64_t, std::size_t > capacities;
+    for ( const auto index : indicesBySizeDescending( sizes ) ) {
+        const uint64_t size = sizes[ index ];
+        auto best_fit = capacities.lower_bound( size );
+        if ( best_fit == capacities.end() ) {
+            plan.emplace_back( 1, index );
+            capacities.emplace( size < max_shard_size ? max_shard_size - size : 0, plan.size() - 1 );
+            continue;
+        }
+
+        const std::size_t shard = best_fit->second;
+        const uint64_t remaining = best_fit->first - size;
+        capacities.erase( best_fit );
+        plan[ shard ].push_back( index );
+        capacities.emplace( remaining, shard ); // Full shards can still receive empty items.
+    }
+    return finalizePlan( std::move( plan ) );
+}
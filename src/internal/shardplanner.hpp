@@ -0,0 +1,32 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef SHARDPLANNER_HPP
+#define SHARDPLANNER_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace bit7z {
+
+// The indices of the items assigned to each shard; each shard's indices are in ascending order.
+using ShardPlan = std::vector< std::vector< uint32_t > >;
+
+/* Partitions the items with the given sizes into (at most) shards_count shards with balanced total sizes,
+ * assigning the largest items first to the least loaded shard. Empty shards are not part of the plan. */
+ShardPlan planShardsByCount( const std::vector< uint64_t >& sizes, uint32_t shards_count );
+
+/* Partitions the items with the given sizes into shards whose total size does not exceed max_shard_size,
+ * assigning the largest items first to the fullest shard that can contain them.
+ * Items larger than max_shard_size are assigned to a shard of their own. */
+ShardPlan planShardsBySize( const std::vector< uint64_t >& sizes, uint64_t max_shard_size );
+
+}  // namespace bit7z
+
+#endif // SHARDPLANNER_HPP
@@ -0,0 +1,219 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "internal/solidorder.hpp"
+
+#include "internal/genericinputitem.hpp"
+#include "internal/itemsampling.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+using namespace bit7z;
+
+// Only the beginning of each file is sketched, which is enough for finding the files sharing most of their content.
+constexpr std::size_t kSketchSampleSize = 64 * 1024;
+
+// A chunk ends where the top 6 bits of the gear hash are zero, i.e., the chunks are ~64 bytes long on average.
+constexpr unsigned kChunkBoundaryShift = 58;
+constexpr std::size_t kMinChunkSize = 16;
+constexpr std::size_t kMaxChunkSize = 256;
+
+// The number of next files (in size order) compared with the last chained one.
+constexpr std::size_t kSimilarityWindow = 64;
+
+// If no file in the window is at least this similar to the last chained one, the next file in size order is chosen.
+constexpr double kMinSimilarity = 0.25;
+
+constexpr uint64_t kFnvOffsetBasis = 0xCBF29CE484222325ull;
+constexpr uint64_t kFnvPrime = 0x100000001B3ull;
+constexpr uint64_t kGoldenRatio = 0x9E3779B97F4A7C15ull;
+
+// The finalizer of the SplitMix64 generator.
+inline uint64_t mix64( uint64_t value ) noexcept {
+    value ^= value >> 30u;
+    value *= 0xBF58476D1CE4E5B9ull;
+    value ^= value >> 27u;
+    value *= 0x94D049BB133111EBull;
+    return value ^ ( value >> 31u );
+}
+
+inline const std::array< uint64_t, 256 >& gearTable() {
+    static const auto table = []() {
+        std::array< uint64_t, 256 > result{};
+        for ( std::size_t value = 0; value < result.size(); ++value ) {
+            result[ value ] = mix64( kGoldenRatio * ( value + 1 ) );
+        }
+        return result;
+    }();
+    return table;
+}
+
+inline void addChunk( ContentSketch& sketch, uint64_t chunk_hash ) noexcept {
+    for ( std::size_t index = 0; index < kContentSketchSize; ++index ) {
+        sketch[ index ] = std::min( sketch[ index ], mix64( chunk_hash + ( kGoldenRatio * ( index + 1 ) ) ) );
+    }
+}
+
+ContentSketch bit7z::contentSketch( const byte_t* data, std::size_t size ) {
+    const auto& gear = gearTable();
+    ContentSketch sketch;
+    sketch.fill( ( std::numeric_limits< uint64_t >::max )() );
+
+    uint64_t rolling_hash = 0;
+    uint64_t chunk_hash = kFnvOffsetBasis;
+    std::size_t chunk_size = 0;
+    for ( std::size_t index = 0; index < size; ++index ) {
+        const auto value = static_cast< uint8_t >( data[ index ] );
+        rolling_hash = ( rolling_hash << 1u ) + gear[ value ];
+        chunk_hash = ( chunk_hash ^ value ) * kFnvPrime;
+        ++chunk_size;
+        if ( ( chunk_size >= kMinChunkSize && ( rolling_hash >> kChunkBoundaryShift ) == 0 ) ||
+             chunk_size == kMaxChunkSize ) {
+            addChunk( sketch, chunk_hash );
+            chunk_hash = kFnvOffsetBasis;
+            chunk_size = 0;
+        }
+    }
+    if ( chunk_size > 0 ) {
+        addChunk( sketch, chunk_hash );
+    }
+    return sketch;
+}
+
+double bit7z::sketchSimilarity( const ContentSketch& first, const ContentSketch& second ) noexcept {
+    std::size_t equal_values = 0;
+    for ( std::size_t index = 0; index < kContentSketchSize; ++index ) {
+        if ( first[ index ] == second[ index ] ) {
+            ++equal_values;
+        }
+    }
+    return static_cast< double >( equal_values ) / static_cast< double >( kContentSketchSize );
+}
+
+inline bool sketchItem( const GenericInputItem& item, ContentSketch& sketch ) {
+    buffer_t sample;
+    if ( !readItemSample( item, kSketchSampleSize, sample ) ) {
+        return false;
+    }
+    sketch = contentSketch( sample.data(), sample.size() );
+    return true;
+}
+
+struct SolidFile {
+    uint32_t index;
+    tstring extension;
+    uint64_t size;
+};
+
+inline tstring lowercaseExtension( const GenericInputItem& item ) {
+    tstring extension = item.inArchivePath().extension().string< tchar >();
+    for ( auto& character : extension ) {
+        if ( character >= BIT7Z_STRING( 'A' ) && character <= BIT7Z_STRING( 'Z' ) ) {
+            character = static_cast< tchar >( character - BIT7Z_STRING( 'A' ) + BIT7Z_STRING( 'a' ) );
+        }
+    }
+    return extension;
+}
+
+/* Greedily chains the given files (sorted by size): each file is followed by the most similar one among the next
+ * kSimilarityWindow files not chained yet, so that the scan is linear in the number of files. */
+inline void chainBySimilarity( const BitItemsVector& items,
+                               const SolidFile* files,
+                               std::size_t count,
+                               std::vector< uint32_t >& sequence ) {
+    std::vector< ContentSketch > sketches( count );
+    std::vector< bool > sketched( count, false );
+    for ( std::size_t file = 0; file < count; ++file ) {
+        sketched[ file ] = sketchItem( items[ files[ file ].index ], sketches[ file ] );
+    }
+
+    // The files not chained yet, as a singly linked list in size order (count is the end of the list).
+    std::vector< std::size_t > next_file( count );
+    std::iota( next_file.begin(), next_file.end(), 1 );
+    std::size_t head = 0;
+    std::size_t current = count;
+    while ( head != count ) {
+        std::size_t best = head;
+        std::size_t best_previous = count;
+        if ( current != count && sketched[ current ] ) {
+            double best_similarity = kMinSimilarity;
+            std::size_t previous = count;
+            std::size_t candidate = head;
+            for ( std::size_t scanned = 0; candidate != count && scanned < kSimilarityWindow; ++scanned ) {
+                if ( sketched[ candidate ] ) {
+                    const double similarity = sketchSimilarity( sketches[ current ], sketches[ candidate ] );
+                    if ( similarity > best_similarity ) {
+                        best = candidate;
+                        best_previous = previous;
+                        best_similarity = similarity;
+                    }
+                }
+                previous = candidate;
+                candidate = next_file[ candidate ];
+            }
+        }
+
+        if ( best_previous == count ) {
+            head = next_file[ best ];
+        } else {
+            next_file[ best_previous ] = next_file[ best ];
+        }
+        sequence.push_back( files[ best ].index );
+        current = best;
+    }
+}
+
+std::vector< uint32_t > bit7z::solidOrderRanks( const BitItemsVector& items, SolidOrder order ) {
+    std::vector< uint32_t > ranks( items.size() );
+    std::iota( ranks.begin(), ranks.end(), 0 );
+    if ( order == SolidOrder::None || items.size() < 2 ) {
+        return ranks;
+    }
+
+    std::vector< uint32_t > sequence;
+    sequence.reserve( items.size() );
+    std::vector< SolidFile > files;
+    for ( uint32_t index = 0; index < static_cast< uint32_t >( items.size() ); ++index ) {
+        const GenericInputItem& item = items[ index ];
+        if ( item.isDir() ) {
+            sequence.push_back( index );
+        } else {
+            files.push_back( SolidFile{ index, lowercaseExtension( item ), item.size() } );
+        }
+    }
+    std::stable_sort( files.begin(), files.end(), []( const SolidFile& first, const SolidFile& second ) {
+        return first.extension != second.extension ? first.extension < second.extension : first.size < second.size;
+    } );
+
+    for ( std::size_t group_begin = 0; group_begin < files.size(); ) {
+        std::size_t group_end = group_begin + 1;
+        while ( group_end < files.size() && files[ group_end ].extension == files[ group_begin ].extension ) {
+            ++group_end;
+        }
+        // Two files are adjacent in any order, so there is no need to sketch them.
+        if ( order == SolidOrder::BySimilarity && group_end - group_begin > 2 ) {
+            chainBySimilarity( items, &files[ group_begin ], group_end - group_begin, sequence );
+        } else {
+            for ( std::size_t file = group_begin; file < group_end; ++file ) {
+                sequence.push_back( files[ file ].index );
+            }
+        }
+        group_begin = group_end;
+    }
+
+    for ( uint32_t position = 0; position < static_cast< uint32_t >( sequence.size() ); ++position ) {
+        ranks[ sequence[ position ] ] = position;
+    }
+    return ranks;
+}
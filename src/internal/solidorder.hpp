@@ -0,0 +1,41 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef SOLIDORDER_HPP
+#define SOLIDORDER_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "bitabstractarchivecreator.hpp"
+#include "bititemsvector.hpp"
+
+namespace bit7z {
+
+constexpr std::size_t kContentSketchSize = 16;
+
+// A MinHash sketch of the content-defined chunks of some data; similar data have many equal values.
+using ContentSketch = std::array< uint64_t, kContentSketchSize >;
+
+BIT7Z_NODISCARD ContentSketch contentSketch( const byte_t* data, std::size_t size );
+
+// The estimated Jaccard similarity of the chunks of the sketched data, i.e., the fraction of equal values.
+BIT7Z_NODISCARD double sketchSimilarity( const ContentSketch& first, const ContentSketch& second ) noexcept;
+
+/* Returns the rank of each of the given items in the given order, i.e., the position at which the item should be
+ * passed to the compressor. Directories come first, in the order they were added, then the files grouped by
+ * extension and sorted by size; with SolidOrder::BySimilarity, the files of each group are chained so that every
+ * file is followed by the most similar among the next ones in size order. */
+std::vector< uint32_t > solidOrderRanks( const BitItemsVector& items, SolidOrder order );
+
+}  // namespace bit7z
+
+#endif // SOLIDORDER_HPP
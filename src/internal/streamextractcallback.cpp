@@ -44,9 +44,7 @@ HRESULT StreamExtractCallback::getOutStream( uint32_t index, ISequentialOutStrea
         return E_FAIL;
     }
 
-    if ( mHandler.fileCallback() ) {
-        mHandler.fileCallback()( fullPath );
-    }
+    progressReporter().reportFile( fullPath );
 
     auto outStreamLoc = bit7z::make_com< CStdOutStream, IOutStream >( mOutputStream );
     mStdOutStream = outStreamLoc;
@@ -0,0 +1,264 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "internal/tarmerge.hpp"
+
+#include "bitexception.hpp"
+#include "internal/rawcopy.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace bit7z;
+
+constexpr std::size_t kBlockSize = 512;
+
+// The maximum size of the extended headers (pax and GNU long names) that are read for knowing the item paths.
+constexpr uint64_t kMaxExtendedHeaderSize = 16 * 1024 * 1024;
+
+constexpr std::size_t kNameOffset = 0;
+constexpr std::size_t kNameSize = 100;
+constexpr std::size_t kSizeOffset = 124;
+constexpr std::size_t kSizeSize = 12;
+constexpr std::size_t kChecksumOffset = 148;
+constexpr std::size_t kChecksumSize = 8;
+constexpr std::size_t kTypeOffset = 156;
+constexpr std::size_t kMagicOffset = 257;
+constexpr std::size_t kPrefixOffset = 345;
+constexpr std::size_t kPrefixSize = 155;
+constexpr std::size_t kSparseExtendedOffset = 482; // The "isextended" flag of old GNU sparse headers.
+constexpr std::size_t kSparseBlockExtendedOffset = 504; // The "isextended" flag of the sparse extension blocks.
+
+inline BitException invalidTar( const tstring& archive_path ) {
+    return BitException( "Invalid Tar archive", std::make_error_code( std::errc::invalid_argument ), archive_path );
+}
+
+inline uint64_t paddedSize( uint64_t size ) noexcept {
+    return ( size + kBlockSize - 1 ) / kBlockSize * kBlockSize;
+}
+
+inline bool isZeroBlock( const byte_t* block ) noexcept {
+    return std::all_of( block, block + kBlockSize, []( byte_t value ) {
+        return static_cast< unsigned >( value ) == 0;
+    } );
+}
+
+inline unsigned fieldByte( const byte_t* field, std::size_t index ) noexcept {
+    return static_cast< unsigned >( field[ index ] );
+}
+
+// Numeric fields are either octal strings, or (GNU extension) big-endian binary values flagged by the highest bit.
+inline bool parseTarNumber( const byte_t* field, std::size_t size, uint64_t& value ) noexcept {
+    value = 0;
+    if ( ( fieldByte( field, 0 ) & 0x80u ) != 0 ) {
+        value = fieldByte( field, 0 ) & 0x7Fu;
+        for ( std::size_t index = 1; index < size; ++index ) {
+            value = ( value << 8u ) | fieldByte( field, index );
+        }
+        return true;
+    }
+    std::size_t index = 0;
+    while ( index < size && fieldByte( field, index ) == ' ' ) {
+        ++index;
+    }
+    for ( ; index < size; ++index ) {
+        const unsigned digit = fieldByte( field, index );
+        if ( digit == 0 || digit == ' ' ) {
+            break;
+        }
+        if ( digit < '0' || digit > '7' ) {
+            return false;
+        }
+        value = ( value << 3u ) | ( digit - '0' );
+    }
+    return true;
+}
+
+// The checksum is the sum of the bytes of the header, with the checksum field considered as filled with spaces;
+// some old archivers summed signed bytes, so both sums are accepted.
+inline bool isValidHeader( const byte_t* block ) noexcept {
+    uint64_t checksum = 0;
+    if ( !parseTarNumber( block + kChecksumOffset, kChecksumSize, checksum ) ) {
+        return false;
+    }
+    int64_t unsigned_sum = 0;
+    int64_t signed_sum = 0;
+    for ( std::size_t index = 0; index < kBlockSize; ++index ) {
+        const bool is_checksum = index >= kChecksumOffset && index < kChecksumOffset + kChecksumSize;
+        const unsigned value = is_checksum ? static_cast< unsigned >( ' ' ) : fieldByte( block, index );
+        unsigned_sum += static_cast< int64_t >( value );
+        signed_sum += static_cast< int64_t >( static_cast< signed char >( value ) );
+    }
+    return static_cast< int64_t >( checksum ) == unsigned_sum || static_cast< int64_t >( checksum ) == signed_sum;
+}
+
+inline std::string headerString( const byte_t* field, std::size_t size ) {
+    const auto* chars = reinterpret_cast< const char* >( field );
+    return std::string{ chars, static_cast< std::size_t >( std::find( chars, chars + size, '\0' ) - chars ) };
+}
+
+inline std::string headerPath( const byte_t* block ) {
+    std::string path = headerString( block + kNameOffset, kNameSize );
+    // Only POSIX ustar headers have the prefix field (GNU ones use it for other purposes).
+    if ( std::memcmp( block + kMagicOffset, "ustar\0", 6 ) == 0 && fieldByte( block, kPrefixOffset ) != 0 ) {
+        path = headerString( block + kPrefixOffset, kPrefixSize ) + '/' + path;
+    }
+    return path;
+}
+
+// Reads the "path" and "size" records of a pax extended header, formatted as "<length> <key>=<value>\n".
+inline void parsePaxRecords( const buffer_t& data, std::string& path, bool& has_size, uint64_t& size ) {
+    const std::string records{ reinterpret_cast< const char* >( data.data() ), data.size() };
+    std::size_t position = 0;
+    while ( position < records.size() ) {
+        std::size_t length = 0;
+        std::size_t index = position;
+        while ( index < records.size() && records[ index ] >= '0' && records[ index ] <= '9' ) {
+            length = length * 10 + static_cast< std::size_t >( records[ index ] - '0' );
+            ++index;
+        }
+        if ( length == 0 || index >= records.size() || records[ index ] != ' ' ||
+             position + length > records.size() ) {
+            return; // Malformed or padding: the remaining records are ignored.
+        }
+        const std::string record = records.substr( index + 1, position + length - index - 2 );
+        const std::size_t separator = record.find( '=' );
+        if ( separator != std::string::npos ) {
+            const std::string key = record.substr( 0, separator );
+            const std::string value = record.substr( separator + 1 );
+            if ( key == "path" ) {
+                path = value;
+            } else if ( key == "size" ) {
+                has_size = true;
+                size = 0;
+                for ( const char digit : value ) {
+                    if ( digit < '0' || digit > '9' ) {
+                        break;
+                    }
+                    size = size * 10 + static_cast< uint64_t >( digit - '0' );
+                }
+            }
+        }
+        position += length;
+    }
+}
+
+inline bool hasData( char type ) noexcept {
+    // Symbolic links, devices, folders and FIFOs have no data blocks, whatever their size field says.
+    return type != '2' && type != '3' && type != '4' && type != '5' && type != '6';
+}
+
+std::vector< TarEntry > bit7z::readTarEntries( std::istream& archive, const tstring& archive_path ) {
+    std::vector< TarEntry > entries;
+    byte_t block[ kBlockSize ];
+    uint64_t position = 0;
+    uint64_t entry_offset = 0;
+    bool in_entry = false;
+    std::string long_name;
+    std::string pax_path;
+    bool has_pax_size = false;
+    uint64_t pax_size = 0;
+
+    const auto seek = [ & ]( uint64_t new_position ) {
+        position = new_position;
+        if ( !archive.seekg( static_cast< std::streamoff >( position ), std::ios::beg ) ) {
+            throw invalidTar( archive_path );
+        }
+    };
+
+    archive.clear();
+    seek( 0 );
+    while ( archive.read( reinterpret_cast< char* >( block ), kBlockSize ) ) {
+        if ( isZeroBlock( block ) ) {
+            break; // End-of-archive marker.
+        }
+        uint64_t size = 0;
+        if ( !isValidHeader( block ) || !parseTarNumber( block + kSizeOffset, kSizeSize, size ) ) {
+            throw invalidTar( archive_path );
+        }
+        if ( !in_entry ) {
+            entry_offset = position;
+            in_entry = true;
+        }
+        position += kBlockSize;
+
+        const auto type = static_cast< char >( fieldByte( block, kTypeOffset ) );
+        if ( type == 'x' || type == 'L' || type == 'K' ) { // Extended headers, applying to the following item.
+            if ( size > kMaxExtendedHeaderSize ) {
+                throw invalidTar( archive_path );
+            }
+            buffer_t data( static_cast< std::size_t >( size ) );
+            readRaw( archive, data.data(), data.size(), archive_path );
+            if ( type == 'x' ) {
+                parsePaxRecords( data, pax_path, has_pax_size, pax_size );
+            } else if ( type == 'L' ) {
+                long_name = headerString( data.data(), data.size() );
+            }
+            seek( position + paddedSize( size ) );
+            continue;
+        }
+
+        TarEntry entry;
+        if ( type == 'g' ) { // Pax global header, with no path.
+            entry.keyed = false;
+        } else {
+            if ( type == 'S' && fieldByte( block, kSparseExtendedOffset ) != 0 ) {
+                do {
+                    readRaw( archive, block, kBlockSize, archive_path );
+                    position += kBlockSize;
+                } while ( fieldByte( block, kSparseBlockExtendedOffset ) != 0 );
+            }
+            const std::string path = !pax_path.empty() ? pax_path
+                                                       : ( !long_name.empty() ? long_name : headerPath( block ) );
+            entry.key = rawItemKey( path );
+            entry.is_dir = type == '5' || ( !path.empty() && path.back() == '/' );
+            if ( has_pax_size ) {
+                size = pax_size;
+            }
+        }
+        if ( hasData( type ) ) {
+            position += paddedSize( size );
+        }
+        entry.offset = entry_offset;
+        entry.size = position - entry_offset;
+        entries.push_back( std::move( entry ) );
+
+        in_entry = false;
+        long_name.clear();
+        pax_path.clear();
+        has_pax_size = false;
+        seek( position );
+    }
+    if ( in_entry ) {
+        throw invalidTar( archive_path ); // Extended headers not followed by their item.
+    }
+    return entries;
+}
+
+TarMergeWriter::TarMergeWriter( std::ostream& out ) : mOut{ out } {}
+
+void TarMergeWriter::copyEntry( std::istream& archive, const TarEntry& entry, const tstring& archive_path ) {
+    archive.clear();
+    if ( !archive.seekg( static_cast< std::streamoff >( entry.offset ), std::ios::beg ) ) {
+        throw invalidTar( archive_path );
+    }
+    copyRaw( archive, mOut, entry.size, mBuffer, archive_path );
+}
+
+void TarMergeWriter::finish() {
+    const buffer_t end_marker( 2 * kBlockSize, static_cast< byte_t >( 0 ) );
+    writeRaw( mOut, end_marker.data(), end_marker.size() );
+    mOut.flush();
+    if ( !mOut ) {
+        throw BitException( "Failed to write the output archive", std::make_error_code( std::errc::io_error ) );
+    }
+}
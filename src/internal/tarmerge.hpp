@@ -0,0 +1,53 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef TARMERGE_HPP
+#define TARMERGE_HPP
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "bittypes.hpp"
+
+namespace bit7z {
+
+/* An item of a Tar archive, i.e., the blocks of its header (preceded by any pax or GNU extended header)
+ * and of its data. Pax global headers are items on their own, without a path. */
+struct TarEntry {
+    std::string key; // The path of the item, as compared for detecting duplicates.
+    bool keyed = true;
+    bool is_dir = false;
+    uint64_t offset = 0; // The offset of the first block of the item.
+    uint64_t size = 0; // The total size of the blocks of the item.
+};
+
+// Reads the headers of the given Tar archive, up to its end-of-archive marker.
+std::vector< TarEntry > readTarEntries( std::istream& archive, const tstring& archive_path );
+
+// Writes a Tar archive by copying the blocks of the items of other Tar archives.
+class TarMergeWriter final {
+    public:
+        explicit TarMergeWriter( std::ostream& out );
+
+        void copyEntry( std::istream& archive, const TarEntry& entry, const tstring& archive_path );
+
+        // Writes the end-of-archive marker.
+        void finish();
+
+    private:
+        std::ostream& mOut;
+        buffer_t mBuffer;
+};
+
+}  // namespace bit7z
+
+#endif // TARMERGE_HPP
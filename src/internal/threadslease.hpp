@@ -0,0 +1,52 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef THREADSLEASE_HPP
+#define THREADSLEASE_HPP
+
+#include <cstdint>
+
+#include "bitthreadgovernor.hpp"
+
+namespace bit7z {
+
+/* Keeps the threads granted by the given governor (if any) to a job for the lifetime of the lease;
+ * without a governor, the lease grants no threads (i.e., 0), and the job uses the 7-zip default. */
+class ThreadsLease final {
+    public:
+        ThreadsLease( BitThreadGovernor* governor, uint32_t requested_threads )
+            : mGovernor{ governor },
+              mThreads{ governor != nullptr ? governor->acquire( requested_threads ) : 0 } {}
+
+        ThreadsLease( const ThreadsLease& ) = delete;
+
+        ThreadsLease( ThreadsLease&& ) = delete;
+
+        ThreadsLease& operator=( const ThreadsLease& ) = delete;
+
+        ThreadsLease& operator=( ThreadsLease&& ) = delete;
+
+        ~ThreadsLease() {
+            if ( mGovernor != nullptr ) {
+                mGovernor->release( mThreads );
+            }
+        }
+
+        BIT7Z_NODISCARD uint32_t threads() const noexcept {
+            return mThreads;
+        }
+
+    private:
+        BitThreadGovernor* mGovernor;
+        uint32_t mThreads;
+};
+
+}  // namespace bit7z
+
+#endif // THREADSLEASE_HPP
@@ -0,0 +1,46 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef TRACING_HPP
+#define TRACING_HPP
+
+/* Tracing support (enabled by the BIT7Z_TRACING build option):
+ *   - BIT7Z_PROBE* are USDT static tracepoints of the "bit7z" provider (e.g., usable by bpftrace, perf, or
+ *     SystemTap); they are compiled only if sys/sdt.h is available, and they are a single nop when not attached;
+ *   - BIT7Z_TRACE records an event in the BitTraceRecorder of the handler, if any, at the cost of a null check.
+ * When tracing is disabled, all the macros expand to nothing. */
+
+#ifdef BIT7Z_TRACING
+#   include "bittracerecorder.hpp"
+#   if defined( __has_include )
+#       if __has_include( <sys/sdt.h> )
+#           include <sys/sdt.h>
+#           define BIT7Z_USDT_PROBES
+#       endif
+#   endif
+#endif
+
+#ifdef BIT7Z_USDT_PROBES
+#   define BIT7Z_PROBE( name ) DTRACE_PROBE( bit7z, name )
+#   define BIT7Z_PROBE1( name, arg1 ) DTRACE_PROBE1( bit7z, name, arg1 )
+#   define BIT7Z_PROBE2( name, arg1, arg2 ) DTRACE_PROBE2( bit7z, name, arg1, arg2 )
+#else // The arguments are still "used", to avoid unused parameter warnings.
+#   define BIT7Z_PROBE( name )
+#   define BIT7Z_PROBE1( name, arg1 ) static_cast< void >( arg1 )
+#   define BIT7Z_PROBE2( name, arg1, arg2 ) static_cast< void >( arg1 ), static_cast< void >( arg2 )
+#endif
+
+#ifdef BIT7Z_TRACING
+#   define BIT7Z_TRACE( recorder, event, name, arg ) \
+        do { if ( ( recorder ) != nullptr ) { ( recorder )->event( name, arg ); } } while ( false )
+#else
+#   define BIT7Z_TRACE( recorder, event, name, arg )
+#endif
+
+#endif //TRACING_HPP
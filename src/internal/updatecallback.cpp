@@ -12,15 +12,25 @@
 
 #include "internal/updatecallback.hpp"
 
+#include "internal/ccancellableinstream.hpp"
 #include "internal/cfileoutstream.hpp"
+#include "internal/cmetricsinstream.hpp"
 #include "internal/util.hpp"
 
 using namespace bit7z;
 
-UpdateCallback::UpdateCallback( const BitOutputArchive& output )
+UpdateCallback::UpdateCallback( const BitOutputArchive& output, const UpdateShard* shard, bool store_only )
     : Callback{ output.handler() },
       mOutputArchive{ output },
-      mNeedBeClosed{ false } {}
+      mShard{ shard },
+      mNeedBeClosed{ false },
+      mProgressReporter{ mHandler },
+      mMetrics{ MetricsRecorder::create( mHandler ) },
+      mCancellation{ mHandler } {
+    if ( store_only && mMetrics != nullptr ) {
+        mMetrics->setStoreOnly();
+    }
+}
 
 UpdateCallback::~UpdateCallback() {
     Finalize();
@@ -36,53 +46,138 @@ HRESULT UpdateCallback::Finalize() noexcept {
 
 COM_DECLSPEC_NOTHROW
 STDMETHODIMP UpdateCallback::SetTotal( UInt64 size ) {
-    if ( mHandler.totalCallback() ) {
-        mHandler.totalCallback()( size );
+    if ( mShard != nullptr ) {
+        mShard->progress.reportTotal( mShard->index, size );
+        return S_OK;
     }
+    mProgressReporter.reportTotal( size );
     return S_OK;
 }
 
 COM_DECLSPEC_NOTHROW
 STDMETHODIMP UpdateCallback::SetCompleted( const UInt64* completeValue ) {
-    if ( completeValue != nullptr && mHandler.progressCallback() ) {
-        return mHandler.progressCallback()( *completeValue ) ? S_OK : E_ABORT;
+    if ( mCancellation.isCancelled() ) {
+        return E_ABORT;
     }
-    return S_OK;
+    if ( completeValue == nullptr ) {
+        return S_OK;
+    }
+    if ( mShard != nullptr ) {
+        return mShard->progress.reportCompleted( mShard->index, *completeValue ) ? S_OK : E_ABORT;
+    }
+    return mProgressReporter.reportCompleted( *completeValue ) ? S_OK : E_ABORT;
 }
 
 COM_DECLSPEC_NOTHROW
 STDMETHODIMP UpdateCallback::SetRatioInfo( const UInt64* inSize, const UInt64* outSize ) {
-    if ( inSize != nullptr && outSize != nullptr && mHandler.ratioCallback() ) {
-        mHandler.ratioCallback()( *inSize, *outSize );
+    if ( inSize == nullptr || outSize == nullptr ) {
+        return S_OK;
+    }
+    if ( mShard != nullptr ) {
+        mShard->progress.reportRatio( mShard->index, *inSize, *outSize );
+    } else {
+        mProgressReporter.reportRatio( *inSize, *outSize );
     }
     return S_OK;
 }
 
 COM_DECLSPEC_NOTHROW
 STDMETHODIMP UpdateCallback::GetProperty( UInt32 index, PROPID propID, PROPVARIANT* value ) {
+    if ( mMetrics ) {
+        mMetrics->addPropertyCall();
+    }
+
     BitPropVariant prop;
     if ( propID == kpidIsAnti ) {
-        prop = false;
+        prop = mOutputArchive.isAntiItem( outputIndex( index ) );
     } else {
-        prop = mOutputArchive.outputItemProperty( index, static_cast< BitProperty >( propID ) );
+        prop = mOutputArchive.outputItemProperty( outputIndex( index ), static_cast< BitProperty >( propID ) );
     }
     *value = prop;
     prop.bstrVal = nullptr;
     return S_OK;
 }
 
+void UpdateCallback::reportCurrentItem( uint32_t output_index ) {
+    if ( mShard != nullptr ) {
+        mShard->progress.reportCurrentItem( output_index );
+    } else {
+        mProgressReporter.reportCurrentItem( output_index );
+    }
+
+    const bool has_file_callback = mShard != nullptr ? mShard->progress.hasFileCallback()
+                                                     : mProgressReporter.hasFileCallback();
+    if ( !has_file_callback ) {
+        return;
+    }
+
+    const BitPropVariant filePath = mOutputArchive.outputItemProperty( output_index, BitProperty::Path );
+    if ( !filePath.isString() ) {
+        return;
+    }
+    if ( mShard != nullptr ) {
+        mShard->progress.reportFile( filePath.getString() );
+    } else {
+        mProgressReporter.reportFile( filePath.getString() );
+    }
+}
+
+HRESULT UpdateCallback::itemStream( UInt32 index, ISequentialInStream** inStream ) {
+    const BitAbstractArchiveCreator& creator = mOutputArchive.mArchiveCreator;
+    if ( creator.inputPrefetchCount() == 0 ) {
+        return mOutputArchive.outputItemStream( outputIndex( index ), inStream );
+    }
+
+    if ( !mPrefetcher ) {
+        // Note: the items of the output archive are known only when the compression starts.
+        const uint32_t items_count = mShard != nullptr ? static_cast< uint32_t >( mShard->items.size() )
+                                                       : mOutputArchive.itemsCount();
+        mPrefetcher = std::make_unique< ItemPrefetcher >( mOutputArchive,
+                                                          mShard != nullptr ? &mShard->items : nullptr,
+                                                          items_count,
+                                                          creator.inputPrefetchCount(),
+                                                          creator.inputPrefetchBudget() );
+    }
+    return mPrefetcher->getStream( index, inStream );
+}
+
 COM_DECLSPEC_NOTHROW
 STDMETHODIMP UpdateCallback::GetStream( UInt32 index, ISequentialInStream** inStream ) {
+    BIT7Z_PROBE1( update_get_stream, index );
+    BIT7Z_TRACE( mTraceRecorder, begin, "item", index );
     RINOK( Finalize() )
+    if ( mCancellation.isCancelled() ) {
+        return E_ABORT;
+    }
 
-    if ( mHandler.fileCallback() ) {
-        const BitPropVariant filePath = mOutputArchive.outputItemProperty( index, BitProperty::Path );
-        if ( filePath.isString() ) {
-            mHandler.fileCallback()( filePath.getString() );
-        }
+    const uint32_t output_index = outputIndex( index );
+    reportCurrentItem( output_index );
+
+    if ( !mMetrics && !mCancellation.isEnabled() ) {
+        return itemStream( index, inStream );
     }
 
-    return mOutputArchive.outputItemStream( index, inStream );
+    if ( mMetrics ) {
+        mMetrics->beginItem();
+    }
+    const HRESULT res = itemStream( index, inStream );
+    if ( res != S_OK || *inStream == nullptr ) {
+        return res;
+    }
+
+    CMyComPtr< IInStream > in_stream;
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    if ( ( *inStream )->QueryInterface( ::IID_IInStream, reinterpret_cast< void** >( &in_stream ) ) == S_OK ) {
+        if ( mMetrics ) {
+            in_stream = bit7z::make_com< CMetricsInStream, IInStream >( in_stream, &mMetrics->itemStreams() );
+        }
+        if ( mCancellation.isEnabled() ) {
+            in_stream = bit7z::make_com< CCancellableInStream, IInStream >( in_stream, &mCancellation );
+        }
+        ( *inStream )->Release();
+        *inStream = in_stream.Detach();
+    }
+    return S_OK;
 }
 
 COM_DECLSPEC_NOTHROW
@@ -114,6 +209,7 @@ STDMETHODIMP UpdateCallback::GetUpdateItemInfo( UInt32 index,
                                                 Int32* newData,
                                                 Int32* newProperties,
                                                 UInt32* indexInArchive ) noexcept {
+    index = outputIndex( index );
     if ( newData != nullptr ) {
         *newData = static_cast< Int32 >( mOutputArchive.hasNewData( index ) ); //1 = true, 0 = false;
     }
@@ -128,7 +224,12 @@ STDMETHODIMP UpdateCallback::GetUpdateItemInfo( UInt32 index,
 }
 
 COM_DECLSPEC_NOTHROW
-STDMETHODIMP UpdateCallback::SetOperationResult( Int32 /* operationResult */ ) noexcept {
+STDMETHODIMP UpdateCallback::SetOperationResult( Int32 operationResult ) noexcept {
+    BIT7Z_PROBE1( update_set_result, operationResult );
+    BIT7Z_TRACE( mTraceRecorder, end, "item", static_cast< uint64_t >( operationResult ) );
+    if ( mMetrics ) {
+        mMetrics->endItem();
+    }
     mNeedBeClosed = true;
     return S_OK;
 }
@@ -10,9 +10,17 @@
 #ifndef UPDATECALLBACK_HPP
 #define UPDATECALLBACK_HPP
 
+#include <memory>
+#include <vector>
+
 #include "bitoutputarchive.hpp"
 #include "internal/callback.hpp"
+#include "internal/itemprefetcher.hpp"
 #include "internal/macros.hpp"
+#include "internal/metricsrecorder.hpp"
+#include "internal/operationcancellation.hpp"
+#include "internal/progressreporter.hpp"
+#include "internal/shardedprogress.hpp"
 
 #include <7zip/Archive/IArchive.h>
 #include <7zip/ICoder.h>
@@ -22,12 +30,21 @@ namespace bit7z {
 
 constexpr auto kUnsupportedOperation = "Unsupported operation";
 
+// A shard of an output archive, i.e., a subset of its items compressed into a separate archive.
+struct UpdateShard {
+    std::size_t index; // The index of the shard.
+    const std::vector< uint32_t >& items; // The indices of the shard's items in the output archive.
+    ShardedProgress& progress; // The progress shared by all the shards.
+};
+
 class UpdateCallback final : public Callback,
                              public IArchiveUpdateCallback2,
                              public ICompressProgressInfo,
                              protected ICryptoGetTextPassword2 {
     public:
-        explicit UpdateCallback( const BitOutputArchive& output );
+        explicit UpdateCallback( const BitOutputArchive& output,
+                                 const UpdateShard* shard = nullptr,
+                                 bool store_only = false );
 
         UpdateCallback( const UpdateCallback& ) = delete;
 
@@ -44,6 +61,22 @@ class UpdateCallback final : public Callback,
 
         HRESULT Finalize() noexcept;
 
+        // Note: the recorder is null if the handler has no metrics callback.
+        BIT7Z_NODISCARD
+        inline MetricsRecorder* metrics() const noexcept {
+            return mMetrics.get();
+        }
+
+        BIT7Z_NODISCARD
+        inline const OperationCancellation& cancellation() const noexcept {
+            return mCancellation;
+        }
+
+        // Delivers the progress coalesced by the reporter when the operation finishes.
+        inline void flushProgress() {
+            mProgressReporter.flush();
+        }
+
         // IProgress from IArchiveUpdateCallback2
         BIT7Z_STDMETHOD( SetTotal, UInt64 size );
 
@@ -73,7 +106,22 @@ class UpdateCallback final : public Callback,
 
     private:
         const BitOutputArchive& mOutputArchive;
+        const UpdateShard* mShard;
         bool mNeedBeClosed;
+        ProgressReporter mProgressReporter;
+        std::unique_ptr< MetricsRecorder > mMetrics;
+        OperationCancellation mCancellation;
+        std::unique_ptr< ItemPrefetcher > mPrefetcher; // Created when the first stream is requested.
+
+        // Maps the indices used by 7-zip (local to the shard, if any) to the indices of the output archive.
+        BIT7Z_NODISCARD
+        inline uint32_t outputIndex( UInt32 index ) const noexcept {
+            return mShard == nullptr ? index : mShard->items[ index ];
+        }
+
+        void reportCurrentItem( uint32_t output_index );
+
+        HRESULT itemStream( UInt32 index, ISequentialInStream** inStream );
 };
 
 }  // namespace bit7z
@@ -57,6 +57,46 @@ std::string bit7z::narrow( const wchar_t* wideString, size_t size ) {
 #endif
 }
 
+/* Note: unlike narrow, the conversion is done manually, as both WideCharToMultiByte and std::wstring_convert
+ *       would need a temporary buffer. Invalid code units (e.g., unpaired surrogates) are replaced with U+FFFD. */
+void bit7z::narrowInto( const wchar_t* wideString, size_t size, std::string& result ) {
+    result.clear();
+    if ( wideString == nullptr ) {
+        return;
+    }
+    for ( size_t position = 0; position < size; ++position ) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        auto code_point = static_cast< uint32_t >( wideString[ position ] );
+        if ( code_point >= 0xD800 && code_point <= 0xDBFF && position + 1 < size ) { // UTF-16 surrogate pair.
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            const auto low_surrogate = static_cast< uint32_t >( wideString[ position + 1 ] );
+            if ( low_surrogate >= 0xDC00 && low_surrogate <= 0xDFFF ) {
+                code_point = 0x10000 + ( ( code_point - 0xD800 ) << 10 ) + ( low_surrogate - 0xDC00 );
+                ++position;
+            }
+        }
+        if ( ( code_point >= 0xD800 && code_point <= 0xDFFF ) || code_point > 0x10FFFF ) {
+            code_point = 0xFFFD;
+        }
+
+        if ( code_point < 0x80 ) {
+            result.push_back( static_cast< char >( code_point ) );
+        } else if ( code_point < 0x800 ) {
+            result.push_back( static_cast< char >( 0xC0 | ( code_point >> 6 ) ) );
+            result.push_back( static_cast< char >( 0x80 | ( code_point & 0x3F ) ) );
+        } else if ( code_point < 0x10000 ) {
+            result.push_back( static_cast< char >( 0xE0 | ( code_point >> 12 ) ) );
+            result.push_back( static_cast< char >( 0x80 | ( ( code_point >> 6 ) & 0x3F ) ) );
+            result.push_back( static_cast< char >( 0x80 | ( code_point & 0x3F ) ) );
+        } else {
+            result.push_back( static_cast< char >( 0xF0 | ( code_point >> 18 ) ) );
+            result.push_back( static_cast< char >( 0x80 | ( ( code_point >> 12 ) & 0x3F ) ) );
+            result.push_back( static_cast< char >( 0x80 | ( ( code_point >> 6 ) & 0x3F ) ) );
+            result.push_back( static_cast< char >( 0x80 | ( code_point & 0x3F ) ) );
+        }
+    }
+}
+
 std::wstring bit7z::widen( const std::string& narrowString ) {
 #ifdef WIN32
     const int wideStringSize = MultiByteToWideChar( CP_UTF8,
@@ -81,4 +121,55 @@ std::wstring bit7z::widen( const std::string& narrowString ) {
     std::wstring_convert< convert_type, wchar_t > converter;
     return converter.from_bytes( narrowString );
 #endif
-}
\ No newline at end of file
+}
+
+std::string bit7z::toUtf8( const tstring& str ) {
+#if defined( _WIN32 ) && defined( BIT7Z_USE_NATIVE_STRING )
+    return narrow( str.c_str(), str.size() );
+#else
+    return str;
+#endif
+}
+
+tstring bit7z::fromUtf8( const std::string& str ) {
+#if defined( _WIN32 ) && defined( BIT7Z_USE_NATIVE_STRING )
+    return widen( str );
+#else
+    return str;
+#endif
+}
+
+std::string bit7z::escapeLine( const std::string& str ) {
+    std::string result;
+    result.reserve( str.size() );
+    for ( const char character : str ) {
+        switch ( character ) {
+            case '\\':
+                result += "\\\\";
+                break;
+            case '\n':
+                result += "\\n";
+                break;
+            case '\r':
+                result += "\\r";
+                break;
+            default:
+                result += character;
+        }
+    }
+    return result;
+}
+
+std::string bit7z::unescapeLine( const std::string& str ) {
+    std::string result;
+    result.reserve( str.size() );
+    for ( std::size_t i = 0; i < str.size(); ++i ) {
+        if ( str[ i ] != '\\' || i + 1 == str.size() ) {
+            result += str[ i ];
+            continue;
+        }
+        const char escaped = str[ ++i ];
+        result += escaped == 'n' ? '\n' : ( escaped == 'r' ? '\r' : escaped );
+    }
+    return result;
+}
@@ -15,6 +15,8 @@
 #include <string>
 #include <type_traits>
 
+#include "bittypes.hpp"
+
 #ifndef _WIN32
 #include "internal/guiddef.hpp"
 #include "internal/windows.hpp"
@@ -35,6 +37,20 @@ std::string narrow( const wchar_t* wideString, size_t size );
 
 std::wstring widen( const std::string& narrowString );
 
+// Converts the wide string to UTF-8 into the given string, reusing its capacity (i.e., without allocating memory,
+// once the capacity is enough).
+void narrowInto( const wchar_t* wideString, size_t size, std::string& result );
+
+// Converts between tstrings and UTF-8 strings (tstrings are wide only on Windows, when using native strings).
+std::string toUtf8( const tstring& str );
+
+tstring fromUtf8( const std::string& str );
+
+// Escapes the line breaks (and the escape character itself) of the strings written one per line in text files.
+std::string escapeLine( const std::string& str );
+
+std::string unescapeLine( const std::string& str );
+
 constexpr inline bool check_overflow( int64_t position, int64_t offset ) noexcept {
     return ( offset > 0 && position > ( std::numeric_limits< int64_t >::max )() - offset ) ||
            ( offset < 0 && position < ( std::numeric_limits< int64_t >::min )() - offset );
@@ -0,0 +1,404 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "internal/zipmerge.hpp"
+
+#include "biterror.hpp"
+#include "bitexception.hpp"
+#include "internal/rawcopy.hpp"
+
+#include <algorithm>
+
+using namespace bit7z;
+
+constexpr uint32_t kLocalHeaderSignature = 0x04034B50;
+constexpr uint32_t kCentralHeaderSignature = 0x02014B50;
+constexpr uint32_t kDataDescriptorSignature = 0x08074B50;
+constexpr uint32_t kEndSignature = 0x06054B50;
+constexpr uint32_t kZip64EndSignature = 0x06064B50;
+constexpr uint32_t kZip64LocatorSignature = 0x07064B50;
+
+constexpr std::size_t kLocalHeaderSize = 30;
+constexpr std::size_t kCentralHeaderSize = 46;
+constexpr std::size_t kEndSize = 22;
+constexpr std::size_t kZip64EndSize = 56;
+constexpr std::size_t kZip64LocatorSize = 20;
+constexpr std::size_t kMaxCommentSize = 0xFFFF;
+
+constexpr uint16_t kZip64ExtraId = 0x0001;
+constexpr uint16_t kZip64Version = 45;
+constexpr uint16_t kDataDescriptorFlag = 0x0008;
+constexpr uint32_t kDosDirectoryAttribute = 0x10;
+
+constexpr uint16_t kMax16 = 0xFFFF;
+constexpr uint32_t kMax32 = 0xFFFFFFFF;
+
+inline uint16_t get16( const byte_t* data ) noexcept {
+    return static_cast< uint16_t >( static_cast< unsigned >( data[ 0 ] ) |
+                                    ( static_cast< unsigned >( data[ 1 ] ) << 8u ) );
+}
+
+inline uint32_t get32( const byte_t* data ) noexcept {
+    return static_cast< uint32_t >( get16( data ) ) | ( static_cast< uint32_t >( get16( data + 2 ) ) << 16u );
+}
+
+inline uint64_t get64( const byte_t* data ) noexcept {
+    return static_cast< uint64_t >( get32( data ) ) | ( static_cast< uint64_t >( get32( data + 4 ) ) << 32u );
+}
+
+inline void put16( buffer_t& out, uint16_t value ) {
+    out.push_back( static_cast< byte_t >( value & 0xFFu ) );
+    out.push_back( static_cast< byte_t >( ( value >> 8u ) & 0xFFu ) );
+}
+
+inline void put32( buffer_t& out, uint32_t value ) {
+    put16( out, static_cast< uint16_t >( value & 0xFFFFu ) );
+    put16( out, static_cast< uint16_t >( value >> 16u ) );
+}
+
+inline void put64( buffer_t& out, uint64_t value ) {
+    put32( out, static_cast< uint32_t >( value & 0xFFFFFFFFu ) );
+    put32( out, static_cast< uint32_t >( value >> 32u ) );
+}
+
+inline void putBytes( buffer_t& out, const buffer_t& bytes ) {
+    out.insert( out.end(), bytes.begin(), bytes.end() );
+}
+
+inline uint32_t clamp32( uint64_t value ) noexcept {
+    return value >= kMax32 ? kMax32 : static_cast< uint32_t >( value );
+}
+
+inline BitException invalidZip( const tstring& archive_path ) {
+    return BitException( "Invalid Zip archive", std::make_error_code( std::errc::invalid_argument ), archive_path );
+}
+
+inline void seekRaw( std::istream& archive, uint64_t position, const tstring& archive_path ) {
+    archive.clear();
+    if ( !archive.seekg( static_cast< std::streamoff >( position ), std::ios::beg ) ) {
+        throw invalidZip( archive_path );
+    }
+}
+
+/* Removes the Zip64 extended information field from the given extra fields; if the field is found, the values
+ * it contains replace the corresponding 0xFFFFFFFF ones, in the order given by the Zip specification. */
+inline buffer_t stripZip64Extra( const buffer_t& extra,
+                                 uint64_t* size,
+                                 uint64_t* packed_size,
+                                 uint64_t* local_header_offset ) {
+    buffer_t result;
+    result.reserve( extra.size() );
+    std::size_t position = 0;
+    while ( position + 4 <= extra.size() ) {
+        const uint16_t field_id = get16( &extra[ position ] );
+        const std::size_t field_size = get16( &extra[ position + 2 ] );
+        if ( position + 4 + field_size > extra.size() ) {
+            break; // Malformed field: the remaining bytes are kept as they are.
+        }
+        if ( field_id != kZip64ExtraId ) {
+            result.insert( result.end(), extra.begin() + static_cast< std::ptrdiff_t >( position ),
+                           extra.begin() + static_cast< std::ptrdiff_t >( position + 4 + field_size ) );
+            position += 4 + field_size;
+            continue;
+        }
+        std::size_t value_position = position + 4;
+        const std::size_t field_end = value_position + field_size;
+        for ( uint64_t* value : { size, packed_size, local_header_offset } ) {
+            if ( value != nullptr && *value == kMax32 && value_position + 8 <= field_end ) {
+                *value = get64( &extra[ value_position ] );
+                value_position += 8;
+            }
+        }
+        position = field_end;
+    }
+    result.insert( result.end(), extra.begin() + static_cast< std::ptrdiff_t >( position ), extra.end() );
+    return result;
+}
+
+inline ZipEntry readCentralHeader( std::istream& archive, uint64_t prefix_size, const tstring& archive_path ) {
+    byte_t header[ kCentralHeaderSize ];
+    readRaw( archive, header, kCentralHeaderSize, archive_path );
+    if ( get32( header ) != kCentralHeaderSignature ) {
+        throw invalidZip( archive_path );
+    }
+    if ( get16( header + 34 ) != 0 ) {
+        throw BitException( "Multi-volume Zip archives are not supported",
+                            make_error_code( BitError::FormatFeatureNotSupported ), archive_path );
+    }
+
+    ZipEntry entry;
+    entry.version_made_by = get16( header + 4 );
+    entry.version_needed = get16( header + 6 );
+    entry.flags = get16( header + 8 );
+    entry.method = get16( header + 10 );
+    entry.time = get16( header + 12 );
+    entry.date = get16( header + 14 );
+    entry.crc = get32( header + 16 );
+    entry.packed_size = get32( header + 20 );
+    entry.size = get32( header + 24 );
+    entry.internal_attributes = get16( header + 36 );
+    entry.external_attributes = get32( header + 38 );
+    entry.local_header_offset = get32( header + 42 );
+
+    entry.name.resize( get16( header + 28 ) );
+    buffer_t extra( get16( header + 30 ) );
+    entry.comment.resize( get16( header + 32 ) );
+    readRaw( archive, entry.name.data(), entry.name.size(), archive_path );
+    readRaw( archive, extra.data(), extra.size(), archive_path );
+    readRaw( archive, entry.comment.data(), entry.comment.size(), archive_path );
+    entry.extra = stripZip64Extra( extra, &entry.size, &entry.packed_size, &entry.local_header_offset );
+    entry.local_header_offset += prefix_size;
+
+    const std::string name{ reinterpret_cast< const char* >( entry.name.data() ), entry.name.size() };
+    entry.key = rawItemKey( name );
+    entry.is_dir = ( !name.empty() && name.back() == '/' ) ||
+                   ( ( entry.external_attributes & kDosDirectoryAttribute ) != 0 && entry.size == 0 );
+    return entry;
+}
+
+std::vector< ZipEntry > bit7z::readZipEntries( std::istream& archive, const tstring& archive_path ) {
+    archive.seekg( 0, std::ios::end );
+    const std::streamoff end_position = archive.tellg();
+    if ( end_position < static_cast< std::streamoff >( kEndSize ) ) {
+        throw invalidZip( archive_path );
+    }
+    const auto archive_size = static_cast< uint64_t >( end_position );
+
+    // The end of central directory record is searched backwards, as it can be followed by the archive comment.
+    const auto tail_size = static_cast< std::size_t >( std::min< uint64_t >( archive_size,
+                                                                             kEndSize + kMaxCommentSize ) );
+    buffer_t tail( tail_size );
+    seekRaw( archive, archive_size - tail_size, archive_path );
+    readRaw( archive, tail.data(), tail_size, archive_path );
+    std::size_t end_index = tail_size - kEndSize + 1;
+    while ( end_index-- > 0 ) {
+        if ( get32( &tail[ end_index ] ) == kEndSignature &&
+             end_index + kEndSize + get16( &tail[ end_index + 20 ] ) <= tail_size ) {
+            break;
+        }
+    }
+    if ( end_index == static_cast< std::size_t >( -1 ) ) {
+        throw invalidZip( archive_path );
+    }
+    const byte_t* end_record = &tail[ end_index ];
+    uint64_t end_offset = archive_size - tail_size + end_index;
+    uint32_t disk = get16( end_record + 4 );
+    uint32_t central_disk = get16( end_record + 6 );
+    uint64_t entries_count = get16( end_record + 10 );
+    uint64_t central_size = get32( end_record + 12 );
+    uint64_t central_offset = get32( end_record + 16 );
+
+    if ( ( entries_count == kMax16 || central_size == kMax32 || central_offset == kMax32 ) &&
+         end_offset >= kZip64LocatorSize + kZip64EndSize ) {
+        byte_t locator[ kZip64LocatorSize ];
+        seekRaw( archive, end_offset - kZip64LocatorSize, archive_path );
+        readRaw( archive, locator, kZip64LocatorSize, archive_path );
+        if ( get32( locator ) == kZip64LocatorSignature ) {
+            if ( get32( locator + 16 ) > 1 ) {
+                throw BitException( "Multi-volume Zip archives are not supported",
+                                    make_error_code( BitError::FormatFeatureNotSupported ), archive_path );
+            }
+            // The Zip64 end record usually precedes the locator: its recorded offset is wrong if the archive
+            // has some prefix data (e.g., a self-extracting stub).
+            byte_t zip64_end[ kZip64EndSize ];
+            const uint64_t zip64_end_offset = end_offset - kZip64LocatorSize - kZip64EndSize;
+            seekRaw( archive, zip64_end_offset, archive_path );
+            readRaw( archive, zip64_end, kZip64EndSize, archive_path );
+            if ( get32( zip64_end ) != kZip64EndSignature ) {
+                seekRaw( archive, get64( locator + 8 ), archive_path );
+                readRaw( archive, zip64_end, kZip64EndSize, archive_path );
+                if ( get32( zip64_end ) != kZip64EndSignature ) {
+                    throw invalidZip( archive_path );
+                }
+                end_offset = get64( locator + 8 );
+            } else {
+                end_offset = zip64_end_offset;
+            }
+            disk = get32( zip64_end + 16 );
+            central_disk = get32( zip64_end + 20 );
+            entries_count = get64( zip64_end + 32 );
+            central_size = get64( zip64_end + 40 );
+            central_offset = get64( zip64_end + 48 );
+        }
+    }
+    if ( disk != 0 || central_disk != 0 ) {
+        throw BitException( "Multi-volume Zip archives are not supported",
+                            make_error_code( BitError::FormatFeatureNotSupported ), archive_path );
+    }
+    if ( central_size > end_offset || end_offset - central_size < central_offset ||
+         entries_count > central_size / kCentralHeaderSize ) {
+        throw invalidZip( archive_path );
+    }
+
+    // The central directory ends where the end records begin: any difference with its recorded offset
+    // is the size of the data prepended to the archive, which shifts all the recorded offsets.
+    const uint64_t prefix_size = end_offset - central_size - central_offset;
+    seekRaw( archive, central_offset + prefix_size, archive_path );
+    std::vector< ZipEntry > entries;
+    entries.reserve( static_cast< std::size_t >( entries_count ) );
+    for ( uint64_t index = 0; index < entries_count; ++index ) {
+        entries.push_back( readCentralHeader( archive, prefix_size, archive_path ) );
+    }
+    return entries;
+}
+
+ZipMergeWriter::ZipMergeWriter( std::ostream& out ) : mOut{ out }, mOffset{ 0 }, mEntriesCount{ 0 } {}
+
+void ZipMergeWriter::copyEntry( std::istream& archive, const ZipEntry& entry, const tstring& archive_path ) {
+    byte_t source_header[ kLocalHeaderSize ];
+    seekRaw( archive, entry.local_header_offset, archive_path );
+    readRaw( archive, source_header, kLocalHeaderSize, archive_path );
+    if ( get32( source_header ) != kLocalHeaderSignature ) {
+        throw invalidZip( archive_path );
+    }
+    buffer_t source_extra( get16( source_header + 28 ) );
+    archive.seekg( get16( source_header + 26 ), std::ios::cur );
+    readRaw( archive, source_extra.data(), source_extra.size(), archive_path );
+    const buffer_t local_extra = stripZip64Extra( source_extra, nullptr, nullptr, nullptr );
+
+    // The local header of the copy has the actual sizes and CRC of the item, also when the source one used a data
+    // descriptor; the flags are kept as they are (e.g., the check of encrypted items depends on them).
+    const bool zip64_sizes = entry.size >= kMax32 || entry.packed_size >= kMax32;
+    const bool zip64_offset = mOffset >= kMax32;
+    const bool zip64 = zip64_sizes || zip64_offset;
+    const uint16_t version_needed = zip64 ? std::max( entry.version_needed, kZip64Version ) : entry.version_needed;
+    const std::size_t local_extra_size = local_extra.size() + ( zip64_sizes ? 20 : 0 );
+    if ( local_extra_size > kMax16 ) {
+        throw invalidZip( archive_path );
+    }
+
+    buffer_t local_header;
+    local_header.reserve( kLocalHeaderSize + entry.name.size() + local_extra_size );
+    put32( local_header, kLocalHeaderSignature );
+    put16( local_header, version_needed );
+    put16( local_header, entry.flags );
+    put16( local_header, entry.method );
+    put16( local_header, entry.time );
+    put16( local_header, entry.date );
+    put32( local_header, entry.crc );
+    put32( local_header, zip64_sizes ? kMax32 : static_cast< uint32_t >( entry.packed_size ) );
+    put32( local_header, zip64_sizes ? kMax32 : static_cast< uint32_t >( entry.size ) );
+    put16( local_header, static_cast< uint16_t >( entry.name.size() ) );
+    put16( local_header, static_cast< uint16_t >( local_extra_size ) );
+    putBytes( local_header, entry.name );
+    if ( zip64_sizes ) {
+        put16( local_header, kZip64ExtraId );
+        put16( local_header, 16 );
+        put64( local_header, entry.size );
+        put64( local_header, entry.packed_size );
+    }
+    putBytes( local_header, local_extra );
+    writeRaw( mOut, local_header.data(), local_header.size() );
+    copyRaw( archive, mOut, entry.packed_size, mBuffer, archive_path );
+
+    uint64_t written_size = local_header.size() + entry.packed_size;
+    if ( ( entry.flags & kDataDescriptorFlag ) != 0 ) {
+        buffer_t descriptor;
+        put32( descriptor, kDataDescriptorSignature );
+        put32( descriptor, entry.crc );
+        if ( zip64_sizes ) {
+            put64( descriptor, entry.packed_size );
+            put64( descriptor, entry.size );
+        } else {
+            put32( descriptor, static_cast< uint32_t >( entry.packed_size ) );
+            put32( descriptor, static_cast< uint32_t >( entry.size ) );
+        }
+        writeRaw( mOut, descriptor.data(), descriptor.size() );
+        written_size += descriptor.size();
+    }
+
+    buffer_t central_extra;
+    if ( entry.size >= kMax32 ) {
+        put64( central_extra, entry.size );
+    }
+    if ( entry.packed_size >= kMax32 ) {
+        put64( central_extra, entry.packed_size );
+    }
+    if ( zip64_offset ) {
+        put64( central_extra, mOffset );
+    }
+    const std::size_t central_extra_size = ( central_extra.empty() ? 0 : central_extra.size() + 4 ) +
+                                           entry.extra.size();
+    if ( central_extra_size > kMax16 ) {
+        throw invalidZip( archive_path );
+    }
+
+    auto& central = mCentralDirectory;
+    put32( central, kCentralHeaderSignature );
+    put16( central, entry.version_made_by );
+    put16( central, version_needed );
+    put16( central, entry.flags );
+    put16( central, entry.method );
+    put16( central, entry.time );
+    put16( central, entry.date );
+    put32( central, entry.crc );
+    put32( central, clamp32( entry.packed_size ) );
+    put32( central, clamp32( entry.size ) );
+    put16( central, static_cast< uint16_t >( entry.name.size() ) );
+    put16( central, static_cast< uint16_t >( central_extra_size ) );
+    put16( central, static_cast< uint16_t >( entry.comment.size() ) );
+    put16( central, 0 ); // Disk number
+    put16( central, entry.internal_attributes );
+    put32( central, entry.external_attributes );
+    put32( central, clamp32( mOffset ) );
+    putBytes( central, entry.name );
+    if ( !central_extra.empty() ) {
+        put16( central, kZip64ExtraId );
+        put16( central, static_cast< uint16_t >( central_extra.size() ) );
+        putBytes( central, central_extra );
+    }
+    putBytes( central, entry.extra );
+    putBytes( central, entry.comment );
+
+    mOffset += written_size;
+    ++mEntriesCount;
+}
+
+void ZipMergeWriter::finish() {
+    const uint64_t central_offset = mOffset;
+    const uint64_t central_size = mCentralDirectory.size();
+    writeRaw( mOut, mCentralDirectory.data(), mCentralDirectory.size() );
+
+    buffer_t end_records;
+    if ( mEntriesCount >= kMax16 || central_offset >= kMax32 || central_size >= kMax32 ) {
+        const uint64_t zip64_end_offset = central_offset + central_size;
+        put32( end_records, kZip64EndSignature );
+        put64( end_records, kZip64EndSize - 12 ); // The size of the record, excluding the signature and this field.
+        put16( end_records, kZip64Version );
+        put16( end_records, kZip64Version );
+        put32( end_records, 0 ); // Disk number
+        put32( end_records, 0 ); // Disk containing the central directory
+        put64( end_records, mEntriesCount );
+        put64( end_records, mEntriesCount );
+        put64( end_records, central_size );
+        put64( end_records, central_offset );
+
+        put32( end_records, kZip64LocatorSignature );
+        put32( end_records, 0 ); // Disk containing the Zip64 end record
+        put64( end_records, zip64_end_offset );
+        put32( end_records, 1 ); // Total number of disks
+    }
+    const auto entries_count = static_cast< uint16_t >( std::min< uint64_t >( mEntriesCount, kMax16 ) );
+    put32( end_records, kEndSignature );
+    put16( end_records, 0 ); // Disk number
+    put16( end_records, 0 ); // Disk containing the central directory
+    put16( end_records, entries_count );
+    put16( end_records, entries_count );
+    put32( end_records, clamp32( central_size ) );
+    put32( end_records, clamp32( central_offset ) );
+    put16( end_records, 0 ); // Comment size
+    writeRaw( mOut, end_records.data(), end_records.size() );
+    mOut.flush();
+    if ( !mOut ) {
+        throw BitException( "Failed to write the output archive", std::make_error_code( std::errc::io_error ) );
+    }
+}
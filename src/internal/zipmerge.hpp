@@ -0,0 +1,69 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef ZIPMERGE_HPP
+#define ZIPMERGE_HPP
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "bittypes.hpp"
+
+namespace bit7z {
+
+// An item of a Zip archive, as described by its central directory header.
+struct ZipEntry {
+    std::string key; // The path of the item, as compared for detecting duplicates.
+    bool keyed = true;
+    bool is_dir = false;
+    uint16_t version_made_by = 0;
+    uint16_t version_needed = 0;
+    uint16_t flags = 0;
+    uint16_t method = 0;
+    uint16_t time = 0;
+    uint16_t date = 0;
+    uint32_t crc = 0;
+    uint64_t packed_size = 0;
+    uint64_t size = 0;
+    uint16_t internal_attributes = 0;
+    uint32_t external_attributes = 0;
+    uint64_t local_header_offset = 0; // The actual offset within the archive file (i.e., including any prefix data).
+    buffer_t name;
+    buffer_t extra; // The extra fields, except the Zip64 one (which is rewritten as needed).
+    buffer_t comment;
+};
+
+// Reads the central directory of the given single-volume Zip archive.
+std::vector< ZipEntry > readZipEntries( std::istream& archive, const tstring& archive_path );
+
+/* Writes a Zip archive by copying the compressed data of the items of other Zip archives,
+ * rewriting their local headers and the central directory with the new offsets. */
+class ZipMergeWriter final {
+    public:
+        explicit ZipMergeWriter( std::ostream& out );
+
+        void copyEntry( std::istream& archive, const ZipEntry& entry, const tstring& archive_path );
+
+        // Writes the central directory and the end of central directory records.
+        void finish();
+
+    private:
+        std::ostream& mOut;
+        uint64_t mOffset;
+        uint64_t mEntriesCount;
+        buffer_t mCentralDirectory;
+        buffer_t mBuffer;
+};
+
+}  // namespace bit7z
+
+#endif // ZIPMERGE_HPP
@@ -11,6 +11,7 @@
 #define FILESYSTEM_HPP
 
 #include <bitfs.hpp>
+#include <bittypes.hpp>
 
 #ifndef WIN32_LEAN_AND_MEAN
 #define WIN32_LEAN_AND_MEAN
@@ -25,6 +26,11 @@
 
 #include <internal/fs.hpp>
 
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <string>
+
 namespace bit7z { // NOLINT(modernize-concat-nested-namespaces)
 namespace test {
 namespace filesystem {
@@ -45,6 +51,33 @@ inline auto exe_path() -> fs::path {
 #endif
 }
 
+inline void write_file( const fs::path& file_path, const buffer_t& content ) {
+    fs::ofstream file{ file_path, std::ios::binary | std::ios::trunc };
+    file.write( reinterpret_cast< const char* >( content.data() ), // NOLINT(*-pro-type-reinterpret-cast)
+                static_cast< std::streamsize >( content.size() ) );
+}
+
+// Pseudo-random content (always the same for a given seed), i.e., data that does not compress.
+inline auto random_content( std::size_t size, std::uint32_t seed ) -> buffer_t {
+    std::mt19937 generator{ seed };
+    std::uniform_int_distribution< int > distribution{ 0, 255 };
+    buffer_t result( size );
+    for ( auto& value : result ) {
+        value = static_cast< byte_t >( distribution( generator ) );
+    }
+    return result;
+}
+
+inline void write_text_file( const fs::path& file_path, const std::string& content ) {
+    fs::ofstream file{ file_path, std::ios::binary | std::ios::trunc };
+    file << content;
+}
+
+inline auto read_text_file( const fs::path& file_path ) -> std::string {
+    fs::ifstream file{ file_path, std::ios::binary };
+    return std::string{ std::istreambuf_iterator< char >( file ), std::istreambuf_iterator< char >() };
+}
+
 } // namespace filesystem
 } // namespace test
 } // namespace bit7z
@@ -26,6 +26,18 @@ constexpr auto regex_matching = "ON";
 constexpr auto regex_matching = "OFF";
 #endif
 
+#ifdef BIT7Z_NULL_CODEC
+constexpr auto null_codec = "ON";
+#else
+constexpr auto null_codec = "OFF";
+#endif
+
+#ifdef BIT7Z_TRACING
+constexpr auto tracing = "ON";
+#else
+constexpr auto tracing = "OFF";
+#endif
+
 #ifdef BIT7Z_USE_NATIVE_STRING
 constexpr auto native_string = "ON";
 #else
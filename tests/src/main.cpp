@@ -45,6 +45,8 @@ int main( int argc, char* argv[] ) {
     std::cout << "[Flags]" << std::endl;
     std::cout << "BIT7Z_AUTO_FORMAT: " << flags::auto_format << std::endl;
     std::cout << "BIT7Z_REGEX_MATCHING: " << flags::regex_matching << std::endl;
+    std::cout << "BIT7Z_NULL_CODEC: " << flags::null_codec << std::endl;
+    std::cout << "BIT7Z_TRACING: " << flags::tracing << std::endl;
     std::cout << "BIT7Z_USE_NATIVE_STRING: " << flags::native_string << std::endl << std::endl;
 
     return Catch::Session().run( argc, argv );
@@ -0,0 +1,141 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <bit7z/bitadmissioncontroller.hpp>
+#include <bit7z/bitexception.hpp>
+
+#ifdef BIT7Z_NULL_CODEC
+#include <bit7z/bit7zlibrary.hpp>
+#include <bit7z/bitarchivereader.hpp>
+#include <bit7z/bitnullcodec.hpp>
+#endif
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bit7z {
+namespace test {
+
+inline void wait_queued_jobs( const BitAdmissionController& controller, uint32_t queued_jobs ) {
+    while ( controller.queuedJobs() != queued_jobs ) {
+        std::this_thread::sleep_for( std::chrono::milliseconds{ 1 } );
+    }
+}
+
+TEST_CASE( "BitAdmissionController: Rejecting the jobs exceeding the budget", "[bitadmissioncontroller]" ) {
+    BitAdmissionController controller{ 100, AdmissionPolicy::Reject };
+    REQUIRE( controller.memoryBudget() == 100 );
+    REQUIRE( controller.policy() == AdmissionPolicy::Reject );
+
+    controller.acquire( 60 );
+    REQUIRE( controller.memoryInUse() == 60 );
+    REQUIRE( controller.runningJobs() == 1 );
+
+    REQUIRE_THROWS_AS( controller.acquire( 50 ), BitException );
+    controller.acquire( 40 );
+    REQUIRE( controller.memoryInUse() == 100 );
+
+    controller.release( 60 );
+    controller.release( 40 );
+    REQUIRE( controller.memoryInUse() == 0 );
+    REQUIRE( controller.runningJobs() == 0 );
+
+    // A job larger than the whole budget is never admitted.
+    REQUIRE_THROWS_AS( controller.acquire( 101 ), BitException );
+}
+
+TEST_CASE( "BitAdmissionController: Queuing the jobs exceeding the budget", "[bitadmissioncontroller]" ) {
+    BitAdmissionController controller{ 100 };
+    REQUIRE( controller.policy() == AdmissionPolicy::Queue );
+    REQUIRE_THROWS_AS( controller.acquire( 101 ), BitException );
+
+    controller.acquire( 80 );
+
+    std::vector< int > admission_order;
+    std::mutex order_mutex;
+    const auto run_job = [ & ]( int job, uint64_t memory_usage ) {
+        controller.acquire( memory_usage );
+        {
+            const std::lock_guard< std::mutex > lock{ order_mutex };
+            admission_order.push_back( job );
+        }
+        controller.release( memory_usage );
+    };
+
+    // The large job arrives first, so the small one (which would fit) waits for it.
+    std::thread large_job{ run_job, 1, 50 };
+    wait_queued_jobs( controller, 1 );
+    std::thread small_job{ run_job, 2, 10 };
+    wait_queued_jobs( controller, 2 );
+    REQUIRE( controller.runningJobs() == 1 );
+
+    controller.release( 80 );
+    large_job.join();
+    small_job.join();
+
+    REQUIRE( admission_order == std::vector< int >{ 1, 2 } );
+    REQUIRE( controller.memoryInUse() == 0 );
+    REQUIRE( controller.queuedJobs() == 0 );
+}
+
+#ifdef BIT7Z_NULL_CODEC
+
+TEST_CASE( "BitInputArchive: Admitting the extractions", "[bitadmissioncontroller]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    const buffer_t archive = makeNullArchive( 3, 100 );
+    BitArchiveReader reader{ lib, archive, BitNullFormat };
+
+    const BitMemoryEstimate estimate = reader.memoryEstimate();
+    REQUIRE( estimate.memory_usage > 0 );
+    REQUIRE( estimate.memory_budget == 0 );
+    REQUIRE( estimate.fits );
+
+    SECTION( "Within the budget" ) {
+        BitAdmissionController controller{ estimate.memory_usage };
+        reader.setAdmissionController( &controller );
+        REQUIRE( reader.memoryEstimate().memory_budget == estimate.memory_usage );
+
+        buffer_t extracted;
+        REQUIRE_NOTHROW( reader.extract( extracted, 0 ) );
+        REQUIRE_NOTHROW( reader.test() );
+        REQUIRE( controller.memoryInUse() == 0 );
+    }
+
+    SECTION( "Without enough memory for the archive" ) {
+        BitAdmissionController controller{ estimate.memory_usage - 1 };
+        reader.setAdmissionController( &controller );
+        REQUIRE_FALSE( reader.memoryEstimate().fits );
+
+        buffer_t extracted;
+        REQUIRE_THROWS_AS( reader.extract( extracted, 0 ), BitException );
+    }
+
+    SECTION( "While other jobs use the memory" ) {
+        BitAdmissionController controller{ estimate.memory_usage, AdmissionPolicy::Reject };
+        reader.setAdmissionController( &controller );
+        controller.acquire( 1 );
+
+        buffer_t extracted;
+        REQUIRE_THROWS_AS( reader.extract( extracted, 0 ), BitException );
+        controller.release( 1 );
+        REQUIRE_NOTHROW( reader.extract( extracted, 0 ) );
+    }
+}
+
+#endif
+
+} // namespace test
+} // namespace bit7z
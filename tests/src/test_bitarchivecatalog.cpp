@@ -0,0 +1,157 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <bit7z/bit7zlibrary.hpp>
+#include <bit7z/bitarchivecatalog.hpp>
+#include <bit7z/bitarchivereader.hpp>
+#include <bit7z/bitarchivewriter.hpp>
+#include <bit7z/bitexception.hpp>
+#include <bit7z/bitnullcodec.hpp>
+#include <internal/fs.hpp>
+
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "filesystem.hpp"
+
+namespace bit7z {
+namespace test {
+
+TEST_CASE( "BitArchiveCatalog: Saving and loading a catalog", "[bitarchivecatalog]" ) {
+    const fs::path catalog_file = fs::temp_directory_path() / "bit7z_test_catalog.txt";
+
+    BitCatalogItem file_item;
+    file_item.size = 42;
+    file_item.last_write_time = time_type{ std::chrono::seconds{ 1600000000 } };
+    file_item.has_crc = true;
+    file_item.crc = 0xDEADBEEF;
+
+    BitCatalogItem folder_item;
+    folder_item.is_dir = true;
+
+    BitArchiveCatalog catalog;
+    catalog.addItem( BIT7Z_STRING( "folder/file with spaces.txt" ), file_item );
+    catalog.addItem( BIT7Z_STRING( "folder" ), folder_item );
+    catalog.addItem( BIT7Z_STRING( "new\nline" ), BitCatalogItem{} );
+    REQUIRE( catalog.size() == 3 );
+    catalog.save( catalog_file.string< tchar >() );
+
+    const BitArchiveCatalog loaded = BitArchiveCatalog::load( catalog_file.string< tchar >() );
+    REQUIRE( loaded.size() == catalog.size() );
+
+    const BitCatalogItem* loaded_file = loaded.find( BIT7Z_STRING( "folder/file with spaces.txt" ) );
+    REQUIRE( loaded_file != nullptr );
+    REQUIRE_FALSE( loaded_file->is_dir );
+    REQUIRE( loaded_file->size == file_item.size );
+    REQUIRE( loaded_file->last_write_time == file_item.last_write_time );
+    REQUIRE( loaded_file->has_crc );
+    REQUIRE( loaded_file->crc == file_item.crc );
+
+    const BitCatalogItem* loaded_folder = loaded.find( BIT7Z_STRING( "folder" ) );
+    REQUIRE( loaded_folder != nullptr );
+    REQUIRE( loaded_folder->is_dir );
+    REQUIRE_FALSE( loaded_folder->has_crc );
+
+    REQUIRE( loaded.find( BIT7Z_STRING( "new\nline" ) ) != nullptr );
+    REQUIRE( loaded.find( BIT7Z_STRING( "missing" ) ) == nullptr );
+
+    {
+        fs::ofstream invalid_file{ catalog_file, std::ios::binary | std::ios::trunc };
+        invalid_file << "not a catalog\n";
+    }
+    REQUIRE_THROWS_AS( BitArchiveCatalog::load( catalog_file.string< tchar >() ), BitException );
+
+    std::error_code error;
+    fs::remove( catalog_file, error );
+}
+
+#ifdef BIT7Z_NULL_CODEC
+
+// The paths of the items of the archive, together with whether they are anti-items.
+inline std::vector< std::pair< tstring, bool > > archived_items( const Bit7zLibrary& lib, const buffer_t& archive ) {
+    const BitArchiveReader reader{ lib, archive, BitNullFormat };
+    std::vector< std::pair< tstring, bool > > result;
+    for ( const auto& item : reader ) {
+        const BitPropVariant is_anti = item.itemProperty( BitProperty::IsAnti );
+        result.emplace_back( item.path(), is_anti.isBool() && is_anti.getBool() );
+    }
+    return result;
+}
+
+TEST_CASE( "BitOutputArchive: Creating a differential archive against a baseline", "[bitarchivecatalog]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    const fs::path test_dir = fs::temp_directory_path() / "bit7z_test_differential";
+    const fs::path source_dir = test_dir / "source";
+    const fs::path output_dir = test_dir / "output";
+    std::error_code error;
+    fs::remove_all( test_dir, error );
+    fs::create_directories( source_dir );
+
+    filesystem::write_text_file( source_dir / "a.txt", "unchanged" );
+    filesystem::write_text_file( source_dir / "b.txt", "original" );
+    filesystem::write_text_file( source_dir / "c.txt", "deleted" );
+
+    buffer_t baseline_archive;
+    {
+        BitArchiveWriter writer{ lib, BitNullFormat };
+        writer.addFiles( source_dir.string< tchar >() );
+        writer.compressTo( baseline_archive );
+    }
+    const BitArchiveCatalog baseline{ BitArchiveReader{ lib, baseline_archive, BitNullFormat } };
+    REQUIRE( baseline.size() == 3 );
+
+    filesystem::write_text_file( source_dir / "b.txt", "changed content" );
+    fs::remove( source_dir / "c.txt" );
+    filesystem::write_text_file( source_dir / "d.txt", "new" );
+
+    BitArchiveWriter writer{ lib, BitNullFormat };
+    writer.setBaseline( baseline );
+    writer.addFiles( source_dir.string< tchar >() );
+
+    SECTION( "Only the changed and new items are archived, and the deleted ones become anti-items" ) {
+        buffer_t differential_archive;
+        writer.compressTo( differential_archive );
+        REQUIRE( archived_items( lib, differential_archive ) == std::vector< std::pair< tstring, bool > >{
+            { BIT7Z_STRING( "b.txt" ), false }, { BIT7Z_STRING( "d.txt" ), false }, { BIT7Z_STRING( "c.txt" ), true }
+        } );
+
+        // Extracting the differential archive over the baseline one yields the current files.
+        fs::create_directories( output_dir );
+        BitArchiveReader baseline_reader{ lib, baseline_archive, BitNullFormat };
+        baseline_reader.extract( output_dir.string< tchar >() );
+        REQUIRE( fs::exists( output_dir / "c.txt" ) );
+
+        BitArchiveReader differential_reader{ lib, differential_archive, BitNullFormat };
+        differential_reader.setOverwriteMode( OverwriteMode::Overwrite );
+        differential_reader.extract( output_dir.string< tchar >() );
+        REQUIRE( filesystem::read_text_file( output_dir / "a.txt" ) == "unchanged" );
+        REQUIRE( filesystem::read_text_file( output_dir / "b.txt" ) == "changed content" );
+        REQUIRE_FALSE( fs::exists( output_dir / "c.txt" ) );
+        REQUIRE( filesystem::read_text_file( output_dir / "d.txt" ) == "new" );
+    }
+
+    SECTION( "Differential archives cannot be compressed to shards" ) {
+        const fs::path prefix = test_dir / "shards";
+        REQUIRE_THROWS_AS( writer.compressToShards( prefix.string< tchar >(), 2 ), BitException );
+    }
+
+    fs::remove_all( test_dir, error );
+}
+
+#endif
+
+} // namespace test
+} // namespace bit7z
@@ -0,0 +1,152 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <bit7z/bit7zlibrary.hpp>
+#include <bit7z/bitarchivediff.hpp>
+#include <bit7z/bitarchivereader.hpp>
+#include <bit7z/bitarchivewriter.hpp>
+#include <bit7z/bitexception.hpp>
+#include <bit7z/bitnullcodec.hpp>
+#include <internal/fs.hpp>
+
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bit7z {
+namespace test {
+
+inline BitCatalogItem catalog_file( uint64_t size, uint32_t crc ) {
+    BitCatalogItem result;
+    result.size = size;
+    result.has_crc = true;
+    result.crc = crc;
+    return result;
+}
+
+TEST_CASE( "BitArchiveDiff: Comparing the catalogs of two archives", "[bitarchivediff]" ) {
+    BitCatalogItem folder;
+    folder.is_dir = true;
+
+    BitCatalogItem old_untracked; // No CRC: the items are compared by last write time.
+    old_untracked.size = 5;
+    old_untracked.last_write_time = time_type{ std::chrono::seconds{ 1000 } };
+    BitCatalogItem new_untracked = old_untracked;
+
+    BitArchiveCatalog old_catalog;
+    old_catalog.addItem( BIT7Z_STRING( "folder" ), folder );
+    old_catalog.addItem( BIT7Z_STRING( "folder/same.txt" ), catalog_file( 10, 0x1234 ) );
+    old_catalog.addItem( BIT7Z_STRING( "folder/crc.txt" ), catalog_file( 10, 0x1234 ) );
+    old_catalog.addItem( BIT7Z_STRING( "size.txt" ), catalog_file( 10, 0x1234 ) );
+    old_catalog.addItem( BIT7Z_STRING( "type" ), catalog_file( 0, 0 ) );
+    old_catalog.addItem( BIT7Z_STRING( "removed.txt" ), catalog_file( 1, 1 ) );
+    old_catalog.addItem( BIT7Z_STRING( "untracked.txt" ), old_untracked );
+    old_catalog.addItem( BIT7Z_STRING( "touched.txt" ), old_untracked );
+
+    BitArchiveCatalog new_catalog;
+    new_catalog.addItem( BIT7Z_STRING( "folder" ), folder );
+    new_catalog.addItem( BIT7Z_STRING( "folder/same.txt" ), catalog_file( 10, 0x1234 ) );
+    new_catalog.addItem( BIT7Z_STRING( "folder/crc.txt" ), catalog_file( 10, 0x4321 ) );
+    new_catalog.addItem( BIT7Z_STRING( "size.txt" ), catalog_file( 11, 0x1234 ) );
+    new_catalog.addItem( BIT7Z_STRING( "type" ), folder );
+    new_catalog.addItem( BIT7Z_STRING( "added.txt" ), catalog_file( 1, 1 ) );
+    new_catalog.addItem( BIT7Z_STRING( "untracked.txt" ), new_untracked );
+    new_untracked.last_write_time += std::chrono::seconds{ 1 };
+    new_catalog.addItem( BIT7Z_STRING( "touched.txt" ), new_untracked );
+
+    const BitArchiveDiff diff{ old_catalog, new_catalog };
+    REQUIRE( diff.added() == std::vector< tstring >{ BIT7Z_STRING( "added.txt" ) } );
+    REQUIRE( diff.removed() == std::vector< tstring >{ BIT7Z_STRING( "removed.txt" ) } );
+    REQUIRE( diff.changed() == std::vector< tstring >{
+        BIT7Z_STRING( "folder/crc.txt" ), BIT7Z_STRING( "size.txt" ),
+        BIT7Z_STRING( "touched.txt" ), BIT7Z_STRING( "type" )
+    } );
+    REQUIRE( diff.unchanged() == std::vector< tstring >{
+        BIT7Z_STRING( "folder" ), BIT7Z_STRING( "folder/same.txt" ), BIT7Z_STRING( "untracked.txt" )
+    } );
+    REQUIRE_FALSE( diff.identical() );
+
+    REQUIRE( BitArchiveDiff( old_catalog, old_catalog ).identical() );
+}
+
+#ifdef BIT7Z_NULL_CODEC
+
+inline buffer_t make_archive( const Bit7zLibrary& lib, const std::vector< std::pair< tstring, std::string > >& files ) {
+    BitArchiveWriter writer{ lib, BitNullFormat };
+    std::vector< buffer_t > contents;
+    contents.reserve( files.size() );
+    for ( const auto& file : files ) {
+        contents.emplace_back( file.second.begin(), file.second.end() );
+        writer.addFile( contents.back(), file.first );
+    }
+    buffer_t result;
+    writer.compressTo( result );
+    return result;
+}
+
+TEST_CASE( "BitArchiveDiff: Comparing two archives without CRCs by content", "[bitarchivediff]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    const buffer_t old_archive = make_archive( lib, {
+        { BIT7Z_STRING( "same.txt" ), "same content" },
+        { BIT7Z_STRING( "edited.txt" ), "old content" },
+        { BIT7Z_STRING( "removed.txt" ), "removed" }
+    } );
+    const buffer_t new_archive = make_archive( lib, {
+        { BIT7Z_STRING( "same.txt" ), "same content" },
+        { BIT7Z_STRING( "edited.txt" ), "new content" },
+        { BIT7Z_STRING( "added.txt" ), "added" }
+    } );
+
+    const BitArchiveReader old_reader{ lib, old_archive, BitNullFormat };
+    const BitArchiveReader new_reader{ lib, new_archive, BitNullFormat };
+    const BitArchiveDiff diff{ old_reader, new_reader };
+    REQUIRE( diff.added() == std::vector< tstring >{ BIT7Z_STRING( "added.txt" ) } );
+    REQUIRE( diff.removed() == std::vector< tstring >{ BIT7Z_STRING( "removed.txt" ) } );
+    REQUIRE( diff.changed() == std::vector< tstring >{ BIT7Z_STRING( "edited.txt" ) } );
+    REQUIRE( diff.unchanged() == std::vector< tstring >{ BIT7Z_STRING( "same.txt" ) } );
+
+    SECTION( "Comparing archives files concurrently" ) {
+        const fs::path test_dir = fs::temp_directory_path() / "bit7z_test_archivediff";
+        std::error_code error;
+        fs::remove_all( test_dir, error );
+        fs::create_directories( test_dir );
+        const auto write_archive = [ &test_dir ]( const char* name, const buffer_t& archive ) {
+            fs::ofstream file{ test_dir / name, std::ios::binary };
+            file.write( reinterpret_cast< const char* >( archive.data() ),
+                        static_cast< std::streamsize >( archive.size() ) );
+            return ( test_dir / name ).string< tchar >();
+        };
+        const tstring old_path = write_archive( "old.bin", old_archive );
+        const tstring new_path = write_archive( "new.bin", new_archive );
+
+        const auto diffs = BitArchiveDiff::compare( lib, { { old_path, new_path }, { new_path, new_path } },
+                                                    BitNullFormat );
+        REQUIRE( diffs.size() == 2 );
+        REQUIRE( diffs[ 0 ].changed() == diff.changed() );
+        REQUIRE( diffs[ 0 ].added() == diff.added() );
+        REQUIRE( diffs[ 1 ].identical() );
+
+        const tstring missing_path = ( test_dir / "missing.bin" ).string< tchar >();
+        REQUIRE_THROWS_AS( BitArchiveDiff::compare( lib, { { old_path, missing_path } }, BitNullFormat ),
+                           BitException );
+
+        fs::remove_all( test_dir, error );
+    }
+}
+
+#endif
+
+} // namespace test
+} // namespace bit7z
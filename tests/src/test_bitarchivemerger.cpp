@@ -0,0 +1,346 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <bit7z/bitarchivemerger.hpp>
+#include <bit7z/bitexception.hpp>
+#include <internal/crc32.hpp>
+#include <internal/fs.hpp>
+#include <internal/tarmerge.hpp>
+#include <internal/zipmerge.hpp>
+
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bit7z {
+namespace test {
+
+using TestItems = std::vector< std::pair< std::string, std::string > >; // Paths and contents of the items.
+
+inline void append16( std::string& out, uint32_t value ) {
+    out += static_cast< char >( value & 0xFFu );
+    out += static_cast< char >( ( value >> 8u ) & 0xFFu );
+}
+
+inline void append32( std::string& out, uint32_t value ) {
+    append16( out, value & 0xFFFFu );
+    append16( out, value >> 16u );
+}
+
+inline uint32_t content_crc( const std::string& content ) {
+    return crc32( 0, reinterpret_cast< const byte_t* >( content.data() ), content.size() );
+}
+
+// Writes a Zip archive with stored items, optionally prefixed by some data (like a self-extracting archive).
+inline void write_zip( const fs::path& path,
+                       const TestItems& items,
+                       bool data_descriptors = false,
+                       const std::string& prefix = "" ) {
+    std::string archive = prefix;
+    std::string central_directory;
+    for ( const auto& item : items ) {
+        const auto offset = static_cast< uint32_t >( archive.size() - prefix.size() );
+        const uint32_t crc = content_crc( item.second );
+        const auto size = static_cast< uint32_t >( item.second.size() );
+        const uint16_t flags = data_descriptors ? 0x0008 : 0;
+        append32( archive, 0x04034B50 );
+        append16( archive, 20 );
+        append16( archive, flags );
+        append16( archive, 0 ); // Stored
+        append32( archive, 0 ); // Time and date
+        append32( archive, data_descriptors ? 0 : crc );
+        append32( archive, data_descriptors ? 0 : size );
+        append32( archive, data_descriptors ? 0 : size );
+        append16( archive, static_cast< uint32_t >( item.first.size() ) );
+        append16( archive, 0 );
+        archive += item.first;
+        archive += item.second;
+        if ( data_descriptors ) {
+            append32( archive, 0x08074B50 );
+            append32( archive, crc );
+            append32( archive, size );
+            append32( archive, size );
+        }
+
+        append32( central_directory, 0x02014B50 );
+        append16( central_directory, 20 );
+        append16( central_directory, 20 );
+        append16( central_directory, flags );
+        append16( central_directory, 0 );
+        append32( central_directory, 0 );
+        append32( central_directory, crc );
+        append32( central_directory, size );
+        append32( central_directory, size );
+        append16( central_directory, static_cast< uint32_t >( item.first.size() ) );
+        append16( central_directory, 0 );
+        append16( central_directory, 0 );
+        append16( central_directory, 0 );
+        append16( central_directory, 0 );
+        append32( central_directory, item.first.back() == '/' ? 0x10 : 0 );
+        append32( central_directory, offset );
+        central_directory += item.first;
+    }
+    const auto central_offset = static_cast< uint32_t >( archive.size() - prefix.size() );
+    archive += central_directory;
+    append32( archive, 0x06054B50 );
+    append32( archive, 0 );
+    append16( archive, static_cast< uint32_t >( items.size() ) );
+    append16( archive, static_cast< uint32_t >( items.size() ) );
+    append32( archive, static_cast< uint32_t >( central_directory.size() ) );
+    append32( archive, central_offset );
+    append16( archive, 0 );
+
+    fs::ofstream file{ path, std::ios::binary };
+    file << archive;
+}
+
+// Reads the paths and the contents of the items of a Zip archive with stored items, checking their CRCs.
+inline TestItems read_zip( const fs::path& path ) {
+    fs::ifstream archive{ path, std::ios::binary };
+    TestItems result;
+    for ( const auto& entry : readZipEntries( archive, path.string< tchar >() ) ) {
+        REQUIRE( entry.method == 0 );
+        REQUIRE( entry.size == entry.packed_size );
+        char header[ 30 ];
+        archive.seekg( static_cast< std::streamoff >( entry.local_header_offset ) );
+        archive.read( header, sizeof( header ) );
+        const auto name_size = static_cast< unsigned char >( header[ 26 ] ) |
+                               ( static_cast< unsigned char >( header[ 27 ] ) << 8u );
+        const auto extra_size = static_cast< unsigned char >( header[ 28 ] ) |
+                                ( static_cast< unsigned char >( header[ 29 ] ) << 8u );
+        std::string name( name_size, '\0' );
+        archive.read( &name[ 0 ], name_size );
+        archive.seekg( extra_size, std::ios::cur );
+        std::string content( static_cast< std::size_t >( entry.size ), '\0' );
+        archive.read( &content[ 0 ], static_cast< std::streamsize >( content.size() ) );
+        REQUIRE( archive );
+        REQUIRE( name == std::string( entry.name.begin(), entry.name.end() ) );
+        REQUIRE( content_crc( content ) == entry.crc );
+        result.emplace_back( name, content );
+    }
+    return result;
+}
+
+inline std::string tar_header( const std::string& name, std::size_t size, char type ) {
+    std::string header( 512, '\0' );
+    header.replace( 0, name.size(), name );
+    header.replace( 100, 7, "0000644" );
+    char size_field[ 12 ];
+    std::snprintf( size_field, sizeof( size_field ), "%011o", static_cast< unsigned >( size ) );
+    header.replace( 124, 11, size_field );
+    header.replace( 136, 11, "00000000000" );
+    header.replace( 148, 8, "        " );
+    header[ 156 ] = type;
+    header.replace( 257, 8, std::string( "ustar\0" "00", 8 ) );
+    unsigned checksum = 0;
+    for ( const char character : header ) {
+        checksum += static_cast< unsigned char >( character );
+    }
+    char checksum_field[ 8 ];
+    std::snprintf( checksum_field, sizeof( checksum_field ), "%06o", checksum );
+    header.replace( 148, 7, checksum_field, 7 );
+    return header;
+}
+
+inline void append_tar_data( std::string& archive, const std::string& data ) {
+    archive += data;
+    archive.append( ( 512 - data.size() % 512 ) % 512, '\0' );
+}
+
+// Writes a Tar archive, using GNU long name headers for the paths longer than 100 characters.
+inline void write_tar( const fs::path& path, const TestItems& items ) {
+    std::string archive;
+    for ( const auto& item : items ) {
+        if ( item.first.size() > 100 ) {
+            archive += tar_header( "././@LongLink", item.first.size() + 1, 'L' );
+            append_tar_data( archive, item.first + '\0' );
+        }
+        const bool is_dir = item.first.back() == '/';
+        archive += tar_header( item.first.substr( 0, 100 ), item.second.size(), is_dir ? '5' : '0' );
+        append_tar_data( archive, item.second );
+    }
+    archive.append( 1024, '\0' );
+
+    fs::ofstream file{ path, std::ios::binary };
+    file << archive;
+}
+
+// Reads the paths (as detected by the merger) and the contents of the items of a Tar archive.
+inline TestItems read_tar( const fs::path& path ) {
+    fs::ifstream archive{ path, std::ios::binary };
+    TestItems result;
+    for ( const auto& entry : readTarEntries( archive, path.string< tchar >() ) ) {
+        std::string blocks( static_cast< std::size_t >( entry.size ), '\0' );
+        archive.seekg( static_cast< std::streamoff >( entry.offset ) );
+        archive.read( &blocks[ 0 ], static_cast< std::streamsize >( blocks.size() ) );
+        REQUIRE( archive );
+        // The blocks are an optional GNU long name header with its data, the item header, and the item data.
+        std::size_t header_offset = 0;
+        if ( blocks[ 156 ] == 'L' ) {
+            header_offset = 512 + ( std::stoul( blocks.substr( 124, 11 ), nullptr, 8 ) + 511 ) / 512 * 512;
+        }
+        const std::size_t data_size = std::stoul( blocks.substr( header_offset + 124, 11 ), nullptr, 8 );
+        const std::string data = blocks.substr( header_offset + 512, data_size );
+        result.emplace_back( entry.key, data );
+    }
+    return result;
+}
+
+struct MergeTestDir {
+    fs::path path;
+
+    MergeTestDir() : path{ fs::temp_directory_path() / "bit7z_test_merger" } {
+        fs::remove_all( path );
+        fs::create_directories( path );
+    }
+
+    MergeTestDir( const MergeTestDir& ) = delete;
+
+    MergeTestDir( MergeTestDir&& ) = delete;
+
+    MergeTestDir& operator=( const MergeTestDir& ) = delete;
+
+    MergeTestDir& operator=( MergeTestDir&& ) = delete;
+
+    ~MergeTestDir() {
+        std::error_code error;
+        fs::remove_all( path, error );
+    }
+
+    BIT7Z_NODISCARD tstring file( const char* name ) const {
+        return ( path / name ).string< tchar >();
+    }
+};
+
+TEST_CASE( "BitArchiveMerger: Only Zip and Tar archives can be merged", "[bitarchivemerger]" ) {
+    REQUIRE_NOTHROW( BitArchiveMerger{ BitFormat::Zip } );
+    REQUIRE_NOTHROW( BitArchiveMerger{ BitFormat::Tar } );
+    REQUIRE_THROWS_AS( BitArchiveMerger{ BitFormat::SevenZip }, BitException );
+
+    const BitArchiveMerger merger{ BitFormat::Zip };
+    REQUIRE( merger.format() == BitFormat::Zip );
+    REQUIRE( merger.duplicatePolicy() == DuplicatePolicy::Fail );
+    REQUIRE( merger.overwriteMode() == OverwriteMode::None );
+}
+
+TEST_CASE( "BitArchiveMerger: Merging Zip archives", "[bitarchivemerger]" ) {
+    const MergeTestDir test_dir;
+    const TestItems first_items{ { "docs/", "" }, { "docs/readme.txt", "Hello, World!" }, { "a.bin", "first" } };
+    const TestItems second_items{ { "docs/", "" }, { "docs/notes.txt", "Some notes" }, { "b.bin", "second" } };
+    write_zip( test_dir.path / "first.zip", first_items );
+    write_zip( test_dir.path / "second.zip", second_items, true, "SFX stub" );
+
+    const BitArchiveMerger merger{ BitFormat::Zip };
+    merger.merge( { test_dir.file( "first.zip" ), test_dir.file( "second.zip" ) }, test_dir.file( "merged.zip" ) );
+
+    // The folder is merged, and the items keep the order of the archives.
+    const TestItems expected{ { "docs/", "" },
+                              { "docs/readme.txt", "Hello, World!" },
+                              { "a.bin", "first" },
+                              { "docs/notes.txt", "Some notes" },
+                              { "b.bin", "second" } };
+    REQUIRE( read_zip( test_dir.path / "merged.zip" ) == expected );
+}
+
+TEST_CASE( "BitArchiveMerger: Handling duplicate items in Zip archives", "[bitarchivemerger]" ) {
+    const MergeTestDir test_dir;
+    write_zip( test_dir.path / "first.zip", { { "same.txt", "first" }, { "a.txt", "a" } } );
+    write_zip( test_dir.path / "second.zip", { { "b.txt", "b" }, { "same.txt", "second" } } );
+    const std::vector< tstring > in_archives{ test_dir.file( "first.zip" ), test_dir.file( "second.zip" ) };
+    const tstring out_archive = test_dir.file( "merged.zip" );
+
+    BitArchiveMerger merger{ BitFormat::Zip };
+    merger.setOverwriteMode( OverwriteMode::Overwrite );
+
+    SECTION( "Failing" ) {
+        REQUIRE_THROWS_AS( merger.merge( in_archives, out_archive ), BitException );
+        REQUIRE_FALSE( fs::exists( out_archive ) );
+    }
+
+    SECTION( "Keeping the first item" ) {
+        merger.setDuplicatePolicy( DuplicatePolicy::KeepFirst );
+        merger.merge( in_archives, out_archive );
+        const TestItems expected{ { "same.txt", "first" }, { "a.txt", "a" }, { "b.txt", "b" } };
+        REQUIRE( read_zip( out_archive ) == expected );
+    }
+
+    SECTION( "Keeping the last item" ) {
+        merger.setDuplicatePolicy( DuplicatePolicy::KeepLast );
+        merger.merge( in_archives, out_archive );
+        const TestItems expected{ { "a.txt", "a" }, { "b.txt", "b" }, { "same.txt", "second" } };
+        REQUIRE( read_zip( out_archive ) == expected );
+    }
+
+    SECTION( "Keeping all the items" ) {
+        merger.setDuplicatePolicy( DuplicatePolicy::KeepAll );
+        merger.merge( in_archives, out_archive );
+        const TestItems expected{
+            { "same.txt", "first" }, { "a.txt", "a" }, { "b.txt", "b" }, { "same.txt", "second" }
+        };
+        REQUIRE( read_zip( out_archive ) == expected );
+    }
+}
+
+TEST_CASE( "BitArchiveMerger: Merging Tar archives", "[bitarchivemerger]" ) {
+    const MergeTestDir test_dir;
+    const std::string long_path = "folder/" + std::string( 120, 'x' ) + ".txt";
+    write_tar( test_dir.path / "first.tar", { { "folder/", "" }, { long_path, "long" }, { "a.txt", "a" } } );
+    write_tar( test_dir.path / "second.tar", { { "./folder/", "" }, { long_path, "longer" }, { "b.txt", "b" } } );
+    const std::vector< tstring > in_archives{ test_dir.file( "first.tar" ), test_dir.file( "second.tar" ) };
+
+    BitArchiveMerger merger{ BitFormat::Tar };
+    REQUIRE_THROWS_AS( merger.merge( in_archives, test_dir.file( "merged.tar" ) ), BitException );
+
+    merger.setDuplicatePolicy( DuplicatePolicy::KeepLast );
+    merger.merge( in_archives, test_dir.file( "merged.tar" ) );
+    const TestItems expected{ { "folder", "" }, { "a.txt", "a" }, { long_path, "longer" }, { "b.txt", "b" } };
+    REQUIRE( read_tar( test_dir.path / "merged.tar" ) == expected );
+
+    // The merged archive ends with the end-of-archive marker.
+    REQUIRE( fs::file_size( test_dir.path / "merged.tar" ) % 512 == 0 );
+}
+
+TEST_CASE( "BitArchiveMerger: Writing the output archive", "[bitarchivemerger]" ) {
+    const MergeTestDir test_dir;
+    write_zip( test_dir.path / "first.zip", { { "a.txt", "a" } } );
+    write_zip( test_dir.path / "second.zip", { { "b.txt", "b" } } );
+    const std::vector< tstring > in_archives{ test_dir.file( "first.zip" ), test_dir.file( "second.zip" ) };
+
+    BitArchiveMerger merger{ BitFormat::Zip };
+    REQUIRE_THROWS_AS( merger.merge( in_archives, test_dir.file( "first.zip" ) ), BitException );
+
+    write_zip( test_dir.path / "merged.zip", { { "old.txt", "old" } } );
+    REQUIRE_THROWS_AS( merger.merge( in_archives, test_dir.file( "merged.zip" ) ), BitException );
+
+    merger.setOverwriteMode( OverwriteMode::Skip );
+    merger.merge( in_archives, test_dir.file( "merged.zip" ) );
+    REQUIRE( read_zip( test_dir.path / "merged.zip" ) == TestItems{ { "old.txt", "old" } } );
+
+    merger.setOverwriteMode( OverwriteMode::Overwrite );
+    merger.merge( in_archives, test_dir.file( "merged.zip" ) );
+    REQUIRE( read_zip( test_dir.path / "merged.zip" ) == TestItems{ { "a.txt", "a" }, { "b.txt", "b" } } );
+
+    // Invalid archives are detected before touching the output archive.
+    {
+        fs::ofstream invalid{ test_dir.path / "invalid.zip", std::ios::binary };
+        invalid << "not a zip archive";
+    }
+    REQUIRE_THROWS_AS( merger.merge( { test_dir.file( "invalid.zip" ) }, test_dir.file( "merged.zip" ) ),
+                       BitException );
+    REQUIRE( read_zip( test_dir.path / "merged.zip" ) == TestItems{ { "a.txt", "a" }, { "b.txt", "b" } } );
+}
+
+} // namespace test
+} // namespace bit7z
@@ -0,0 +1,239 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <bit7z/bitcancellationtoken.hpp>
+
+#ifdef BIT7Z_NULL_CODEC
+#include <bit7z/bit7zlibrary.hpp>
+#include <bit7z/bitarchivereader.hpp>
+#include <bit7z/bitarchivewriter.hpp>
+#include <bit7z/bitexception.hpp>
+#include <bit7z/bitnullcodec.hpp>
+#include <internal/cbufferoutstream.hpp>
+#include <internal/ccancellableoutstream.hpp>
+#include <internal/fs.hpp>
+#include <internal/util.hpp>
+#endif
+
+#include <thread>
+
+namespace bit7z {
+namespace test {
+
+using clock = BitCancellationToken::clock;
+
+TEST_CASE( "BitCancellationToken: Cancelling a token", "[bitcancellationtoken]" ) {
+    BitCancellationToken token;
+    REQUIRE( token.deadline() == clock::time_point::max() );
+    REQUIRE_FALSE( token.isCancelled() );
+
+    token.cancel();
+    REQUIRE( token.isCancelled() );
+}
+
+TEST_CASE( "BitCancellationToken: Deadline of a token", "[bitcancellationtoken]" ) {
+    const auto deadline = clock::now() + std::chrono::hours{ 1 };
+    BitCancellationToken token{ deadline };
+    REQUIRE( token.deadline() == deadline );
+    REQUIRE_FALSE( token.isCancelled() );
+
+    token.setDeadline( clock::now() + std::chrono::milliseconds{ 5 } );
+    std::this_thread::sleep_for( std::chrono::milliseconds{ 10 } );
+    REQUIRE( token.isCancelled() );
+}
+
+#ifdef BIT7Z_NULL_CODEC
+
+inline bool is_cancellation( const BitException& ex ) {
+    return ex.code() == std::errc::operation_canceled;
+}
+
+TEST_CASE( "BitCancellationToken: Cancelling the writes of an operation", "[bitcancellationtoken]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    BitArchiveWriter writer{ lib, BitNullFormat };
+    BitCancellationToken token;
+    writer.setCancellationToken( &token );
+    REQUIRE( writer.cancellationToken() == &token );
+
+    const OperationCancellation cancellation{ writer };
+    REQUIRE( cancellation.isEnabled() );
+
+    buffer_t output;
+    auto buffer_stream = bit7z::make_com< CBufferOutStream, IOutStream >( output );
+    auto stream = bit7z::make_com< CCancellableOutStream, IOutStream >( buffer_stream, cancellation );
+    const byte_t data[] = { 1, 2, 3 }; // NOLINT(*-avoid-c-arrays)
+    UInt32 processed = 0;
+    REQUIRE( stream->Write( &data, sizeof( data ), &processed ) == S_OK );
+    REQUIRE( processed == sizeof( data ) );
+
+    token.cancel(); // The next write fails, without waiting for any progress notification.
+    REQUIRE( stream->Write( &data, sizeof( data ), &processed ) == E_ABORT );
+    REQUIRE( processed == 0 );
+    REQUIRE( output.size() == sizeof( data ) );
+
+    writer.setCancellationToken( nullptr );
+    REQUIRE_FALSE( OperationCancellation{ writer }.isEnabled() );
+}
+
+TEST_CASE( "BitCancellationToken: Cancelling a compression", "[bitcancellationtoken]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    const fs::path test_dir = fs::temp_directory_path() / "bit7z_test_cancel_compression";
+    std::error_code error;
+    fs::remove_all( test_dir, error );
+    fs::create_directories( test_dir );
+
+    BitArchiveWriter writer{ lib, BitNullFormat };
+    const buffer_t content( 1024 * 1024, static_cast< byte_t >( 'a' ) );
+    writer.addFile( content, BIT7Z_STRING( "first.bin" ) );
+    writer.addFile( content, BIT7Z_STRING( "second.bin" ) );
+
+    BitCancellationToken token;
+    writer.setCancellationToken( &token );
+    writer.setProgressCallback( [ &token ]( uint64_t completed ) {
+        if ( completed > 0 ) {
+            token.cancel();
+        }
+        return true;
+    } );
+
+    SECTION( "To a file" ) {
+        const tstring out_file = ( test_dir / "archive.null" ).string< tchar >();
+        try {
+            writer.compressTo( out_file );
+            FAIL( "The compression was not cancelled" );
+        } catch ( const BitException& ex ) {
+            REQUIRE( is_cancellation( ex ) );
+        }
+        REQUIRE_FALSE( fs::exists( out_file ) );
+    }
+
+    SECTION( "To a file, overwriting it" ) {
+        const fs::path out_file = test_dir / "archive.null";
+        fs::ofstream{ out_file } << "old archive";
+        writer.setOverwriteMode( OverwriteMode::Overwrite );
+        REQUIRE_THROWS_AS( writer.compressTo( out_file.string< tchar >() ), BitException );
+        REQUIRE_FALSE( fs::exists( out_file ) );
+    }
+
+    SECTION( "To a buffer" ) {
+        buffer_t output;
+        REQUIRE_THROWS_AS( writer.compressTo( output ), BitException );
+        REQUIRE( output.empty() );
+    }
+
+    SECTION( "Aborting it from the progress callback" ) {
+        // Not a cancellation: the partial output is kept.
+        writer.setProgressCallback( []( uint64_t completed ) {
+            return completed == 0;
+        } );
+        const tstring out_file = ( test_dir / "archive.null" ).string< tchar >();
+        REQUIRE_THROWS_AS( writer.compressTo( out_file ), BitException );
+        REQUIRE( fs::exists( out_file ) );
+    }
+
+    SECTION( "With a timeout" ) {
+        writer.setCancellationToken( nullptr );
+        writer.setTimeout( std::chrono::milliseconds{ 1 } );
+        writer.setProgressCallback( []( uint64_t ) {
+            std::this_thread::sleep_for( std::chrono::milliseconds{ 5 } );
+            return true;
+        } );
+        buffer_t output;
+        try {
+            writer.compressTo( output );
+            FAIL( "The compression did not time out" );
+        } catch ( const BitException& ex ) {
+            REQUIRE( is_cancellation( ex ) );
+        }
+    }
+
+    fs::remove_all( test_dir, error );
+}
+
+TEST_CASE( "BitCancellationToken: Cancelling an extraction", "[bitcancellationtoken]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    const buffer_t archive = makeNullArchive( 2, 1024 * 1024 );
+    BitArchiveReader reader{ lib, archive, BitNullFormat };
+
+    BitCancellationToken token;
+    reader.setCancellationToken( &token );
+
+    SECTION( "Before it starts" ) {
+        token.cancel();
+        try {
+            reader.test();
+            FAIL( "The test was not cancelled" );
+        } catch ( const BitException& ex ) {
+            REQUIRE( is_cancellation( ex ) );
+        }
+    }
+
+    SECTION( "While extracting the files" ) {
+        const fs::path test_dir = fs::temp_directory_path() / "bit7z_test_cancel_extraction";
+        std::error_code error;
+        fs::remove_all( test_dir, error );
+
+        // Cancelling the extraction halfway through the second item.
+        reader.setProgressCallback( [ &token ]( uint64_t completed ) {
+            if ( completed > 1024 * 1024 + 512 * 1024 ) {
+                token.cancel();
+            }
+            return true;
+        } );
+        REQUIRE_THROWS_AS( reader.extract( test_dir.string< tchar >() ), BitException );
+
+        // The first item was completely extracted, while the partial second one is removed.
+        std::size_t files_count = 0;
+        for ( const auto& entry : fs::recursive_directory_iterator( test_dir ) ) {
+            if ( fs::is_regular_file( entry.path() ) ) {
+                REQUIRE( fs::file_size( entry.path() ) == 1024 * 1024 );
+                ++files_count;
+            }
+        }
+        REQUIRE( files_count == 1 );
+        fs::remove_all( test_dir, error );
+    }
+
+    SECTION( "Aborting it from the progress callback" ) {
+        const fs::path test_dir = fs::temp_directory_path() / "bit7z_test_abort_extraction";
+        std::error_code error;
+        fs::remove_all( test_dir, error );
+
+        // Not a cancellation: the partial second item is kept.
+        reader.setProgressCallback( []( uint64_t completed ) {
+            return completed <= 1024 * 1024 + 512 * 1024;
+        } );
+        REQUIRE_THROWS_AS( reader.extract( test_dir.string< tchar >() ), BitException );
+
+        std::size_t files_count = 0;
+        for ( const auto& entry : fs::recursive_directory_iterator( test_dir ) ) {
+            if ( fs::is_regular_file( entry.path() ) ) {
+                ++files_count;
+            }
+        }
+        REQUIRE( files_count == 2 );
+        fs::remove_all( test_dir, error );
+    }
+
+    SECTION( "With a deadline" ) {
+        token.setDeadline( clock::now() );
+        buffer_t output;
+        REQUIRE_THROWS_AS( reader.extract( output, 0 ), BitException );
+    }
+}
+
+#endif
+
+} // namespace test
+} // namespace bit7z
@@ -0,0 +1,333 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <bit7z/bit7zlibrary.hpp>
+#include <bit7z/bitarchivereader.hpp>
+#include <bit7z/bitextractioncache.hpp>
+#include <bit7z/bithashmanifest.hpp>
+#include <bit7z/bitnullcodec.hpp>
+#include <internal/fs.hpp>
+#include <internal/sha256.hpp>
+
+#include <chrono>
+#include <string>
+
+#include "filesystem.hpp"
+
+namespace bit7z {
+namespace test {
+
+inline std::string sha256( const std::string& data ) {
+    Sha256 hash;
+    hash.update( reinterpret_cast< const byte_t* >( data.data() ), data.size() ); // NOLINT(*-reinterpret-cast)
+    return hash.hexDigest();
+}
+
+TEST_CASE( "sha256: Computing the SHA-256 of some data", "[bitextractioncache][sha256]" ) {
+    REQUIRE( sha256( "" ) == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" );
+    REQUIRE( sha256( "abc" ) == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" );
+    REQUIRE( sha256( "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq" ) ==
+             "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" );
+
+    // The SHA-256 can be computed incrementally.
+    const std::string data( 1000, 'a' );
+    Sha256 hash;
+    for ( std::size_t offset = 0; offset < data.size(); offset += 100 ) {
+        hash.update( reinterpret_cast< const byte_t* >( data.data() ) + offset, 100 ); // NOLINT(*-reinterpret-cast)
+    }
+    REQUIRE( hash.hexDigest() == sha256( data ) );
+}
+
+TEST_CASE( "BitExtractionCache: Inserting and restoring files", "[bitextractioncache]" ) {
+    const fs::path test_dir = fs::temp_directory_path() / "bit7z_test_extractioncache";
+    std::error_code error;
+    fs::remove_all( test_dir, error );
+    fs::create_directories( test_dir );
+
+    BitExtractionCache cache{ ( test_dir / "store" ).string< tchar >() };
+    REQUIRE( fs::is_directory( test_dir / "store" ) );
+    cache.setCrcOnlyKeys( true );
+    REQUIRE_FALSE( cache.contains( 0x1234, 5 ) );
+    REQUIRE_FALSE( cache.restore( 0x1234, 5, ( test_dir / "missing.txt" ).string< tchar >() ) );
+    REQUIRE_FALSE( fs::exists( test_dir / "missing.txt" ) );
+    REQUIRE( cache.misses() == 1 );
+
+    filesystem::write_text_file( test_dir / "source.txt", "hello" );
+    cache.insert( 0x1234, 5, ( test_dir / "source.txt" ).string< tchar >() );
+    REQUIRE( cache.contains( 0x1234, 5 ) );
+    REQUIRE_FALSE( cache.contains( 0x1234, 6 ) );
+
+    // The cached file is independent of the inserted one.
+    fs::remove( test_dir / "source.txt" );
+    REQUIRE( cache.restore( 0x1234, 5, ( test_dir / "copy.txt" ).string< tchar >() ) );
+    REQUIRE( filesystem::read_text_file( test_dir / "copy.txt" ) == "hello" );
+    REQUIRE( cache.hits() == 1 );
+
+    cache.setHardLinks( true );
+    REQUIRE( cache.hardLinks() );
+    REQUIRE( cache.restore( 0x1234, 5, ( test_dir / "link.txt" ).string< tchar >() ) );
+    REQUIRE( filesystem::read_text_file( test_dir / "link.txt" ) == "hello" );
+    REQUIRE( cache.hits() == 2 );
+
+    fs::remove_all( test_dir, error );
+}
+
+TEST_CASE( "BitExtractionCache: Verifying the cached files", "[bitextractioncache]" ) {
+    const fs::path test_dir = fs::temp_directory_path() / "bit7z_test_extractioncache_verification";
+    std::error_code error;
+    fs::remove_all( test_dir, error );
+    fs::create_directories( test_dir );
+
+    BitExtractionCache cache{ ( test_dir / "store" ).string< tchar >() };
+    cache.setCrcOnlyKeys( true );
+    REQUIRE_FALSE( cache.hashVerification() );
+    filesystem::write_text_file( test_dir / "source.txt", "hello" );
+    cache.insert( 0x1234, 5, ( test_dir / "source.txt" ).string< tchar >() );
+    REQUIRE( filesystem::read_text_file( test_dir / "store" / "00" / "00001234-5.sha256" ) == sha256( "hello" ) );
+
+    cache.setHashVerification( true );
+    REQUIRE( cache.hashVerification() );
+    REQUIRE( cache.restore( 0x1234, 5, ( test_dir / "verified.txt" ).string< tchar >() ) );
+    REQUIRE( filesystem::read_text_file( test_dir / "verified.txt" ) == "hello" );
+
+    // E.g., the cached file was modified through a hard link.
+    filesystem::write_text_file( test_dir / "store" / "00" / "00001234-5", "HELLO" );
+    REQUIRE_FALSE( cache.restore( 0x1234, 5, ( test_dir / "modified.txt" ).string< tchar >() ) );
+    REQUIRE_FALSE( fs::exists( test_dir / "modified.txt" ) );
+    REQUIRE( cache.misses() == 1 );
+    REQUIRE_FALSE( cache.contains( 0x1234, 5 ) ); // The modified file was removed from the cache.
+
+    cache.insert( 0x1234, 5, ( test_dir / "source.txt" ).string< tchar >() );
+    REQUIRE( cache.restore( 0x1234, 5, ( test_dir / "modified.txt" ).string< tchar >() ) );
+    REQUIRE( filesystem::read_text_file( test_dir / "modified.txt" ) == "hello" );
+
+    fs::remove_all( test_dir, error );
+}
+
+TEST_CASE( "BitExtractionCache: Keying the files by their SHA-256", "[bitextractioncache]" ) {
+    const fs::path test_dir = fs::temp_directory_path() / "bit7z_test_extractioncache_keys";
+    std::error_code error;
+    fs::remove_all( test_dir, error );
+    fs::create_directories( test_dir );
+
+    BitExtractionCache cache{ ( test_dir / "store" ).string< tchar >() };
+    filesystem::write_text_file( test_dir / "source.txt", "hello" );
+    const tstring source = ( test_dir / "source.txt" ).string< tchar >();
+    const std::string hello_hash = sha256( "hello" );
+
+    // By default, the files cannot be keyed only by their CRC and size.
+    REQUIRE_FALSE( cache.crcOnlyKeys() );
+    cache.insert( 0x1234, 5, source );
+    REQUIRE_FALSE( cache.contains( 0x1234, 5 ) );
+    REQUIRE_FALSE( cache.restore( 0x1234, 5, ( test_dir / "crc.txt" ).string< tchar >() ) );
+    REQUIRE_FALSE( fs::exists( test_dir / "crc.txt" ) );
+    REQUIRE( cache.misses() == 0 ); // The refused keys are not looked up.
+
+    cache.insert( 0x1234, 5, hello_hash, source );
+    REQUIRE( cache.contains( 0x1234, 5, hello_hash ) );
+    REQUIRE( fs::is_regular_file( test_dir / "store" / "00" / ( "00001234-5-" + hello_hash ) ) );
+    REQUIRE( cache.restore( 0x1234, 5, hello_hash, ( test_dir / "strong.txt" ).string< tchar >() ) );
+    REQUIRE( filesystem::read_text_file( test_dir / "strong.txt" ) == "hello" );
+
+    // A file with the same CRC and size, but with a different content, has a different key.
+    const std::string other_hash = sha256( "HELLO" );
+    REQUIRE_FALSE( cache.contains( 0x1234, 5, other_hash ) );
+    REQUIRE_FALSE( cache.restore( 0x1234, 5, other_hash, ( test_dir / "other.txt" ).string< tchar >() ) );
+    REQUIRE_FALSE( fs::exists( test_dir / "other.txt" ) );
+
+    // Files not matching the SHA-256 of their key are not inserted.
+    cache.insert( 0x1234, 5, other_hash, source );
+    REQUIRE_FALSE( cache.contains( 0x1234, 5, other_hash ) );
+
+    // Keys whose SHA-256 is not a digest are refused.
+    cache.insert( 0x1234, 5, "../../escaped", source );
+    REQUIRE_FALSE( cache.contains( 0x1234, 5, "../../escaped" ) );
+    REQUIRE_FALSE( fs::exists( test_dir / "escaped" ) );
+
+    cache.setCrcOnlyKeys( true );
+    REQUIRE( cache.crcOnlyKeys() );
+    REQUIRE_FALSE( cache.contains( 0x1234, 5 ) ); // The file was inserted only with its SHA-256.
+    cache.insert( 0x1234, 5, source );
+    REQUIRE( cache.contains( 0x1234, 5 ) );
+
+    fs::remove_all( test_dir, error );
+}
+
+TEST_CASE( "BitHashManifest: Saving and loading the hashes of the items", "[bitextractioncache]" ) {
+    const fs::path test_dir = fs::temp_directory_path() / "bit7z_test_hashmanifest";
+    std::error_code error;
+    fs::remove_all( test_dir, error );
+    fs::create_directories( test_dir );
+
+    filesystem::write_text_file( test_dir / "hello.txt", "hello" );
+    BitHashManifest manifest;
+    manifest.addFile( BIT7Z_STRING( "folder/hello.txt" ), ( test_dir / "hello.txt" ).string< tchar >() );
+    manifest.items[ BIT7Z_STRING( "line\nbreak.txt" ) ] = sha256( "abc" );
+    REQUIRE( manifest.hashOf( BIT7Z_STRING( "folder/hello.txt" ) ) == sha256( "hello" ) );
+    REQUIRE( manifest.hashOf( BIT7Z_STRING( "missing.txt" ) ).empty() );
+    const tstring missing_file = ( test_dir / "missing.txt" ).string< tchar >();
+    REQUIRE_THROWS_AS( manifest.addFile( BIT7Z_STRING( "missing.txt" ), missing_file ), BitException );
+
+    const tstring manifest_file = ( test_dir / "archive.hashes" ).string< tchar >();
+    manifest.save( manifest_file );
+    const BitHashManifest loaded = BitHashManifest::load( manifest_file );
+    REQUIRE( loaded.items == manifest.items );
+
+    filesystem::write_text_file( test_dir / "invalid.hashes", "bit7z-hashes 1\nitem 1234 hello.txt\n" );
+    REQUIRE_THROWS_AS( BitHashManifest::load( ( test_dir / "invalid.hashes" ).string< tchar >() ), BitException );
+    REQUIRE_THROWS_AS( BitHashManifest::load( ( test_dir / "missing.hashes" ).string< tchar >() ), BitException );
+
+    fs::remove_all( test_dir, error );
+}
+
+#ifdef BIT7Z_NULL_CODEC
+
+TEST_CASE( "BitInputArchive: Extracting the items using an extraction cache", "[bitextractioncache]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    const fs::path test_dir = fs::temp_directory_path() / "bit7z_test_cachedextraction";
+    std::error_code error;
+    fs::remove_all( test_dir, error );
+
+    BitExtractionCache cache{ ( test_dir / "store" ).string< tchar >() };
+    cache.setCrcOnlyKeys( true );
+    const buffer_t archive = makeNullArchive( 3, 1000 );
+    BitArchiveReader reader{ lib, archive, BitNullFormat };
+    reader.setExtractionCache( &cache );
+    uint64_t decoded_total = 0;
+    reader.setTotalCallback( [ &decoded_total ]( uint64_t total ) {
+        decoded_total += total;
+    } );
+
+    // The first extraction decodes the items, inserting them into the cache.
+    reader.extract( ( test_dir / "first" ).string< tchar >() );
+    REQUIRE( decoded_total == 3000 );
+    REQUIRE( cache.hits() == 0 );
+    REQUIRE( cache.contains( reader.items()[ 0 ].crc(), 1000 ) );
+
+    // The second extraction restores all the items from the cache, without decoding them.
+    decoded_total = 0;
+    reader.extract( ( test_dir / "second" ).string< tchar >() );
+    REQUIRE( decoded_total == 0 );
+    REQUIRE( cache.hits() == 3 );
+    for ( const auto& item : reader ) {
+        const fs::path first_file = test_dir / "first" / item.name();
+        const fs::path second_file = test_dir / "second" / item.name();
+        REQUIRE( fs::file_size( second_file ) == 1000 );
+        REQUIRE( filesystem::read_text_file( second_file ) == filesystem::read_text_file( first_file ) );
+        REQUIRE( fs::last_write_time( second_file ) == fs::last_write_time( first_file ) );
+    }
+
+    // Only the items not in the cache are decoded.
+    fs::remove_all( test_dir / "store", error );
+    BitExtractionCache partial_cache{ ( test_dir / "store" ).string< tchar >() };
+    partial_cache.setCrcOnlyKeys( true );
+    partial_cache.insert( reader.items()[ 1 ].crc(), 1000, ( test_dir / "first" / "item1.bin" ).string< tchar >() );
+    reader.setExtractionCache( &partial_cache );
+    decoded_total = 0;
+    reader.extract( ( test_dir / "third" ).string< tchar >() );
+    REQUIRE( decoded_total == 2000 );
+    REQUIRE( partial_cache.hits() == 1 );
+    for ( const auto& item : reader ) {
+        REQUIRE( filesystem::read_text_file( test_dir / "third" / item.name() ) ==
+                 filesystem::read_text_file( test_dir / "first" / item.name() ) );
+    }
+
+    // The metadata of the items restored as hard links is not applied to the cached files.
+    fs::remove_all( test_dir / "store", error );
+    BitExtractionCache linking_cache{ ( test_dir / "store" ).string< tchar >() };
+    linking_cache.setCrcOnlyKeys( true );
+    linking_cache.setHardLinks( true );
+    reader.setExtractionCache( &linking_cache );
+    reader.extract( ( test_dir / "fourth" ).string< tchar >() );
+    const auto cached_time = fs::last_write_time( test_dir / "fourth" / "item0.bin" ) + std::chrono::hours( 1 );
+    for ( const auto& entry : fs::recursive_directory_iterator( test_dir / "store" ) ) {
+        if ( fs::is_regular_file( entry.path() ) ) {
+            fs::last_write_time( entry.path(), cached_time );
+        }
+    }
+    reader.extract( ( test_dir / "fifth" ).string< tchar >() );
+    REQUIRE( linking_cache.hits() == 3 );
+    for ( const auto& entry : fs::recursive_directory_iterator( test_dir / "store" ) ) {
+        if ( fs::is_regular_file( entry.path() ) ) {
+            REQUIRE( fs::last_write_time( entry.path() ) == cached_time );
+        }
+    }
+
+    fs::remove_all( test_dir, error );
+}
+
+TEST_CASE( "BitInputArchive: Extracting the items using an extraction cache keyed by SHA-256",
+           "[bitextractioncache]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    const fs::path test_dir = fs::temp_directory_path() / "bit7z_test_cachedextraction_sha256";
+    std::error_code error;
+    fs::remove_all( test_dir, error );
+
+    BitExtractionCache cache{ ( test_dir / "store" ).string< tchar >() };
+    const buffer_t archive = makeNullArchive( 3, 1000 );
+    BitArchiveReader reader{ lib, archive, BitNullFormat };
+    reader.setExtractionCache( &cache );
+    uint64_t decoded_total = 0;
+    reader.setTotalCallback( [ &decoded_total ]( uint64_t total ) {
+        decoded_total += total;
+    } );
+
+    // Without the SHA-256 of the items, they are not cached, as the cache refuses the CRC-only keys.
+    reader.extract( ( test_dir / "first" ).string< tchar >() );
+    reader.extract( ( test_dir / "second" ).string< tchar >() );
+    REQUIRE( decoded_total == 6000 );
+    REQUIRE( cache.hits() == 0 );
+    REQUIRE( cache.misses() == 0 );
+    REQUIRE( fs::is_empty( test_dir / "store" ) );
+
+    BitHashManifest manifest;
+    for ( const auto& item : reader ) {
+        manifest.addFile( item.path(), ( test_dir / "first" / item.name() ).string< tchar >() );
+    }
+    reader.setHashManifest( &manifest );
+    REQUIRE( reader.hashManifest() == &manifest );
+
+    decoded_total = 0;
+    reader.extract( ( test_dir / "third" ).string< tchar >() );
+    REQUIRE( decoded_total == 3000 );
+    REQUIRE( cache.contains( reader.items()[ 0 ].crc(), 1000, manifest.hashOf( reader.items()[ 0 ].path() ) ) );
+
+    decoded_total = 0;
+    reader.extract( ( test_dir / "fourth" ).string< tchar >() );
+    REQUIRE( decoded_total == 0 );
+    REQUIRE( cache.hits() == 3 );
+    for ( const auto& item : reader ) {
+        REQUIRE( filesystem::read_text_file( test_dir / "fourth" / item.name() ) ==
+                 filesystem::read_text_file( test_dir / "first" / item.name() ) );
+    }
+
+    // An item whose content does not match the manifest is extracted, but it is not inserted into the cache.
+    fs::remove_all( test_dir / "store", error );
+    BitExtractionCache other_cache{ ( test_dir / "store" ).string< tchar >() };
+    reader.setExtractionCache( &other_cache );
+    manifest.items[ reader.items()[ 1 ].path() ] = sha256( "not the content of the item" );
+    reader.extract( ( test_dir / "fifth" ).string< tchar >() );
+    REQUIRE( filesystem::read_text_file( test_dir / "fifth" / reader.items()[ 1 ].name() ) ==
+             filesystem::read_text_file( test_dir / "first" / reader.items()[ 1 ].name() ) );
+    REQUIRE( other_cache.contains( reader.items()[ 0 ].crc(), 1000, manifest.hashOf( reader.items()[ 0 ].path() ) ) );
+    REQUIRE_FALSE( other_cache.contains( reader.items()[ 1 ].crc(), 1000,
+                                         manifest.hashOf( reader.items()[ 1 ].path() ) ) );
+
+    fs::remove_all( test_dir, error );
+}
+
+#endif
+
+} // namespace test
+} // namespace bit7z
@@ -0,0 +1,159 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <bit7z/bit7zlibrary.hpp>
+#include <bit7z/bitarchivereader.hpp>
+#include <bit7z/bitexception.hpp>
+#include <bit7z/bitformat.hpp>
+#include <bit7z/bitnullcodec.hpp>
+#include <internal/cbufferinstream.hpp>
+#include <internal/cnullarchive.hpp>
+#include <internal/formatdetect.hpp>
+#include <internal/fs.hpp>
+#include <internal/util.hpp>
+
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace bit7z {
+namespace test {
+
+#ifdef BIT7Z_AUTO_FORMAT
+
+TEST_CASE( "detectFormat: Detecting the format of a missing file without throwing", "[bitinputarchive]" ) {
+    std::error_code error;
+    const BitInFormat& format = detectFormat( BIT7Z_STRING( "bit7z_missing_archive.7z" ), error );
+    REQUIRE( error );
+    REQUIRE( format == BitFormat::Auto );
+}
+
+TEST_CASE( "detectFormat: Detecting formats clears the error of a previous call", "[bitinputarchive]" ) {
+    std::error_code error = std::make_error_code( std::errc::io_error );
+
+    SECTION( "From the signature" ) {
+        buffer_t signature{ '7', 'z', 0xBC, 0xAF, 0x27, 0x1C };
+        signature.resize( 32, 0 );
+        const auto stream = bit7z::make_com< CBufferInStream, IInStream >( signature );
+        REQUIRE( detectFormatFromSig( stream, error ) == BitFormat::SevenZip );
+        REQUIRE_FALSE( error );
+    }
+
+    SECTION( "From the extension" ) {
+        REQUIRE( detectFormatFromExt( fs::path{ "archive.7z" }, error ) == BitFormat::SevenZip );
+        REQUIRE_FALSE( error );
+    }
+}
+
+#endif
+
+#ifdef BIT7Z_NULL_CODEC
+
+// Writes an archive whose second item is stored (the other ones are synthetic), returning the offset of its data.
+inline uint64_t writeStoredNullArchive( const fs::path& file_path ) {
+    buffer_t result;
+    writeNullSignature( result );
+    const uint64_t data_offset = result.size();
+    result.insert( result.end(), 100, 0x42 );
+    const uint64_t index_offset = result.size();
+    for ( uint32_t index = 0; index < 3; ++index ) {
+        NullItem item{};
+        item.offset = index == 1 ? data_offset : index;
+        item.size = 100;
+        item.flags = index == 1 ? 0 : kNullItemSynthetic;
+        item.path = "item" + std::to_string( index ) + ".bin";
+        writeNullItem( result, item );
+    }
+    writeNullFooter( result, index_offset, 3 );
+
+    fs::ofstream file{ file_path, std::ios::binary | std::ios::trunc };
+    file.write( reinterpret_cast< const char* >( result.data() ), // NOLINT(*-pro-type-reinterpret-cast)
+                static_cast< std::streamsize >( result.size() ) );
+    return data_offset;
+}
+
+TEST_CASE( "BitArchiveReader: Opening archives without throwing", "[bitinputarchive]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    std::error_code error;
+
+    SECTION( "Opening a valid archive" ) {
+        const auto reader = BitArchiveReader::tryOpen( lib, makeNullArchive( 3, 100 ), error, BitNullFormat );
+        REQUIRE_FALSE( error );
+        REQUIRE( reader != nullptr );
+        REQUIRE( reader->itemsCount() == 3 );
+    }
+
+    SECTION( "Opening an invalid buffer" ) {
+        const buffer_t garbage( 64, 0x42 );
+        const auto reader = BitArchiveReader::tryOpen( lib, garbage, error, BitNullFormat );
+        REQUIRE( error );
+        REQUIRE( reader == nullptr );
+    }
+
+    SECTION( "Opening a missing file" ) {
+        const auto reader = BitArchiveReader::tryOpen( lib, BIT7Z_STRING( "bit7z_missing_archive.null" ),
+                                                       error, BitNullFormat );
+        REQUIRE( error );
+        REQUIRE( reader == nullptr );
+    }
+}
+
+TEST_CASE( "BitInputArchive: Testing and extracting without throwing", "[bitinputarchive]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    FailedItems failed_items;
+    std::error_code error;
+
+    SECTION( "Testing a valid archive" ) {
+        const BitArchiveReader reader{ lib, makeNullArchive( 3, 100 ), BitNullFormat };
+        reader.test( failed_items, error );
+        REQUIRE_FALSE( error );
+        REQUIRE( failed_items.empty() );
+    }
+
+    SECTION( "Testing and extracting an archive with a corrupted item" ) {
+        const fs::path test_dir = fs::temp_directory_path() / "bit7z_test_failed_items";
+        fs::remove_all( test_dir, error );
+        fs::create_directories( test_dir );
+        const fs::path archive_path = test_dir / "archive.null";
+        const uint64_t data_offset = writeStoredNullArchive( archive_path );
+
+        const BitArchiveReader reader{ lib, archive_path.string< tchar >(), BitNullFormat };
+        // Truncating the data of the stored item after the archive was opened, so that it cannot be decoded.
+        fs::resize_file( archive_path, data_offset + 10 );
+        REQUIRE_THROWS_AS( reader.test(), BitException );
+
+        reader.test( failed_items, error );
+        REQUIRE( error );
+        REQUIRE( error == std::errc::io_error );
+        REQUIRE( failed_items.size() == 1 );
+        REQUIRE( failed_items[ 0 ].first == 1 );
+        REQUIRE( failed_items[ 0 ].second == error );
+
+        // The other items are extracted regardless of the failed one.
+        failed_items.clear();
+        reader.extract( ( test_dir / "out" ).string< tchar >(), { 0, 1, 2 }, failed_items, error );
+        REQUIRE( error );
+        REQUIRE( failed_items.size() == 1 );
+        REQUIRE( failed_items[ 0 ].first == 1 );
+        REQUIRE( fs::file_size( test_dir / "out" / "item0.bin" ) == 100 );
+        REQUIRE( fs::file_size( test_dir / "out" / "item2.bin" ) == 100 );
+
+        fs::remove_all( test_dir, error );
+    }
+}
+
+#endif
+
+} // namespace test
+} // namespace bit7z
@@ -0,0 +1,93 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <bit7z/bit7zlibrary.hpp>
+#include <bit7z/bitarchivereader.hpp>
+#include <bit7z/bititemview.hpp>
+#include <bit7z/bitnullcodec.hpp>
+#include <internal/util.hpp>
+
+#include <string>
+#include <vector>
+
+namespace bit7z {
+namespace test {
+
+TEST_CASE( "util: Converting wide strings to UTF-8 into a reused buffer", "[bititemview]" ) {
+    std::string buffer;
+    for ( const std::wstring& wide_string : { std::wstring{ L"ascii.txt" },
+                                              std::wstring{ L"èàò.txt" },
+                                              std::wstring{ L"テスト" },
+                                              std::wstring{ L"\U0001F600" },
+                                              std::wstring{} } ) {
+        narrowInto( wide_string.c_str(), wide_string.size(), buffer );
+        REQUIRE( buffer == narrow( wide_string.c_str(), wide_string.size() ) );
+    }
+
+    // The capacity of the buffer is reused for the shorter strings.
+    const std::wstring long_string( 100, L'x' );
+    narrowInto( long_string.c_str(), long_string.size(), buffer );
+    const auto* buffer_data = buffer.data();
+    narrowInto( L"short", 5, buffer );
+    REQUIRE( buffer == "short" );
+    REQUIRE( buffer.data() == buffer_data );
+}
+
+#ifdef BIT7Z_NULL_CODEC
+
+TEST_CASE( "BitInputArchive: Visiting the metadata of the items", "[bititemview]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+
+    SECTION( "Visiting all the fields" ) {
+        const BitArchiveReader reader{ lib, makeNullArchive( 10, 100 ), BitNullFormat };
+        const auto items = reader.items();
+        uint32_t visited_items = 0;
+        reader.visitItems( BitItemField::All, [ & ]( const BitItemView& item ) {
+            REQUIRE( item.index == visited_items );
+            const auto& expected = items[ item.index ];
+            REQUIRE( item.path != nullptr );
+            REQUIRE( tstring( item.path, item.path_size ) == expected.path() );
+#if BIT7Z_CPP_STANDARD >= 17
+            REQUIRE( item.pathView() == expected.path() );
+#endif
+            REQUIRE( item.is_dir == expected.isDir() );
+            REQUIRE( item.size == expected.size() );
+            REQUIRE( item.pack_size == expected.packSize() );
+            REQUIRE( item.has_crc );
+            REQUIRE( item.crc == expected.crc() );
+            REQUIRE( item.attributes == expected.attributes() );
+            REQUIRE( item.last_write_time == expected.lastWriteTime() );
+            REQUIRE_FALSE( item.is_encrypted );
+            ++visited_items;
+        } );
+        REQUIRE( visited_items == 10 );
+    }
+
+    SECTION( "Visiting only the requested fields" ) {
+        const BitArchiveReader reader{ lib, makeNullArchive( 3, 100 ), BitNullFormat };
+        std::vector< uint64_t > sizes;
+        reader.visitItems( BitItemField::Size | BitItemField::IsDir, [ &sizes ]( const BitItemView& item ) {
+            REQUIRE( item.path == nullptr );
+            REQUIRE_FALSE( item.has_crc );
+            REQUIRE_FALSE( item.is_dir );
+            sizes.push_back( item.size );
+        } );
+        REQUIRE( sizes == std::vector< uint64_t >{ 100, 100, 100 } );
+    }
+}
+
+#endif
+
+} // namespace test
+} // namespace bit7z
@@ -0,0 +1,190 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <bit7z/bitmetrics.hpp>
+
+#ifdef BIT7Z_NULL_CODEC
+#include <bit7z/bit7zlibrary.hpp>
+#include <bit7z/bitarchivereader.hpp>
+#include <bit7z/bitarchivewriter.hpp>
+#include <bit7z/bitnullcodec.hpp>
+#endif
+
+#include <limits>
+#include <vector>
+
+namespace bit7z {
+namespace test {
+
+TEST_CASE( "BitLatencyHistogram: Recording latencies", "[bitmetrics]" ) {
+    BitLatencyHistogram histogram;
+    REQUIRE( histogram.count() == 0 );
+    REQUIRE( histogram.sum() == 0 );
+    REQUIRE( histogram.max() == 0 );
+
+    histogram.record( 0 );
+    histogram.record( 1000 ); // Upper bound of the first bucket (1us).
+    histogram.record( 1001 );
+    histogram.record( 16000 );
+    histogram.record( std::numeric_limits< uint64_t >::max() / 2 );
+
+    REQUIRE( histogram.count() == 5 );
+    REQUIRE( histogram.max() == std::numeric_limits< uint64_t >::max() / 2 );
+    REQUIRE( histogram.bucketCount( 0 ) == 2 );
+    REQUIRE( histogram.bucketCount( 1 ) == 1 );
+    REQUIRE( histogram.bucketCount( 2 ) == 1 );
+    REQUIRE( histogram.bucketCount( BitLatencyHistogram::kBucketsCount - 1 ) == 1 );
+    REQUIRE( histogram.bucketCount( BitLatencyHistogram::kBucketsCount ) == 0 );
+
+    REQUIRE( BitLatencyHistogram::bucketUpperBound( 0 ) == 1000 );
+    REQUIRE( BitLatencyHistogram::bucketUpperBound( 1 ) == 4000 );
+    REQUIRE( BitLatencyHistogram::bucketUpperBound( BitLatencyHistogram::kBucketsCount - 1 ) ==
+             std::numeric_limits< uint64_t >::max() );
+}
+
+TEST_CASE( "BitOperationMetrics: Splitting the I/O and codec time", "[bitmetrics]" ) {
+    BitOperationMetrics metrics;
+    metrics.total_time_ns = 1000;
+    metrics.archive_stream.io_time_ns = 300;
+    metrics.item_streams.io_time_ns = 200;
+    REQUIRE( metrics.ioTimeNs() == 500 );
+    REQUIRE( metrics.codecTimeNs() == 500 );
+
+    metrics.item_streams.io_time_ns = 2000; // e.g., clocks with different resolutions.
+    REQUIRE( metrics.codecTimeNs() == 0 );
+}
+
+TEST_CASE( "BitOperationMetrics: Exporting to the Prometheus text format", "[bitmetrics]" ) {
+    BitOperationMetrics metrics;
+    metrics.operation = BitOperation::Test;
+    metrics.total_time_ns = 1500000000;
+    metrics.archive_stream.bytes_read = 1024;
+    metrics.item_streams.bytes_written = 42;
+    metrics.items_count = 2;
+    metrics.item_latency.record( 500 );
+    metrics.item_latency.record( 2000000 );
+    metrics.peak_buffer_memory = 4096;
+    metrics.stored_bytes = 8192;
+
+    const std::string text = toPrometheus( metrics, "app" );
+    REQUIRE_THAT( text, Catch::Contains( "# TYPE app_operation_duration_seconds gauge\n"
+                                         "app_operation_duration_seconds{operation=\"test\"} 1.5\n" ) );
+    REQUIRE_THAT( text, Catch::Contains( "app_stream_bytes_read_total{operation=\"test\",stream=\"archive\"} 1024\n" ) );
+    REQUIRE_THAT( text, Catch::Contains( "app_stream_bytes_written_total{operation=\"test\",stream=\"items\"} 42\n" ) );
+    REQUIRE_THAT( text, Catch::Contains( "app_items_total{operation=\"test\"} 2\n" ) );
+    REQUIRE_THAT( text, Catch::Contains( "app_peak_buffer_memory_bytes{operation=\"test\"} 4096\n" ) );
+    REQUIRE_THAT( text, Catch::Contains( "app_stored_bytes_total{operation=\"test\"} 8192\n" ) );
+    REQUIRE_THAT( text, Catch::Contains( "# TYPE app_item_latency_seconds histogram\n" ) );
+    REQUIRE_THAT( text, Catch::Contains( "app_item_latency_seconds_bucket{operation=\"test\",le=\"1e-06\"} 1\n" ) );
+    REQUIRE_THAT( text, Catch::Contains( "app_item_latency_seconds_bucket{operation=\"test\",le=\"0.001024\"} 1\n" ) );
+    REQUIRE_THAT( text, Catch::Contains( "app_item_latency_seconds_bucket{operation=\"test\",le=\"0.004096\"} 2\n" ) );
+    REQUIRE_THAT( text, Catch::Contains( "app_item_latency_seconds_bucket{operation=\"test\",le=\"+Inf\"} 2\n" ) );
+    REQUIRE_THAT( text, Catch::Contains( "app_item_latency_seconds_sum{operation=\"test\"} 0.0020005\n" ) );
+    REQUIRE_THAT( text, Catch::Contains( "app_item_latency_seconds_count{operation=\"test\"} 2\n" ) );
+    REQUIRE_THAT( text, !Catch::Contains( "bit7z_" ) );
+}
+
+#ifdef BIT7Z_NULL_CODEC
+
+TEST_CASE( "BitOperationMetrics: Collecting the metrics of the operations", "[bitmetrics]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    constexpr uint32_t kItemsCount = 10;
+    constexpr uint64_t kItemSize = 1000;
+    const buffer_t archive = makeNullArchive( kItemsCount, kItemSize );
+
+    std::vector< BitOperationMetrics > collected;
+    const auto collect = [ &collected ]( const BitOperationMetrics& metrics ) {
+        collected.push_back( metrics );
+    };
+
+    SECTION( "No metrics are collected without a callback" ) {
+        const BitArchiveReader reader{ lib, archive, BitNullFormat };
+        REQUIRE_FALSE( reader.metricsCallback() );
+        REQUIRE_NOTHROW( reader.test() );
+        REQUIRE( collected.empty() );
+    }
+
+    SECTION( "Extracting to memory" ) {
+        BitArchiveReader reader{ lib, archive, BitNullFormat };
+        reader.setMetricsCallback( collect );
+
+        std::map< tstring, buffer_t > extracted;
+        reader.extract( extracted );
+
+        REQUIRE( collected.size() == 1 );
+        const auto& metrics = collected.front();
+        REQUIRE( metrics.operation == BitOperation::Extract );
+        REQUIRE( metrics.items_count == kItemsCount );
+        REQUIRE( metrics.item_latency.count() == kItemsCount );
+        REQUIRE( metrics.item_streams.bytes_written == kItemsCount * kItemSize );
+        REQUIRE( metrics.item_streams.write_calls >= kItemsCount );
+        REQUIRE( metrics.item_streams.bytes_read == 0 );
+        REQUIRE( metrics.peak_buffer_memory == kItemsCount * kItemSize );
+        REQUIRE( metrics.property_calls > 0 );
+        REQUIRE( metrics.total_time_ns >= metrics.ioTimeNs() );
+    }
+
+    SECTION( "Testing the archive" ) {
+        BitArchiveReader reader{ lib, archive, BitNullFormat };
+        reader.setMetricsCallback( collect );
+        reader.test();
+
+        REQUIRE( collected.size() == 1 );
+        const auto& metrics = collected.front();
+        REQUIRE( metrics.operation == BitOperation::Test );
+        REQUIRE( metrics.items_count == kItemsCount );
+        REQUIRE( metrics.item_streams.bytes_written == 0 );
+        REQUIRE( metrics.peak_buffer_memory == 0 );
+    }
+
+    SECTION( "Compressing to memory" ) {
+        BitArchiveWriter writer{ lib, BitNullFormat };
+        const buffer_t content( kItemSize, static_cast< byte_t >( 'a' ) );
+        writer.addFile( content, BIT7Z_STRING( "first.txt" ) );
+        writer.addFile( content, BIT7Z_STRING( "second.txt" ) );
+        writer.setMetricsCallback( collect );
+
+        buffer_t output;
+        writer.compressTo( output );
+
+        REQUIRE( collected.size() == 1 );
+        const auto& metrics = collected.front();
+        REQUIRE( metrics.operation == BitOperation::Compress );
+        REQUIRE( metrics.items_count == 2 );
+        REQUIRE( metrics.item_streams.bytes_read == 2 * kItemSize );
+        REQUIRE( metrics.archive_stream.bytes_written == output.size() );
+        REQUIRE( metrics.peak_buffer_memory == output.size() );
+        REQUIRE( metrics.property_calls > 0 );
+
+        SECTION( "Reading the archive stream while updating" ) {
+            collected.clear();
+            BitArchiveWriter updater{ lib, output, BitNullFormat };
+            updater.addFile( content, BIT7Z_STRING( "third.txt" ) );
+            updater.setMetricsCallback( collect );
+
+            buffer_t updated;
+            updater.compressTo( updated );
+
+            REQUIRE( collected.size() == 1 );
+            REQUIRE( collected.front().items_count == 1 );
+            REQUIRE( collected.front().archive_stream.bytes_read >= 2 * kItemSize );
+            REQUIRE( collected.front().archive_stream.bytes_written == updated.size() );
+        }
+    }
+}
+
+#endif
+
+} // namespace test
+} // namespace bit7z
@@ -0,0 +1,160 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifdef BIT7Z_NULL_CODEC
+
+#include <catch2/catch.hpp>
+
+#include <bit7z/bit7zlibrary.hpp>
+#include <bit7z/bitarchivereader.hpp>
+#include <bit7z/bitarchivewriter.hpp>
+#include <bit7z/bitexception.hpp>
+#include <bit7z/bitnullcodec.hpp>
+
+#include <algorithm>
+#include <map>
+
+namespace bit7z {
+namespace test {
+
+inline buffer_t make_content( size_t size, unsigned char value ) {
+    return buffer_t( size, static_cast< byte_t >( value ) );
+}
+
+TEST_CASE( "BitNullCodec: Creating the archive handlers of other formats", "[bitnullcodec]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    const buffer_t archive = makeNullArchive( 1, 1 );
+
+    REQUIRE_THROWS_WITH( BitArchiveReader( lib, archive, BitFormat::SevenZip ),
+                         Catch::Matchers::StartsWith( "Failed to get class object" ) );
+    REQUIRE_NOTHROW( BitArchiveReader( lib, archive, BitNullFormat ) );
+}
+
+TEST_CASE( "BitNullCodec: Reading a synthetic archive", "[bitnullcodec]" ) {
+    const uint32_t items_count = GENERATE( 0u, 1u, 10u, 1000u );
+    const uint64_t item_size = GENERATE( 0u, 1u, 100000u );
+
+    DYNAMIC_SECTION( items_count << " items of " << item_size << " bytes" ) {
+        const Bit7zLibrary lib{ &nullCodecCreateObject };
+        const buffer_t archive = makeNullArchive( items_count, item_size );
+        const BitArchiveReader reader{ lib, archive, BitNullFormat };
+
+        REQUIRE( reader.itemsCount() == items_count );
+        REQUIRE( reader.size() == static_cast< uint64_t >( items_count ) * item_size );
+        REQUIRE_NOTHROW( reader.test() );
+
+        if ( items_count > 0 ) {
+            const auto index = items_count - 1;
+            const auto item = reader.items().back();
+            REQUIRE( item.path() == BIT7Z_STRING( "item" ) + to_tstring( index ) + BIT7Z_STRING( ".bin" ) );
+            REQUIRE( item.size() == item_size );
+            REQUIRE_FALSE( item.isDir() );
+
+            buffer_t content;
+            reader.extract( content, index );
+            REQUIRE( content == make_content( item_size, static_cast< unsigned char >( index & 0xFFu ) ) );
+        }
+    }
+}
+
+TEST_CASE( "BitNullCodec: Writing and reading back an archive", "[bitnullcodec]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+
+    const std::map< tstring, buffer_t > expected_items = {
+        { BIT7Z_STRING( "empty.txt" ), buffer_t{} },
+        { BIT7Z_STRING( "small.txt" ), make_content( 42, 'a' ) },
+        { BIT7Z_STRING( "large.bin" ), make_content( 300000, 'b' ) } // Larger than the internal copy buffer.
+    };
+
+    BitArchiveWriter writer{ lib, BitNullFormat };
+    for ( const auto& item : expected_items ) {
+        writer.addFile( item.second, item.first );
+    }
+
+    buffer_t archive;
+    writer.compressTo( archive );
+
+    const BitArchiveReader reader{ lib, archive, BitNullFormat };
+    REQUIRE( reader.itemsCount() == expected_items.size() );
+    REQUIRE_NOTHROW( reader.test() );
+
+    std::map< tstring, buffer_t > extracted_items;
+    reader.extract( extracted_items );
+    REQUIRE( extracted_items == expected_items );
+
+    SECTION( "Appending new items to the archive" ) {
+        BitArchiveWriter updater{ lib, archive, BitNullFormat };
+        const buffer_t new_content = make_content( 1000, 'c' );
+        updater.addFile( new_content, BIT7Z_STRING( "new.txt" ) );
+
+        buffer_t updated_archive;
+        updater.compressTo( updated_archive );
+
+        const BitArchiveReader updated_reader{ lib, updated_archive, BitNullFormat };
+        REQUIRE( updated_reader.itemsCount() == expected_items.size() + 1 );
+
+        std::map< tstring, buffer_t > updated_items;
+        updated_reader.extract( updated_items );
+        REQUIRE( updated_items.at( BIT7Z_STRING( "new.txt" ) ) == new_content );
+        for ( const auto& item : expected_items ) {
+            REQUIRE( updated_items.at( item.first ) == item.second );
+        }
+    }
+}
+
+TEST_CASE( "BitNullCodec: Appending items to a synthetic archive", "[bitnullcodec]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    const buffer_t archive = makeNullArchive( 3, 1024 );
+
+    BitArchiveWriter updater{ lib, archive, BitNullFormat };
+    const buffer_t new_content = make_content( 10, 'z' );
+    updater.addFile( new_content, BIT7Z_STRING( "new.txt" ) );
+
+    buffer_t updated_archive;
+    updater.compressTo( updated_archive );
+
+    // The synthetic items are kept as such, so only the new item's data is stored in the archive.
+    REQUIRE( updated_archive.size() < archive.size() + 1024 );
+
+    const BitArchiveReader reader{ lib, updated_archive, BitNullFormat };
+    REQUIRE( reader.itemsCount() == 4 );
+
+    buffer_t content;
+    reader.extract( content, 2 );
+    REQUIRE( content == make_content( 1024, 2 ) );
+    reader.extract( content, 3 );
+    REQUIRE( content == new_content );
+}
+
+TEST_CASE( "BitNullCodec: Opening an invalid archive", "[bitnullcodec]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+
+    buffer_t archive = makeNullArchive( 10, 10 );
+    SECTION( "Wrong signature" ) {
+        archive[ 0 ] = static_cast< byte_t >( 'B' );
+    }
+
+    SECTION( "Truncated index" ) {
+        archive.erase( archive.begin() + 16, archive.begin() + 32 );
+    }
+
+    SECTION( "Too small" ) {
+        archive.resize( 8 );
+    }
+
+    REQUIRE_THROWS_AS( BitArchiveReader( lib, archive, BitNullFormat ), BitException );
+}
+
+} // namespace test
+} // namespace bit7z
+
+#endif
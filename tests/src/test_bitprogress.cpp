@@ -0,0 +1,140 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <bit7z/bitprogress.hpp>
+
+#ifdef BIT7Z_NULL_CODEC
+#include <bit7z/bit7zlibrary.hpp>
+#include <bit7z/bitarchivereader.hpp>
+#include <bit7z/bitnullcodec.hpp>
+#include <internal/progressreporter.hpp>
+
+#include <chrono>
+#include <vector>
+#endif
+
+namespace bit7z {
+namespace test {
+
+TEST_CASE( "BitProgress: Updating the counters", "[bitprogress]" ) {
+    BitProgress progress;
+    REQUIRE( progress.total() == 0 );
+    REQUIRE( progress.completed() == 0 );
+    REQUIRE( progress.inputBytes() == 0 );
+    REQUIRE( progress.outputBytes() == 0 );
+    REQUIRE( progress.currentItem() == BitProgress::kNoItem );
+
+    progress.setTotal( 100 );
+    progress.setCompleted( 42 );
+    progress.setRatioInfo( 42, 21 );
+    progress.setCurrentItem( 3 );
+    REQUIRE( progress.total() == 100 );
+    REQUIRE( progress.completed() == 42 );
+    REQUIRE( progress.inputBytes() == 42 );
+    REQUIRE( progress.outputBytes() == 21 );
+    REQUIRE( progress.currentItem() == 3 );
+
+    progress.reset();
+    REQUIRE( progress.total() == 0 );
+    REQUIRE( progress.completed() == 0 );
+    REQUIRE( progress.currentItem() == BitProgress::kNoItem );
+}
+
+#ifdef BIT7Z_NULL_CODEC
+
+TEST_CASE( "BitProgress: Tracking the progress of an operation", "[bitprogress]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    constexpr uint32_t kItemsCount = 100;
+    constexpr uint64_t kItemSize = 10;
+    const buffer_t archive = makeNullArchive( kItemsCount, kItemSize );
+
+    BitArchiveReader reader{ lib, archive, BitNullFormat };
+    REQUIRE( reader.progressTracker() == nullptr );
+    REQUIRE( reader.progressInterval() == std::chrono::milliseconds::zero() );
+
+    BitProgress progress;
+    reader.setProgressTracker( &progress );
+
+    std::vector< uint64_t > notified;
+    reader.setProgressCallback( [ &notified ]( uint64_t completed ) {
+        notified.push_back( completed );
+        return true;
+    } );
+
+    SECTION( "Every notification is delivered by default" ) {
+        reader.test();
+        REQUIRE( notified.size() > kItemsCount );
+    }
+
+    SECTION( "Notifications are coalesced to the progress interval" ) {
+        reader.setProgressInterval( std::chrono::hours{ 1 } );
+        reader.test();
+        // Only the first notification and the final one.
+        REQUIRE( notified.size() <= 3 );
+    }
+
+    REQUIRE( notified.back() == kItemsCount * kItemSize );
+    REQUIRE( progress.total() == kItemsCount * kItemSize );
+    REQUIRE( progress.completed() == kItemsCount * kItemSize );
+    REQUIRE( progress.currentItem() == kItemsCount - 1 );
+}
+
+TEST_CASE( "BitProgress: Stopping an operation with coalesced notifications", "[bitprogress]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    const buffer_t archive = makeNullArchive( 100, 10 );
+
+    BitArchiveReader reader{ lib, archive, BitNullFormat };
+    reader.setProgressInterval( std::chrono::hours{ 1 } );
+    reader.setProgressCallback( []( uint64_t ) { return false; } );
+    REQUIRE_THROWS( reader.test() );
+}
+
+TEST_CASE( "ProgressReporter: Flushing the coalesced notifications", "[bitprogress]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    BitArchiveReader reader{ lib, makeNullArchive( 1, 10 ), BitNullFormat };
+    reader.setProgressInterval( std::chrono::hours{ 1 } );
+
+    std::vector< uint64_t > notified;
+    reader.setProgressCallback( [ &notified ]( uint64_t completed ) {
+        notified.push_back( completed );
+        return true;
+    } );
+    std::vector< std::pair< uint64_t, uint64_t > > ratios;
+    reader.setRatioCallback( [ &ratios ]( uint64_t input_bytes, uint64_t output_bytes ) {
+        ratios.emplace_back( input_bytes, output_bytes );
+    } );
+
+    // The total is unknown, so no notification is final.
+    ProgressReporter reporter{ reader };
+    REQUIRE( reporter.reportCompleted( 10 ) );
+    REQUIRE( reporter.reportCompleted( 20 ) );
+    reporter.reportRatio( 1, 2 );
+    reporter.reportRatio( 3, 4 );
+    REQUIRE( notified == std::vector< uint64_t >{ 10 } );
+    REQUIRE( ratios.size() == 1 );
+
+    reporter.flush();
+    REQUIRE( notified == std::vector< uint64_t >{ 10, 20 } );
+    REQUIRE( ratios.back() == std::make_pair< uint64_t, uint64_t >( 3, 4 ) );
+
+    // Nothing is left to be delivered.
+    reporter.flush();
+    REQUIRE( notified.size() == 2 );
+    REQUIRE( ratios.size() == 2 );
+}
+
+#endif
+
+} // namespace test
+} // namespace bit7z
@@ -0,0 +1,237 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <bit7z/bitshardmanifest.hpp>
+#include <internal/fs.hpp>
+#include <internal/shardplanner.hpp>
+
+#ifdef BIT7Z_NULL_CODEC
+#include <bit7z/bit7zlibrary.hpp>
+#include <bit7z/bitarchivewriter.hpp>
+#include <bit7z/bitcancellationtoken.hpp>
+#include <bit7z/bitexception.hpp>
+#include <bit7z/bitnullcodec.hpp>
+#include <bit7z/bitshardedarchivereader.hpp>
+#endif
+
+#include <algorithm>
+#include <map>
+#include <numeric>
+
+namespace bit7z {
+namespace test {
+
+inline uint64_t shard_size( const std::vector< uint32_t >& shard, const std::vector< uint64_t >& sizes ) {
+    return std::accumulate( shard.begin(), shard.end(), uint64_t{ 0 }, [ &sizes ]( uint64_t sum, uint32_t index ) {
+        return sum + sizes[ index ];
+    } );
+}
+
+inline void require_partition( const ShardPlan& plan, std::size_t items_count ) {
+    std::vector< uint32_t > assigned;
+    for ( const auto& shard : plan ) {
+        REQUIRE_FALSE( shard.empty() );
+        REQUIRE( std::is_sorted( shard.begin(), shard.end() ) );
+        assigned.insert( assigned.end(), shard.begin(), shard.end() );
+    }
+    std::sort( assigned.begin(), assigned.end() );
+    std::vector< uint32_t > expected( items_count );
+    std::iota( expected.begin(), expected.end(), 0 );
+    REQUIRE( assigned == expected );
+}
+
+TEST_CASE( "ShardPlanner: Partitioning items by shards count", "[shardplanner]" ) {
+    const std::vector< uint64_t > sizes = { 70, 10, 40, 40, 30, 20, 10, 0 };
+
+    SECTION( "Balanced shards" ) {
+        const ShardPlan plan = planShardsByCount( sizes, 2 );
+        REQUIRE( plan.size() == 2 );
+        require_partition( plan, sizes.size() );
+        REQUIRE( shard_size( plan[ 0 ], sizes ) == 110 );
+        REQUIRE( shard_size( plan[ 1 ], sizes ) == 110 );
+    }
+
+    SECTION( "More shards than items" ) {
+        const ShardPlan plan = planShardsByCount( sizes, 100 );
+        REQUIRE( plan.size() == sizes.size() );
+        require_partition( plan, sizes.size() );
+    }
+
+    SECTION( "Zero shards" ) {
+        const ShardPlan plan = planShardsByCount( sizes, 0 );
+        REQUIRE( plan.size() == 1 );
+        require_partition( plan, sizes.size() );
+    }
+
+    SECTION( "No items" ) {
+        REQUIRE( planShardsByCount( {}, 4 ).empty() );
+    }
+}
+
+TEST_CASE( "ShardPlanner: Partitioning items by shard size", "[shardplanner]" ) {
+    const std::vector< uint64_t > sizes = { 70, 10, 40, 40, 30, 20, 10, 0, 250 };
+
+    const ShardPlan plan = planShardsBySize( sizes, 100 );
+    require_partition( plan, sizes.size() );
+    REQUIRE( plan.size() == 4 );
+    for ( const auto& shard : plan ) {
+        // Only the item larger than the maximum size is allowed to exceed it, in a shard of its own
+        // (except for empty items).
+        if ( shard_size( shard, sizes ) > 100 ) {
+            REQUIRE( std::find( shard.begin(), shard.end(), 8 ) != shard.end() );
+            REQUIRE( shard_size( shard, sizes ) == 250 );
+        }
+    }
+}
+
+TEST_CASE( "BitShardManifest: Saving and loading a manifest", "[bitshardmanifest]" ) {
+    const fs::path manifest_path = fs::temp_directory_path() / "bit7z_test_manifest.manifest";
+
+    BitShardManifest manifest;
+    manifest.shards = { BIT7Z_STRING( "backup.001.7z" ), BIT7Z_STRING( "backup.002.7z" ) };
+    manifest.items = {
+        { BIT7Z_STRING( "folder/file.txt" ), 0 },
+        { BIT7Z_STRING( "name with spaces.bin" ), 1 },
+        { BIT7Z_STRING( "line\nbreak\\and backslash" ), 1 }
+    };
+    manifest.save( manifest_path.string< tchar >() );
+
+    const BitShardManifest loaded = BitShardManifest::load( manifest_path.string< tchar >() );
+    REQUIRE( loaded.shards == manifest.shards );
+    REQUIRE( loaded.items == manifest.items );
+    REQUIRE( loaded.shardOf( BIT7Z_STRING( "name with spaces.bin" ) ) == 1 );
+    REQUIRE( loaded.shardOf( BIT7Z_STRING( "missing.txt" ) ) == 2 );
+
+    SECTION( "Invalid manifest" ) {
+        {
+            fs::ofstream invalid{ manifest_path, std::ios::binary | std::ios::trunc };
+            invalid << "bit7z-shards 1\nshard a.7z\nitem 1 file.txt\n";
+        }
+        REQUIRE_THROWS_AS( BitShardManifest::load( manifest_path.string< tchar >() ), BitException );
+    }
+
+    std::error_code error;
+    fs::remove( manifest_path, error );
+}
+
+#ifdef BIT7Z_NULL_CODEC
+TEST_CASE( "BitOutputArchive: Compressing to shards", "[bitshards]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    const fs::path test_dir = fs::temp_directory_path() / "bit7z_test_shards";
+    std::error_code error;
+    fs::remove_all( test_dir, error );
+    fs::create_directories( test_dir );
+    const tstring prefix = ( test_dir / "backup" ).string< tchar >();
+
+    std::map< tstring, buffer_t > expected_items;
+    for ( int i = 0; i < 10; ++i ) {
+        expected_items.emplace( BIT7Z_STRING( "item" ) + to_tstring( i ) + BIT7Z_STRING( ".bin" ),
+                                buffer_t( static_cast< size_t >( 1000 * ( i + 1 ) ), static_cast< byte_t >( i ) ) );
+    }
+
+    BitArchiveWriter writer{ lib, BitNullFormat };
+    for ( const auto& item : expected_items ) {
+        writer.addFile( item.second, item.first );
+    }
+
+    uint64_t total = 0;
+    uint64_t completed = 0;
+    writer.setTotalCallback( [ &total ]( uint64_t value ) { total = value; } );
+    writer.setProgressCallback( [ &completed ]( uint64_t value ) {
+        completed = value;
+        return true;
+    } );
+
+    BitShardManifest manifest;
+    SECTION( "By shards count" ) {
+        manifest = writer.compressToShards( prefix, 3 );
+        REQUIRE( manifest.shards.size() == 3 );
+    }
+
+    SECTION( "By shard size" ) {
+        manifest = writer.compressToShardsOfSize( prefix, 20000 );
+        REQUIRE( manifest.shards.size() == 3 );
+    }
+
+    REQUIRE( manifest.shards[ 0 ] == BIT7Z_STRING( "backup.001.null" ) );
+    REQUIRE( manifest.items.size() == expected_items.size() );
+    REQUIRE( total == 55000 );
+    REQUIRE( completed == total );
+    for ( const auto& shard : manifest.shards ) {
+        REQUIRE( fs::exists( test_dir / shard ) );
+    }
+
+    const BitShardedArchiveReader reader{ lib, prefix + BIT7Z_STRING( ".manifest" ), BitNullFormat };
+    REQUIRE( reader.shardsCount() == manifest.shards.size() );
+    REQUIRE( reader.itemsCount() == expected_items.size() );
+    REQUIRE( reader.size() == 55000 );
+    REQUIRE_NOTHROW( reader.test() );
+
+    std::map< tstring, buffer_t > extracted_items;
+    reader.extract( extracted_items );
+    REQUIRE( extracted_items == expected_items );
+
+    buffer_t content;
+    reader.extract( BIT7Z_STRING( "item9.bin" ), content );
+    REQUIRE( content == expected_items.at( BIT7Z_STRING( "item9.bin" ) ) );
+    REQUIRE_FALSE( reader.contains( BIT7Z_STRING( "missing.bin" ) ) );
+    REQUIRE_THROWS_AS( reader.extract( BIT7Z_STRING( "missing.bin" ), content ), BitException );
+
+    fs::remove_all( test_dir, error );
+}
+
+TEST_CASE( "BitOutputArchive: Stopping the compression of the shards", "[bitshards]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    const fs::path test_dir = fs::temp_directory_path() / "bit7z_test_shards_stop";
+    std::error_code error;
+    fs::remove_all( test_dir, error );
+    fs::create_directories( test_dir );
+    const tstring prefix = ( test_dir / "backup" ).string< tchar >();
+
+    BitArchiveWriter writer{ lib, BitNullFormat };
+    const buffer_t content( 300000, static_cast< byte_t >( 'a' ) );
+    for ( int i = 0; i < 8; ++i ) {
+        writer.addFile( content, BIT7Z_STRING( "item" ) + to_tstring( i ) + BIT7Z_STRING( ".bin" ) );
+    }
+
+    SECTION( "Aborting it from the progress callback" ) {
+        writer.setProgressCallback( []( uint64_t /*completed*/ ) { return false; } );
+        REQUIRE_THROWS_AS( writer.compressToShards( prefix, 4 ), BitException );
+        REQUIRE_FALSE( fs::exists( prefix + BIT7Z_STRING( ".manifest" ) ) );
+        REQUIRE_FALSE( fs::is_empty( test_dir ) ); // Not a cancellation: the partial shards are kept.
+    }
+
+    SECTION( "Cancelling it" ) {
+        BitCancellationToken token;
+        token.cancel();
+        writer.setCancellationToken( &token );
+        REQUIRE_THROWS_AS( writer.compressToShards( prefix, 4 ), BitException );
+        REQUIRE_FALSE( fs::exists( prefix + BIT7Z_STRING( ".manifest" ) ) );
+        REQUIRE( fs::is_empty( test_dir ) ); // The partial shards are removed.
+    }
+
+    fs::remove_all( test_dir, error );
+}
+
+TEST_CASE( "BitOutputArchive: Compressing an updated archive to shards", "[bitshards]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    const buffer_t archive = makeNullArchive( 2, 10 );
+
+    BitArchiveWriter updater{ lib, archive, BitNullFormat };
+    REQUIRE_THROWS_AS( updater.compressToShards( BIT7Z_STRING( "unused" ), 2 ), BitException );
+}
+#endif
+
+} // namespace test
+} // namespace bit7z
@@ -0,0 +1,141 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <bit7z/bit7zlibrary.hpp>
+#include <bit7z/bitarchivereader.hpp>
+#include <bit7z/bitarchivewriter.hpp>
+#include <bit7z/bitnullcodec.hpp>
+#include <internal/crc32.hpp>
+#include <internal/fs.hpp>
+
+#include <map>
+#include <string>
+
+#include "filesystem.hpp"
+
+namespace bit7z {
+namespace test {
+
+TEST_CASE( "crc32: Computing the CRC-32 of some data", "[bitsync][crc32]" ) {
+    const std::string check_string = "123456789";
+    std::vector< byte_t > data;
+    for ( const auto character : check_string ) {
+        data.push_back( static_cast< byte_t >( character ) );
+    }
+
+    REQUIRE( crc32( 0, nullptr, 0 ) == 0 );
+    REQUIRE( crc32( 0, data.data(), data.size() ) == 0xCBF43926u );
+
+    // The CRC can be computed incrementally.
+    const uint32_t partial_crc = crc32( 0, data.data(), 4 );
+    REQUIRE( crc32( partial_crc, data.data() + 4, data.size() - 4 ) == 0xCBF43926u );
+}
+
+#ifdef BIT7Z_NULL_CODEC
+
+inline std::map< tstring, buffer_t > extract_all( const Bit7zLibrary& lib, const fs::path& archive_path ) {
+    const BitArchiveReader reader{ lib, archive_path.string< tchar >(), BitNullFormat };
+    std::map< tstring, buffer_t > result;
+    reader.extract( result );
+    return result;
+}
+
+inline buffer_t to_buffer( const std::string& content ) {
+    buffer_t result;
+    for ( const auto character : content ) {
+        result.push_back( static_cast< byte_t >( character ) );
+    }
+    return result;
+}
+
+TEST_CASE( "BitOutputArchive: Synchronizing an archive with its source directory", "[bitsync]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    const fs::path test_dir = fs::temp_directory_path() / "bit7z_test_sync";
+    const fs::path archive_path = fs::temp_directory_path() / "bit7z_test_sync.null";
+    std::error_code error;
+    fs::remove_all( test_dir, error );
+    fs::remove( archive_path, error );
+    fs::create_directories( test_dir );
+
+    filesystem::write_text_file( test_dir / "unchanged.txt", std::string( 1000, 'u' ) );
+    filesystem::write_text_file( test_dir / "changed.txt", "old content" );
+    filesystem::write_text_file( test_dir / "touched.txt", "same content" );
+    filesystem::write_text_file( test_dir / "removed.txt", "removed" );
+    {
+        BitArchiveWriter writer{ lib, BitNullFormat };
+        writer.addFiles( test_dir.string< tchar >() );
+        writer.compressTo( archive_path.string< tchar >() );
+    }
+    REQUIRE( extract_all( lib, archive_path ).size() == 4 );
+
+    filesystem::write_text_file( test_dir / "changed.txt", "new, longer, content" );
+    fs::last_write_time( test_dir / "touched.txt",
+                         fs::last_write_time( test_dir / "touched.txt" ) + std::chrono::hours( 1 ) );
+    fs::remove( test_dir / "removed.txt" );
+    filesystem::write_text_file( test_dir / "added.txt", "added" );
+
+    BitOperationMetrics metrics;
+    BitArchiveWriter writer{ lib, archive_path.string< tchar >(), BitNullFormat };
+    writer.setMetricsCallback( [ &metrics ]( const BitOperationMetrics& operation_metrics ) {
+        metrics = operation_metrics;
+    } );
+
+    SECTION( "Using UpdateMode::Sync" ) {
+        writer.setUpdateMode( UpdateMode::Sync );
+        writer.addFiles( test_dir.string< tchar >() );
+        writer.compressTo( archive_path.string< tchar >() );
+
+        const std::map< tstring, buffer_t > expected_items{
+            { BIT7Z_STRING( "added.txt" ), to_buffer( "added" ) },
+            { BIT7Z_STRING( "changed.txt" ), to_buffer( "new, longer, content" ) },
+            { BIT7Z_STRING( "touched.txt" ), to_buffer( "same content" ) },
+            { BIT7Z_STRING( "unchanged.txt" ), to_buffer( std::string( 1000, 'u' ) ) }
+        };
+        REQUIRE( extract_all( lib, archive_path ) == expected_items );
+
+        // Only the new and changed files were read; the unchanged one was copied from the old archive.
+        REQUIRE( metrics.item_streams.bytes_read == 5 + 20 + 12 );
+    }
+
+    SECTION( "Using UpdateMode::Update" ) {
+        writer.setUpdateMode( UpdateMode::Update );
+        writer.addFiles( test_dir.string< tchar >() );
+        writer.compressTo( archive_path.string< tchar >() );
+
+        const auto items = extract_all( lib, archive_path );
+        REQUIRE( items.size() == 5 );
+        REQUIRE( items.at( BIT7Z_STRING( "changed.txt" ) ) == to_buffer( "new, longer, content" ) );
+        REQUIRE( items.at( BIT7Z_STRING( "removed.txt" ) ) == to_buffer( "removed" ) );
+        REQUIRE( metrics.item_streams.bytes_read == 1000 + 5 + 20 + 12 );
+    }
+
+    SECTION( "Using UpdateMode::Sync with the content check" ) {
+        // Note: the null format does not store the CRC of the items, so the modification time is used.
+        writer.setUpdateMode( UpdateMode::Sync );
+        writer.setSyncContentCheck( true );
+        writer.addFiles( test_dir.string< tchar >() );
+        writer.compressTo( archive_path.string< tchar >() );
+
+        REQUIRE( extract_all( lib, archive_path ).size() == 4 );
+        REQUIRE( metrics.item_streams.bytes_read == 5 + 20 + 12 );
+    }
+
+    fs::remove_all( test_dir, error );
+    fs::remove( archive_path, error );
+}
+
+#endif
+
+} // namespace test
+} // namespace bit7z
@@ -0,0 +1,154 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <bit7z/bitthreadgovernor.hpp>
+
+#ifdef BIT7Z_NULL_CODEC
+#include <bit7z/bit7zlibrary.hpp>
+#include <bit7z/bitarchivereader.hpp>
+#include <bit7z/bitarchivewriter.hpp>
+#include <bit7z/bitnullcodec.hpp>
+#endif
+
+#include <algorithm>
+#include <thread>
+
+namespace bit7z {
+namespace test {
+
+TEST_CASE( "BitThreadGovernor: Granting the threads to the jobs", "[bitthreadgovernor]" ) {
+    BitThreadGovernor governor{ 8 };
+    REQUIRE( governor.tokens() == 8 );
+
+    SECTION( "A single job gets all the pool" ) {
+        const uint32_t threads = governor.acquire( 0 );
+        REQUIRE( threads == 8 );
+        REQUIRE( governor.tokensInUse() == 8 );
+        REQUIRE( governor.runningJobs() == 1 );
+        governor.release( threads );
+    }
+
+    SECTION( "Jobs never get more threads than requested" ) {
+        const uint32_t threads = governor.acquire( 3 );
+        REQUIRE( threads == 3 );
+        governor.release( threads );
+    }
+
+    SECTION( "Jobs get their fair share of the pool" ) {
+        const uint32_t first = governor.acquire( 2 );
+        const uint32_t second = governor.acquire( 0 );
+        REQUIRE( first == 2 );
+        REQUIRE( second == 4 ); // 8 tokens / 2 jobs
+        const uint32_t third = governor.acquire( 0 );
+        REQUIRE( third == 2 ); // Only the tokens left by the other jobs.
+        REQUIRE( governor.tokensInUse() == 8 );
+
+        // With the pool exhausted, jobs still run single-threaded.
+        const uint32_t fourth = governor.acquire( 4 );
+        REQUIRE( fourth == 1 );
+        REQUIRE( governor.runningJobs() == 4 );
+
+        governor.release( fourth );
+        governor.release( third );
+        governor.release( second );
+
+        // The released tokens are granted to the next jobs.
+        const uint32_t fifth = governor.acquire( 0 );
+        REQUIRE( fifth == 4 ); // 8 tokens / 2 jobs
+        governor.release( fifth );
+        governor.release( first );
+    }
+
+    SECTION( "Jobs started with the pool exhausted oversubscribe it by a single thread each" ) {
+        const uint32_t first = governor.acquire( 0 );
+        REQUIRE( first == 8 ); // Alone, the job gets all the pool.
+
+        const uint32_t second = governor.acquire( 0 );
+        const uint32_t third = governor.acquire( 4 );
+        REQUIRE( second == 1 );
+        REQUIRE( third == 1 );
+        REQUIRE( governor.tokensInUse() == 8 + 2 );
+        REQUIRE( governor.runningJobs() == 3 );
+
+        // Once the first job ends, the pool is no longer oversubscribed, and the new jobs get their fair share.
+        governor.release( first );
+        REQUIRE( governor.tokensInUse() == 2 );
+        const uint32_t fourth = governor.acquire( 0 );
+        REQUIRE( fourth == 2 ); // 8 tokens / 3 jobs
+        REQUIRE( governor.tokensInUse() <= governor.tokens() );
+
+        governor.release( fourth );
+        governor.release( third );
+        governor.release( second );
+    }
+
+    REQUIRE( governor.tokensInUse() == 0 );
+    REQUIRE( governor.runningJobs() == 0 );
+}
+
+TEST_CASE( "BitThreadGovernor: Pool with the CPU cores", "[bitthreadgovernor]" ) {
+    const BitThreadGovernor governor{};
+    REQUIRE( governor.tokens() == std::max( std::thread::hardware_concurrency(), 1u ) );
+}
+
+#ifdef BIT7Z_NULL_CODEC
+
+TEST_CASE( "BitThreadGovernor: Governing the threads of the operations", "[bitthreadgovernor]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    BitThreadGovernor governor{ 4 };
+
+    uint32_t tokens_in_use = 0;
+    uint32_t running_jobs = 0;
+    const auto record_governor = [ & ]( uint64_t ) {
+        tokens_in_use = std::max( tokens_in_use, governor.tokensInUse() );
+        running_jobs = std::max( running_jobs, governor.runningJobs() );
+        return true;
+    };
+
+    SECTION( "Compressing" ) {
+        BitArchiveWriter writer{ lib, BitNullFormat };
+        writer.setThreadGovernor( &governor );
+        writer.setThreadsCount( 2 );
+        writer.setProgressCallback( record_governor );
+        REQUIRE( writer.threadGovernor() == &governor );
+
+        const buffer_t content( 1024, 'a' );
+        writer.addFile( content, BIT7Z_STRING( "file.txt" ) );
+        buffer_t output;
+        REQUIRE_NOTHROW( writer.compressTo( output ) );
+        REQUIRE( tokens_in_use == 2 );
+    }
+
+    SECTION( "Extracting with the global governor" ) {
+        const buffer_t archive = makeNullArchive( 2, 1024 );
+        BitArchiveReader reader{ lib, archive, BitNullFormat };
+        REQUIRE( reader.threadGovernor() == nullptr );
+
+        BitAbstractArchiveHandler::setGlobalThreadGovernor( &governor );
+        REQUIRE( reader.threadGovernor() == &governor );
+        reader.setProgressCallback( record_governor );
+        REQUIRE_NOTHROW( reader.test() );
+        BitAbstractArchiveHandler::setGlobalThreadGovernor( nullptr );
+        REQUIRE( tokens_in_use == 4 );
+    }
+
+    REQUIRE( running_jobs == 1 );
+    REQUIRE( governor.tokensInUse() == 0 );
+    REQUIRE( governor.runningJobs() == 0 );
+}
+
+#endif
+
+} // namespace test
+} // namespace bit7z
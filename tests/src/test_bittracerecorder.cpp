@@ -0,0 +1,101 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifdef BIT7Z_TRACING
+
+#include <catch2/catch.hpp>
+
+#include <bit7z/bittracerecorder.hpp>
+
+#ifdef BIT7Z_NULL_CODEC
+#include <bit7z/bit7zlibrary.hpp>
+#include <bit7z/bitarchivereader.hpp>
+#include <bit7z/bitnullcodec.hpp>
+#endif
+
+namespace bit7z {
+namespace test {
+
+inline std::size_t count_occurrences( const std::string& text, const std::string& pattern ) {
+    std::size_t count = 0;
+    for ( auto pos = text.find( pattern ); pos != std::string::npos; pos = text.find( pattern, pos + 1 ) ) {
+        ++count;
+    }
+    return count;
+}
+
+TEST_CASE( "BitTraceRecorder: Recording events", "[bittracerecorder]" ) {
+    BitTraceRecorder recorder{ 4 };
+    REQUIRE( recorder.capacity() == 4 );
+    REQUIRE( recorder.size() == 0 );
+    REQUIRE( recorder.toChromeTrace() == R"({"displayTimeUnit":"ns","traceEvents":[]})" );
+
+    recorder.begin( "extract", 3 );
+    recorder.instant( "close" );
+    recorder.end( "extract" );
+    REQUIRE( recorder.size() == 3 );
+    REQUIRE( recorder.droppedEvents() == 0 );
+
+    const std::string trace = recorder.toChromeTrace();
+    REQUIRE_THAT( trace, Catch::StartsWith( R"({"displayTimeUnit":"ns","traceEvents":[{"name":"extract")" ) );
+    REQUIRE_THAT( trace, Catch::Contains( R"("ph":"B")" ) && Catch::Contains( R"("ph":"E")" ) );
+    REQUIRE_THAT( trace, Catch::Contains( R"("name":"close","cat":"bit7z","ph":"i","s":"t")" ) );
+    REQUIRE_THAT( trace, Catch::Contains( R"("args":{"value":3})" ) );
+
+    SECTION( "The oldest events are overwritten when the buffer is full" ) {
+        recorder.begin( "test" );
+        recorder.end( "test" );
+        REQUIRE( recorder.size() == 4 );
+        REQUIRE( recorder.droppedEvents() == 1 );
+
+        const std::string full_trace = recorder.toChromeTrace();
+        REQUIRE_THAT( full_trace, Catch::StartsWith( R"({"displayTimeUnit":"ns","traceEvents":[{"name":"close")" ) );
+        REQUIRE( count_occurrences( full_trace, R"("name":"extract")" ) == 1 );
+        REQUIRE( count_occurrences( full_trace, R"("name":"test")" ) == 2 );
+    }
+
+    SECTION( "Clearing the recorder" ) {
+        recorder.clear();
+        REQUIRE( recorder.size() == 0 );
+        REQUIRE( recorder.droppedEvents() == 0 );
+    }
+}
+
+#ifdef BIT7Z_NULL_CODEC
+
+TEST_CASE( "BitTraceRecorder: Tracing the operations of a handler", "[bittracerecorder]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    const buffer_t archive = makeNullArchive( 5, 10 );
+
+    BitTraceRecorder recorder;
+    {
+        BitArchiveReader reader{ lib, archive, BitNullFormat };
+        reader.setTraceRecorder( &recorder );
+        REQUIRE( reader.traceRecorder() == &recorder );
+        reader.test();
+    }
+
+    // Note: the archive was opened before setting the recorder.
+    const std::string trace = recorder.toChromeTrace();
+    REQUIRE( count_occurrences( trace, R"("name":"open")" ) == 0 );
+    REQUIRE( count_occurrences( trace, R"("name":"test")" ) == 2 );
+    REQUIRE( count_occurrences( trace, R"("name":"item","cat":"bit7z","ph":"B")" ) == 5 );
+    REQUIRE( count_occurrences( trace, R"("name":"item","cat":"bit7z","ph":"E")" ) == 5 );
+    REQUIRE( count_occurrences( trace, R"("name":"close")" ) == 1 );
+}
+
+#endif
+
+} // namespace test
+} // namespace bit7z
+
+#endif
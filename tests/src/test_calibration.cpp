@@ -0,0 +1,162 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <internal/calibration.hpp>
+#include <internal/fs.hpp>
+
+#ifdef BIT7Z_NULL_CODEC
+#include <bit7z/bit7zlibrary.hpp>
+#include <bit7z/bitarchivewriter.hpp>
+#include <bit7z/bitnullcodec.hpp>
+#endif
+
+#include <string>
+#include <vector>
+
+#include "filesystem.hpp"
+
+namespace bit7z {
+namespace test {
+
+inline BitCalibrationResult calibration_result( BitCompressionLevel level, double ratio, double throughput ) {
+    BitCalibrationResult result;
+    result.parameters.level = level;
+    result.ratio = ratio;
+    result.throughput = throughput;
+    return result;
+}
+
+TEST_CASE( "calibration: Computing the required throughput", "[calibration]" ) {
+    BitCalibrationOptions options;
+    REQUIRE( requiredThroughput( options, 1000 ) == 0.0 );
+
+    options.min_throughput = 100;
+    REQUIRE( requiredThroughput( options, 1000 ) == 100.0 );
+
+    options.deadline = std::chrono::milliseconds{ 2000 };
+    REQUIRE( requiredThroughput( options, 1000 ) == 500.0 );
+    REQUIRE( requiredThroughput( options, 100 ) == 100.0 );
+}
+
+TEST_CASE( "calibration: Choosing the best candidate", "[calibration]" ) {
+    const std::vector< BitCalibrationResult > results{
+        calibration_result( BitCompressionLevel::Fastest, 0.6, 400 ),
+        calibration_result( BitCompressionLevel::Normal, 0.4, 200 ),
+        calibration_result( BitCompressionLevel::Max, 0.4, 250 ),
+        calibration_result( BitCompressionLevel::Ultra, 0.3, 50 )
+    };
+
+    BitCalibrationResult chosen = chooseCalibration( results, 0 );
+    REQUIRE( chosen.parameters.level == BitCompressionLevel::Ultra );
+    REQUIRE( chosen.meets_target );
+
+    // Between candidates with the same ratio, the faster one is chosen.
+    chosen = chooseCalibration( results, 100 );
+    REQUIRE( chosen.parameters.level == BitCompressionLevel::Max );
+    REQUIRE( chosen.meets_target );
+
+    // If no candidate meets the target, the fastest one is chosen.
+    chosen = chooseCalibration( results, 1000 );
+    REQUIRE( chosen.parameters.level == BitCompressionLevel::Fastest );
+    REQUIRE_FALSE( chosen.meets_target );
+}
+
+#ifdef BIT7Z_NULL_CODEC
+
+inline buffer_t patterned_content( std::size_t size ) {
+    buffer_t result( size );
+    for ( std::size_t index = 0; index < size; ++index ) {
+        result[ index ] = static_cast< byte_t >( ( index * 31 ) % 251 );
+    }
+    return result;
+}
+
+TEST_CASE( "BitArchiveWriter: Calibrating the compression parameters", "[calibration]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    const fs::path test_dir = fs::temp_directory_path() / "bit7z_test_calibration";
+    std::error_code error;
+    fs::remove_all( test_dir, error );
+    fs::create_directories( test_dir / "input" );
+    filesystem::write_file( test_dir / "input" / "first.txt", patterned_content( 30000 ) );
+    filesystem::write_file( test_dir / "input" / "second.bin", patterned_content( 20000 ) );
+
+    BitArchiveWriter writer{ lib, BitNullFormat };
+
+    SECTION( "Without input files" ) {
+        REQUIRE_THROWS_AS( writer.calibrate(), BitException );
+    }
+
+    writer.addFiles( ( test_dir / "input" ).string< tchar >() );
+
+    SECTION( "With the default candidates" ) {
+        const BitCalibrationResult result = writer.calibrate();
+        REQUIRE( result.meets_target );
+        REQUIRE_FALSE( result.cached );
+        REQUIRE( result.ratio > 0 );
+        REQUIRE( result.throughput > 0 );
+        REQUIRE( writer.compressionLevel() == result.parameters.level );
+    }
+
+    SECTION( "With an unreachable throughput target" ) {
+        BitCalibrationOptions options;
+        options.min_throughput = 1e18;
+        const BitCalibrationResult result = writer.calibrate( options );
+        REQUIRE_FALSE( result.meets_target );
+        REQUIRE( writer.compressionLevel() == result.parameters.level );
+    }
+
+    SECTION( "With custom candidates" ) {
+        BitCalibrationOptions options;
+        BitCompressionParameters parameters;
+        parameters.level = BitCompressionLevel::Fast;
+        parameters.threads_count = 2;
+        options.candidates.push_back( parameters );
+
+        const BitCalibrationResult result = writer.calibrate( options );
+        REQUIRE( result.parameters.level == BitCompressionLevel::Fast );
+        REQUIRE( writer.compressionLevel() == BitCompressionLevel::Fast );
+        REQUIRE( writer.threadsCount() == 2 );
+
+        buffer_t archive;
+        REQUIRE_NOTHROW( writer.compressTo( archive ) );
+    }
+
+    SECTION( "With a cache file" ) {
+        BitCalibrationOptions options;
+        options.cache_file = ( test_dir / "calibrations.txt" ).string< tchar >();
+
+        const BitCalibrationResult first = writer.calibrate( options );
+        REQUIRE_FALSE( first.cached );
+        REQUIRE( fs::exists( test_dir / "calibrations.txt" ) );
+
+        BitArchiveWriter other_writer{ lib, BitNullFormat };
+        other_writer.addFiles( ( test_dir / "input" ).string< tchar >() );
+        const BitCalibrationResult second = other_writer.calibrate( options );
+        REQUIRE( second.cached );
+        REQUIRE( second.parameters.level == first.parameters.level );
+        REQUIRE( second.ratio == first.ratio );
+        REQUIRE( other_writer.compressionLevel() == first.parameters.level );
+
+        // A different throughput target is a different profile.
+        options.min_throughput = 1e18;
+        REQUIRE_FALSE( other_writer.calibrate( options ).cached );
+    }
+
+    fs::remove_all( test_dir, error );
+}
+
+#endif
+
+} // namespace test
+} // namespace bit7z
@@ -0,0 +1,140 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <internal/fs.hpp>
+#include <internal/fsindexer.hpp>
+
+#include <string>
+#include <vector>
+
+using std::vector;
+using namespace bit7z;
+using namespace bit7z::filesystem;
+
+inline void make_file( const fs::path& file_path ) {
+    fs::ofstream file{ file_path };
+    file << file_path.filename().string();
+}
+
+/* Creates the following tree (created in a shuffled order, so that it is unlikely the filesystem returns the entries
+ * in the sorted order by chance):
+ *
+ *  root/
+ *    a.txt
+ *    b.log
+ *    dir00/ ... dir31/
+ *      file.txt
+ *      nested/
+ *        file.log
+ *    empty/
+ */
+inline fs::path make_test_tree( const std::string& name ) {
+    const fs::path root = fs::temp_directory_path() / name;
+    std::error_code error;
+    fs::remove_all( root, error );
+    fs::create_directories( root / "empty" );
+    for ( int i = 31; i >= 0; --i ) {
+        const fs::path dir = root / ( std::string{ "dir" } + ( i < 10 ? "0" : "" ) + std::to_string( i ) );
+        fs::create_directories( dir / "nested" );
+        make_file( dir / "nested" / "file.log" );
+        make_file( dir / "file.txt" );
+    }
+    make_file( root / "b.log" );
+    make_file( root / "a.txt" );
+    return root;
+}
+
+inline vector< std::string > indexed_paths( const fs::path& root,
+                                            const tstring& filter,
+                                            bool only_files,
+                                            bool recursive ) {
+    FSItemTable result;
+    FSIndexer indexer{ FSItem{ root }, filter, only_files };
+    indexer.listDirectoryItems( result, recursive );
+
+    vector< std::string > paths;
+    paths.reserve( result.size() );
+    for ( std::size_t index = 0; index < result.size(); ++index ) {
+        paths.push_back( result[ index ].inArchivePath().generic_string() );
+    }
+    return paths;
+}
+
+TEST_CASE( "FSIndexer: Indexing a directory recursively", "[fsindexer]" ) {
+    const fs::path root = make_test_tree( "bit7z_test_indexer" );
+    const std::string root_name = root.filename().string();
+
+    // The items are in a depth-first order, with the entries of each directory sorted by name.
+    vector< std::string > expected{ root_name + "/a.txt", root_name + "/b.log" };
+    for ( int i = 0; i < 32; ++i ) {
+        const std::string dir = root_name + "/dir" + ( i < 10 ? "0" : "" ) + std::to_string( i );
+        expected.push_back( dir );
+        expected.push_back( dir + "/file.txt" );
+        expected.push_back( dir + "/nested" );
+        expected.push_back( dir + "/nested/file.log" );
+    }
+    expected.push_back( root_name + "/empty" );
+
+    const auto paths = indexed_paths( root, {}, false, true );
+    REQUIRE( paths == expected );
+
+    // The order does not depend on the scheduling of the directory listings.
+    for ( int run = 0; run < 10; ++run ) {
+        REQUIRE( indexed_paths( root, {}, false, true ) == paths );
+    }
+
+    std::error_code error;
+    fs::remove_all( root, error );
+}
+
+TEST_CASE( "FSIndexer: Indexing a directory with a filter", "[fsindexer]" ) {
+    const fs::path root = make_test_tree( "bit7z_test_indexer_filter" );
+
+    SECTION( "Recursively" ) {
+        vector< std::string > expected{ "a.txt" };
+        for ( int i = 0; i < 32; ++i ) {
+            expected.push_back( std::string{ "dir" } + ( i < 10 ? "0" : "" ) + std::to_string( i ) + "/file.txt" );
+        }
+        REQUIRE( indexed_paths( root, BIT7Z_STRING( "*.txt" ), false, true ) == expected );
+    }
+
+    SECTION( "Non-recursively" ) {
+        REQUIRE( indexed_paths( root, BIT7Z_STRING( "*.txt" ), false, false ) == vector< std::string >{ "a.txt" } );
+    }
+
+    SECTION( "Non-recursively, with matching directories" ) {
+        // Directories matching the filter are listed too, but their content must match the filter as well.
+        vector< std::string > expected;
+        for ( int i = 0; i < 10; ++i ) {
+            expected.push_back( "dir0" + std::to_string( i ) );
+        }
+        REQUIRE( indexed_paths( root, BIT7Z_STRING( "dir0?" ), false, false ) == expected );
+    }
+
+    std::error_code error;
+    fs::remove_all( root, error );
+}
+
+TEST_CASE( "FSIndexer: Indexing only the files of a directory", "[fsindexer]" ) {
+    const fs::path root = make_test_tree( "bit7z_test_indexer_files" );
+
+    const auto paths = indexed_paths( root, {}, true, true );
+    REQUIRE( paths.size() == 2 + 32 * 2 );
+    for ( const auto& path : paths ) {
+        REQUIRE( fs::is_regular_file( root.parent_path() / path ) );
+    }
+
+    std::error_code error;
+    fs::remove_all( root, error );
+}
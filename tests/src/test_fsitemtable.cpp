@@ -0,0 +1,130 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <bit7z/bititemsvector.hpp>
+#include <internal/fs.hpp>
+#include <internal/fsindexer.hpp>
+#include <internal/fsitemtable.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace bit7z;
+using namespace bit7z::filesystem;
+
+inline uint64_t filetime_value( const FILETIME& file_time ) {
+    return ( static_cast< uint64_t >( file_time.dwHighDateTime ) << 32u ) | file_time.dwLowDateTime;
+}
+
+inline fs::path make_table_test_tree( const std::string& name ) {
+    const fs::path root = fs::temp_directory_path() / name;
+    std::error_code error;
+    fs::remove_all( root, error );
+    fs::create_directories( root / "sub" / "deep" );
+    fs::create_directories( root / "empty" );
+    for ( const auto* file : { "a.txt", "sub/b.bin", "sub/deep/c.txt" } ) {
+        fs::ofstream stream{ root / file };
+        stream << std::string( 100, 'x' ) << file;
+    }
+    return root;
+}
+
+TEST_CASE( "FSItemTable: Items have the same properties of the equivalent FSItem objects", "[fsitemtable]" ) {
+    const fs::path root = make_table_test_tree( "bit7z_test_table" );
+    const bool retain_root = GENERATE( true, false );
+
+    DYNAMIC_SECTION( ( retain_root ? "Retaining" : "Not retaining" ) << " the indexed directory" ) {
+        const FSItem dir_item{ root, retain_root ? root : fs::path{} };
+        FSItemTable table;
+        FSIndexer indexer{ dir_item };
+        indexer.listDirectoryItems( table, true );
+        REQUIRE( table.size() == 6 );
+
+        for ( std::size_t index = 0; index < table.size(); ++index ) {
+            const FSTableItem& item = table[ index ];
+            const fs::path item_path = item.path();
+            const fs::path relative_dir = item_path.parent_path().lexically_relative( root );
+            const fs::path search_path = relative_dir == "." ? dir_item.inArchivePath() :
+                                                               dir_item.inArchivePath() / relative_dir;
+            const FSItem expected{ fs::directory_entry{ item_path }, search_path };
+
+            INFO( "Item: " << item_path );
+            REQUIRE( item_path.parent_path().string().rfind( root.string(), 0 ) == 0 );
+            REQUIRE( item.name() == expected.name() );
+            REQUIRE( item.inArchivePath() == expected.inArchivePath() );
+            REQUIRE( item.isDir() == expected.isDir() );
+            REQUIRE( item.size() == expected.size() );
+            REQUIRE( item.attributes() == expected.attributes() );
+            REQUIRE( filetime_value( item.creationTime() ) == filetime_value( expected.creationTime() ) );
+            REQUIRE( filetime_value( item.lastAccessTime() ) == filetime_value( expected.lastAccessTime() ) );
+            REQUIRE( filetime_value( item.lastWriteTime() ) == filetime_value( expected.lastWriteTime() ) );
+            REQUIRE( item.isPrefetchable() == !item.isDir() );
+        }
+    }
+
+    std::error_code error;
+    fs::remove_all( root, error );
+}
+
+TEST_CASE( "FSItemTable: Indexing several directories in the same table", "[fsitemtable]" ) {
+    const fs::path first_root = make_table_test_tree( "bit7z_test_table_first" );
+    const fs::path second_root = make_table_test_tree( "bit7z_test_table_second" );
+
+    FSItemTable table;
+    FSIndexer first_indexer{ FSItem{ first_root, first_root } };
+    first_indexer.listDirectoryItems( table, true );
+    FSIndexer second_indexer{ FSItem{ second_root, second_root }, BIT7Z_STRING( "*.txt" ) };
+    second_indexer.listDirectoryItems( table, true );
+
+    REQUIRE( table.size() == 6 + 2 );
+    REQUIRE( table[ 0 ].path() == ( first_root / "a.txt" ).string< tchar >() );
+    REQUIRE( table[ 5 ].path() == ( first_root / "sub" / "deep" / "c.txt" ).string< tchar >() );
+    REQUIRE( table[ 6 ].path() == ( second_root / "a.txt" ).string< tchar >() );
+    REQUIRE( table[ 7 ].path() == ( second_root / "sub" / "deep" / "c.txt" ).string< tchar >() );
+    REQUIRE( table[ 7 ].inArchivePath() == fs::path{ "sub" } / "deep" / "c.txt" );
+
+    std::error_code error;
+    fs::remove_all( first_root, error );
+    fs::remove_all( second_root, error );
+}
+
+TEST_CASE( "BitItemsVector: Indexed directories keep the order of the other items", "[fsitemtable]" ) {
+    const fs::path root = make_table_test_tree( "bit7z_test_items_vector" );
+    const std::vector< byte_t > buffer( 10 );
+
+    BitItemsVector items;
+    items.indexBuffer( buffer, BIT7Z_STRING( "first.bin" ) );
+    items.indexDirectory( root, BIT7Z_STRING( "*.txt" ) );
+    items.indexBuffer( buffer, BIT7Z_STRING( "last.bin" ) );
+
+    const std::vector< tstring > expected{ BIT7Z_STRING( "first.bin" ),
+                                           BIT7Z_STRING( "a.txt" ),
+                                           BIT7Z_STRING( "c.txt" ),
+                                           BIT7Z_STRING( "last.bin" ) };
+    REQUIRE( items.size() == expected.size() );
+
+    std::vector< tstring > names;
+    for ( const auto& item : items ) {
+        names.push_back( item->name() );
+    }
+    REQUIRE( names == expected );
+    REQUIRE( items[ 2 ].inArchivePath() == fs::path{ "sub" } / "deep" / "c.txt" );
+
+    BitItemsVector moved_items{ std::move( items ) };
+    REQUIRE( moved_items.size() == expected.size() );
+    REQUIRE( moved_items[ 1 ].size() == 105 );
+
+    std::error_code error;
+    fs::remove_all( root, error );
+}
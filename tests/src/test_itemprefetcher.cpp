@@ -0,0 +1,101 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifdef BIT7Z_NULL_CODEC
+
+#include <catch2/catch.hpp>
+
+#include <bit7z/bit7zlibrary.hpp>
+#include <bit7z/bitarchivereader.hpp>
+#include <bit7z/bitarchivewriter.hpp>
+#include <bit7z/bitnullcodec.hpp>
+#include <internal/fs.hpp>
+
+#include <map>
+
+namespace bit7z {
+namespace test {
+
+// Creates a folder with files of increasing sizes, returning the expected content of the archived items.
+inline std::map< tstring, buffer_t > make_test_files( const fs::path& test_dir, int files_count ) {
+    std::error_code error;
+    fs::remove_all( test_dir, error );
+    fs::create_directories( test_dir );
+
+    std::map< tstring, buffer_t > files;
+    for ( int i = 0; i < files_count; ++i ) {
+        const tstring name = BIT7Z_STRING( "file" ) + to_tstring( i ) + BIT7Z_STRING( ".bin" );
+        const buffer_t content( static_cast< size_t >( 1000 * i ), static_cast< byte_t >( i ) );
+        fs::ofstream file{ test_dir / name, std::ios::binary };
+        file.write( reinterpret_cast< const char* >( content.data() ), // NOLINT(*-pro-type-reinterpret-cast)
+                    static_cast< std::streamsize >( content.size() ) );
+        files.emplace( name, content );
+    }
+    return files;
+}
+
+TEST_CASE( "ItemPrefetcher: Compressing files read in advance", "[itemprefetcher]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    const fs::path test_dir = fs::temp_directory_path() / "bit7z_test_prefetch";
+    const auto expected_files = make_test_files( test_dir, 20 );
+
+    // Note: buffers are already in memory, so they are not read in advance.
+    const buffer_t buffer_content( 10, static_cast< byte_t >( 'x' ) );
+    BitArchiveWriter writer{ lib, BitNullFormat };
+    writer.addFiles( test_dir.string< tchar >() );
+    writer.addFile( buffer_content, BIT7Z_STRING( "buffer.bin" ) );
+
+    const uint32_t prefetch_count = GENERATE( 0u, 1u, 4u, 100u );
+    const uint64_t prefetch_budget = GENERATE( 0u, 5000u, kDefaultInputPrefetchBudget );
+    DYNAMIC_SECTION( "Prefetching " << prefetch_count << " items with a budget of " << prefetch_budget << " bytes" ) {
+        writer.setInputPrefetch( prefetch_count, prefetch_budget );
+
+        buffer_t archive;
+        writer.compressTo( archive );
+
+        const BitArchiveReader reader{ lib, archive, BitNullFormat };
+        std::map< tstring, buffer_t > extracted_items;
+        reader.extract( extracted_items );
+
+        REQUIRE( extracted_items.size() == expected_files.size() + 1 );
+        REQUIRE( extracted_items.at( BIT7Z_STRING( "buffer.bin" ) ) == buffer_content );
+        for ( const auto& file : expected_files ) {
+            REQUIRE( extracted_items.at( file.first ) == file.second );
+        }
+    }
+
+    std::error_code error;
+    fs::remove_all( test_dir, error );
+}
+
+TEST_CASE( "ItemPrefetcher: Compressing missing files read in advance", "[itemprefetcher]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    const fs::path test_dir = fs::temp_directory_path() / "bit7z_test_prefetch_missing";
+    make_test_files( test_dir, 5 );
+
+    BitArchiveWriter writer{ lib, BitNullFormat };
+    writer.addFiles( test_dir.string< tchar >() );
+    writer.setInputPrefetch( 4 );
+
+    // The failure to read a file is reported as usual, even if the file was meant to be read in advance.
+    fs::remove( test_dir / "file3.bin" );
+    buffer_t archive;
+    REQUIRE_THROWS_AS( writer.compressTo( archive ), BitException );
+
+    std::error_code error;
+    fs::remove_all( test_dir, error );
+}
+
+} // namespace test
+} // namespace bit7z
+
+#endif
@@ -0,0 +1,185 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <bit7z/bitmetrics.hpp>
+#include <internal/fs.hpp>
+#include <internal/fsitem.hpp>
+#include <internal/itemsampling.hpp>
+
+#ifdef BIT7Z_NULL_CODEC
+#include <bit7z/bit7zlibrary.hpp>
+#include <bit7z/bitarchivewriter.hpp>
+#include <bit7z/bitnullcodec.hpp>
+#endif
+
+#include <mutex>
+#include <string>
+
+#include "filesystem.hpp"
+
+namespace bit7z {
+namespace test {
+
+inline buffer_t text_bytes( std::size_t size ) {
+    const std::string sentence = "The quick brown fox jumps over the lazy dog. ";
+    buffer_t result;
+    while ( result.size() < size ) {
+        result.push_back( static_cast< byte_t >( sentence[ result.size() % sentence.size() ] ) );
+    }
+    return result;
+}
+
+TEST_CASE( "itemsampling: Computing the entropy of some data", "[itemsampling]" ) {
+    REQUIRE( byteEntropy( nullptr, 0 ) == 0.0 );
+
+    const buffer_t zeros( 1000, static_cast< byte_t >( 0 ) );
+    REQUIRE( byteEntropy( zeros.data(), zeros.size() ) == 0.0 );
+
+    buffer_t all_values;
+    for ( int repetition = 0; repetition < 4; ++repetition ) {
+        for ( int value = 0; value < 256; ++value ) {
+            all_values.push_back( static_cast< byte_t >( value ) );
+        }
+    }
+    REQUIRE( byteEntropy( all_values.data(), all_values.size() ) == Approx( 8.0 ) );
+
+    const buffer_t text = text_bytes( 8192 );
+    REQUIRE( byteEntropy( text.data(), text.size() ) < 5.0 );
+
+    const buffer_t random = filesystem::random_content( 8192, 42 );
+    REQUIRE( byteEntropy( random.data(), random.size() ) > 7.9 );
+}
+
+TEST_CASE( "itemsampling: Estimating the compressibility of the files", "[itemsampling]" ) {
+    const fs::path test_dir = fs::temp_directory_path() / "bit7z_test_itemsampling";
+    std::error_code error;
+    fs::remove_all( test_dir, error );
+    fs::create_directories( test_dir );
+
+    filesystem::write_file( test_dir / "random.bin", filesystem::random_content( 20000, 1 ) );
+    filesystem::write_file( test_dir / "text.txt", text_bytes( 20000 ) );
+    filesystem::write_file( test_dir / "small.bin", filesystem::random_content( 100, 2 ) );
+
+    using bit7z::filesystem::FSItem;
+    REQUIRE( estimateCompressibility( FSItem{ test_dir / "random.bin" }, kDefaultIncompressibleEntropy ) ==
+             Compressibility::Incompressible );
+    REQUIRE( estimateCompressibility( FSItem{ test_dir / "text.txt" }, kDefaultIncompressibleEntropy ) ==
+             Compressibility::Compressible );
+    REQUIRE( estimateCompressibility( FSItem{ test_dir / "small.bin" }, kDefaultIncompressibleEntropy ) ==
+             Compressibility::Unknown );
+    REQUIRE( estimateCompressibility( FSItem{ test_dir }, kDefaultIncompressibleEntropy ) ==
+             Compressibility::Unknown );
+
+    // With a threshold above 8 bits per byte, no file is incompressible.
+    REQUIRE( estimateCompressibility( FSItem{ test_dir / "random.bin" }, 8.5 ) == Compressibility::Compressible );
+
+    fs::remove_all( test_dir, error );
+}
+
+#ifdef BIT7Z_NULL_CODEC
+
+TEST_CASE( "BitOutputArchive: Storing the incompressible files", "[itemsampling]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    const fs::path test_dir = fs::temp_directory_path() / "bit7z_test_store";
+    std::error_code error;
+    fs::remove_all( test_dir, error );
+    fs::create_directories( test_dir );
+
+    filesystem::write_file( test_dir / "photo.jpg", filesystem::random_content( 30000, 1 ) );
+    filesystem::write_file( test_dir / "package.zip", filesystem::random_content( 20000, 2 ) );
+    filesystem::write_file( test_dir / "readme.txt", text_bytes( 100 ) ); // Too small for being checked.
+
+    std::mutex metrics_mutex;
+    uint64_t stored_bytes = 0;
+    std::size_t operations = 0;
+    BitArchiveWriter writer{ lib, BitNullFormat };
+    writer.setStoreIncompressible( true );
+    writer.setMetricsCallback( [ & ]( const BitOperationMetrics& metrics ) {
+        const std::lock_guard< std::mutex > lock{ metrics_mutex };
+        stored_bytes += metrics.stored_bytes;
+        ++operations;
+    } );
+
+    SECTION( "Into a single archive, when all the files are incompressible" ) {
+        writer.addFiles( test_dir.string< tchar >() );
+        buffer_t archive;
+        writer.compressTo( archive );
+        REQUIRE( operations == 1 );
+        REQUIRE( stored_bytes == 30000 + 20000 + 100 );
+    }
+
+    SECTION( "Into a single archive, when some files are compressible" ) {
+        filesystem::write_file( test_dir / "notes.txt", text_bytes( 10000 ) );
+        writer.addFiles( test_dir.string< tchar >() );
+        buffer_t archive;
+        writer.compressTo( archive );
+        REQUIRE( operations == 1 );
+        REQUIRE( stored_bytes == 0 );
+    }
+
+    SECTION( "Into a single archive, when a compressible file is added after estimating the memory" ) {
+        writer.addFiles( test_dir.string< tchar >() );
+        REQUIRE( writer.memoryEstimate().fits );
+
+        filesystem::write_file( test_dir / "notes.txt", text_bytes( 10000 ) );
+        writer.addFile( ( test_dir / "notes.txt" ).string< tchar >() );
+        buffer_t archive;
+        writer.compressTo( archive );
+        REQUIRE( operations == 1 );
+        REQUIRE( stored_bytes == 0 );
+    }
+
+    SECTION( "Into a single archive, without the store option" ) {
+        writer.setStoreIncompressible( false );
+        writer.addFiles( test_dir.string< tchar >() );
+        buffer_t archive;
+        writer.compressTo( archive );
+        REQUIRE( stored_bytes == 0 );
+    }
+
+    SECTION( "Into shards" ) {
+        filesystem::write_file( test_dir / "notes.txt", text_bytes( 10000 ) );
+        writer.addFiles( test_dir.string< tchar >() );
+        const fs::path prefix = test_dir / "backup";
+        const BitShardManifest manifest = writer.compressToShards( prefix.string< tchar >(), 1 );
+
+        // The incompressible files are stored into a shard of their own.
+        REQUIRE( manifest.shards.size() == 2 );
+        REQUIRE( manifest.items.at( BIT7Z_STRING( "notes.txt" ) ) == 0 );
+        REQUIRE( manifest.items.at( BIT7Z_STRING( "readme.txt" ) ) == 0 );
+        REQUIRE( manifest.items.at( BIT7Z_STRING( "photo.jpg" ) ) == 1 );
+        REQUIRE( manifest.items.at( BIT7Z_STRING( "package.zip" ) ) == 1 );
+        REQUIRE( operations == 2 );
+        REQUIRE( stored_bytes == 30000 + 20000 );
+    }
+
+    SECTION( "Into shards of a maximum size" ) {
+        writer.addFiles( test_dir.string< tchar >() );
+        const fs::path prefix = test_dir / "backup";
+        const BitShardManifest manifest = writer.compressToShardsOfSize( prefix.string< tchar >(), 40000 );
+
+        REQUIRE( manifest.shards.size() == 3 );
+        REQUIRE( manifest.items.at( BIT7Z_STRING( "readme.txt" ) ) == 0 );
+        REQUIRE( manifest.items.at( BIT7Z_STRING( "photo.jpg" ) ) !=
+                 manifest.items.at( BIT7Z_STRING( "package.zip" ) ) );
+        REQUIRE( stored_bytes == 30000 + 20000 );
+    }
+
+    fs::remove_all( test_dir, error );
+}
+
+#endif
+
+} // namespace test
+} // namespace bit7z
@@ -0,0 +1,210 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <internal/fs.hpp>
+#include <internal/memoryplanner.hpp>
+
+#ifdef BIT7Z_NULL_CODEC
+#include <bit7z/bit7zlibrary.hpp>
+#include <bit7z/bitarchivewriter.hpp>
+#include <bit7z/bitnullcodec.hpp>
+#endif
+
+namespace bit7z {
+namespace test {
+
+constexpr uint64_t kMiB = 1024 * 1024;
+constexpr uint64_t kGiB = 1024 * kMiB;
+
+TEST_CASE( "memoryplanner: Estimating the memory used by the encoders", "[memoryplanner]" ) {
+    const auto lzma2_usage = []( uint32_t dictionary_size, uint32_t threads_count, uint64_t input_size ) {
+        return compressionMemoryUsage( BitFormat::SevenZip, BitCompressionMethod::Lzma2, BitCompressionLevel::Ultra,
+                                       dictionary_size, threads_count, input_size );
+    };
+
+    // The binary tree match finder uses about 10.5 times the dictionary size.
+    const uint64_t single_thread = lzma2_usage( 64 * kMiB, 1, 0 );
+    REQUIRE( single_thread > 10 * 64 * kMiB );
+    REQUIRE( single_thread < 11 * 64 * kMiB );
+
+    // Two threads per LZMA2 block, each block with its own encoder.
+    REQUIRE( lzma2_usage( 64 * kMiB, 2, 0 ) == single_thread );
+    REQUIRE( lzma2_usage( 64 * kMiB, 8, 0 ) > 4 * single_thread );
+
+    // The dictionary is allocated only as needed by the input, which also limits the number of blocks.
+    REQUIRE( lzma2_usage( 64 * kMiB, 8, kMiB ) < 32 * kMiB );
+    REQUIRE( lzma2_usage( 1536 * kMiB, 32, 0 ) > 100 * kGiB );
+
+    const uint64_t bzip2_usage = compressionMemoryUsage( BitFormat::SevenZip, BitCompressionMethod::BZip2,
+                                                         BitCompressionLevel::Normal, 0, 4, 0 );
+    REQUIRE( bzip2_usage > 4 * 10 * kMiB );
+    REQUIRE( bzip2_usage < 4 * 10 * kMiB + 10 * kMiB );
+
+    // The zip format compresses a file per thread.
+    REQUIRE( compressionMemoryUsage( BitFormat::Zip, BitCompressionMethod::Lzma, BitCompressionLevel::Normal,
+                                     16 * kMiB, 4, 0 ) >
+             3 * compressionMemoryUsage( BitFormat::SevenZip, BitCompressionMethod::Lzma, BitCompressionLevel::Normal,
+                                         16 * kMiB, 4, 0 ) );
+
+    REQUIRE( defaultDictionarySize( BitCompressionMethod::Lzma2, BitCompressionLevel::Normal ) == 16 * kMiB );
+    REQUIRE( defaultDictionarySize( BitCompressionMethod::Deflate, BitCompressionLevel::Normal ) == 0 );
+}
+
+TEST_CASE( "memoryplanner: Estimating the memory used by the decoders", "[memoryplanner]" ) {
+    uint32_t dictionary_size = 0;
+    const uint64_t base_usage = decodingMemoryUsage( BIT7Z_STRING( "" ), dictionary_size );
+    REQUIRE( dictionary_size == 0 );
+
+    const uint64_t lzma2_usage = decodingMemoryUsage( BIT7Z_STRING( "LZMA2:26" ), dictionary_size );
+    REQUIRE( dictionary_size == 64 * kMiB );
+    REQUIRE( lzma2_usage > base_usage + 64 * kMiB );
+    REQUIRE( lzma2_usage < base_usage + 66 * kMiB );
+
+    // The coders of an item are all allocated at the same time.
+    REQUIRE( decodingMemoryUsage( BIT7Z_STRING( "BCJ2 LZMA2:26 LZMA:20 LZMA:20" ), dictionary_size ) >
+             lzma2_usage + 2 * kMiB );
+    REQUIRE( dictionary_size == 64 * kMiB );
+
+    // Dictionary sizes that are not powers of two have a unit.
+    REQUIRE( decodingMemoryUsage( BIT7Z_STRING( "LZMA:1536m BCJ 7zAES" ), dictionary_size ) > 1536 * kMiB );
+    REQUIRE( dictionary_size == 1536 * kMiB );
+
+    REQUIRE( decodingMemoryUsage( BIT7Z_STRING( "PPMD:o32:mem192m" ), dictionary_size ) > 192 * kMiB );
+    REQUIRE( dictionary_size == 192 * kMiB );
+    REQUIRE( decodingMemoryUsage( BIT7Z_STRING( "PPMd:o6:mem24" ), dictionary_size ) > 16 * kMiB );
+    REQUIRE( dictionary_size == 16 * kMiB );
+
+    REQUIRE( decodingMemoryUsage( BIT7Z_STRING( "Deflate" ), dictionary_size ) < base_usage + 2 * kMiB );
+    REQUIRE( dictionary_size == 0 );
+    REQUIRE( decodingMemoryUsage( BIT7Z_STRING( "Copy" ), dictionary_size ) < base_usage + kMiB );
+
+    // Unknown coders and malformed sizes are assumed to need a few MiB.
+    REQUIRE( decodingMemoryUsage( BIT7Z_STRING( "LZMA2:huge" ), dictionary_size ) > base_usage );
+    REQUIRE( dictionary_size == 0 );
+    REQUIRE( decodingMemoryUsage( BIT7Z_STRING( "Unknown" ), dictionary_size ) > base_usage );
+}
+
+#ifdef BIT7Z_NULL_CODEC
+
+TEST_CASE( "memoryplanner: Planning the compression within a memory budget", "[memoryplanner]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    BitArchiveWriter writer{ lib, BitFormat::SevenZip };
+    writer.setCompressionLevel( BitCompressionLevel::Ultra );
+    writer.setDictionarySize( 1536 * kMiB );
+    writer.setThreadsCount( 32 );
+
+    BitMemoryEstimate estimate = planCompressionMemory( writer, 0, 0 );
+    REQUIRE( estimate.fits );
+    REQUIRE_FALSE( estimate.reduced );
+    REQUIRE( estimate.memory_usage > 100 * kGiB );
+    REQUIRE( estimate.threads_count == 32 );
+    REQUIRE( estimate.dictionary_size == 1536 * kMiB );
+
+    // The threads granted by a thread governor limit the planned ones.
+    estimate = planCompressionMemory( writer, 0, 0, false, 4 );
+    REQUIRE_FALSE( estimate.reduced );
+    REQUIRE( estimate.threads_count == 4 );
+
+    // The threads are reduced first, then the dictionary.
+    estimate = planCompressionMemory( writer, 0, 20 * kGiB );
+    REQUIRE( estimate.fits );
+    REQUIRE( estimate.reduced );
+    REQUIRE( estimate.memory_usage <= 20 * kGiB );
+    REQUIRE( estimate.threads_count == 3 );
+    REQUIRE( estimate.dictionary_size == 1536 * kMiB );
+
+    estimate = planCompressionMemory( writer, 0, 2 * kGiB );
+    REQUIRE( estimate.fits );
+    REQUIRE( estimate.memory_usage <= 2 * kGiB );
+    REQUIRE( estimate.threads_count == 1 );
+    REQUIRE( estimate.dictionary_size == 128 * kMiB );
+
+    estimate = planCompressionMemory( writer, 0, kMiB );
+    REQUIRE_FALSE( estimate.fits );
+    REQUIRE( estimate.memory_budget == kMiB );
+
+    // Small inputs need much less memory.
+    REQUIRE( planCompressionMemory( writer, 100 * 1024, 0 ).memory_usage < 16 * kMiB );
+
+    // Storing does not depend on the dictionary size.
+    REQUIRE( planCompressionMemory( writer, 0, 16 * kMiB, true ).fits );
+}
+
+TEST_CASE( "BitOutputArchive: Compressing within a memory budget", "[memoryplanner]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    const fs::path test_dir = fs::temp_directory_path() / "bit7z_test_memoryplanner";
+    std::error_code error;
+    fs::remove_all( test_dir, error );
+    fs::create_directories( test_dir );
+
+    const buffer_t first_content( 1000, static_cast< byte_t >( 'a' ) );
+    const buffer_t second_content( 2000, static_cast< byte_t >( 'b' ) );
+    BitArchiveWriter writer{ lib, BitNullFormat };
+    writer.addFile( first_content, BIT7Z_STRING( "first.txt" ) );
+    writer.addFile( second_content, BIT7Z_STRING( "second.txt" ) );
+
+    const uint64_t usage = writer.memoryEstimate().memory_usage;
+    REQUIRE( usage > 0 );
+    REQUIRE( writer.memoryEstimate().fits );
+
+    SECTION( "With enough memory" ) {
+        writer.setMemoryBudget( usage );
+        buffer_t archive;
+        REQUIRE_NOTHROW( writer.compressTo( archive ) );
+        REQUIRE_FALSE( archive.empty() );
+    }
+
+    SECTION( "Without enough memory" ) {
+        writer.setMemoryBudget( usage - 1 );
+        REQUIRE_FALSE( writer.memoryEstimate().fits );
+
+        buffer_t archive;
+        REQUIRE_THROWS_AS( writer.compressTo( archive ), BitException );
+
+        // The old archive is kept.
+        const fs::path archive_path = test_dir / "archive.bin";
+        fs::ofstream{ archive_path } << "old";
+        writer.setOverwriteMode( OverwriteMode::Overwrite );
+        REQUIRE_THROWS_AS( writer.compressTo( archive_path.string< tchar >() ), BitException );
+        REQUIRE( fs::file_size( archive_path ) == 3 );
+    }
+
+    SECTION( "With a global budget" ) {
+        BitAbstractArchiveCreator::setGlobalMemoryBudget( usage - 1 );
+        REQUIRE( BitAbstractArchiveCreator::globalMemoryBudget() == usage - 1 );
+        REQUIRE_FALSE( writer.memoryEstimate().fits );
+
+        // The smaller of the two budgets is used.
+        writer.setMemoryBudget( 2 * usage );
+        REQUIRE_FALSE( writer.memoryEstimate().fits );
+        BitAbstractArchiveCreator::setGlobalMemoryBudget( 0 );
+        REQUIRE( writer.memoryEstimate().fits );
+    }
+
+    SECTION( "Into shards" ) {
+        // The budget allows compressing only one shard at a time.
+        writer.setMemoryBudget( usage );
+        const fs::path prefix = test_dir / "backup";
+        const BitShardManifest manifest = writer.compressToShards( prefix.string< tchar >(), 2 );
+        REQUIRE( manifest.shards.size() == 2 );
+    }
+
+    BitAbstractArchiveCreator::setGlobalMemoryBudget( 0 );
+    fs::remove_all( test_dir, error );
+}
+
+#endif
+
+} // namespace test
+} // namespace bit7z
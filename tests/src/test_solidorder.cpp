@@ -0,0 +1,141 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2022 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <bit7z/bit7zlibrary.hpp>
+#include <bit7z/bitarchivereader.hpp>
+#include <bit7z/bitarchivewriter.hpp>
+#include <bit7z/bitnullcodec.hpp>
+#include <internal/fs.hpp>
+#include <internal/solidorder.hpp>
+
+#include <string>
+#include <vector>
+
+#include "filesystem.hpp"
+
+namespace bit7z {
+namespace test {
+
+TEST_CASE( "solidorder: Sketching the content of some data", "[solidorder]" ) {
+    const buffer_t original = filesystem::random_content( 16 * 1024, 1 );
+    const ContentSketch original_sketch = contentSketch( original.data(), original.size() );
+
+    REQUIRE( sketchSimilarity( original_sketch, contentSketch( original.data(), original.size() ) ) == 1.0 );
+
+    // The chunks are content-defined, so inserting some bytes changes only the chunks around the insertion point.
+    buffer_t edited = original;
+    const buffer_t insertion = filesystem::random_content( 10, 2 );
+    edited.insert( edited.begin() + 5000, insertion.begin(), insertion.end() );
+    REQUIRE( sketchSimilarity( original_sketch, contentSketch( edited.data(), edited.size() ) ) >= 0.75 );
+
+    const buffer_t unrelated = filesystem::random_content( 16 * 1024, 3 );
+    REQUIRE( sketchSimilarity( original_sketch, contentSketch( unrelated.data(), unrelated.size() ) ) <= 0.125 );
+}
+
+#ifdef BIT7Z_NULL_CODEC
+
+inline std::vector< tstring > archived_paths( const Bit7zLibrary& lib, const buffer_t& archive ) {
+    const BitArchiveReader reader{ lib, archive, BitNullFormat };
+    std::vector< tstring > result;
+    for ( const auto& item : reader ) {
+        result.push_back( item.path() );
+    }
+    return result;
+}
+
+TEST_CASE( "BitOutputArchive: Ordering the items for solid compression", "[solidorder]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    const fs::path test_dir = fs::temp_directory_path() / "bit7z_test_solidorder";
+    std::error_code error;
+    fs::remove_all( test_dir, error );
+    fs::create_directories( test_dir );
+
+    // In size order, the near-duplicate of a.txt (c.txt) is the last of the text files.
+    const buffer_t content = filesystem::random_content( 4000, 10 );
+    buffer_t near_duplicate = content;
+    const buffer_t insertion = filesystem::random_content( 30, 11 );
+    near_duplicate.insert( near_duplicate.begin() + 2000, insertion.begin(), insertion.end() );
+    filesystem::write_file( test_dir / "a.txt", content );
+    filesystem::write_file( test_dir / "b.LOG", filesystem::random_content( 10, 12 ) );
+    filesystem::write_file( test_dir / "c.txt", near_duplicate );
+    filesystem::write_file( test_dir / "x.txt", filesystem::random_content( 4010, 13 ) );
+    filesystem::write_file( test_dir / "y.txt", filesystem::random_content( 4020, 14 ) );
+
+    BitArchiveWriter writer{ lib, BitNullFormat };
+    writer.addFiles( test_dir.string< tchar >() );
+
+    buffer_t archive;
+    SECTION( "Without ordering" ) {
+        writer.compressTo( archive );
+        REQUIRE( archived_paths( lib, archive ) == std::vector< tstring >{
+            BIT7Z_STRING( "a.txt" ), BIT7Z_STRING( "b.LOG" ), BIT7Z_STRING( "c.txt" ),
+            BIT7Z_STRING( "x.txt" ), BIT7Z_STRING( "y.txt" )
+        } );
+    }
+
+    SECTION( "By type" ) {
+        writer.setSolidOrder( SolidOrder::ByType );
+        writer.compressTo( archive );
+        REQUIRE( archived_paths( lib, archive ) == std::vector< tstring >{
+            BIT7Z_STRING( "b.LOG" ), BIT7Z_STRING( "a.txt" ), BIT7Z_STRING( "x.txt" ),
+            BIT7Z_STRING( "y.txt" ), BIT7Z_STRING( "c.txt" )
+        } );
+    }
+
+    SECTION( "By similarity" ) {
+        writer.setSolidOrder( SolidOrder::BySimilarity );
+        writer.compressTo( archive );
+        REQUIRE( archived_paths( lib, archive ) == std::vector< tstring >{
+            BIT7Z_STRING( "b.LOG" ), BIT7Z_STRING( "a.txt" ), BIT7Z_STRING( "c.txt" ),
+            BIT7Z_STRING( "x.txt" ), BIT7Z_STRING( "y.txt" )
+        } );
+
+        // The content of the items is not affected by their order.
+        const BitArchiveReader reader{ lib, archive, BitNullFormat };
+        buffer_t extracted;
+        reader.extract( extracted, 2 );
+        REQUIRE( extracted == near_duplicate );
+    }
+
+    fs::remove_all( test_dir, error );
+}
+
+TEST_CASE( "BitOutputArchive: Ordering the items appended to an archive", "[solidorder]" ) {
+    const Bit7zLibrary lib{ &nullCodecCreateObject };
+    const buffer_t input_archive = makeNullArchive( 2, 10 );
+
+    const buffer_t large_text = filesystem::random_content( 20, 1 );
+    const buffer_t small_text = filesystem::random_content( 10, 2 );
+    const buffer_t log = filesystem::random_content( 10, 3 );
+
+    BitArchiveWriter writer{ lib, input_archive, BitNullFormat };
+    writer.setSolidOrder( SolidOrder::ByType );
+    writer.addFile( large_text, BIT7Z_STRING( "z.txt" ) );
+    writer.addFile( small_text, BIT7Z_STRING( "y.txt" ) );
+    writer.addFile( log, BIT7Z_STRING( "a.log" ) );
+
+    buffer_t archive;
+    writer.compressTo( archive );
+
+    // The items of the input archive are kept before the new ones.
+    REQUIRE( archived_paths( lib, archive ) == std::vector< tstring >{
+        BIT7Z_STRING( "item0.bin" ), BIT7Z_STRING( "item1.bin" ),
+        BIT7Z_STRING( "a.log" ), BIT7Z_STRING( "y.txt" ), BIT7Z_STRING( "z.txt" )
+    } );
+}
+
+#endif
+
+} // namespace test
+} // namespace bit7z